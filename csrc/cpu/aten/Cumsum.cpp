@@ -11,24 +11,50 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(cumsum_kernel_stub);
+DEFINE_DISPATCH(segment_cumsum_kernel_stub);
+
+namespace {
+
+// The integers are summed in int64 unless another dtype is given. The
+// kernels cast the input themselves, e.g. int32 lengths are not copied.
+at::ScalarType cumsum_result_type(
+    const at::Tensor& self,
+    c10::optional<at::ScalarType> dtype) {
+  if (dtype.has_value()) {
+    return dtype.value();
+  }
+  return at::isIntegralType(self.scalar_type(), /*includeBool=*/true)
+      ? at::kLong
+      : self.scalar_type();
+}
+
+} // namespace
 
 at::Tensor cumsum(
     const at::Tensor& self,
     int64_t dim,
-    c10::optional<at::ScalarType> dtype) {
-  auto casted_self = at::native::integer_upcast(self, dtype);
-  at::Tensor result = at::empty_like(casted_self, at::MemoryFormat::Contiguous);
+    c10::optional<at::ScalarType> dtype,
+    bool exclusive) {
+  at::Tensor result = at::empty(
+      self.sizes(), self.options().dtype(cumsum_result_type(self, dtype)));
 
-  // pointer to cumsum_kernel_impl(result, casted_self, dim, dtype);
-  return cumsum_kernel_stub(kCPU, result, casted_self, dim, dtype);
+  // pointer to cumsum_kernel_impl(result, self, dim, exclusive);
+  return cumsum_kernel_stub(kCPU, result, self, dim, exclusive);
 }
 
 at::Tensor& cumsum_(
     at::Tensor& self,
     int64_t dim,
-    c10::optional<at::ScalarType> dtype) {
-  // pointer to cumsum_kernel_impl(self, self, dim, dtype);
-  cumsum_kernel_stub(kCPU, self, self, dim, dtype);
+    c10::optional<at::ScalarType> dtype,
+    bool exclusive) {
+  TORCH_CHECK(
+      !dtype.has_value() || dtype.value() == self.scalar_type(),
+      "cumsum_: expected dtype ",
+      self.scalar_type(),
+      " for the in-place scan, got ",
+      dtype.value());
+  // pointer to cumsum_kernel_impl(self, self, dim, exclusive);
+  cumsum_kernel_stub(kCPU, self, self, dim, exclusive);
 
   return self;
 }
@@ -37,30 +63,67 @@ at::Tensor& cumsum_out(
     const at::Tensor& self,
     int64_t dim,
     c10::optional<at::ScalarType> dtype,
+    bool exclusive,
     at::Tensor& result) {
-  // cumsum_kernel_impl(result, self.toType(result.scalar_type()), dim, dtype);
-  cumsum_kernel_stub(
-      kCPU, result, self.toType(result.scalar_type()), dim, dtype);
+  TORCH_CHECK(
+      !dtype.has_value() || dtype.value() == result.scalar_type(),
+      "cumsum.out: expected dtype ",
+      result.scalar_type(),
+      " for the out tensor, got ",
+      dtype.value());
+  // pointer to cumsum_kernel_impl(result, self, dim, exclusive);
+  cumsum_kernel_stub(kCPU, result, self, dim, exclusive);
 
   return result;
 }
 
+at::Tensor segment_cumsum(
+    const at::Tensor& self,
+    const at::Tensor& offsets,
+    bool exclusive,
+    c10::optional<at::ScalarType> dtype) {
+  TORCH_CHECK(
+      self.dim() >= 1, "segment_cumsum: expected a tensor of 1 dim or more");
+  TORCH_CHECK(
+      offsets.dim() == 1 && offsets.numel() >= 1 &&
+          at::isIntegralType(offsets.scalar_type(), /*includeBool=*/false),
+      "segment_cumsum: expected 1-D integer offsets");
+  auto offsets_ = offsets.to(at::kLong).contiguous();
+  const int64_t* offsets_data = offsets_.data_ptr<int64_t>();
+  const int64_t num_segments = offsets_.numel() - 1;
+  TORCH_CHECK(
+      offsets_data[0] == 0 && offsets_data[num_segments] == self.size(0) &&
+          std::is_sorted(offsets_data, offsets_data + num_segments + 1),
+      "segment_cumsum: expected non-decreasing offsets from 0 to ",
+      self.size(0));
+  at::Tensor result = at::empty(
+      self.sizes(), self.options().dtype(cumsum_result_type(self, dtype)));
+
+  // pointer to segment_cumsum_kernel_impl(result, self, offsets_, exclusive);
+  return segment_cumsum_kernel_stub(kCPU, result, self, offsets_, exclusive);
+}
+
 } // namespace cpu
 
 namespace {
 
 TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
-      "cumsum(Tensor self, int dim, *, ScalarType? dtype=None) -> Tensor",
+      "cumsum(Tensor self, int dim, *, ScalarType? dtype=None, "
+      "bool exclusive=False) -> Tensor",
       torch_ipex::cpu::cumsum);
   m.def(
-      "cumsum_(Tensor(a!) self, int dim, *, ScalarType? dtype=None) -> "
-      "Tensor(a!)",
+      "cumsum_(Tensor(a!) self, int dim, *, ScalarType? dtype=None, "
+      "bool exclusive=False) -> Tensor(a!)",
       torch_ipex::cpu::cumsum_);
   m.def(
       "cumsum.out(Tensor self, int dim, *, ScalarType? dtype=None, "
-      "Tensor(a!) out) -> Tensor(a!)",
+      "bool exclusive=False, Tensor(a!) out) -> Tensor(a!)",
       torch_ipex::cpu::cumsum_out);
+  m.def(
+      "segment_cumsum(Tensor self, Tensor offsets, *, bool exclusive=False, "
+      "ScalarType? dtype=None) -> Tensor",
+      torch_ipex::cpu::segment_cumsum);
 }
 
 } // namespace
@@ -11,16 +11,23 @@ at::Tensor cumsum_kernel_impl(
     at::Tensor& result,
     const at::Tensor& self,
     int64_t dim,
-    c10::optional<at::ScalarType> dtype);
+    bool exclusive);
 
-}
+at::Tensor segment_cumsum_kernel_impl(
+    at::Tensor& result,
+    const at::Tensor& self,
+    const at::Tensor& offsets,
+    bool exclusive);
 
-using cumsum_kernel_fn = at::Tensor (*)(
-    at::Tensor&,
-    const at::Tensor&,
-    int64_t,
-    c10::optional<at::ScalarType>);
+} // namespace
+
+using cumsum_kernel_fn =
+    at::Tensor (*)(at::Tensor&, const at::Tensor&, int64_t, bool);
 DECLARE_DISPATCH(cumsum_kernel_fn, cumsum_kernel_stub);
 
+using segment_cumsum_kernel_fn =
+    at::Tensor (*)(at::Tensor&, const at::Tensor&, const at::Tensor&, bool);
+DECLARE_DISPATCH(segment_cumsum_kernel_fn, segment_cumsum_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
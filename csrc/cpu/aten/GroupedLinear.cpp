@@ -0,0 +1,84 @@
+#include "GroupedLinear.h"
+
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(grouped_linear_kernel_stub);
+
+namespace {
+
+GroupedLinearPostOp parse_post_op(c10::string_view post_op) {
+  if (post_op == "none") {
+    return GroupedLinearPostOp::None;
+  } else if (post_op == "relu") {
+    return GroupedLinearPostOp::Relu;
+  } else if (post_op == "gelu") {
+    return GroupedLinearPostOp::Gelu;
+  } else if (post_op == "silu") {
+    return GroupedLinearPostOp::Silu;
+  }
+  TORCH_CHECK(
+      post_op == "sigmoid", "grouped_linear: unsupported post op ", post_op);
+  return GroupedLinearPostOp::Sigmoid;
+}
+
+} // namespace
+
+std::vector<at::Tensor> grouped_linear(
+    const std::vector<at::Tensor>& inputs,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    c10::string_view post_op) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::grouped_linear\n");
+#endif
+  RECORD_FUNCTION("torch_ipex::grouped_linear", c10::ArrayRef<c10::IValue>({}));
+
+  const int64_t groups = inputs.size();
+  TORCH_CHECK(groups > 0, "grouped_linear: expects at least one input");
+  TORCH_CHECK(
+      weight.dim() == 3 && weight.size(0) == groups,
+      "grouped_linear: expects weight in [G, K, N] with G = number of inputs");
+  // The leading sizes of the inputs are free: the graph is grouped on
+  // profiled shapes, which later runs do not have to keep.
+  for (const auto& input : inputs) {
+    TORCH_CHECK(
+        input.scalar_type() == weight.scalar_type(),
+        "grouped_linear: expects all inputs with the same dtype as the weight");
+    TORCH_CHECK(
+        input.dim() > 0 && input.size(-1) == weight.size(1),
+        "grouped_linear: input feature size does not match the weight");
+  }
+  const auto dtype = weight.scalar_type();
+  TORCH_CHECK(
+      dtype == at::kFloat || dtype == at::kBFloat16 || dtype == at::kHalf,
+      "grouped_linear: expects float, bfloat16 or half inputs, but got ",
+      dtype);
+  at::Tensor bias_ = bias.has_value() ? bias.value() : at::Tensor();
+  TORCH_CHECK(
+      !bias_.defined() ||
+          (bias_.dim() == 2 && bias_.size(0) == groups &&
+           bias_.size(1) == weight.size(2)),
+      "grouped_linear: expects bias in [G, N]");
+  // pointer to grouped_linear_kernel_impl(inputs, weight, bias, post_op);
+  return grouped_linear_kernel_stub(
+      kCPU, inputs, weight, bias_, parse_post_op(post_op));
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      torch::schema(
+          "torch_ipex::grouped_linear(Tensor[] inputs, Tensor weight, "
+          "Tensor? bias, str post_op) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::cpu::grouped_linear);
+}
+
+} // namespace
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Eltwise applied on the output of every group, together with the bias.
+enum class GroupedLinearPostOp : int64_t {
+  None = 0,
+  Relu,
+  Gelu,
+  Silu,
+  Sigmoid,
+};
+
+// G independent linears sharing the same weight shape, evaluated together:
+// outputs[g] = post_op(inputs[g] @ weight[g] + bias[g]).
+// Every input is [*, K], weight is the stacked and transposed weights in
+// [G, K, N] and bias, if given, is [G, N].
+std::vector<at::Tensor> grouped_linear(
+    const std::vector<at::Tensor>& inputs,
+    const at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    c10::string_view post_op);
+
+namespace {
+
+std::vector<at::Tensor> grouped_linear_kernel_impl(
+    const std::vector<at::Tensor>& inputs,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    GroupedLinearPostOp post_op);
+
+} // namespace
+
+using grouped_linear_kernel_fn = std::vector<at::Tensor> (*)(
+    const std::vector<at::Tensor>&,
+    const at::Tensor&,
+    const at::Tensor&,
+    GroupedLinearPostOp);
+DECLARE_DISPATCH(grouped_linear_kernel_fn, grouped_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
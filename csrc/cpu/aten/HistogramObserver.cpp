@@ -0,0 +1,78 @@
+#include "HistogramObserver.h"
+
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(histogram_observer_update_kernel_stub);
+DEFINE_DISPATCH(histogram_observer_param_search_kernel_stub);
+
+void histogram_observer_update(
+    const at::Tensor& x,
+    at::Tensor& histogram,
+    at::Tensor& min_val,
+    at::Tensor& max_val,
+    int64_t upsample_rate) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::histogram_observer_update\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::histogram_observer_update", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      histogram.scalar_type() == at::kFloat && histogram.is_contiguous(),
+      "histogram_observer_update: expects a contiguous float histogram");
+  TORCH_CHECK(
+      min_val.numel() == 1 && max_val.numel() == 1,
+      "histogram_observer_update: expects per tensor min_val and max_val");
+  TORCH_CHECK(
+      upsample_rate > 0,
+      "histogram_observer_update: upsample_rate should be positive");
+  if (x.numel() == 0) {
+    return;
+  }
+  // pointer to histogram_observer_update_kernel_impl(x, histogram, min_val,
+  // max_val, upsample_rate);
+  histogram_observer_update_kernel_stub(
+      kCPU, x, histogram, min_val, max_val, upsample_rate);
+}
+
+std::tuple<at::Tensor, at::Tensor> histogram_observer_param_search(
+    const at::Tensor& histogram,
+    const at::Tensor& min_val,
+    const at::Tensor& max_val,
+    int64_t dst_nbins) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::histogram_observer_param_search\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::histogram_observer_param_search",
+      c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      dst_nbins > 0,
+      "histogram_observer_param_search: dst_nbins should be positive");
+  // pointer to histogram_observer_param_search_kernel_impl(histogram,
+  // min_val, max_val, dst_nbins);
+  return histogram_observer_param_search_kernel_stub(
+      kCPU, histogram, min_val, max_val, dst_nbins);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "histogram_observer_update(Tensor x, Tensor(a!) histogram, "
+      "Tensor(b!) min_val, Tensor(c!) max_val, int upsample_rate) -> ()",
+      torch_ipex::cpu::histogram_observer_update);
+  m.def(
+      "histogram_observer_param_search(Tensor histogram, Tensor min_val, "
+      "Tensor max_val, int dst_nbins) -> (Tensor, Tensor)",
+      torch_ipex::cpu::histogram_observer_param_search);
+}
+
+} // namespace
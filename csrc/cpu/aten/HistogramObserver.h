@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Same semantics as torch.ao.quantization.HistogramObserver.forward:
+// histogram, min_val and max_val are the observer buffers and are updated in
+// place with the statistics of x.
+void histogram_observer_update(
+    const at::Tensor& x,
+    at::Tensor& histogram,
+    at::Tensor& min_val,
+    at::Tensor& max_val,
+    int64_t upsample_rate);
+
+// Same semantics as HistogramObserver._non_linear_param_search, returns the
+// (min, max) clipping range minimizing the L2 quantization error.
+std::tuple<at::Tensor, at::Tensor> histogram_observer_param_search(
+    const at::Tensor& histogram,
+    const at::Tensor& min_val,
+    const at::Tensor& max_val,
+    int64_t dst_nbins);
+
+namespace {
+
+void histogram_observer_update_kernel_impl(
+    const at::Tensor& x,
+    at::Tensor& histogram,
+    at::Tensor& min_val,
+    at::Tensor& max_val,
+    int64_t upsample_rate);
+
+std::tuple<at::Tensor, at::Tensor> histogram_observer_param_search_kernel_impl(
+    const at::Tensor& histogram,
+    const at::Tensor& min_val,
+    const at::Tensor& max_val,
+    int64_t dst_nbins);
+
+} // namespace
+
+using histogram_observer_update_kernel_fn = void (*)(
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    int64_t);
+DECLARE_DISPATCH(
+    histogram_observer_update_kernel_fn,
+    histogram_observer_update_kernel_stub);
+
+using histogram_observer_param_search_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        int64_t);
+DECLARE_DISPATCH(
+    histogram_observer_param_search_kernel_fn,
+    histogram_observer_param_search_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
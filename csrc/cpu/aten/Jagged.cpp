@@ -0,0 +1,301 @@
+#include "Jagged.h"
+
+#include <algorithm>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(jagged_to_padded_dense_kernel_stub);
+DEFINE_DISPATCH(dense_to_jagged_kernel_stub);
+DEFINE_DISPATCH(jagged_dense_elementwise_kernel_stub);
+DEFINE_DISPATCH(jagged_softmax_kernel_stub);
+DEFINE_DISPATCH(jagged_dense_bmm_kernel_stub);
+DEFINE_DISPATCH(jagged_jagged_bmm_kernel_stub);
+DEFINE_DISPATCH(jagged_index_select_kernel_stub);
+
+namespace {
+
+// Checks the offsets of a jagged tensor of `total_length` rows and returns
+// them as contiguous int64 for the kernels.
+at::Tensor check_offsets(
+    const at::Tensor& offsets,
+    int64_t total_length,
+    const char* op) {
+  TORCH_CHECK(
+      offsets.dim() == 1 && offsets.numel() >= 1 &&
+          (offsets.scalar_type() == at::kLong ||
+           offsets.scalar_type() == at::kInt),
+      op,
+      ": expected 1-D int32 or int64 offsets");
+  auto offsets_ = offsets.to(at::kLong).contiguous();
+  const int64_t* data = offsets_.data_ptr<int64_t>();
+  const int64_t B = offsets_.numel() - 1;
+  TORCH_CHECK(
+      data[0] == 0 && data[B] == total_length &&
+          std::is_sorted(data, data + B + 1),
+      op,
+      ": expected non-decreasing offsets from 0 to ",
+      total_length);
+  return offsets_;
+}
+
+// The values and the dense tensors have the same dims after the rows.
+void check_dense(
+    const at::Tensor& values,
+    const at::Tensor& dense,
+    int64_t B,
+    const char* op) {
+  TORCH_CHECK(
+      dense.dim() == values.dim() + 1 && dense.size(0) == B &&
+          dense.sizes().slice(2) == values.sizes().slice(1),
+      op,
+      ": expected a dense tensor of [",
+      B,
+      ", max_length] followed by the dims ",
+      values.sizes().slice(1),
+      ", got ",
+      dense.sizes());
+  TORCH_CHECK(
+      dense.scalar_type() == values.scalar_type(),
+      op,
+      ": expected the same dtype for the jagged and the dense tensors");
+}
+
+at::Tensor jagged_dense_elementwise(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense,
+    JaggedDenseOp op,
+    const char* name) {
+  TORCH_CHECK(values.dim() >= 1, name, ": expected values");
+  auto offsets_ = check_offsets(offsets, values.size(0), name);
+  check_dense(values, dense, offsets_.numel() - 1, name);
+
+  // pointer to jagged_dense_elementwise_kernel_impl(
+  //     values, offsets_, dense, op);
+  return jagged_dense_elementwise_kernel_stub(
+      kCPU, values.contiguous(), offsets_, dense.contiguous(), op);
+}
+
+} // namespace
+
+at::Tensor jagged_to_padded_dense(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    int64_t max_length,
+    double padding_value) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_to_padded_dense\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_to_padded_dense", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(values.dim() >= 1, "jagged_to_padded_dense: expected values");
+  auto offsets_ =
+      check_offsets(offsets, values.size(0), "jagged_to_padded_dense");
+  if (max_length < 0) {
+    auto lengths = offsets_.diff();
+    max_length = lengths.numel() > 0 ? lengths.max().item<int64_t>() : 0;
+  }
+
+  // pointer to jagged_to_padded_dense_kernel_impl(
+  //     values, offsets_, max_length, padding_value);
+  return jagged_to_padded_dense_kernel_stub(
+      kCPU, values.contiguous(), offsets_, max_length, padding_value);
+}
+
+at::Tensor dense_to_jagged(const at::Tensor& dense, const at::Tensor& offsets) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::dense_to_jagged\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::dense_to_jagged", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      dense.dim() >= 2 && dense.size(0) == offsets.numel() - 1,
+      "dense_to_jagged: expected a dense tensor of [B, max_length, *] for ",
+      offsets.numel() - 1,
+      " offsets, got ",
+      dense.sizes());
+  auto total_length = offsets[-1].item<int64_t>();
+  auto offsets_ = check_offsets(offsets, total_length, "dense_to_jagged");
+
+  // pointer to dense_to_jagged_kernel_impl(dense, offsets_);
+  return dense_to_jagged_kernel_stub(kCPU, dense.contiguous(), offsets_);
+}
+
+at::Tensor jagged_dense_elementwise_add(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_dense_elementwise_add\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_dense_elementwise_add",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return jagged_dense_elementwise(
+      values,
+      offsets,
+      dense,
+      JaggedDenseOp::Add,
+      "jagged_dense_elementwise_add");
+}
+
+at::Tensor jagged_dense_elementwise_mul(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_dense_elementwise_mul\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_dense_elementwise_mul",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return jagged_dense_elementwise(
+      values,
+      offsets,
+      dense,
+      JaggedDenseOp::Mul,
+      "jagged_dense_elementwise_mul");
+}
+
+at::Tensor jagged_softmax(const at::Tensor& values, const at::Tensor& offsets) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_softmax\n");
+#endif
+  RECORD_FUNCTION("torch_ipex::jagged_softmax", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(values.dim() >= 1, "jagged_softmax: expected values");
+  auto offsets_ = check_offsets(offsets, values.size(0), "jagged_softmax");
+
+  // pointer to jagged_softmax_kernel_impl(values, offsets_);
+  return jagged_softmax_kernel_stub(kCPU, values.contiguous(), offsets_);
+}
+
+at::Tensor jagged_dense_bmm(
+    const at::Tensor& x,
+    const at::Tensor& offsets,
+    const at::Tensor& y) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_dense_bmm\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_dense_bmm", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(x.dim() == 2, "jagged_dense_bmm: expected 2-D values");
+  auto offsets_ = check_offsets(offsets, x.size(0), "jagged_dense_bmm");
+  TORCH_CHECK(
+      y.dim() == 3 && y.size(0) == offsets_.numel() - 1 &&
+          y.size(1) == x.size(1),
+      "jagged_dense_bmm: expected a dense tensor of [",
+      offsets_.numel() - 1,
+      ", ",
+      x.size(1),
+      ", N], got ",
+      y.sizes());
+  TORCH_CHECK(
+      x.scalar_type() == y.scalar_type(),
+      "jagged_dense_bmm: expected the same dtype for x and y");
+
+  // pointer to jagged_dense_bmm_kernel_impl(x, offsets_, y);
+  return jagged_dense_bmm_kernel_stub(kCPU, x.contiguous(), offsets_, y);
+}
+
+at::Tensor jagged_jagged_bmm(
+    const at::Tensor& x,
+    const at::Tensor& y,
+    const at::Tensor& offsets) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_jagged_bmm\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_jagged_bmm", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      x.dim() == 2 && y.dim() == 2 && x.size(0) == y.size(0),
+      "jagged_jagged_bmm: expected 2-D values with the same rows");
+  TORCH_CHECK(
+      x.scalar_type() == y.scalar_type(),
+      "jagged_jagged_bmm: expected the same dtype for x and y");
+  auto offsets_ = check_offsets(offsets, x.size(0), "jagged_jagged_bmm");
+
+  // pointer to jagged_jagged_bmm_kernel_impl(x, y, offsets_);
+  return jagged_jagged_bmm_kernel_stub(
+      kCPU, x.contiguous(), y.contiguous(), offsets_);
+}
+
+std::tuple<at::Tensor, at::Tensor> jagged_index_select(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& indices) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::jagged_index_select\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::jagged_index_select", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(values.dim() >= 1, "jagged_index_select: expected values");
+  TORCH_CHECK(
+      indices.dim() == 1 &&
+          (indices.scalar_type() == at::kLong ||
+           indices.scalar_type() == at::kInt),
+      "jagged_index_select: expected 1-D int32 or int64 indices");
+  auto offsets_ = check_offsets(offsets, values.size(0), "jagged_index_select");
+  auto indices_ = indices.to(at::kLong).contiguous();
+  const int64_t B = offsets_.numel() - 1;
+  if (indices_.numel() > 0) {
+    TORCH_CHECK_INDEX(
+        indices_.min().item<int64_t>() >= 0 &&
+            indices_.max().item<int64_t>() < B,
+        "jagged_index_select: indices out of range for ",
+        B,
+        " sequences");
+  }
+
+  // pointer to jagged_index_select_kernel_impl(values, offsets_, indices_);
+  auto result = jagged_index_select_kernel_stub(
+      kCPU, values.contiguous(), offsets_, indices_);
+  return std::make_tuple(
+      std::get<0>(result), std::get<1>(result).to(offsets.scalar_type()));
+}
+
+} // namespace cpu
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "jagged_to_padded_dense(Tensor values, Tensor offsets, "
+      "int max_length=-1, float padding_value=0.0) -> Tensor",
+      torch_ipex::cpu::jagged_to_padded_dense);
+  m.def(
+      "dense_to_jagged(Tensor dense, Tensor offsets) -> Tensor",
+      torch_ipex::cpu::dense_to_jagged);
+  m.def(
+      "jagged_dense_elementwise_add(Tensor values, Tensor offsets, "
+      "Tensor dense) -> Tensor",
+      torch_ipex::cpu::jagged_dense_elementwise_add);
+  m.def(
+      "jagged_dense_elementwise_mul(Tensor values, Tensor offsets, "
+      "Tensor dense) -> Tensor",
+      torch_ipex::cpu::jagged_dense_elementwise_mul);
+  m.def(
+      "jagged_softmax(Tensor values, Tensor offsets) -> Tensor",
+      torch_ipex::cpu::jagged_softmax);
+  m.def(
+      "jagged_dense_bmm(Tensor x, Tensor offsets, Tensor y) -> Tensor",
+      torch_ipex::cpu::jagged_dense_bmm);
+  m.def(
+      "jagged_jagged_bmm(Tensor x, Tensor y, Tensor offsets) -> Tensor",
+      torch_ipex::cpu::jagged_jagged_bmm);
+  m.def(
+      "jagged_index_select(Tensor values, Tensor offsets, Tensor indices) "
+      "-> (Tensor, Tensor)",
+      torch_ipex::cpu::jagged_index_select);
+}
+
+} // namespace
+} // namespace torch_ipex
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// A jagged tensor is a pair of `values`, the rows of all the sequences of a
+// batch one after the other, [total_length, *], and `offsets` [B + 1], the
+// first row of each sequence followed by total_length. This is the offsets
+// of merged_embeddingbag_forward with the last offset included, and the
+// t_offs of the TPP BERT.
+enum class JaggedDenseOp { Add, Mul };
+
+namespace {
+
+at::Tensor jagged_to_padded_dense_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    int64_t max_length,
+    double padding_value);
+
+at::Tensor dense_to_jagged_kernel_impl(
+    const at::Tensor& dense,
+    const at::Tensor& offsets);
+
+at::Tensor jagged_dense_elementwise_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense,
+    JaggedDenseOp op);
+
+at::Tensor jagged_softmax_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets);
+
+at::Tensor jagged_dense_bmm_kernel_impl(
+    const at::Tensor& x,
+    const at::Tensor& offsets,
+    const at::Tensor& y);
+
+at::Tensor jagged_jagged_bmm_kernel_impl(
+    const at::Tensor& x,
+    const at::Tensor& y,
+    const at::Tensor& offsets);
+
+std::tuple<at::Tensor, at::Tensor> jagged_index_select_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& indices);
+
+} // namespace
+
+using jagged_to_padded_dense_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    double);
+DECLARE_DISPATCH(
+    jagged_to_padded_dense_kernel_fn,
+    jagged_to_padded_dense_kernel_stub);
+
+using dense_to_jagged_kernel_fn =
+    at::Tensor (*)(const at::Tensor&, const at::Tensor&);
+DECLARE_DISPATCH(dense_to_jagged_kernel_fn, dense_to_jagged_kernel_stub);
+
+using jagged_dense_elementwise_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    JaggedDenseOp);
+DECLARE_DISPATCH(
+    jagged_dense_elementwise_kernel_fn,
+    jagged_dense_elementwise_kernel_stub);
+
+using jagged_softmax_kernel_fn =
+    at::Tensor (*)(const at::Tensor&, const at::Tensor&);
+DECLARE_DISPATCH(jagged_softmax_kernel_fn, jagged_softmax_kernel_stub);
+
+using jagged_bmm_kernel_fn =
+    at::Tensor (*)(const at::Tensor&, const at::Tensor&, const at::Tensor&);
+DECLARE_DISPATCH(jagged_bmm_kernel_fn, jagged_dense_bmm_kernel_stub);
+DECLARE_DISPATCH(jagged_bmm_kernel_fn, jagged_jagged_bmm_kernel_stub);
+
+using jagged_index_select_kernel_fn = std::tuple<at::Tensor, at::Tensor> (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&);
+DECLARE_DISPATCH(
+    jagged_index_select_kernel_fn,
+    jagged_index_select_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,19 +1,25 @@
 #include "LayerNorm.h"
+#include <ATen/native/layer_norm.h>
+#include <c10/util/irange.h>
 #include <torch/all.h>
-#include "ideep/IDeepConversions.h"
 #include "utils/library.h"
 
 namespace torch_ipex {
 namespace cpu {
 
-/**layer_norm kernel for inference mode with oneDNN implementation
+DEFINE_DISPATCH(layer_norm_kernel_stub);
+DEFINE_DISPATCH(layer_norm_backward_kernel_stub);
+
+/**layer_norm kernel with a native single pass Welford implementation
  *
- * @param X: input tensor for layernorm
- * @param gamma: scale for layernorm
- * @param beta: shift for layernorm
+ * @param X: input tensor for layernorm, float, bf16 or fp16
+ * @param gamma: scale for layernorm, float or the dtype of X
+ * @param beta: shift for layernorm, float or the dtype of X
  * @param M
  * @param N
  * @param eps
+ *
+ * return: (Y, mean, rstd), mean and rstd are float of [M]
  **/
 std::tuple<at::Tensor, at::Tensor, at::Tensor> layer_norm_impl(
     const at::Tensor& X,
@@ -22,33 +28,24 @@ std::tuple<at::Tensor, at::Tensor, at::Tensor> layer_norm_impl(
     int64_t M,
     int64_t N,
     double eps) {
-  TORCH_CHECK(
-      gamma.scalar_type() == at::kFloat && beta.scalar_type() == at::kFloat,
-      "gamma adn beta's data type should be float");
-  ideep::tensor x = itensor_view_from_dense(X);
-  const ideep::tensor scale = itensor_view_from_dense(gamma);
-  const ideep::tensor shift = itensor_view_from_dense(beta);
-  int64_t i = 0;
-  auto dim = at::maybe_wrap_dim(0, X.dim(), false);
-  auto j = X.sizes()[dim];
-  std::vector<int64_t> input_size;
-  while (j <= M) {
-    dim = at::maybe_wrap_dim(i++, X.dim(), false);
-    input_size.push_back(X.sizes()[dim]);
-    dim = at::maybe_wrap_dim(i, X.dim(), false);
-    j *= X.sizes()[dim];
+  return layer_norm_kernel_stub(kCPU, X, gamma, beta, M, N, eps);
+}
+
+// The native kernel handles float/bf16/fp16 input with gamma and beta either
+// in float or in the input dtype.
+static bool is_layer_norm_kernel_supported(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias) {
+  auto dtype = input.scalar_type();
+  if (dtype != at::kFloat && dtype != at::kBFloat16 && dtype != at::kHalf) {
+    return false;
   }
-  input_size.push_back(N);
-  auto src = x.reshape(input_size);
-  at::Tensor Y = at::native::empty_like(X);
-  at::Tensor mean = at::empty({M}, X.options());
-  at::Tensor variance = at::empty({M}, X.options());
-  auto onednn_Y = itensor_view_from_dense(Y);
-  auto onednn_mean = itensor_view_from_dense(mean);
-  auto onednn_variance = itensor_view_from_dense(variance);
-  ideep::layer_normalization_forward::compute(
-      src, scale, shift, onednn_Y, onednn_mean, onednn_variance, eps);
-  return std::make_tuple(Y, mean, variance);
+  auto param_ok = [&](const at::Tensor& param) {
+    return !param.defined() || param.scalar_type() == at::kFloat ||
+        param.scalar_type() == dtype;
+  };
+  return param_ok(weight) && param_ok(bias) && input.numel() > 0;
 }
 
 /**
@@ -144,10 +141,8 @@ at::Tensor layer_norm_forward(
  * #PR https://github.com/pytorch/pytorch/pull/59987
  * This is a workaround for layernorm regression.
  * Replace at::layer_norm with ipex::layernorm in jit pass for inference.
- * Now, we only use oneDNN kernel when both weight and bias are provided.
- * ToDo: more scenarios to use oneDNN or remvoe this pass
- * when at::layer_norm performance is back compared to w/o
- * mergeing https://github.com/pytorch/pytorch/pull/59987
+ * Now, we use the native kernel directly when both weight and bias are
+ * provided, other cases go through native_layer_norm.
  *
  * @param input: the source tensor to layernorm
  * @param normalized_shape: input shape from an expected input of size
@@ -167,16 +162,88 @@ at::Tensor layer_norm(
     bool cudnn_enable) {
   RECORD_FUNCTION("torch_ipex::layer_norm", c10::ArrayRef<c10::IValue>({}));
 
-  // onednn path for inference.
-  // TODO: enable training path ??
-  if (weight_opt.has_value() && weight_opt.value().defined() &&
-      weight_opt.value().scalar_type() == at::kFloat && bias_opt.has_value() &&
-      bias_opt.value().defined() &&
-      bias_opt.value().scalar_type() == at::kFloat &&
-      !at::GradMode::is_enabled() && input.dim() >= 2 && input.dim() <= 5) {
-    return layer_norm_forward(
-        input, normalized_shape, weight_opt.value(), bias_opt.value(), eps);
+  c10::MaybeOwned<at::Tensor> weight_maybe_owned =
+      at::borrow_from_optional_tensor(weight_opt);
+  const at::Tensor& weight = *weight_maybe_owned;
+  c10::MaybeOwned<at::Tensor> bias_maybe_owned =
+      at::borrow_from_optional_tensor(bias_opt);
+  const at::Tensor& bias = *bias_maybe_owned;
+
+  // native kernel path for inference, training goes through
+  // native_layer_norm below which also ends up in the same kernel.
+  if (weight.defined() && bias.defined() && !at::GradMode::is_enabled() &&
+      input.dim() >= 2 && input.dim() <= 5 &&
+      is_layer_norm_kernel_supported(input, weight, bias)) {
+    return layer_norm_forward(input, normalized_shape, weight, bias, eps);
+  }
+  return std::get<0>(
+      at::native_layer_norm(input, normalized_shape, weight, bias, eps));
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_layer_norm(
+    const at::Tensor& input,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::native_layer_norm\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::native_layer_norm", c10::ArrayRef<c10::IValue>({}));
+
+  c10::MaybeOwned<at::Tensor> weight_maybe_owned =
+      at::borrow_from_optional_tensor(weight_opt);
+  const at::Tensor& weight = *weight_maybe_owned;
+  c10::MaybeOwned<at::Tensor> bias_maybe_owned =
+      at::borrow_from_optional_tensor(bias_opt);
+  const at::Tensor& bias = *bias_maybe_owned;
+  if (!is_layer_norm_kernel_supported(input, weight, bias)) {
+    return at::native::layer_norm_cpu(
+        input, normalized_shape, weight_opt, bias_opt, eps);
+  }
+
+  auto M_N = at::native::_check_layer_norm_inputs(
+      input, normalized_shape, weight, bias);
+  auto M = M_N.first;
+  auto N = M_N.second;
+  auto outputs = layer_norm_impl(input, weight, bias, M, N, eps);
+
+  // same statistics layout as aten: input shape with normalized dims set to 1,
+  // float when the parameters are in a different dtype from the input.
+  const int axis = input.dim() - normalized_shape.size();
+  at::DimVector stat_shape;
+  for (const auto idx : c10::irange(axis)) {
+    stat_shape.emplace_back(input.size(idx));
   }
+  for (const auto idx : c10::irange(axis, input.dim())) {
+    (void)idx;
+    stat_shape.emplace_back(1);
+  }
+  bool mixed_type = (weight.defined() &&
+                     weight.scalar_type() != input.scalar_type()) ||
+      (bias.defined() && bias.scalar_type() != input.scalar_type());
+  auto stat_dtype = mixed_type ? at::kFloat : input.scalar_type();
+  auto mean = std::get<1>(outputs).view(stat_shape).to(stat_dtype);
+  auto rstd = std::get<2>(outputs).view(stat_shape).to(stat_dtype);
+  return std::make_tuple(std::get<0>(outputs), mean, rstd);
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_layer_norm_backward(
+    const at::Tensor& grad_out,
+    const at::Tensor& input,
+    at::IntArrayRef normalized_shape,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    std::array<bool, 3> grad_input_mask) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::native_layer_norm_backward\n");
+#endif
+  RECORD_FUNCTION(
+      "torch_ipex::native_layer_norm_backward",
+      c10::ArrayRef<c10::IValue>({}));
 
   c10::MaybeOwned<at::Tensor> weight_maybe_owned =
       at::borrow_from_optional_tensor(weight_opt);
@@ -184,21 +251,46 @@ at::Tensor layer_norm(
   c10::MaybeOwned<at::Tensor> bias_maybe_owned =
       at::borrow_from_optional_tensor(bias_opt);
   const at::Tensor& bias = *bias_maybe_owned;
-  // for pytorch layernorm, input, weight and bias need have same dtype,
-  // so for bfloat16 path(autocast), if input is bfloat16, we need convert it to
-  // float.
-  auto input_ = input;
-  if (input.scalar_type() == at::kBFloat16 &&
-      weight.scalar_type() == at::kFloat && bias.scalar_type() == at::kFloat) {
-    input_ = input.to(at::kFloat);
+  if (!is_layer_norm_kernel_supported(input, weight, bias) ||
+      grad_out.scalar_type() != input.scalar_type()) {
+    return at::native::layer_norm_backward_cpu(
+        grad_out,
+        input,
+        normalized_shape,
+        mean,
+        rstd,
+        weight_opt,
+        bias_opt,
+        grad_input_mask);
+  }
+
+  auto M_N = at::native::_check_layer_norm_inputs(
+      input, normalized_shape, weight, bias);
+  auto M = M_N.first;
+  auto N = M_N.second;
+  std::array<bool, 3> kernel_mask = {
+      grad_input_mask[0],
+      grad_input_mask[1] && weight.defined(),
+      grad_input_mask[2] && bias.defined()};
+  auto grads = layer_norm_backward_kernel_stub(
+      kCPU,
+      grad_out,
+      input,
+      mean,
+      rstd,
+      weight,
+      M,
+      N,
+      kernel_mask);
+  auto dgamma = std::get<1>(grads);
+  auto dbeta = std::get<2>(grads);
+  if (dgamma.defined()) {
+    dgamma = dgamma.view(weight.sizes()).to(weight.scalar_type());
   }
-  at::Tensor output = std::get<0>(
-      at::native_layer_norm(input_, normalized_shape, weight, bias, eps));
-  if (input.scalar_type() == at::kBFloat16 &&
-      weight.scalar_type() == at::kFloat && bias.scalar_type() == at::kFloat) {
-    return output.to(at::kBFloat16);
+  if (dbeta.defined()) {
+    dbeta = dbeta.view(bias.sizes()).to(bias.scalar_type());
   }
-  return output;
+  return std::make_tuple(std::get<0>(grads), dgamma, dbeta);
 }
 
 } // namespace cpu
@@ -211,6 +303,12 @@ IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("aten::layer_norm"),
       TORCH_FN((&torch_ipex::cpu::layer_norm)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::native_layer_norm"),
+      TORCH_FN((&torch_ipex::cpu::native_layer_norm)));
+  m.impl(
+      TORCH_SELECTIVE_NAME("aten::native_layer_norm_backward"),
+      TORCH_FN((&torch_ipex::cpu::native_layer_norm_backward)));
 }
 
 } // namespace
\ No newline at end of file
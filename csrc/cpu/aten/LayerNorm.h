@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
 
 #include <ideep.hpp>
 
@@ -15,5 +16,73 @@ at::Tensor layer_norm(
     double eps,
     bool cudnn_enable);
 
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_layer_norm(
+    const at::Tensor& input,
+    at::IntArrayRef normalized_shape,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    double eps);
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> native_layer_norm_backward(
+    const at::Tensor& grad_out,
+    const at::Tensor& input,
+    at::IntArrayRef normalized_shape,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const c10::optional<at::Tensor>& weight_opt,
+    const c10::optional<at::Tensor>& bias_opt,
+    std::array<bool, 3> grad_input_mask);
+
+namespace {
+
+// X is [M, N] in float, bf16 or fp16; gamma/beta are [N] in float or the
+// dtype of X, or undefined. Returns (Y, mean, rstd) with float statistics.
+std::tuple<at::Tensor, at::Tensor, at::Tensor> layer_norm_kernel_impl(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps);
+
+// Returns (dX, dgamma, dbeta); outputs not requested by grad_input_mask are
+// undefined. dgamma and dbeta are float.
+std::tuple<at::Tensor, at::Tensor, at::Tensor> layer_norm_backward_kernel_impl(
+    const at::Tensor& dY,
+    const at::Tensor& X,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const at::Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    std::array<bool, 3> grad_input_mask);
+
+} // namespace
+
+using layer_norm_kernel_fn = std::tuple<at::Tensor, at::Tensor, at::Tensor> (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    int64_t,
+    double);
+
+DECLARE_DISPATCH(layer_norm_kernel_fn, layer_norm_kernel_stub);
+
+using layer_norm_backward_kernel_fn =
+    std::tuple<at::Tensor, at::Tensor, at::Tensor> (*)(
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        const at::Tensor&,
+        int64_t,
+        int64_t,
+        std::array<bool, 3>);
+
+DECLARE_DISPATCH(
+    layer_norm_backward_kernel_fn,
+    layer_norm_backward_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
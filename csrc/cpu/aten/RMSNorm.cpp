@@ -1,10 +1,12 @@
 #include "RMSNorm.h"
+#include <torch/all.h>
 #include <torch/csrc/autograd/function.h>
 
 namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(rmsnorm_kernel_stub);
+DEFINE_DISPATCH(add_rmsnorm_kernel_stub);
 
 at::Tensor dil_RMSNorm(
     const at::Tensor& input,
@@ -14,5 +16,100 @@ at::Tensor dil_RMSNorm(
 
   return rmsnorm_kernel_stub(kCPU, input, b, eps);
 }
+
+namespace {
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> AddRMSNorm(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    float eps,
+    bool quant_out) {
+  TORCH_CHECK(
+      input.sizes() == residual.sizes(),
+      "add_rmsnorm: expects input and residual of the same shape");
+  TORCH_CHECK(
+      input.scalar_type() == residual.scalar_type(),
+      "add_rmsnorm: expects input and residual of the same dtype");
+  auto x = input.contiguous();
+  auto r = residual.contiguous();
+  int64_t N = x.size(-1);
+  int64_t M = x.numel() / N;
+  auto w = weight.to(at::kFloat).contiguous();
+  TORCH_CHECK(w.numel() == N, "add_rmsnorm: weight size mismatch");
+
+  auto output = quant_out ? at::empty(x.sizes(), x.options().dtype(at::kChar))
+                          : at::empty_like(x);
+  auto residual_out = at::empty_like(x);
+  auto scales =
+      quant_out ? at::empty({M}, x.options().dtype(at::kFloat)) : at::Tensor();
+  /*
+  pointer to add_rmsnorm_kernel_impl(
+      x, r, w, eps, output, residual_out, scales);
+  */
+  add_rmsnorm_kernel_stub(kCPU, x, r, w, eps, output, residual_out, scales);
+  if (quant_out) {
+    scales = scales.view(c10::IntArrayRef(x.sizes().data(), x.dim() - 1));
+  }
+  return std::make_tuple(output, residual_out, scales);
+}
+
+} // namespace
+
+std::tuple<at::Tensor, at::Tensor> dil_add_RMSNorm(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    int alpha,
+    const at::Tensor& weight,
+    float eps) {
+  RECORD_FUNCTION("dil_add_RMSNorm", c10::ArrayRef<c10::IValue>({}));
+
+  if (alpha == 1 && a.sizes() == b.sizes() &&
+      a.scalar_type() == b.scalar_type()) {
+    auto result = AddRMSNorm(a, b, weight, eps, /*quant_out*/ false);
+    return std::make_tuple(std::get<0>(result), std::get<1>(result));
+  }
+  auto add_res = at::add(a, b, alpha);
+  return std::make_tuple(dil_RMSNorm(add_res, weight, eps), add_res);
+}
+
+std::tuple<at::Tensor, at::Tensor> add_rmsnorm(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps) {
+  RECORD_FUNCTION("ipex::add_rmsnorm", c10::ArrayRef<c10::IValue>({}));
+
+  auto result = AddRMSNorm(input, residual, weight, eps, /*quant_out*/ false);
+  return std::make_tuple(std::get<0>(result), std::get<1>(result));
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> add_rmsnorm_quant(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps) {
+  RECORD_FUNCTION("ipex::add_rmsnorm_quant", c10::ArrayRef<c10::IValue>({}));
+
+  auto result = AddRMSNorm(input, residual, weight, eps, /*quant_out*/ true);
+  return std::make_tuple(
+      std::get<0>(result), std::get<2>(result), std::get<1>(result));
+}
+
 } // namespace cpu
 } // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "add_rmsnorm(Tensor input, Tensor residual, Tensor weight, float eps) "
+      "-> (Tensor, Tensor)",
+      torch_ipex::cpu::add_rmsnorm);
+  m.def(
+      "add_rmsnorm_quant(Tensor input, Tensor residual, Tensor weight, float "
+      "eps) -> (Tensor, Tensor, Tensor)",
+      torch_ipex::cpu::add_rmsnorm_quant);
+}
+
+} // namespace
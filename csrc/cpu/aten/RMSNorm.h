@@ -8,18 +8,61 @@ namespace cpu {
 
 at::Tensor dil_RMSNorm(const at::Tensor& input, const at::Tensor& b, float eps);
 
+// Fused `s = a + alpha * b; r = RMSNorm(s)`, returns (r, s) so that the sum
+// can be used as the residual of the next block.
+std::tuple<at::Tensor, at::Tensor> dil_add_RMSNorm(
+    const at::Tensor& a,
+    const at::Tensor& b,
+    int alpha,
+    const at::Tensor& weight,
+    float eps);
+
+std::tuple<at::Tensor, at::Tensor> add_rmsnorm(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps);
+
+// Same as add_rmsnorm but emits symmetric per-token INT8 for the following
+// linear: returns (int8 output, fp32 scale per token, residual sum).
+std::tuple<at::Tensor, at::Tensor, at::Tensor> add_rmsnorm_quant(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    double eps);
+
 namespace {
 
 at::Tensor rmsnorm_kernel_impl(
     const at::Tensor& input,
     const at::Tensor& b,
     float eps);
-}
+
+void add_rmsnorm_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    float eps,
+    at::Tensor& output,
+    at::Tensor& residual_out,
+    at::Tensor& scales);
+} // namespace
 
 using rms_norm_kernel_fn =
     at::Tensor (*)(const at::Tensor&, const at::Tensor&, float);
 
 DECLARE_DISPATCH(rms_norm_kernel_fn, rmsnorm_kernel_stub);
 
+using add_rms_norm_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    float,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&);
+
+DECLARE_DISPATCH(add_rms_norm_kernel_fn, add_rmsnorm_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -8,16 +8,22 @@
 #include <ATen/quantized/QTensorImpl.h>
 #include <ATen/record_function.h>
 #include <c10/util/Exception.h>
+#include <c10/util/hash.h>
 #include <torch/all.h>
 #include "RNN.h"
 #include "WeightPack.h"
 #include "autocast/autocast_mode.h"
 #include "ideep/IDeepConversions.h"
 #include "quantization/utils/utils.h"
+#include "utils/rw_lock.h"
+
+#include <algorithm>
 
 namespace torch_ipex {
 namespace cpu {
 
+DEFINE_DISPATCH(lstm_fused_forward_kernel_stub);
+
 // When feeding to mkldnn, weight is in `ldigo`
 constexpr int weights_scale_mask = 0 +
     (1 << 3) // bit, indicating the unique scales for `g` dim in `ldigo`
@@ -201,6 +207,157 @@ std::tuple<at::Tensor, at::Tensor> pack_hidden<
   return std::make_tuple(hx, cx);
 }
 
+// Identifies an LSTM parameter by the bytes of the storage it views, like
+// the packed weight cache does, so that the different tensor objects of one
+// parameter share one context.
+struct LstmParamKey {
+  c10::StorageImpl* storage;
+  int64_t offset;
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> strides;
+  at::ScalarType dtype;
+
+  explicit LstmParamKey(const at::Tensor& t)
+      : storage(t.storage().unsafeGetStorageImpl()),
+        offset(t.storage_offset()),
+        sizes(t.sizes().vec()),
+        strides(t.strides().vec()),
+        dtype(t.scalar_type()) {}
+
+  bool operator==(const LstmParamKey& other) const {
+    return storage == other.storage && offset == other.offset &&
+        sizes == other.sizes && strides == other.strides &&
+        dtype == other.dtype;
+  }
+};
+
+struct LstmParamKeyHash {
+  size_t operator()(const LstmParamKey& key) const {
+    return c10::get_hash(
+        reinterpret_cast<uintptr_t>(key.storage),
+        key.offset,
+        key.sizes,
+        key.strides,
+        static_cast<int>(key.dtype));
+  }
+};
+
+// Inference state derived from the LSTM parameters that would otherwise be
+// rebuilt on every call: the shuffled bias and, for small batches, the
+// gate-interleaved weight of the fused kernel. An entry is dropped as soon as
+// any parameter storage is freed or a parameter is updated in place.
+struct LstmInferenceContext {
+  std::vector<c10::weak_intrusive_ptr<c10::StorageImpl>> storages;
+  std::vector<LstmParamKey> keys;
+  std::vector<int64_t> versions;
+  at::Tensor bias;
+  at::Tensor fused_weight;
+  at::Tensor fused_bias;
+
+  bool expired() const {
+    return std::any_of(storages.begin(), storages.end(), [](const auto& s) {
+      return s.expired();
+    });
+  }
+
+  bool matches(const std::vector<at::Tensor>& tensors) const {
+    if (tensors.size() != keys.size() || expired()) {
+      return false;
+    }
+    for (const auto i : c10::irange(tensors.size())) {
+      if (!(keys[i] == LstmParamKey(tensors[i])) ||
+          versions[i] != tensors[i]._version()) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+std::unordered_map<
+    LstmParamKey,
+    std::shared_ptr<LstmInferenceContext>,
+    LstmParamKeyHash>
+    lstm_contexts;
+torch_ipex::ReadWriteMutex lstm_contexts_mutex;
+
+// Repack [4 * hidden_size, K] gate weights into
+// [hidden block][K][gate][kLstmFusedBlockSize] so that one block holds all
+// four gates of the same hidden units.
+at::Tensor lstm_fused_pack_gates(const at::Tensor& t, int64_t hidden_size) {
+  int64_t num_blocks =
+      (hidden_size + kLstmFusedBlockSize - 1) / kLstmFusedBlockSize;
+  int64_t pad = num_blocks * kLstmFusedBlockSize - hidden_size;
+  int64_t k = t.numel() / (4 * hidden_size);
+  auto gates = at::constant_pad_nd(
+      t.to(at::kFloat).reshape({4, hidden_size, k}), {0, 0, 0, pad});
+  return gates.view({4, num_blocks, kLstmFusedBlockSize, k})
+      .permute({1, 3, 0, 2})
+      .contiguous();
+}
+
+std::shared_ptr<LstmInferenceContext> get_lstm_inference_context(
+    const at::Tensor& w0,
+    const at::Tensor& w1,
+    const at::Tensor& w2,
+    const at::Tensor& w3,
+    bool has_biases,
+    const RNNParams& rnn,
+    at::ScalarType bias_dtype,
+    bool fused) {
+  std::vector<at::Tensor> tensors =
+      has_biases ? std::vector<at::Tensor>{w0, w1, w2, w3}
+                 : std::vector<at::Tensor>{w0, w1};
+  // Inference tensors carry no version counter, so an in-place update of
+  // them could not be detected: their context is only built for this call.
+  const bool cacheable =
+      std::none_of(tensors.begin(), tensors.end(), [](const at::Tensor& t) {
+        return t.is_inference();
+      });
+  if (cacheable) {
+    torch_ipex::UniqueReadLock<torch_ipex::ReadWriteMutex> lock(
+        lstm_contexts_mutex);
+    auto it = lstm_contexts.find(LstmParamKey(w0));
+    if (it != lstm_contexts.end() && it->second->matches(tensors) &&
+        (!fused || it->second->fused_weight.defined())) {
+      return it->second;
+    }
+  }
+
+  auto context = std::make_shared<LstmInferenceContext>();
+  if (cacheable) {
+    for (const auto& t : tensors) {
+      context->storages.emplace_back(t.storage().getIntrusivePtr());
+      context->keys.emplace_back(t);
+      context->versions.push_back(t._version());
+    }
+  }
+  context->bias = has_biases
+      ? _shuffle_bias(w2, w3, rnn.mode)
+      : at::zeros(
+            {rnn.num_bias_gates * rnn.hidden_size},
+            w0.options().dtype(bias_dtype));
+  if (fused) {
+    context->fused_weight = lstm_fused_pack_gates(
+        at::cat({w0.contiguous(), w1.contiguous()}, /*K*/ 1),
+        rnn.hidden_size);
+    context->fused_bias =
+        lstm_fused_pack_gates(context->bias, rnn.hidden_size)
+            .view({-1, 4, kLstmFusedBlockSize});
+  }
+  if (!cacheable) {
+    return context;
+  }
+
+  torch_ipex::UniqueWriteLock<torch_ipex::ReadWriteMutex> lock(
+      lstm_contexts_mutex);
+  for (auto it = lstm_contexts.begin(); it != lstm_contexts.end();) {
+    it = it->second->expired() ? lstm_contexts.erase(it) : std::next(it);
+  }
+  lstm_contexts[LstmParamKey(w0)] = context;
+  return context;
+}
+
 } // anonymous namespace
 
 // For fp32 and bf16, bias dtype is the same as weight dtype
@@ -239,50 +396,23 @@ std::vector<float> get_mkldnn_weight_scales_of_lstm(
   return weight_scales;
 }
 
-std::vector<at::Tensor> lstm_kernel(
+std::vector<at::Tensor> lstm_kernel_impl(
     const at::Tensor& input,
-    const at::Tensor& w0,
-    const at::Tensor& w1,
-    const at::Tensor& w2,
-    const at::Tensor& w3,
+    const at::Tensor& weight_ih,
+    const at::Tensor& weight_hh,
+    const at::Tensor& bias,
     const at::Tensor& hx_,
     const at::Tensor& cx_,
+    const at::Tensor& hy_,
+    const at::Tensor& cy_,
+    const RNNParams& rnn,
     bool reverse,
-    at::IntArrayRef batch_sizes,
-    int64_t mode,
-    int64_t hidden_size,
-    int64_t num_layers,
-    bool has_biases,
-    bool bidirectional,
-    bool batch_first,
     bool train,
     double output_scale,
     int64_t output_zp,
     int64_t output_dtype) {
-  RNNParams rnn(
-      input,
-      batch_sizes,
-      mode,
-      hidden_size,
-      num_layers,
-      bidirectional,
-      batch_first,
-      train);
-
   at::ScalarType input_dt = input.scalar_type();
 
-  auto hy_ = at::empty(hx_.sizes(), hx_.options());
-  auto cy_ = at::empty(cx_.sizes(), cx_.options());
-
-  auto weight_ih = _shuffle_weight(w0, rnn.mode);
-  auto weight_hh = _shuffle_weight(w1, rnn.mode);
-
-  auto bias_dtype = get_bias_dtype(input, weight_ih);
-  auto bias = has_biases ? _shuffle_bias(w2, w3, rnn.mode)
-                         : at::zeros(
-                               {rnn.num_bias_gates * rnn.hidden_size},
-                               weight_ih.options().dtype(bias_dtype));
-
   // per layer input size
   int64_t input_size = input.size(2);
   auto x = torch_ipex::cpu::itensor_view_from_dense(
@@ -393,6 +523,107 @@ std::vector<at::Tensor> lstm_kernel(
   return result;
 }
 
+std::vector<at::Tensor> lstm_kernel(
+    const at::Tensor& input,
+    const at::Tensor& w0,
+    const at::Tensor& w1,
+    const at::Tensor& w2,
+    const at::Tensor& w3,
+    const at::Tensor& hx_,
+    const at::Tensor& cx_,
+    bool reverse,
+    at::IntArrayRef batch_sizes,
+    int64_t mode,
+    int64_t hidden_size,
+    int64_t num_layers,
+    bool has_biases,
+    bool bidirectional,
+    bool batch_first,
+    bool train,
+    double output_scale,
+    int64_t output_zp,
+    int64_t output_dtype) {
+  RNNParams rnn(
+      input,
+      batch_sizes,
+      mode,
+      hidden_size,
+      num_layers,
+      bidirectional,
+      batch_first,
+      train);
+
+  at::ScalarType input_dt = input.scalar_type();
+
+  auto hy_ = at::empty(hx_.sizes(), hx_.options());
+  auto cy_ = at::empty(cx_.sizes(), cx_.options());
+
+  auto bias_dtype = get_bias_dtype(input, w0);
+  if (train) {
+    auto bias = has_biases ? _shuffle_bias(w2, w3, rnn.mode)
+                           : at::zeros(
+                                 {rnn.num_bias_gates * rnn.hidden_size},
+                                 w0.options().dtype(bias_dtype));
+    return lstm_kernel_impl(
+        input,
+        _shuffle_weight(w0, rnn.mode),
+        _shuffle_weight(w1, rnn.mode),
+        bias,
+        hx_,
+        cx_,
+        hy_,
+        cy_,
+        rnn,
+        reverse,
+        train,
+        output_scale,
+        output_zp,
+        output_dtype);
+  }
+
+  // Small batches are dominated by per-call setup rather than the GEMMs, so
+  // they take the fused kernel over the cached gate-interleaved weights.
+  bool fused = rnn.mode == ideep::rnn_kind::LSTM &&
+      !rnn.is_input_packed() &&
+      (input_dt == at::kFloat || input_dt == at::kBFloat16) &&
+      w0.scalar_type() == input_dt && w1.scalar_type() == input_dt &&
+      rnn.mini_batch <= kLstmFusedMaxBatch &&
+      rnn.seq_length <= kLstmFusedMaxSeq;
+  auto context = get_lstm_inference_context(
+      w0, w1, w2, w3, has_biases, rnn, bias_dtype, fused);
+  if (fused) {
+    auto output = at::empty(
+        _output_size</*is_single_direction*/ true>(rnn), input.options());
+    lstm_fused_forward_kernel_stub(
+        kCPU,
+        input.to(at::kFloat).contiguous(),
+        context->fused_weight,
+        context->fused_bias,
+        hx_.to(at::kFloat).contiguous(),
+        cx_.to(at::kFloat).contiguous(),
+        output,
+        hy_,
+        cy_,
+        reverse);
+    return {output, hy_, cy_};
+  }
+  return lstm_kernel_impl(
+      input,
+      _shuffle_weight(w0, rnn.mode),
+      _shuffle_weight(w1, rnn.mode),
+      context->bias,
+      hx_,
+      cx_,
+      hy_,
+      cy_,
+      rnn,
+      reverse,
+      train,
+      output_scale,
+      output_zp,
+      output_dtype);
+}
+
 std::vector<at::Tensor> ipex_lstm_layer_forward(
     const at::Tensor& input,
     const at::Tensor& w0,
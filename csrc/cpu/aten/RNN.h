@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
 #include <torch/csrc/autograd/custom_function.h>
 
 #include <ideep.hpp>
@@ -157,5 +158,40 @@ std::vector<at::Tensor> ipex_lstm_layer_forward(
     double scale,
     int64_t zp,
     int64_t dtype);
+
+// Small-batch LSTM inference (e.g. RNN-T decode steps) bypasses the oneDNN
+// primitive and runs a fused gate GEMM + cell update over weights packed as
+// [hidden block][input_size + hidden_size][gate][kLstmFusedBlockSize].
+constexpr int64_t kLstmFusedBlockSize = 16;
+constexpr int64_t kLstmFusedMaxBatch = 32;
+constexpr int64_t kLstmFusedMaxSeq = 8;
+
+namespace {
+
+void lstm_fused_forward_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    const at::Tensor& hx,
+    const at::Tensor& cx,
+    at::Tensor& output,
+    at::Tensor& hy,
+    at::Tensor& cy,
+    bool reverse);
+}
+
+using lstm_fused_forward_kernel_fn = void (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    at::Tensor&,
+    bool);
+
+DECLARE_DISPATCH(lstm_fused_forward_kernel_fn, lstm_fused_forward_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
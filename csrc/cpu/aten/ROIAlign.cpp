@@ -12,6 +12,7 @@ namespace cpu {
 
 DEFINE_DISPATCH(roi_align_forward_kernel_stub);
 DEFINE_DISPATCH(roi_align_backward_kernel_stub);
+DEFINE_DISPATCH(qroi_align_forward_kernel_stub);
 
 at::Tensor ROIAlign_forward_impl(
     const at::Tensor& input,
@@ -200,6 +201,39 @@ at::Tensor ROIAlign_forward(
       aligned);
 }
 
+at::Tensor qroi_align(
+    const at::Tensor& input,
+    const at::Tensor& rois,
+    double spatial_scale,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::qroi_align\n");
+#endif
+  RECORD_FUNCTION("torch_ipex::qroi_align", c10::ArrayRef<c10::IValue>({}));
+
+  // pointer to qroi_align_forward_kernel_impl(input, rois, spatial_scale,
+  // pooled_height, pooled_width, sampling_ratio, aligned, o_scale, o_zp,
+  // o_dtype);
+  return qroi_align_forward_kernel_stub(
+      kCPU,
+      input,
+      rois,
+      spatial_scale,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      o_scale,
+      o_zp,
+      o_dtype);
+}
+
 at::Tensor ROIAlign_forward_meta(
     const at::Tensor& input,
     const at::Tensor& rois,
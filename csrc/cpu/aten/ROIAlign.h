@@ -67,6 +67,21 @@ at::Tensor ROIAlign_forward(
     int64_t sampling_ratio,
     bool aligned);
 
+// INT8 ROIAlign with fused dequantize and requantize: `input` is a per
+// tensor quantized feature map and the output is quantized with (o_scale,
+// o_zp, o_dtype). Always produces a channels last output.
+at::Tensor qroi_align(
+    const at::Tensor& input,
+    const at::Tensor& rois,
+    double spatial_scale,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype);
+
 at::Tensor ROIAlign_forward_meta(
     const at::Tensor& input,
     const at::Tensor& rois,
@@ -206,6 +221,18 @@ at::Tensor roi_align_forward_kernel_impl(
     int64_t sampling_ratio,
     bool aligned);
 
+at::Tensor qroi_align_forward_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& rois,
+    double spatial_scale,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype);
+
 at::Tensor roi_align_backward_kernel_impl(
     const at::Tensor& grad,
     const at::Tensor& rois,
@@ -247,5 +274,20 @@ using roi_align_backward_kernel_fn = at::Tensor (*)(
     bool);
 DECLARE_DISPATCH(roi_align_backward_kernel_fn, roi_align_backward_kernel_stub);
 
+using qroi_align_forward_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    double,
+    int64_t,
+    int64_t,
+    int64_t,
+    bool,
+    double,
+    int64_t,
+    at::ScalarType);
+DECLARE_DISPATCH(
+    qroi_align_forward_kernel_fn,
+    qroi_align_forward_kernel_stub);
+
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
@@ -0,0 +1,184 @@
+#include <ATen/Parallel.h>
+#include <ATen/Tensor.h>
+#include <c10/util/Exception.h>
+#include <c10/util/Optional.h>
+#include <torch/csrc/autograd/custom_function.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/variable.h>
+#include <torch/script.h>
+
+#include <chrono>
+
+#include "RNN.h"
+#include "RnntEmbedding.h"
+#include "UpdateBatch.h"
+
+namespace torch_ipex {
+namespace kernel {
+
+/*
+  rnnt_greedy_decode: the whole batched greedy decoder of RNN-T in one op.
+  Every symbol step runs embedding -> prediction LSTM -> joint -> argmax ->
+  batch update without returning to Python, and the decoder owns the
+  prediction network state across steps. A sequence stops emitting labels
+  and updating its state once its time index reaches its out_len; the loop
+  exits when all sequences are finished.
+
+  x: the feature got from the encoder, [time_step, batch_size, enc_hidden],
+    f32 or bf16
+  out_lens: valid time step of the encoded feature, [batch_size]
+  embedding_table: prediction network embedding, [vocab_size - 1, pred_hidden]
+  lstm_params: prediction network LSTM weights, (w_ih, w_hh, b_ih, b_hh) for
+    each layer, same dtype as embedding_table
+  joint_fc1_*, joint_fc2_*: joint network
+    fc2(relu(fc1(cat(f, g)))), same dtype as x
+  max_symbols: the max symbols to generate per time step
+  blank_id: id for blank symbol
+  _SOS: the mark of the Start Of Sequence
+
+  Returns the label tensor [batch_size, max_len * max_symbols + 1] (labels of
+  sequence i are in columns 1 .. label_len[i]), label_len [batch_size] and the
+  latency of each symbol step in microseconds.
+*/
+static std::tuple<at::Tensor, at::Tensor, at::Tensor> rnnt_greedy_decode(
+    const at::Tensor& x,
+    const at::Tensor& out_lens,
+    const at::Tensor& embedding_table,
+    std::vector<at::Tensor> lstm_params,
+    const at::Tensor& joint_fc1_weight,
+    const at::Tensor& joint_fc1_bias,
+    const at::Tensor& joint_fc2_weight,
+    const at::Tensor& joint_fc2_bias,
+    int64_t max_symbols,
+    int64_t blank_id,
+    int64_t _SOS) {
+#if defined(IPEX_DISP_OP)
+  printf("IPEX::rnnt_greedy_decode\n");
+#endif
+  RECORD_FUNCTION("IPEX::rnnt_greedy_decode", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      x.dim() == 3, "rnnt_greedy_decode: expects x of [T, batch, feature]");
+  TORCH_CHECK(
+      !lstm_params.empty() && lstm_params.size() % 4 == 0,
+      "rnnt_greedy_decode: expects (w_ih, w_hh, b_ih, b_hh) for each layer");
+  int64_t num_layers = lstm_params.size() / 4;
+  int64_t batch_size = x.size(1);
+  int64_t hidden_size = lstm_params[1].size(1);
+  int64_t embedding_dim = embedding_table.size(1);
+
+  auto lens = out_lens.to(at::kInt).contiguous();
+  int64_t max_len = lens.max().item<int64_t>();
+  auto int_opts = lens.options();
+  auto long_opts = int_opts.dtype(at::kLong);
+
+  // rnnt_update_batch expects x as [batch, T, feature] with [T, batch] memory
+  // order; f is kept in its own buffer so that x is never written.
+  auto x_ = x.contiguous().transpose(0, 1);
+  auto f = x_.select(1, 0).clone();
+
+  auto label_col = at::zeros({batch_size}, int_opts);
+  auto symbols_added = at::zeros({batch_size}, int_opts);
+  auto time_idxs = at::zeros({batch_size}, int_opts);
+  auto blankness = at::zeros({batch_size}, int_opts);
+  auto blank_vec = at::zeros({batch_size}, int_opts);
+  auto not_blank = at::zeros({batch_size}, int_opts);
+  auto label_to_put = at::zeros({batch_size}, long_opts);
+  auto label_tensor =
+      at::full({batch_size, max_len * max_symbols + 1}, _SOS, long_opts);
+  auto label_for_next_loop = at::full({batch_size}, _SOS, long_opts);
+
+  auto state_opts = embedding_table.options();
+  auto hx = at::zeros({num_layers, batch_size, hidden_size}, state_opts);
+  auto cx = at::zeros({num_layers, batch_size, hidden_size}, state_opts);
+  auto embedding = at::empty({batch_size, 1, embedding_dim}, state_opts);
+
+  static auto lstm_op = torch::Dispatcher::singleton()
+                            .findSchemaOrThrow("torch_ipex::ipex_lstm", "")
+                            .typed<decltype(torch_ipex::ipex_lstm)>();
+
+  if (max_len == 0) {
+    return std::make_tuple(
+        label_tensor, label_col, at::empty({0}, int_opts.dtype(at::kDouble)));
+  }
+  std::vector<double> step_latency;
+  // every step either emits a symbol or consumes a time step
+  int64_t max_steps = max_len * (max_symbols + 1);
+  for (int64_t step = 0; step < max_steps; step++) {
+    auto start = std::chrono::steady_clock::now();
+
+    torch_ipex::cpu::rnnt_embedding_kernel_stub(
+        kCPU,
+        embedding_table,
+        label_for_next_loop.unsqueeze(1),
+        embedding,
+        _SOS,
+        batch_size,
+        embedding_dim);
+
+    auto g = lstm_op.call(
+        embedding,
+        {hx, cx},
+        lstm_params,
+        /*has_biases*/ true,
+        num_layers,
+        /*dropout_p*/ 0.,
+        /*train*/ false,
+        /*bidirectional*/ false,
+        /*batch_first*/ true);
+
+    auto joint_in = at::cat(
+        {f, std::get<0>(g).squeeze(1).to(f.scalar_type())}, /*feature*/ 1);
+    auto hidden = at::linear(joint_in, joint_fc1_weight, joint_fc1_bias);
+    auto k = at::linear(hidden.relu_(), joint_fc2_weight, joint_fc2_bias)
+                 .argmax(/*classes*/ 1);
+
+    bool finished = torch_ipex::cpu::rnnt_update_batch_kernel_stub(
+        kCPU,
+        k,
+        lens,
+        label_col,
+        symbols_added,
+        time_idxs,
+        blankness,
+        blank_vec,
+        not_blank,
+        label_to_put,
+        label_tensor,
+        label_for_next_loop,
+        hx,
+        cx,
+        std::get<1>(g),
+        std::get<2>(g),
+        x_,
+        f,
+        max_symbols,
+        blank_id,
+        batch_size,
+        _SOS,
+        max_len);
+
+    step_latency.push_back(
+        std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+    if (finished) {
+      break;
+    }
+  }
+
+  return std::make_tuple(
+      label_tensor,
+      label_col,
+      at::tensor(step_latency, at::TensorOptions().dtype(at::kDouble)));
+}
+
+} // namespace kernel
+} // namespace torch_ipex
+
+namespace {
+
+static auto dispatch = torch::RegisterOperators().op(
+    "torch_ipex::rnnt_greedy_decode",
+    &torch_ipex::kernel::rnnt_greedy_decode);
+}
@@ -27,6 +27,7 @@ namespace torch_ipex {
 namespace cpu {
 
 DEFINE_DISPATCH(index_select_contig_stub);
+DEFINE_DISPATCH(index_add_contig_stub);
 DEFINE_DISPATCH(copy_stub);
 
 at::Tensor& index_select_out_cpu_(
@@ -252,6 +253,42 @@ at::Tensor index_select_cpu_(
   return index_select_out_cpu_(self, dim, index, result);
 }
 
+at::Tensor& index_add_(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::index_add_\n");
+#endif
+  RECORD_FUNCTION("torch_ipex::index_add_", c10::ArrayRef<c10::IValue>({}));
+
+  dim = at::maybe_wrap_dim(dim, self.dim());
+  const auto st = self.scalar_type();
+  bool use_contig_kernel = self.dim() > 0 && self.is_contiguous() &&
+      source.dim() == self.dim() && index.dim() == 1 &&
+      (index.scalar_type() == at::kLong || index.scalar_type() == at::kInt) &&
+      (st == at::kFloat || st == at::kDouble || st == at::kBFloat16) &&
+      source.scalar_type() == st && source.size(dim) == index.numel();
+  for (int64_t d = 0; use_contig_kernel && d < self.dim(); d++) {
+    use_contig_kernel = d == dim || source.size(d) == self.size(d);
+  }
+  if (!use_contig_kernel) {
+    return self.index_add_(dim, index, source, alpha);
+  }
+  at::assert_no_overlap(self, source);
+  at::assert_no_overlap(self, index);
+  if (index.numel() == 0 || self.numel() == 0) {
+    return self;
+  }
+
+  // pointer to index_add_contig_kernel(self, dim, index, source, alpha);
+  index_add_contig_stub(
+      kCPU, self, dim, index.contiguous(), source.contiguous(), alpha);
+  return self;
+}
+
 IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
   m.impl(
       TORCH_SELECTIVE_NAME("aten::index_select"),
@@ -261,5 +298,12 @@ IPEX_TORCH_LIBRARY_IMPL(aten, CPU, m) {
       TORCH_FN((&torch_ipex::cpu::index_select_out_cpu_)));
 }
 
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      "index_add_(Tensor(a!) self, int dim, Tensor index, Tensor source, *, "
+      "Scalar alpha=1) -> Tensor(a!)",
+      torch_ipex::cpu::index_add_);
+}
+
 } // namespace cpu
 } // namespace torch_ipex
\ No newline at end of file
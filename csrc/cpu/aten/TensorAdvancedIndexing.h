@@ -18,6 +18,13 @@ at::Tensor index_select_cpu_(
     int64_t dim,
     const at::Tensor& index);
 
+at::Tensor& index_add_(
+    at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha);
+
 namespace {
 
 void index_select_contig_kernel(
@@ -26,6 +33,13 @@ void index_select_contig_kernel(
     int64_t dim,
     const at::Tensor& index);
 
+void index_add_contig_kernel(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha);
+
 void copy_kernel(at::TensorIterator& iter, bool /*non_blocking*/);
 
 } // namespace
@@ -34,6 +48,14 @@ using index_select_fn =
     void (*)(const at::Tensor&, const at::Tensor&, int64_t, const at::Tensor&);
 DECLARE_DISPATCH(index_select_fn, index_select_contig_stub);
 
+using index_add_fn = void (*)(
+    const at::Tensor&,
+    int64_t,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Scalar&);
+DECLARE_DISPATCH(index_add_fn, index_add_contig_stub);
+
 using copy_fn = void (*)(at::TensorIterator&, bool non_blocking);
 DECLARE_DISPATCH(copy_fn, copy_stub);
 
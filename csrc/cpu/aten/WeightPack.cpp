@@ -1,7 +1,24 @@
+#include <ATen/Parallel.h>
+#include <c10/util/accumulate.h>
 #include <torch/all.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
 #include "WeightPack.h"
-#include "utils/rw_lock.h"
 #include "utils/utils.h"
 
 namespace torch_ipex {
@@ -9,38 +26,424 @@ namespace cpu {
 
 namespace {
 
-using weakref_type =
-    c10::weak_intrusive_ptr<c10::TensorImpl, c10::UndefinedTensorImpl>;
-using val_blocked = std::tuple<weakref_type, ideep::tensor>;
-std::unordered_map<c10::TensorImpl*, val_blocked> cached_weights;
+// Only files of the current user which nobody else can write are mapped.
+bool is_private(const struct stat& st) {
+  return st.st_uid == geteuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+// The packed weights go to a subdirectory of IPEX_WEIGHT_SHARING_DIR private
+// to the user, created with mode 0700. A subdirectory which is not a real
+// directory owned by the user, or which others can access, is refused and
+// the weights are not shared.
+std::string init_weight_sharing_dir() {
+  const char* root = getenv("IPEX_WEIGHT_SHARING_DIR");
+  if (root == nullptr || root[0] == '\0') {
+    return "";
+  }
+  std::string dir =
+      std::string(root) + "/ipex_packed_weights_" + std::to_string(geteuid());
+  if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) {
+    TORCH_WARN(
+        "Failed to create ", dir, ", the packed weights are not shared");
+    return "";
+  }
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW);
+  struct stat st;
+  bool ok = fd >= 0 && fstat(fd, &st) == 0 && S_ISDIR(st.st_mode) &&
+      st.st_uid == geteuid() && (st.st_mode & (S_IRWXG | S_IRWXO)) == 0;
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (!ok) {
+    TORCH_WARN(
+        dir,
+        " is not a directory private to the user, the packed weights are "
+        "not shared");
+    return "";
+  }
+  return dir;
+}
+
+const char* weight_sharing_dir() {
+  static const std::string dir = init_weight_sharing_dir();
+  return dir.empty() ? nullptr : dir.c_str();
+}
+
+inline uint64_t mix64(uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+// Packed weights are keyed by the bytes of the storage the weight views, so
+// that tied weights and views of the same parameter share one packed copy.
+struct PackedWeightKey {
+  c10::StorageImpl* storage;
+  int64_t offset;
+  std::vector<int64_t> sizes;
+  std::vector<int64_t> strides;
+  at::ScalarType dtype;
+
+  explicit PackedWeightKey(const at::Tensor& weight)
+      : storage(weight.storage().unsafeGetStorageImpl()),
+        offset(weight.storage_offset()),
+        sizes(weight.sizes().vec()),
+        strides(weight.strides().vec()),
+        dtype(weight.scalar_type()) {}
+
+  bool operator==(const PackedWeightKey& other) const {
+    return storage == other.storage && offset == other.offset &&
+        sizes == other.sizes && strides == other.strides &&
+        dtype == other.dtype;
+  }
+};
+
+struct PackedWeightKeyHash {
+  size_t operator()(const PackedWeightKey& key) const {
+    uint64_t h = mix64(reinterpret_cast<uintptr_t>(key.storage));
+    h = mix64(h ^ static_cast<uint64_t>(key.offset));
+    for (auto size : key.sizes) {
+      h = mix64(h ^ static_cast<uint64_t>(size));
+    }
+    for (auto stride : key.strides) {
+      h = mix64(h ^ static_cast<uint64_t>(stride));
+    }
+    return mix64(h ^ static_cast<uint64_t>(key.dtype));
+  }
+};
+
+// One packed copy per target, i.e. per set of parameters deciding the
+// packed desc of the weight. The weak reference tells whether the storage
+// the key points to is still the one which was packed.
+struct PackedWeightEntry {
+  c10::weak_intrusive_ptr<c10::StorageImpl> storage;
+  uint64_t target;
+  ideep::tensor packed;
+};
+
+using PackedWeightMap = std::unordered_map<
+    PackedWeightKey,
+    std::vector<PackedWeightEntry>,
+    PackedWeightKeyHash>;
+
+// Sharded copy-on-write map: readers atomically load the current snapshot of
+// a shard without taking any lock, writers of a shard serialize on its mutex
+// and publish a new snapshot, from which the entries of freed storages are
+// dropped. Writes only happen once per packed weight.
+class PackedWeightCache {
+ public:
+  ideep::tensor read(const at::Tensor& weight, uint64_t target) {
+    PackedWeightKey key(weight);
+    auto& shard = shard_of(key);
+    auto map = std::atomic_load(&shard.map);
+    auto it = map->find(key);
+    if (it == map->end()) {
+      return ideep::tensor();
+    }
+    bool has_expired = false;
+    for (const auto& entry : it->second) {
+      if (entry.storage.expired()) {
+        has_expired = true;
+      } else if (entry.target == target) {
+        return entry.packed;
+      }
+    }
+    if (has_expired) {
+      prune(shard);
+    }
+    return ideep::tensor();
+  }
+
+  bool contains(const at::Tensor& weight) {
+    PackedWeightKey key(weight);
+    auto map = std::atomic_load(&shard_of(key).map);
+    auto it = map->find(key);
+    if (it == map->end()) {
+      return false;
+    }
+    return std::any_of(
+        it->second.begin(), it->second.end(), [](const auto& entry) {
+          return !entry.storage.expired();
+        });
+  }
+
+  void write(
+      const at::Tensor& weight,
+      uint64_t target,
+      const ideep::tensor& packed) {
+    PackedWeightKey key(weight);
+    auto& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    auto map = live_copy(*std::atomic_load(&shard.map));
+    auto& entries = (*map)[key];
+    entries.erase(
+        std::remove_if(
+            entries.begin(),
+            entries.end(),
+            [&](const auto& entry) { return entry.target == target; }),
+        entries.end());
+    entries.push_back(
+        {c10::weak_intrusive_ptr<c10::StorageImpl>(
+             weight.storage().getIntrusivePtr()),
+         target,
+         packed});
+    std::atomic_store(
+        &shard.map, std::shared_ptr<const PackedWeightMap>(std::move(map)));
+  }
+
+  // Drops the entries of freed storages and returns the number of packed
+  // weights and the bytes they hold.
+  std::pair<int64_t, int64_t> stats() {
+    int64_t num_entries = 0;
+    int64_t nbytes = 0;
+    for (auto& shard : shards_) {
+      prune(shard);
+      auto map = std::atomic_load(&shard.map);
+      for (const auto& item : *map) {
+        for (const auto& entry : item.second) {
+          num_entries++;
+          nbytes += entry.packed.get_desc().get_size();
+        }
+      }
+    }
+    return std::make_pair(num_entries, nbytes);
+  }
+
+ private:
+  static constexpr size_t kNumShards = 16;
+
+  struct Shard {
+    std::mutex write_mutex;
+    std::shared_ptr<const PackedWeightMap> map =
+        std::make_shared<const PackedWeightMap>();
+  };
+
+  Shard& shard_of(const PackedWeightKey& key) {
+    return shards_[PackedWeightKeyHash()(key) % kNumShards];
+  }
+
+  static std::unique_ptr<PackedWeightMap> live_copy(
+      const PackedWeightMap& map) {
+    auto copy = std::make_unique<PackedWeightMap>();
+    for (const auto& item : map) {
+      std::vector<PackedWeightEntry> entries;
+      for (const auto& entry : item.second) {
+        if (!entry.storage.expired()) {
+          entries.push_back(entry);
+        }
+      }
+      if (!entries.empty()) {
+        copy->emplace(item.first, std::move(entries));
+      }
+    }
+    return copy;
+  }
+
+  void prune(Shard& shard) {
+    std::lock_guard<std::mutex> lock(shard.write_mutex);
+    std::atomic_store(
+        &shard.map,
+        std::shared_ptr<const PackedWeightMap>(
+            live_copy(*std::atomic_load(&shard.map))));
+  }
+
+  std::array<Shard, kNumShards> shards_;
+};
+
+PackedWeightCache& packed_weight_cache() {
+  static PackedWeightCache cache;
+  return cache;
+}
+
+// The packed desc of the LSTM weights only depends on their sizes and dtype,
+// which are part of the key, and on the int8 weight scales.
+uint64_t lstm_pack_target(
+    int weights_scale_mask,
+    const std::vector<float>& weights_scales) {
+  uint64_t h = mix64(static_cast<uint64_t>(weights_scale_mask) + 1);
+  for (float scale : weights_scales) {
+    uint32_t bits;
+    std::memcpy(&bits, &scale, sizeof(bits));
+    h = mix64(h ^ bits);
+  }
+  return h;
+}
+
+// 128 bit hash of the bytes, made of two 64 bit lanes. The bytes are hashed
+// in parallel over fixed size chunks so that the result does not depend on
+// the number of threads of the process.
+std::pair<uint64_t, uint64_t> hash_bytes(const char* data, int64_t nbytes) {
+  constexpr int64_t kChunk = 1 << 20;
+  constexpr uint64_t kPrime = 0x100000001b3ULL;
+  const int64_t nchunks = (nbytes + kChunk - 1) / kChunk;
+  std::vector<std::pair<uint64_t, uint64_t>> chunk_hashes(nchunks);
+  at::parallel_for(0, nchunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      const char* p = data + c * kChunk;
+      const int64_t len = std::min(kChunk, nbytes - c * kChunk);
+      uint64_t h1 = 0x9e3779b97f4a7c15ULL;
+      uint64_t h2 = 0xc2b2ae3d27d4eb4fULL;
+      int64_t i = 0;
+      for (; i + 8 <= len; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, p + i, sizeof(v));
+        h1 = (h1 ^ mix64(v)) * kPrime;
+        h2 = mix64(h2 + v);
+      }
+      for (; i < len; i++) {
+        h1 = (h1 ^ static_cast<uint8_t>(p[i])) * kPrime;
+        h2 = mix64(h2 + static_cast<uint8_t>(p[i]));
+      }
+      chunk_hashes[c] = std::make_pair(mix64(h1 ^ len), mix64(h2 ^ c));
+    }
+  });
+  uint64_t h1 = static_cast<uint64_t>(nbytes);
+  uint64_t h2 = ~h1;
+  for (const auto& chunk_hash : chunk_hashes) {
+    h1 = mix64(h1 ^ chunk_hash.first) * kPrime;
+    h2 = mix64(h2 + chunk_hash.second);
+  }
+  return std::make_pair(h1, h2);
+}
 
-using map_iter =
-    std::unordered_map<c10::TensorImpl*, val_blocked>::const_iterator;
+template <typename T>
+void write_dims(std::ostringstream& os, const T& dims) {
+  for (const auto d : dims) {
+    os << d << ",";
+  }
+  os << "_";
+}
 
-torch_ipex::ReadWriteMutex rwmutex;
+// The file name has the hash of the source weight and of everything that
+// decides the packed layout, so that a stale or foreign file is never picked.
+std::string shared_weight_path(
+    const char* dir,
+    const ideep::tensor& w,
+    const ideep::tensor::desc& packed_desc) {
+  std::ostringstream layout;
+  layout << static_cast<int>(w.get_data_type()) << "_";
+  write_dims(layout, w.get_dims());
+  write_dims(layout, w.get_strides());
+  layout << static_cast<int>(packed_desc.get_data_type()) << "_";
+  write_dims(layout, packed_desc.get_dims());
+  write_dims(layout, packed_desc.get_padded_dims());
+  write_dims(layout, packed_desc.get_strides());
+  write_dims(layout, packed_desc.get_inner_blks());
+  write_dims(layout, packed_desc.get_inner_idxs());
+  layout << packed_desc.get_size();
+  auto layout_str = layout.str();
+  auto layout_hash = hash_bytes(layout_str.data(), layout_str.size());
+  auto content_hash = hash_bytes(
+      static_cast<const char*>(w.get_data_handle()), w.get_size());
+
+  std::ostringstream path;
+  path << dir << "/ipex_packed_weight_" << std::hex << std::setfill('0')
+       << std::setw(16) << content_hash.first << std::setw(16)
+       << content_hash.second << "_" << std::setw(16) << layout_hash.first;
+  return path.str();
+}
 
-ideep::tensor read_cached_weights(const at::Tensor& weight) {
-  torch_ipex::UniqueReadLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
-  ideep::tensor cached_weight;
-  auto it = cached_weights.find(weight.unsafeGetTensorImpl());
-  if (it != cached_weights.end()) {
-    cached_weight = std::get<1>(it->second);
+// Maps the file copy-on-write, so that a process updating the weight (e.g.
+// the optimizer in training) only gets private copies of the touched pages.
+// The opened file itself is checked, so that a file swapped in after the
+// directory check is not mapped either.
+void* map_shared_weight(const std::string& path, size_t nbytes) {
+  int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+  if (fd < 0) {
+    return nullptr;
+  }
+  void* ptr = nullptr;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && is_private(st) &&
+      static_cast<size_t>(st.st_size) == nbytes) {
+    ptr = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (ptr == MAP_FAILED) {
+      ptr = nullptr;
+    }
   }
-  return cached_weight;
+  close(fd);
+  return ptr;
 }
 
-void write_cached_weights(const at::Tensor& weight, ideep::tensor& result) {
-  torch_ipex::UniqueWriteLock<torch_ipex::ReadWriteMutex> lock(rwmutex);
-  cached_weights.emplace(
-      weight.unsafeGetTensorImpl(),
-      val_blocked{weakref_type(weight.getIntrusivePtr()), result});
+// Writes to a uniquely named temporary file first and renames it, so that
+// the threads and processes packing the same weight at the same time never
+// map a partially written file.
+bool write_shared_weight(
+    const std::string& path,
+    const void* data,
+    size_t nbytes) {
+  std::string tmp_path = path + ".tmpXXXXXX";
+  // created with mode 0600
+  int fd = mkstemp(&tmp_path[0]);
+  if (fd < 0) {
+    return false;
+  }
+  const char* p = static_cast<const char*>(data);
+  size_t written = 0;
+  while (written < nbytes) {
+    auto n = write(fd, p + written, nbytes - written);
+    if (n <= 0) {
+      break;
+    }
+    written += n;
+  }
+  close(fd);
+  if (written != nbytes || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    return false;
+  }
+  return true;
 }
 
 } // namespace
 
 bool is_packed(const at::Tensor& weight) {
-  auto cached_weight = read_cached_weights(weight);
-  return !cached_weight.is_empty();
+  return packed_weight_cache().contains(weight);
+}
+
+std::tuple<int64_t, int64_t> get_packed_weight_cache_stats() {
+  return packed_weight_cache().stats();
+}
+
+at::Tensor pack_weight_to_desc(
+    const ideep::tensor& w,
+    const ideep::tensor::desc& packed_desc,
+    const at::TensorOptions& options,
+    ideep::tensor& packed_weight) {
+  auto sizes = aten_sizes_from_desc(packed_desc);
+  const size_t nbytes = packed_desc.get_size();
+  const char* dir = weight_sharing_dir();
+  if (dir != nullptr &&
+      c10::multiply_integers(sizes) * options.dtype().itemsize() == nbytes) {
+    auto path = shared_weight_path(dir, w, packed_desc);
+    void* ptr = map_shared_weight(path, nbytes);
+    if (ptr == nullptr) {
+      auto at_weight = at::empty(sizes, options);
+      packed_weight.init(packed_desc, at_weight.data_ptr());
+      packed_weight.feed_from(w);
+      if (write_shared_weight(path, at_weight.data_ptr(), nbytes)) {
+        ptr = map_shared_weight(path, nbytes);
+      }
+      if (ptr == nullptr) {
+        TORCH_WARN_ONCE(
+            "Failed to share the packed weights in ",
+            dir,
+            ", they are kept private to the process");
+        return at_weight;
+      }
+    }
+    packed_weight.init(packed_desc, ptr);
+    return at::from_blob(
+        ptr, sizes, [nbytes](void* p) { munmap(p, nbytes); }, options);
+  }
+
+  auto at_weight = at::empty(sizes, options);
+  packed_weight.init(packed_desc, at_weight.data_ptr());
+  packed_weight.feed_from(w);
+  return at_weight;
 }
 
 #define LSTM_PACKED_WEIGHT(TYPE)                     \
@@ -74,8 +477,9 @@ std::tuple<ideep::tensor, ideep::tensor> CommonLstmWeightDesc::
 
   cached_weight_ih = w1_src_.reorder_if_differ_in(packed_desc_ih_, op_attr_);
   cached_weight_hh = w2_src_.reorder_if_differ_in(packed_desc_hh_, op_attr_);
-  write_cached_weights(weight_ih_, cached_weight_ih);
-  write_cached_weights(weight_hh_, cached_weight_hh);
+  auto target = lstm_pack_target(weights_scale_mask_, weights_scales_);
+  packed_weight_cache().write(weight_ih_, target, cached_weight_ih);
+  packed_weight_cache().write(weight_hh_, target, cached_weight_hh);
   return std::make_tuple(cached_weight_ih, cached_weight_hh);
 }
 
@@ -162,8 +566,11 @@ std::tuple<ideep::tensor, ideep::tensor> lstm_packed_weight(
     const ideep::tensor& bias,
     const bool reverse,
     const QuantizedLstmParams& quantizedLstmParams) {
-  auto cached_weight_ih = read_cached_weights(weight_ih);
-  auto cached_weight_hh = read_cached_weights(weight_hh);
+  auto target = lstm_pack_target(
+      quantizedLstmParams.weights_scale_mask,
+      quantizedLstmParams.weights_scales);
+  auto cached_weight_ih = packed_weight_cache().read(weight_ih, target);
+  auto cached_weight_hh = packed_weight_cache().read(weight_hh, target);
   bool all_in_cache =
       !cached_weight_ih.is_empty() && !cached_weight_hh.is_empty();
   bool all_miss = cached_weight_ih.is_empty() && cached_weight_hh.is_empty();
@@ -201,8 +201,29 @@ std::tuple<ideep::tensor, ideep::tensor> get_lstm_packed_weight(
     const bool train,
     const QuantizedLstmParams& quantizedLstmParams);
 
+// Whether the bytes viewed by weight have been packed and cached, e.g. by an
+// LSTM in inference. Packed copies are shared by the tensors viewing the same
+// storage bytes and are dropped once the storage is freed.
 bool is_packed(const at::Tensor& weight);
 
+// Returns the number of packed weights in the cache and the bytes they hold,
+// after dropping the ones of freed storages.
+std::tuple<int64_t, int64_t> get_packed_weight_cache_stats();
+
+// Reorders w to packed_desc into a new ATen tensor and inits packed_weight on
+// it. When the IPEX_WEIGHT_SHARING_DIR environment variable is set, the packed
+// bytes are also stored in a file of that directory keyed by packed_desc and a
+// hash of the content of w. Processes packing the same weight later map the
+// file copy-on-write instead of packing it again, so that the instances on one
+// machine share the pages of the packed weights. The files go to a
+// subdirectory private to the user and are kept for later runs, they are
+// removed together with that directory.
+at::Tensor pack_weight_to_desc(
+    const ideep::tensor& w,
+    const ideep::tensor::desc& packed_desc,
+    const at::TensorOptions& options,
+    ideep::tensor& packed_weight);
+
 // Get the conv_transpose's expected ideep weight tensor desc.
 ideep::tensor::desc get_conv_transpose_expected_weights_desc(
     const ideep::tensor::dims& weights_dims,
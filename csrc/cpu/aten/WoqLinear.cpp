@@ -0,0 +1,164 @@
+#include "WoqLinear.h"
+
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+DEFINE_DISPATCH(woq_linear_kernel_stub);
+
+std::tuple<at::Tensor, at::Tensor> woq_linear_pack_weight(
+    const at::Tensor& weight,
+    int64_t bits,
+    int64_t group_size) {
+  TORCH_CHECK(
+      bits == 8 || bits == 4, "woq_linear: only supports 8 or 4 bits weight");
+  TORCH_CHECK(
+      weight.dim() == 2 && weight.size(0) > 0 && weight.size(1) > 0,
+      "woq_linear: expects a non empty 2D weight");
+  TORCH_CHECK(group_size >= 0, "woq_linear: group_size should not be negative");
+  const int64_t N = weight.size(0);
+  const int64_t K = weight.size(1);
+  const int64_t G = group_size > 0 ? group_size : K;
+  const int64_t num_groups = (K + G - 1) / G;
+  const int64_t num_blocks = (N + kWoqBlockN - 1) / kWoqBlockN;
+  const float qmax = bits == 8 ? 127.f : 7.f;
+
+  // zero padding of the last block and of the last group does not change the
+  // scales of the real weights
+  auto w = at::constant_pad_nd(
+      weight.to(at::kFloat),
+      {0, num_groups * G - K, 0, num_blocks * kWoqBlockN - N});
+  auto grouped = w.view({num_blocks * kWoqBlockN, num_groups, G});
+  auto scales = grouped.abs().amax(-1) / qmax;
+  scales.masked_fill_(scales == 0, 1.f);
+  auto q = (grouped / scales.unsqueeze(-1))
+               .round_()
+               .clamp_(-qmax, qmax)
+               .view({num_blocks, kWoqBlockN, num_groups * G})
+               .narrow(2, 0, K)
+               .permute({0, 2, 1});
+
+  at::Tensor qweight;
+  if (bits == 8) {
+    qweight = q.to(at::kChar).contiguous();
+  } else {
+    const int64_t half = kWoqBlockN / 2;
+    auto u = q + 8.f;
+    qweight = (u.narrow(2, 0, half) + u.narrow(2, half, half) * 16.f)
+                  .to(at::kByte)
+                  .contiguous();
+  }
+  auto packed_scales = scales.view({num_blocks, kWoqBlockN, num_groups})
+                           .permute({0, 2, 1})
+                           .contiguous();
+  return std::make_tuple(qweight, packed_scales);
+}
+
+at::Tensor woq_linear_unpack_weight(
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    int64_t out_features,
+    int64_t in_features,
+    int64_t bits,
+    int64_t group_size) {
+  const int64_t num_blocks = qweight.size(0);
+  const int64_t num_groups = scales.size(1);
+  const int64_t G = group_size > 0 ? group_size : in_features;
+  auto q = qweight.to(at::kFloat);
+  if (bits == 4) {
+    q = at::cat({at::remainder(q, 16.f), at::floor(q / 16.f)}, 2) - 8.f;
+  }
+  auto w = q.permute({0, 2, 1}).reshape(
+      {num_blocks * kWoqBlockN, in_features});
+  auto s = scales.permute({0, 2, 1})
+               .reshape({num_blocks * kWoqBlockN, num_groups})
+               .repeat_interleave(G, 1)
+               .narrow(1, 0, in_features);
+  return (w * s).narrow(0, 0, out_features).contiguous();
+}
+
+at::Tensor woq_linear(
+    const at::Tensor& input,
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    const c10::optional<at::Tensor>& bias,
+    int64_t out_features,
+    int64_t bits,
+    int64_t group_size) {
+#if defined(IPEX_DISP_OP)
+  printf("torch_ipex::woq_linear\n");
+#endif
+  RECORD_FUNCTION("torch_ipex::woq_linear", c10::ArrayRef<c10::IValue>({}));
+
+  TORCH_CHECK(
+      input.scalar_type() == at::kFloat || input.scalar_type() == at::kBFloat16,
+      "woq_linear: only supports fp32 and bf16 input");
+  TORCH_CHECK(
+      bits == 8 || bits == 4, "woq_linear: only supports 8 or 4 bits weight");
+  TORCH_CHECK(
+      group_size >= 0, "woq_linear: group_size should not be negative");
+  // the kernels read the packed buffers directly, so their layout is checked
+  // against woq_linear_pack_weight
+  TORCH_CHECK(
+      qweight.dim() == 3 && qweight.is_contiguous() &&
+          qweight.scalar_type() == (bits == 8 ? at::kChar : at::kByte) &&
+          qweight.size(2) == (bits == 8 ? kWoqBlockN : kWoqBlockN / 2),
+      "woq_linear: expects a contiguous ",
+      bits == 8 ? "int8 qweight in [N / 16, K, 16]"
+                : "uint8 qweight in [N / 16, K, 8]",
+      " for ",
+      bits,
+      " bits");
+  TORCH_CHECK(
+      input.dim() >= 1 && input.size(-1) == qweight.size(1),
+      "woq_linear: input feature size does not match the weight");
+  TORCH_CHECK(
+      out_features <= qweight.size(0) * kWoqBlockN,
+      "woq_linear: out_features does not match the weight");
+  const int64_t in_features = qweight.size(1);
+  const int64_t G = group_size > 0 ? group_size : in_features;
+  const int64_t num_groups = in_features == 0 ? 0 : (in_features + G - 1) / G;
+  TORCH_CHECK(
+      scales.scalar_type() == at::kFloat && scales.is_contiguous() &&
+          scales.dim() == 3 && scales.size(0) == qweight.size(0) &&
+          scales.size(1) == num_groups && scales.size(2) == kWoqBlockN,
+      "woq_linear: expects contiguous float scales in [N / 16, ",
+      num_groups,
+      ", 16]");
+  at::Tensor bias_ = bias.has_value() ? bias.value() : at::Tensor();
+  TORCH_CHECK(
+      !bias_.defined() || bias_.numel() == out_features,
+      "woq_linear: expects bias in [out_features]");
+  TORCH_CHECK(
+      !bias_.defined() || bias_.scalar_type() == at::kFloat ||
+          bias_.scalar_type() == at::kBFloat16,
+      "woq_linear: only supports fp32 and bf16 bias");
+  // pointer to woq_linear_kernel_impl(input, qweight, scales, bias,
+  // out_features, bits, group_size);
+  return woq_linear_kernel_stub(
+      kCPU, input, qweight, scales, bias_, out_features, bits, group_size);
+}
+
+} // namespace cpu
+} // namespace torch_ipex
+
+namespace {
+
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      torch::schema(
+          "torch_ipex::woq_linear_pack_weight(Tensor weight, int bits, "
+          "int group_size) -> (Tensor, Tensor)",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::cpu::woq_linear_pack_weight);
+  m.def(
+      torch::schema(
+          "torch_ipex::woq_linear(Tensor input, Tensor qweight, Tensor scales, "
+          "Tensor? bias, int out_features, int bits, int group_size) "
+          "-> Tensor",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::cpu::woq_linear);
+}
+
+} // namespace
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <dyndisp/DispatchStub.h>
+#include <torch/all.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+// Output channels are packed in blocks of kWoqBlockN so that one block of
+// dequantized weights is a full AVX512 register of fp32.
+constexpr int64_t kWoqBlockN = 16;
+
+// Symmetric weight-only quantization of a [N, K] linear weight with one fp32
+// scale per output channel and per group of group_size input channels
+// (group_size = 0 for one group over K).
+// Returns the quantized weight packed in [N / 16, K, 16] int8 for bits = 8 or
+// in [N / 16, K, 8] uint8 for bits = 4, where the byte j holds the channel j
+// in its low nibble and the channel j + 8 in its high nibble, both offset by
+// 8, and the scales packed in [N / 16, ceil(K / group_size), 16]. N is padded
+// to a multiple of 16 with zero weights.
+std::tuple<at::Tensor, at::Tensor> woq_linear_pack_weight(
+    const at::Tensor& weight,
+    int64_t bits,
+    int64_t group_size);
+
+// Dequantizes the packed weight back to a [N, K] fp32 weight.
+at::Tensor woq_linear_unpack_weight(
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    int64_t out_features,
+    int64_t in_features,
+    int64_t bits,
+    int64_t group_size);
+
+// y = x @ dequant(qweight).t() + bias with the weights dequantized in
+// registers and accumulated in fp32. x stays in its own dtype (fp32 or bf16)
+// and so does the output.
+at::Tensor woq_linear(
+    const at::Tensor& input,
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    const c10::optional<at::Tensor>& bias,
+    int64_t out_features,
+    int64_t bits,
+    int64_t group_size);
+
+namespace {
+
+at::Tensor woq_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    const at::Tensor& bias,
+    int64_t out_features,
+    int64_t bits,
+    int64_t group_size);
+
+} // namespace
+
+using woq_linear_kernel_fn = at::Tensor (*)(
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    const at::Tensor&,
+    int64_t,
+    int64_t,
+    int64_t);
+DECLARE_DISPATCH(woq_linear_kernel_fn, woq_linear_kernel_stub);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -1,4 +1,5 @@
 #include <ATen/NamedTensorUtils.h>
+#include <ATen/OpMathType.h>
 #include <ATen/WrapDimUtils.h>
 #include <ATen/cpu/vec/functional.h>
 #include <ATen/cpu/vec/vec.h>
@@ -8,6 +9,7 @@
 #include <aten/Cumsum.h>
 
 #include <immintrin.h>
+#include <algorithm>
 #include "vec/vec.h"
 
 namespace torch_ipex {
@@ -22,130 +24,364 @@ inline int64_t divup(int64_t x, int64_t y) {
   return (x + y - 1) / y;
 }
 
-template <typename scalar_t>
-static inline void cumsum_lastdim_kernel(
-    at::Tensor& result,
-    const at::Tensor& self,
-    int64_t dim) {
-  const auto input_ndim = self.dim();
-  TORCH_CHECK(
-      dim == input_ndim - 1,
-      "cumsum_lastdim_kernel: expect dim to be ",
-      input_ndim - 1,
-      " got ",
-      dim);
-  TORCH_CHECK(
-      self.scalar_type() == result.scalar_type(),
-      "cumsum_lastdim_kernel: expect same data type for self and result");
+// Elements below which a scan is not worth splitting across threads.
+constexpr int64_t kMinChunkSize = 32 * 1024;
+// Bytes of input per thread for each tile of the two pass scan, set to
+// 256KB (L2 cache reside) so that the second pass reads from the L2.
+constexpr int64_t kChunkBytes = 256 * 1024;
+// Columns of the non-last dim scans per task.
+constexpr int64_t kInnerBlockSize = 256;
+
+template <typename in_t, typename out_t, typename acc_t>
+inline acc_t scan_line(
+    const in_t* src,
+    out_t* dst,
+    acc_t init,
+    int64_t n,
+    bool exclusive) {
+  return prefix_sum(src, dst, init, n, exclusive);
+}
 
-  if (result.sizes() != self.sizes()) {
-    result.resize_as_(self);
-  }
-  if (self.numel() == 0) {
-    return;
+// the inclusive int64 scans have a vectorized prefix_sum
+template <>
+inline int64_t scan_line<int64_t, int64_t, int64_t>(
+    const int64_t* src,
+    int64_t* dst,
+    int64_t init,
+    int64_t n,
+    bool exclusive) {
+  if (exclusive || n == 0) {
+    return prefix_sum(src, dst, init, n, exclusive);
   }
-  if (input_ndim == 0) {
-    result.fill_(self);
-    return;
-  }
-
-  int64_t N = self.size(dim);
-  int64_t M = self.numel() / N;
-  const scalar_t* self_data = self.data_ptr<scalar_t>();
-  scalar_t* result_data = result.data_ptr<scalar_t>();
-
-  int64_t T = at::get_num_threads();
-
-  // bytes per core for each chunk, set to 256KB (L2 cache reside)
-  constexpr int64_t CHUNK_SIZE_PER_CORE = 256 * 1024 / sizeof(scalar_t);
-  int64_t CHUNK_SIZE = std::max(int64_t(1), CHUNK_SIZE_PER_CORE / M * T);
-  int64_t K = divup(N, CHUNK_SIZE);
-
-  // offset value per chunk
-  std::vector<scalar_t> outer_offsets(M, scalar_t(0));
-
-  // offset value per thread
-  std::vector<scalar_t> inner_offsets(M * T, scalar_t(0));
-
-  for (int64_t k = 0; k < K; k++) {
-    int64_t k_begin = k * CHUNK_SIZE;
-    int64_t k_end = std::min(k_begin + CHUNK_SIZE, N);
-
-    // Parallel Path I: accumulate locally per thread
-    at::parallel_for(k_begin, k_end, 1, [&](int64_t begin, int64_t end) {
-      int64_t tid = at::get_thread_num();
-      for (int64_t m = 0; m < M; m++) {
-        const scalar_t* self_ptr = self_data + m * N + begin;
-        scalar_t* result_ptr = result_data + m * N + begin;
-        int64_t len = end - begin;
+  prefix_sum<int64_t>(src, dst, init, n);
+  return dst[n - 1];
+}
 
-        prefix_sum<scalar_t>(self_ptr, result_ptr, scalar_t(0), len);
-        inner_offsets[m * T + tid] = result_ptr[len - 1];
+// Scans a contiguous [outer_size, dim_size, inner_size] tensor along
+// dim_size. With enough independent scans, each task runs some of them from
+// the start to the end. Otherwise each scan is split in chunks which are
+// reduced, then scanned from the sum of the chunks before them.
+template <typename in_t, typename out_t>
+void cumsum_kernel(
+    const in_t* src,
+    out_t* dst,
+    int64_t outer_size,
+    int64_t dim_size,
+    int64_t inner_size,
+    bool exclusive) {
+  using acc_t = at::opmath_type<out_t>;
+  const int64_t num_threads = at::get_num_threads();
+  const int64_t inner_blocks = divup(inner_size, kInnerBlockSize);
+  const int64_t num_lanes = outer_size * inner_blocks;
+  const int64_t lane_size = dim_size * std::min(inner_size, kInnerBlockSize);
+
+  if (num_lanes >= num_threads ||
+      outer_size * dim_size * inner_size < kMinChunkSize) {
+    const int64_t grain_size = divup(kMinChunkSize, lane_size);
+    at::parallel_for(0, num_lanes, grain_size, [&](int64_t begin, int64_t end) {
+      std::vector<acc_t> acc(std::min(inner_size, kInnerBlockSize));
+      for (int64_t lane = begin; lane < end; lane++) {
+        int64_t o = lane / inner_blocks;
+        int64_t i = (lane % inner_blocks) * kInnerBlockSize;
+        int64_t width = std::min(kInnerBlockSize, inner_size - i);
+        int64_t offset = o * dim_size * inner_size + i;
+        if (inner_size == 1) {
+          scan_line(src + offset, dst + offset, acc_t(0), dim_size, exclusive);
+        } else {
+          std::fill(acc.begin(), acc.begin() + width, acc_t(0));
+          prefix_sum_rows(
+              src + offset,
+              dst + offset,
+              acc.data(),
+              dim_size,
+              width,
+              inner_size,
+              exclusive);
+        }
       }
     });
+    return;
+  }
 
-    // update offset value for each thread
-    for (int64_t m = 0; m < M; m++) {
-      for (int64_t t = T - 1; t >= 0; t--) {
-        scalar_t offset = scalar_t(0);
-        for (int64_t i = t - 1; i >= 0; i--) {
-          offset += inner_offsets[m * T + i];
+  const int64_t chunk_rows =
+      std::max<int64_t>(1, kChunkBytes / (inner_size * sizeof(in_t)));
+  const int64_t tile_rows = chunk_rows * num_threads;
+  // carry in of the tile, then of each chunk of the tile
+  std::vector<acc_t> carry(inner_size);
+  std::vector<acc_t> chunk_carry(num_threads * inner_size);
+  for (int64_t o = 0; o < outer_size; o++) {
+    std::fill(carry.begin(), carry.end(), acc_t(0));
+    for (int64_t tile = 0; tile < dim_size; tile += tile_rows) {
+      const int64_t rows = std::min(tile_rows, dim_size - tile);
+      const int64_t num_chunks = divup(rows, chunk_rows);
+      const in_t* src_tile = src + (o * dim_size + tile) * inner_size;
+      out_t* dst_tile = dst + (o * dim_size + tile) * inner_size;
+
+      // Parallel Path I: sum of each chunk
+      at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; c++) {
+          int64_t len = std::min(chunk_rows, rows - c * chunk_rows);
+          const in_t* src_ptr = src_tile + c * chunk_rows * inner_size;
+          acc_t* total = chunk_carry.data() + c * inner_size;
+          if (inner_size == 1) {
+            total[0] = reduce_sum(src_ptr, acc_t(0), len);
+          } else {
+            std::fill(total, total + inner_size, acc_t(0));
+            reduce_sum_rows(src_ptr, total, len, inner_size, inner_size);
+          }
+        }
+      });
+
+      // carry in of each chunk
+      for (int64_t c = 0; c < num_chunks; c++) {
+        acc_t* total = chunk_carry.data() + c * inner_size;
+        for (int64_t i = 0; i < inner_size; i++) {
+          acc_t val = total[i];
+          total[i] = carry[i];
+          carry[i] += val;
         }
-        inner_offsets[m * T + t] = offset;
       }
+
+      // Parallel Path II: scan each chunk from its carry (input in L2)
+      at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t c = begin; c < end; c++) {
+          int64_t len = std::min(chunk_rows, rows - c * chunk_rows);
+          int64_t offset = c * chunk_rows * inner_size;
+          acc_t* acc = chunk_carry.data() + c * inner_size;
+          if (inner_size == 1) {
+            scan_line(
+                src_tile + offset, dst_tile + offset, acc[0], len, exclusive);
+          } else {
+            prefix_sum_rows(
+                src_tile + offset,
+                dst_tile + offset,
+                acc,
+                len,
+                inner_size,
+                inner_size,
+                exclusive);
+          }
+        }
+      });
     }
+  }
+}
 
-    // Parallel Path II: apply offset (result should be in L2)
-    at::parallel_for(k_begin, k_end, 1, [&](int64_t begin, int64_t end) {
-      int64_t tid = at::get_thread_num();
-      for (int64_t m = 0; m < M; m++) {
-        scalar_t* result_ptr = result_data + m * N + begin;
-        int64_t len = end - begin;
-
-        scalar_t offset = outer_offsets[m] + inner_offsets[m * T + tid];
-        at::vec::map(
-            [=](Vectorized<scalar_t> x) {
-              return x + Vectorized<scalar_t>(offset);
-            },
-            result_ptr,
-            result_ptr,
-            len);
+// Scans a contiguous [dim_size, inner_size] tensor along dim_size, from zero
+// again at each of the segment boundaries in `offsets`. The rows are split in
+// chunks of the same size whatever the lengths of the segments: the chunks
+// are reduced to the carry of their last segment, then scanned from the
+// carry of the chunks before them, up to their first boundary.
+template <typename in_t, typename out_t>
+void segment_cumsum_kernel(
+    const in_t* src,
+    out_t* dst,
+    const int64_t* offsets,
+    int64_t num_segments,
+    int64_t dim_size,
+    int64_t inner_size,
+    bool exclusive) {
+  using acc_t = at::opmath_type<out_t>;
+  const int64_t* offsets_end = offsets + num_segments + 1;
+
+  // Runs the rows [begin, end) through `fn(row, len, acc)` segment piece by
+  // segment piece, and resets acc at the end of each segment. Returns whether
+  // a segment ends in the rows.
+  auto for_each_piece = [&](int64_t begin, int64_t end, acc_t* acc, auto fn) {
+    bool resets = false;
+    // the offsets end with dim_size, which is past any row
+    const int64_t* next = std::upper_bound(offsets, offsets_end, begin);
+    for (int64_t row = begin; row < end;) {
+      while (*next <= row) {
+        next++;
       }
-    });
+      int64_t piece_end = std::min(*next, end);
+      fn(row, piece_end - row, acc);
+      if (piece_end == *next) {
+        std::fill(acc, acc + inner_size, acc_t(0));
+        resets = true;
+      }
+      row = piece_end;
+    }
+    return resets;
+  };
+  auto scan_piece = [&](int64_t row, int64_t len, acc_t* acc) {
+    int64_t offset = row * inner_size;
+    if (inner_size == 1) {
+      acc[0] = scan_line(src + offset, dst + offset, acc[0], len, exclusive);
+    } else {
+      prefix_sum_rows(
+          src + offset,
+          dst + offset,
+          acc,
+          len,
+          inner_size,
+          inner_size,
+          exclusive);
+    }
+  };
+  auto sum_piece = [&](int64_t row, int64_t len, acc_t* acc) {
+    int64_t offset = row * inner_size;
+    if (inner_size == 1) {
+      acc[0] = reduce_sum(src + offset, acc[0], len);
+    } else {
+      reduce_sum_rows(src + offset, acc, len, inner_size, inner_size);
+    }
+  };
 
-    // reinit inner offset value
-    std::fill(inner_offsets.begin(), inner_offsets.end(), scalar_t(0));
+  const int64_t num_chunks = std::min<int64_t>(
+      at::get_num_threads(), divup(dim_size * inner_size, kMinChunkSize));
+  if (num_chunks <= 1) {
+    std::vector<acc_t> acc(inner_size, acc_t(0));
+    for_each_piece(0, dim_size, acc.data(), scan_piece);
+    return;
+  }
+  const int64_t chunk_rows = divup(dim_size, num_chunks);
+
+  // Parallel Path I: carry out of each chunk from zero
+  std::vector<acc_t> chunk_carry(num_chunks * inner_size, acc_t(0));
+  std::vector<char> chunk_resets(num_chunks, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t row = std::min(c * chunk_rows, dim_size);
+      chunk_resets[c] = for_each_piece(
+          row,
+          std::min(row + chunk_rows, dim_size),
+          chunk_carry.data() + c * inner_size,
+          sum_piece);
+    }
+  });
+
+  // carry in of each chunk: the carry out of the previous chunks is added
+  // until a segment ends
+  std::vector<acc_t> carry(inner_size, acc_t(0));
+  for (int64_t c = 0; c < num_chunks; c++) {
+    acc_t* chunk = chunk_carry.data() + c * inner_size;
+    for (int64_t i = 0; i < inner_size; i++) {
+      acc_t val = chunk[i];
+      chunk[i] = carry[i];
+      carry[i] = chunk_resets[c] ? val : carry[i] + val;
+    }
+  }
 
-    // update outer offset value
-    for (int64_t m = 0; m < M; m++) {
-      outer_offsets[m] = result_data[m * N + k_end - 1];
+  // Parallel Path II: scan each chunk from its carry in
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      int64_t row = std::min(c * chunk_rows, dim_size);
+      for_each_piece(
+          row,
+          std::min(row + chunk_rows, dim_size),
+          chunk_carry.data() + c * inner_size,
+          scan_piece);
     }
+  });
+}
+
+// Calls fn(in_t(), out_t()) for the input and output types of the scan
+// kernels. Returns false for the other ones.
+template <typename F>
+bool dispatch_scan_types(at::ScalarType in, at::ScalarType out, const F& fn) {
+  if (in == at::kInt && out == at::kLong) {
+    fn(int32_t(), int64_t());
+    return true;
   }
+  if (in != out) {
+    return false;
+  }
+  switch (in) {
+    case at::kInt:
+      fn(int32_t(), int32_t());
+      return true;
+    case at::kLong:
+      fn(int64_t(), int64_t());
+      return true;
+    case at::kFloat:
+      fn(float(), float());
+      return true;
+    case at::kDouble:
+      fn(double(), double());
+      return true;
+    case at::kBFloat16:
+      fn(at::BFloat16(), at::BFloat16());
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool is_scan_type(at::ScalarType type) {
+  return dispatch_scan_types(type, type, [](auto, auto) {});
+}
+
+// Returns the input of the scan kernels into `result`, cast to the type of
+// `result` if the kernels do not take the type of `self`, or an undefined
+// tensor if the scan has to go to the aten kernel.
+at::Tensor scan_input(const at::Tensor& self, const at::Tensor& result) {
+  if (!result.is_contiguous() || !is_scan_type(result.scalar_type())) {
+    return at::Tensor();
+  }
+  auto in_type = self.scalar_type();
+  auto out_type = result.scalar_type();
+  bool is_pair = in_type == out_type ||
+      (in_type == at::kInt && out_type == at::kLong);
+  auto input = is_pair ? self : self.to(out_type);
+  return input.contiguous();
 }
 
-bool cumsum_fast_path(
+at::Tensor cumsum_forward(
+    at::Tensor& result,
     const at::Tensor& self,
-    const at::Tensor& result,
     int64_t dim,
-    c10::optional<at::ScalarType> dtype) {
-  // check contiguous
-  bool is_contig = self.is_contiguous() && (result.is_contiguous());
-  if (!is_contig)
-    return false;
-  // check dim
-  auto wrap_dim = at::maybe_wrap_dim(dim, self.dim());
-  if (wrap_dim != self.dim() - 1)
-    return false;
-  // check dtype matched
-  auto out_dtype = result.scalar_type();
-  if (dtype.has_value() && out_dtype != dtype.value())
-    return false;
-  // check dtype enabled
-  bool is_dtype_enabled = out_dtype == at::ScalarType::Double ||
-      out_dtype == at::ScalarType::Float || out_dtype == at::ScalarType::Long;
-  if (!is_dtype_enabled)
-    return false;
-  return true;
+    bool exclusive) {
+  if (result.sizes() != self.sizes()) {
+    at::native::resize_output(result, self.sizes());
+  }
+  if (self.numel() == 0) {
+    return result;
+  }
+  const int64_t wrap_dim = at::maybe_wrap_dim(dim, self.dim());
+  auto input = scan_input(self, result);
+  if (!input.defined()) {
+    auto inclusive = at::cumsum(self.to(result.scalar_type()), wrap_dim);
+    if (!exclusive) {
+      return result.copy_(inclusive);
+    }
+    // the exclusive scan is the inclusive one shifted by one
+    if (self.dim() == 0) {
+      return result.zero_();
+    }
+    const int64_t dim_size = self.size(wrap_dim);
+    result.narrow(wrap_dim, 1, dim_size - 1)
+        .copy_(inclusive.narrow(wrap_dim, 0, dim_size - 1));
+    result.narrow(wrap_dim, 0, 1).zero_();
+    return result;
+  }
+
+  int64_t dim_size = 1;
+  int64_t outer_size = 1;
+  int64_t inner_size = 1;
+  for (int64_t d = 0; d < self.dim(); d++) {
+    if (d < wrap_dim) {
+      outer_size *= self.size(d);
+    } else if (d == wrap_dim) {
+      dim_size = self.size(d);
+    } else {
+      inner_size *= self.size(d);
+    }
+  }
+  dispatch_scan_types(
+      input.scalar_type(), result.scalar_type(), [&](auto in, auto out) {
+        using in_t = decltype(in);
+        using out_t = decltype(out);
+        cumsum_kernel<in_t, out_t>(
+            input.data_ptr<in_t>(),
+            result.data_ptr<out_t>(),
+            outer_size,
+            dim_size,
+            inner_size,
+            exclusive);
+      });
+  return result;
 }
 
 class NewCumSumOp : public torch::autograd::Function<NewCumSumOp> {
@@ -154,20 +390,10 @@ class NewCumSumOp : public torch::autograd::Function<NewCumSumOp> {
       at::Tensor& result,
       const at::Tensor& self,
       int64_t dim,
-      c10::optional<at::ScalarType> dtype) {
+      bool exclusive) {
     RECORD_FUNCTION("IPEXCumSumOp::_forward", c10::ArrayRef<c10::IValue>({}));
 
-    if (result.sizes() != self.sizes()) {
-      at::native::resize_output(result, self.sizes());
-    }
-    if (cumsum_fast_path(result, self, dim, dtype)) {
-      AT_DISPATCH_FLOATING_TYPES_AND(
-          at::ScalarType::Long, self.scalar_type(), "cumsum_lastdim_cpu", [&] {
-            cumsum_lastdim_kernel<scalar_t>(result, self, dim);
-          });
-      return result;
-    }
-    return at::cumsum_out(result, self, dim, dtype);
+    return cumsum_forward(result, self, dim, exclusive);
   }
 
   static at::Tensor forward(
@@ -175,12 +401,13 @@ class NewCumSumOp : public torch::autograd::Function<NewCumSumOp> {
       at::Tensor& result,
       const at::Tensor& self,
       int64_t dim,
-      c10::optional<at::ScalarType> dtype) {
+      bool exclusive) {
     RECORD_FUNCTION("IPEXCumSumOp::forward", c10::ArrayRef<c10::IValue>({}));
 
     at::AutoDispatchBelowADInplaceOrView g;
     ctx->saved_data["dim"] = dim;
-    auto ret = _forward(result, self, dim, dtype);
+    ctx->saved_data["exclusive"] = exclusive;
+    auto ret = _forward(result, self, dim, exclusive);
     return ret;
   }
 
@@ -191,13 +418,21 @@ class NewCumSumOp : public torch::autograd::Function<NewCumSumOp> {
 
     at::AutoDispatchBelowADInplaceOrView g;
     int64_t dim = ctx->saved_data["dim"].toInt();
+    bool exclusive = ctx->saved_data["exclusive"].toBool();
 
     at::Tensor grad_out = grad_outputs[0];
     at::Tensor grad_self;
-    if (grad_out.numel() <= 1 || grad_out.size(dim) == 1) {
-      grad_self = grad_out;
+    if (grad_out.numel() <= 1 ||
+        (grad_out.dim() > 0 && grad_out.size(dim) == 1)) {
+      grad_self = exclusive ? at::zeros_like(grad_out) : grad_out;
+    } else {
+      // the grad of x[i] is the sum of the grads of the outputs from i, or
+      // after i in exclusive mode
+      grad_self = grad_out.flip(dim).cumsum(dim).flip(dim);
+      if (exclusive) {
+        grad_self = grad_self - grad_out;
+      }
     }
-    grad_self = grad_out.flip(dim).cumsum(dim).flip(dim);
     return {at::Tensor(), grad_self, at::Tensor(), at::Tensor()};
   }
 };
@@ -206,15 +441,100 @@ at::Tensor cumsum_kernel_impl(
     at::Tensor& result,
     const at::Tensor& self,
     int64_t dim,
-    c10::optional<at::ScalarType> dtype) {
+    bool exclusive) {
+  if (at::GradMode::is_enabled() && self.requires_grad())
+    return NewCumSumOp::apply(result, self, dim, exclusive);
+  return NewCumSumOp::_forward(result, self, dim, exclusive);
+}
+
+at::Tensor segment_cumsum_forward(
+    at::Tensor& result,
+    const at::Tensor& self,
+    const at::Tensor& offsets,
+    bool exclusive) {
+  if (result.sizes() != self.sizes()) {
+    at::native::resize_output(result, self.sizes());
+  }
+  if (self.numel() == 0) {
+    return result;
+  }
+  auto input = scan_input(self, result);
+  if (!input.defined()) {
+    auto scanned = at::empty(self.sizes(), self.options().dtype(at::kDouble));
+    segment_cumsum_forward(scanned, self.to(at::kDouble), offsets, exclusive);
+    return result.copy_(scanned);
+  }
+  dispatch_scan_types(
+      input.scalar_type(), result.scalar_type(), [&](auto in, auto out) {
+        using in_t = decltype(in);
+        using out_t = decltype(out);
+        segment_cumsum_kernel<in_t, out_t>(
+            input.data_ptr<in_t>(),
+            result.data_ptr<out_t>(),
+            offsets.data_ptr<int64_t>(),
+            offsets.numel() - 1,
+            self.size(0),
+            self.numel() / self.size(0),
+            exclusive);
+      });
+  return result;
+}
+
+class SegmentCumSumOp : public torch::autograd::Function<SegmentCumSumOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      at::Tensor& result,
+      const at::Tensor& self,
+      const at::Tensor& offsets,
+      bool exclusive) {
+    RECORD_FUNCTION(
+        "IPEXSegmentCumSumOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    ctx->save_for_backward({offsets});
+    ctx->saved_data["exclusive"] = exclusive;
+    return segment_cumsum_forward(result, self, offsets, exclusive);
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXSegmentCumSumOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    auto offsets = ctx->get_saved_variables()[0];
+    bool exclusive = ctx->saved_data["exclusive"].toBool();
+
+    // the reversed scan of the grads, on the reversed segments
+    at::Tensor grad_out = grad_outputs[0];
+    auto flipped_offsets = grad_out.size(0) - offsets.flip(0);
+    auto flipped_grad = grad_out.flip(0).contiguous();
+    auto grad_self = at::empty_like(flipped_grad);
+    segment_cumsum_forward(grad_self, flipped_grad, flipped_offsets, false);
+    grad_self = grad_self.flip(0);
+    if (exclusive) {
+      grad_self = grad_self - grad_out;
+    }
+    return {at::Tensor(), grad_self, at::Tensor(), at::Tensor()};
+  }
+};
+
+at::Tensor segment_cumsum_kernel_impl(
+    at::Tensor& result,
+    const at::Tensor& self,
+    const at::Tensor& offsets,
+    bool exclusive) {
   if (at::GradMode::is_enabled() && self.requires_grad())
-    return NewCumSumOp::apply(result, self, dim, dtype);
-  return NewCumSumOp::_forward(result, self, dim, dtype);
+    return SegmentCumSumOp::apply(result, self, offsets, exclusive);
+  return segment_cumsum_forward(result, self, offsets, exclusive);
 }
 
 } // anonymous namespace
 
 REGISTER_DISPATCH(cumsum_kernel_stub, &cumsum_kernel_impl);
+REGISTER_DISPATCH(segment_cumsum_kernel_stub, &segment_cumsum_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,201 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/accumulate.h>
+#include <c10/util/irange.h>
+
+#include <cmath>
+
+#include <aten/GroupedLinear.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+
+template <GroupedLinearPostOp post_op>
+inline Vec apply_post_op(Vec x) {
+  switch (post_op) {
+    case GroupedLinearPostOp::Relu:
+      return at::vec::maximum(x, Vec(0.f));
+    case GroupedLinearPostOp::Gelu:
+      return x * Vec(0.5f) *
+          (Vec(1.f) + (x * Vec(static_cast<float>(M_SQRT1_2))).erf());
+    case GroupedLinearPostOp::Silu:
+      return x / (Vec(1.f) + x.neg().exp());
+    case GroupedLinearPostOp::Sigmoid:
+      return Vec(1.f) / (Vec(1.f) + x.neg().exp());
+    default:
+      return x;
+  }
+}
+
+template <GroupedLinearPostOp post_op>
+inline float apply_post_op(float x) {
+  switch (post_op) {
+    case GroupedLinearPostOp::Relu:
+      return std::max(x, 0.f);
+    case GroupedLinearPostOp::Gelu:
+      return x * 0.5f * (1.f + std::erf(x * static_cast<float>(M_SQRT1_2)));
+    case GroupedLinearPostOp::Silu:
+      return x / (1.f + std::exp(-x));
+    case GroupedLinearPostOp::Sigmoid:
+      return 1.f / (1.f + std::exp(-x));
+    default:
+      return x;
+  }
+}
+
+// Row blocks of one group handled by one task. Small enough for the output
+// block to stay in cache between the GEMM and its epilogue.
+constexpr int64_t kGroupedLinearRowBlock = 64;
+
+// Bias add and eltwise of one output row, done in fp32.
+template <typename T, GroupedLinearPostOp post_op>
+inline void epilogue_row(T* out, const T* bias, float* buf, int64_t N) {
+  float* y = buf;
+  float* b = buf + N;
+  at::vec::convert(out, y, N);
+  if (bias) {
+    at::vec::convert(bias, b, N);
+  }
+  int64_t n = 0;
+  for (; n + Vec::size() <= N; n += Vec::size()) {
+    auto v = Vec::loadu(y + n);
+    if (bias) {
+      v = v + Vec::loadu(b + n);
+    }
+    apply_post_op<post_op>(v).store(y + n);
+  }
+  for (; n < N; n++) {
+    y[n] = apply_post_op<post_op>(bias ? y[n] + b[n] : y[n]);
+  }
+  at::vec::convert(y, out, N);
+}
+
+// Every task runs the GEMM of one row block of one group and then applies
+// the epilogue to the block it just wrote, so the output is not read back
+// from memory in a separate pass. The inputs are read in place, so they may
+// also differ in their leading sizes.
+template <typename T, GroupedLinearPostOp post_op>
+void grouped_linear_blocks(
+    const std::vector<at::Tensor>& inputs,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    std::vector<at::Tensor>& outputs) {
+  const int64_t G = inputs.size();
+  const int64_t N = weight.size(2);
+  int64_t total_rows = 0;
+  for (const auto& input : inputs) {
+    total_rows += input.size(0);
+  }
+  const int64_t block = std::max<int64_t>(
+      1,
+      std::min(
+          kGroupedLinearRowBlock,
+          at::divup(total_rows, at::get_num_threads())));
+  // (group, first row) of every block
+  std::vector<std::pair<int64_t, int64_t>> blocks;
+  for (const auto g : c10::irange(G)) {
+    for (int64_t m = 0; m < inputs[g].size(0); m += block) {
+      blocks.emplace_back(g, m);
+    }
+  }
+  const bool has_epilogue =
+      bias.defined() || post_op != GroupedLinearPostOp::None;
+  const T* bias_data = bias.defined() ? bias.data_ptr<T>() : nullptr;
+  at::parallel_for(0, blocks.size(), 1, [&](int64_t begin, int64_t end) {
+    std::vector<float> buf(has_epilogue ? 2 * N : 0);
+    for (const auto i : c10::irange(begin, end)) {
+      const int64_t g = blocks[i].first;
+      const int64_t m = blocks[i].second;
+      const int64_t rows = std::min(block, inputs[g].size(0) - m);
+      auto out = outputs[g].narrow(0, m, rows);
+      at::mm_out(out, inputs[g].narrow(0, m, rows), weight[g]);
+      if (!has_epilogue) {
+        continue;
+      }
+      T* out_data = out.data_ptr<T>();
+      const T* b = bias_data ? bias_data + g * N : nullptr;
+      for (const auto r : c10::irange(rows)) {
+        epilogue_row<T, post_op>(out_data + r * N, b, buf.data(), N);
+      }
+    }
+  });
+}
+
+template <typename T>
+void grouped_linear_blocks(
+    const std::vector<at::Tensor>& inputs,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    std::vector<at::Tensor>& outputs,
+    GroupedLinearPostOp post_op) {
+  switch (post_op) {
+    case GroupedLinearPostOp::None:
+      return grouped_linear_blocks<T, GroupedLinearPostOp::None>(
+          inputs, weight, bias, outputs);
+    case GroupedLinearPostOp::Relu:
+      return grouped_linear_blocks<T, GroupedLinearPostOp::Relu>(
+          inputs, weight, bias, outputs);
+    case GroupedLinearPostOp::Gelu:
+      return grouped_linear_blocks<T, GroupedLinearPostOp::Gelu>(
+          inputs, weight, bias, outputs);
+    case GroupedLinearPostOp::Silu:
+      return grouped_linear_blocks<T, GroupedLinearPostOp::Silu>(
+          inputs, weight, bias, outputs);
+    case GroupedLinearPostOp::Sigmoid:
+      return grouped_linear_blocks<T, GroupedLinearPostOp::Sigmoid>(
+          inputs, weight, bias, outputs);
+  }
+}
+
+std::vector<at::Tensor> grouped_linear_kernel_impl(
+    const std::vector<at::Tensor>& inputs,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    GroupedLinearPostOp post_op) {
+  const int64_t K = weight.size(1);
+  const int64_t N = weight.size(2);
+  auto weight_ = weight.contiguous();
+  auto bias_ = bias.defined() ? bias.to(weight.scalar_type()).contiguous()
+                              : at::Tensor();
+
+  // The GEMMs of all groups are spread over the threads together, instead
+  // of the rows of one small linear at a time.
+  std::vector<at::Tensor> inputs_2d;
+  std::vector<at::Tensor> outputs;
+  std::vector<at::Tensor> outputs_2d;
+  for (const auto& input : inputs) {
+    auto out_sizes = input.sizes().vec();
+    out_sizes.back() = N;
+    auto out = at::empty(out_sizes, input.options());
+    const int64_t M = c10::multiply_integers(
+        input.sizes().begin(), input.sizes().end() - 1);
+    inputs_2d.push_back(input.contiguous().view({M, K}));
+    outputs_2d.push_back(out.view({M, N}));
+    outputs.push_back(std::move(out));
+  }
+  // The epilogue runs in fp32, so double is rejected by grouped_linear.
+  if (weight.scalar_type() == at::kBFloat16) {
+    grouped_linear_blocks<at::BFloat16>(
+        inputs_2d, weight_, bias_, outputs_2d, post_op);
+  } else if (weight.scalar_type() == at::kHalf) {
+    grouped_linear_blocks<at::Half>(
+        inputs_2d, weight_, bias_, outputs_2d, post_op);
+  } else {
+    grouped_linear_blocks<float>(
+        inputs_2d, weight_, bias_, outputs_2d, post_op);
+  }
+  return outputs;
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(grouped_linear_kernel_stub, &grouped_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,329 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <aten/HistogramObserver.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+
+std::pair<float, float> parallel_minmax(const float* data, int64_t numel) {
+  constexpr float kInf = std::numeric_limits<float>::infinity();
+  int64_t num_threads = at::get_num_threads();
+  std::vector<float> mins(num_threads, kInf);
+  std::vector<float> maxs(num_threads, -kInf);
+  at::parallel_for(
+      0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        int64_t tid = at::get_thread_num();
+        Vec vmin(kInf);
+        Vec vmax(-kInf);
+        int64_t d = begin;
+        for (; d + Vec::size() <= end; d += Vec::size()) {
+          auto v = Vec::loadu(data + d);
+          vmin = at::vec::minimum(vmin, v);
+          vmax = at::vec::maximum(vmax, v);
+        }
+        float lo = at::vec::vec_reduce_all<float>(
+            [](Vec& a, Vec& b) { return at::vec::minimum(a, b); }, vmin);
+        float hi = at::vec::vec_reduce_all<float>(
+            [](Vec& a, Vec& b) { return at::vec::maximum(a, b); }, vmax);
+        for (; d < end; d++) {
+          lo = std::min(lo, data[d]);
+          hi = std::max(hi, data[d]);
+        }
+        mins[tid] = std::min(mins[tid], lo);
+        maxs[tid] = std::max(maxs[tid], hi);
+      });
+  return std::make_pair(
+      *std::min_element(mins.begin(), mins.end()),
+      *std::max_element(maxs.begin(), maxs.end()));
+}
+
+// Same binning as torch.histc: values outside [lo, hi] are dropped and the
+// value equal to hi goes to the last bin.
+inline void add_to_bin(
+    float* hist,
+    float x,
+    float pos,
+    float lo,
+    float hi,
+    int64_t bins) {
+  if (!(x >= lo && x <= hi)) {
+    return;
+  }
+  hist[std::min(static_cast<int64_t>(pos), bins - 1)] += 1.f;
+}
+
+// Every thread bins its chunk into a private histogram; the bin positions of
+// a full vector are computed at once and the private histograms are summed
+// in parallel over the bins at the end.
+void parallel_histc(
+    const float* data,
+    int64_t numel,
+    float lo,
+    float hi,
+    float* out,
+    int64_t bins) {
+  if (lo == hi) {
+    lo -= 1;
+    hi += 1;
+  }
+  const float scale = static_cast<float>(bins) / (hi - lo);
+  int64_t num_threads = at::get_num_threads();
+  std::vector<float> partial(num_threads * bins, 0.f);
+  at::parallel_for(
+      0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        float* local = partial.data() + at::get_thread_num() * bins;
+        const Vec lo_vec(lo);
+        const Vec scale_vec(scale);
+        __at_align__ float pos[Vec::size()];
+        int64_t d = begin;
+        for (; d + Vec::size() <= end; d += Vec::size()) {
+          ((Vec::loadu(data + d) - lo_vec) * scale_vec).store(pos);
+          for (const auto k : c10::irange(Vec::size())) {
+            add_to_bin(local, data[d + k], pos[k], lo, hi, bins);
+          }
+        }
+        for (; d < end; d++) {
+          add_to_bin(local, data[d], (data[d] - lo) * scale, lo, hi, bins);
+        }
+      });
+  at::parallel_for(0, bins, 1, [&](int64_t begin, int64_t end) {
+    for (const auto b : c10::irange(begin, end)) {
+      float sum = 0.f;
+      for (const auto t : c10::irange(num_threads)) {
+        sum += partial[t * bins + b];
+      }
+      out[b] = sum;
+    }
+  });
+}
+
+// HistogramObserver._combine_histograms without materializing the upsampled
+// histogram: the old bin i covers [start_idx + i * upsample_rate,
+// start_idx + (i + 1) * upsample_rate) on the fine grid and every new bin
+// spans downsample_rate fine bins, so only the overlaps are accumulated.
+void combine_histograms(
+    float* combined,
+    const float* orig,
+    int64_t bins,
+    int64_t upsample_rate,
+    int64_t downsample_rate,
+    int64_t start_idx) {
+  const int64_t total = bins * downsample_rate;
+  std::vector<double> acc(bins, 0.);
+  for (const auto i : c10::irange(bins)) {
+    if (orig[i] == 0.f) {
+      continue;
+    }
+    int64_t p = std::max<int64_t>(start_idx + i * upsample_rate, 0);
+    int64_t p_end = std::min(start_idx + (i + 1) * upsample_rate, total);
+    while (p < p_end) {
+      int64_t b = p / downsample_rate;
+      int64_t next = std::min(p_end, (b + 1) * downsample_rate);
+      acc[b] += static_cast<double>(orig[i]) * (next - p);
+      p = next;
+    }
+  }
+  for (const auto b : c10::irange(bins)) {
+    combined[b] += static_cast<float>(acc[b] / upsample_rate);
+  }
+}
+
+void histogram_observer_update_kernel_impl(
+    const at::Tensor& x,
+    at::Tensor& histogram,
+    at::Tensor& min_val,
+    at::Tensor& max_val,
+    int64_t upsample_rate) {
+  auto x_ = x.to(at::kFloat).contiguous();
+  const float* x_data = x_.data_ptr<float>();
+  int64_t numel = x_.numel();
+  int64_t bins = histogram.numel();
+  float* hist_data = histogram.data_ptr<float>();
+
+  auto new_minmax = parallel_minmax(x_data, numel);
+  float cur_min = min_val.item<float>();
+  float cur_max = max_val.item<float>();
+  bool is_uninitialized = cur_min == std::numeric_limits<float>::infinity() &&
+      cur_max == -std::numeric_limits<float>::infinity();
+  if (is_uninitialized || cur_min == cur_max) {
+    parallel_histc(
+        x_data, numel, new_minmax.first, new_minmax.second, hist_data, bins);
+    min_val.fill_(new_minmax.first);
+    max_val.fill_(new_minmax.second);
+    return;
+  }
+
+  // HistogramObserver._adjust_min_max: extend the combined range so that the
+  // old bins align with a common grid of downsample_rate / upsample_rate.
+  float combined_min = std::min(new_minmax.first, cur_min);
+  float combined_max = std::max(new_minmax.second, cur_max);
+  const float range = cur_max - cur_min;
+  const float upsample = static_cast<float>(upsample_rate);
+  int64_t downsample_rate = static_cast<int64_t>(
+      std::ceil((combined_max - combined_min) * upsample / range));
+  float e = static_cast<float>(downsample_rate) * range / upsample -
+      (combined_max - combined_min);
+  int64_t start_idx = static_cast<int64_t>(std::nearbyint(
+      (cur_min - combined_min) * static_cast<float>(bins) * upsample / range));
+  combined_max = combined_max + e;
+
+  std::vector<float> combined(bins);
+  parallel_histc(
+      x_data, numel, combined_min, combined_max, combined.data(), bins);
+  if (combined_min == cur_min && combined_max == cur_max) {
+    for (const auto b : c10::irange(bins)) {
+      combined[b] += hist_data[b];
+    }
+  } else {
+    combine_histograms(
+        combined.data(),
+        hist_data,
+        bins,
+        upsample_rate,
+        downsample_rate,
+        start_idx);
+  }
+  std::copy(combined.begin(), combined.end(), hist_data);
+  min_val.fill_(combined_min);
+  max_val.fill_(combined_max);
+}
+
+inline double get_norm(double delta_begin, double delta_end) {
+  return (delta_end * delta_end * delta_end -
+          delta_begin * delta_begin * delta_begin) /
+      3;
+}
+
+// HistogramObserver._compute_quantization_error: L2 error of quantizing the
+// histogram into dst_nbins uniform bins over [start_bin, end_bin].
+double compute_quantization_error(
+    const float* hist,
+    int64_t bins,
+    double bin_width,
+    int64_t start_bin,
+    int64_t end_bin,
+    int64_t dst_nbins) {
+  const double dst_bin_width =
+      bin_width * (end_bin - start_bin + 1) / dst_nbins;
+  if (dst_bin_width == 0.0) {
+    return 0.0;
+  }
+  const double half = dst_bin_width / 2;
+  const double full_norm = get_norm(-half, half);
+  double norm = 0.;
+  for (const auto i : c10::irange(bins)) {
+    if (hist[i] == 0.f) {
+      continue;
+    }
+    double src_begin = (i - start_bin) * bin_width;
+    double src_end = src_begin + bin_width;
+    double dst_of_begin = std::min(
+        std::max(std::floor(src_begin / dst_bin_width), 0.),
+        static_cast<double>(dst_nbins - 1));
+    double dst_of_end = std::min(
+        std::max(std::floor(src_end / dst_bin_width), 0.),
+        static_cast<double>(dst_nbins - 1));
+    double dst_of_begin_center = (dst_of_begin + 0.5) * dst_bin_width;
+    double dst_of_end_center = dst_of_end * dst_bin_width + half;
+    double n = get_norm(src_begin - dst_of_begin_center, half) +
+        (dst_of_end - dst_of_begin - 1) * full_norm +
+        get_norm(-half, src_end - dst_of_end_center);
+    norm += hist[i] / bin_width * n;
+  }
+  return norm;
+}
+
+std::tuple<at::Tensor, at::Tensor> histogram_observer_param_search_kernel_impl(
+    const at::Tensor& histogram,
+    const at::Tensor& min_val,
+    const at::Tensor& max_val,
+    int64_t dst_nbins) {
+  auto hist = histogram.to(at::kFloat).contiguous();
+  const float* hist_data = hist.data_ptr<float>();
+  int64_t bins = hist.numel();
+  float min_v = min_val.item<float>();
+  float max_v = max_val.item<float>();
+  const double bin_width =
+      (static_cast<double>(max_v) - static_cast<double>(min_v)) / bins;
+
+  std::vector<double> csum(bins);
+  double total = 0.;
+  for (const auto i : c10::irange(bins)) {
+    total += hist_data[i];
+    csum[i] = total;
+  }
+
+  // Greedily move whichever end drops more bins for the next 1e-5 quantile
+  // step, and stop as soon as the quantization error goes up.
+  const double stepsize = 1e-5;
+  double alpha = 0.;
+  double beta = 1.;
+  int64_t start_bin = 0;
+  int64_t end_bin = bins - 1;
+  double norm_min = std::numeric_limits<double>::infinity();
+  while (alpha < beta) {
+    double next_alpha = alpha + stepsize;
+    double next_beta = beta - stepsize;
+
+    int64_t l = start_bin;
+    int64_t r = end_bin;
+    while (l < end_bin && csum[l] < next_alpha * total) {
+      l++;
+    }
+    while (r > start_bin && csum[r] > next_beta * total) {
+      r--;
+    }
+
+    int64_t next_start_bin = start_bin;
+    int64_t next_end_bin = end_bin;
+    if ((l - start_bin) > (end_bin - r)) {
+      next_start_bin = l;
+      alpha = next_alpha;
+    } else {
+      next_end_bin = r;
+      beta = next_beta;
+    }
+    if (next_start_bin == start_bin && next_end_bin == end_bin) {
+      continue;
+    }
+
+    double norm = compute_quantization_error(
+        hist_data, bins, bin_width, next_start_bin, next_end_bin, dst_nbins);
+    if (norm > norm_min) {
+      break;
+    }
+    norm_min = norm;
+    start_bin = next_start_bin;
+    end_bin = next_end_bin;
+  }
+
+  const float bin_width_f = (max_v - min_v) / static_cast<float>(bins);
+  auto opts = min_val.options().dtype(at::kFloat);
+  return std::make_tuple(
+      at::scalar_tensor(min_v + bin_width_f * start_bin, opts),
+      at::scalar_tensor(min_v + bin_width_f * (end_bin + 1), opts));
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    histogram_observer_update_kernel_stub,
+    &histogram_observer_update_kernel_impl);
+REGISTER_DISPATCH(
+    histogram_observer_param_search_kernel_stub,
+    &histogram_observer_param_search_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
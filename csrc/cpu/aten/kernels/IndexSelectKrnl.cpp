@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 
 #include <ATen/Dispatch.h>
+#include <ATen/OpMathType.h>
 #include <ATen/Parallel.h>
 #include <ATen/TensorIterator.h>
 #include <ATen/cpu/vec/vec.h>
@@ -12,6 +13,17 @@
 #include <c10/util/TypeCast.h>
 #include <c10/util/irange.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+#include <immintrin.h>
+
 #include <utils/library.h>
 
 #include <aten/TensorAdvancedIndexing.h>
@@ -55,14 +67,100 @@ static inline void copy_stub(scalar_t* result, scalar_t* self, int64_t size) {
   }
 }
 
+// Number of rows prefetched ahead by the gather, from
+// IPEX_INDEX_SELECT_PREFETCH_DISTANCE, 0 turns the prefetch off.
+static inline int64_t gather_prefetch_distance() {
+  static const int64_t distance = [] {
+    const char* val = std::getenv("IPEX_INDEX_SELECT_PREFETCH_DISTANCE");
+    return val == nullptr ? int64_t(8) : std::max<int64_t>(0, std::atoll(val));
+  }();
+  return distance;
+}
+
+static inline int64_t llc_size_bytes() {
+  static const int64_t size = [] {
+#if defined(__linux__) && defined(_SC_LEVEL3_CACHE_SIZE)
+    long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (llc > 0) {
+      return int64_t(llc);
+    }
+#endif
+    return int64_t(32) << 20;
+  }();
+  return size;
+}
+
+constexpr int64_t kCacheLineSize = 64;
+constexpr int64_t kPageSize = 4096;
+// indices gathered at a time by a thread, see index_select_firstdim_impl
+constexpr int64_t kGatherBlockSize = 1024;
+
+static inline void prefetch_row(const void* row, int64_t bytes) {
+  // the first lines are enough to get the DRAM page and the TLB entry
+  // loaded, the hardware prefetcher follows the rest of a long row
+  bytes = std::min(bytes, 16 * kCacheLineSize);
+  for (int64_t b = 0; b < bytes; b += kCacheLineSize) {
+    _mm_prefetch(static_cast<const char*>(row) + b, _MM_HINT_T0);
+  }
+}
+
+// Copies a row with non-temporal stores, which bypass the caches, for the
+// outputs larger than the LLC: they would evict the source rows and be
+// evicted before being read anyway. Needs an _mm_sfence() once done.
+static inline void copy_stub_nt(void* result, const void* self, int64_t bytes) {
+  auto dst = static_cast<char*>(result);
+  auto src = static_cast<const char*>(self);
+#if defined(CPU_CAPABILITY_AVX512)
+  constexpr int64_t kAlign = 64;
+#else
+  constexpr int64_t kAlign = 16;
+#endif
+  int64_t head = (kAlign - (reinterpret_cast<uintptr_t>(dst) & (kAlign - 1))) &
+      (kAlign - 1);
+  head = std::min(head, bytes);
+  std::memcpy(dst, src, head);
+  int64_t d = head;
+  for (; d + kAlign <= bytes; d += kAlign) {
+#if defined(CPU_CAPABILITY_AVX512)
+    _mm512_stream_si512(
+        reinterpret_cast<__m512i*>(dst + d),
+        _mm512_loadu_si512(reinterpret_cast<const void*>(src + d)));
+#else
+    _mm_stream_si128(
+        reinterpret_cast<__m128i*>(dst + d),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + d)));
+#endif
+  }
+  std::memcpy(dst + d, src + d, bytes - d);
+}
+
+template <typename scalar_t>
+static inline void copy_row(
+    scalar_t* result,
+    scalar_t* self,
+    int64_t size,
+    bool non_temporal) {
+  if (non_temporal) {
+    copy_stub_nt(result, self, size * sizeof(scalar_t));
+  } else {
+    copy_stub(result, self, size);
+  }
+}
+
 template <typename scalar_t, typename index_t>
 static void index_select_firstdim_impl(
     scalar_t* result_data,
     scalar_t* self_data,
     index_t* index_data,
+    int64_t dim_size,
     int64_t index_size,
     int64_t inner_size) {
   constexpr int64_t grain_size = at::internal::GRAIN_SIZE / 2;
+  const int64_t row_bytes = inner_size * int64_t(sizeof(scalar_t));
+  const int64_t llc_size = llc_size_bytes();
+  // partial lines are not worth streaming
+  const bool non_temporal =
+      index_size * row_bytes > llc_size && row_bytes >= kCacheLineSize;
   if (inner_size > grain_size) {
     constexpr int64_t block_size = 2048;
     int64_t num_blocks = at::divup(inner_size, block_size);
@@ -82,26 +180,49 @@ static void index_select_firstdim_impl(
                 self_data + offset * inner_size + inner_idx_begin;
             scalar_t* result_ptr =
                 result_data + j * inner_size + inner_idx_begin;
-            copy_stub(result_ptr, self_ptr, size);
+            copy_row(result_ptr, self_ptr, size, non_temporal);
+          }
+          if (non_temporal) {
+            _mm_sfence();
           }
         });
   } else {
+    const int64_t distance = gather_prefetch_distance();
+    // With a source larger than the LLC, random rows are mostly TLB and
+    // cache misses. The indices of a block are then visited in the order of
+    // their rows, so that the rows on the same pages are copied one after
+    // the other and the duplicated rows are still cached.
+    const bool group_by_page =
+        dim_size * row_bytes > llc_size && row_bytes < kPageSize;
     at::parallel_for(
         0,
         index_size,
         grain_size / inner_size,
         [&](int64_t begin, int64_t end) {
-          for (const auto j : c10::irange(begin, end)) {
-            index_t offset = index_data[j];
-#ifdef __GNUC__
-            if (j + 1 < index_size) {
-              __builtin_prefetch(
-                  self_data + index_data[j + 1] * inner_size, 0, 1);
+          std::vector<int64_t> order;
+          for (int64_t b = begin; b < end; b += kGatherBlockSize) {
+            const int64_t n = std::min(end - b, kGatherBlockSize);
+            order.resize(n);
+            std::iota(order.begin(), order.end(), b);
+            if (group_by_page) {
+              std::sort(order.begin(), order.end(), [&](int64_t x, int64_t y) {
+                return index_data[x] < index_data[y];
+              });
             }
-#endif // __GNUC__
-            scalar_t* self_ptr = self_data + offset * inner_size;
-            scalar_t* result_ptr = result_data + j * inner_size;
-            copy_stub(result_ptr, self_ptr, inner_size);
+            for (const auto k : c10::irange(n)) {
+              if (distance > 0 && k + distance < n) {
+                prefetch_row(
+                    self_data + index_data[order[k + distance]] * inner_size,
+                    row_bytes);
+              }
+              int64_t j = order[k];
+              scalar_t* self_ptr = self_data + index_data[j] * inner_size;
+              scalar_t* result_ptr = result_data + j * inner_size;
+              copy_row(result_ptr, self_ptr, inner_size, non_temporal);
+            }
+          }
+          if (non_temporal) {
+            _mm_sfence();
           }
         });
   }
@@ -117,6 +238,11 @@ static void index_select_non_firstdim_impl(
     int64_t index_size,
     int64_t inner_size) {
   constexpr int64_t grain_size = at::internal::GRAIN_SIZE / 2;
+  const int64_t row_bytes = inner_size * int64_t(sizeof(scalar_t));
+  const int64_t distance = gather_prefetch_distance();
+  const bool non_temporal =
+      outer_size * index_size * row_bytes > llc_size_bytes() &&
+      row_bytes >= kCacheLineSize;
   at::parallel_for(
       0,
       outer_size * index_size,
@@ -129,11 +255,20 @@ static void index_select_non_firstdim_impl(
           index_t offset = index_data[j];
           scalar_t* self_ptr =
               self_data + i * dim_size * inner_size + offset * inner_size;
+          if (distance > 0 && j + distance < index_size) {
+            prefetch_row(
+                self_data + i * dim_size * inner_size +
+                    index_data[j + distance] * inner_size,
+                row_bytes);
+          }
           scalar_t* result_ptr = result_data + ii * inner_size;
-          copy_stub(result_ptr, self_ptr, inner_size);
+          copy_row(result_ptr, self_ptr, inner_size, non_temporal);
           // move on to next index in {outer_size, index_size}
           at::native::data_index_step(i, outer_size, j, index_size);
         }
+        if (non_temporal) {
+          _mm_sfence();
+        }
       });
 }
 
@@ -223,14 +358,16 @@ void cpu_index_select_dispatch(
   // 2. `index_select_firstdim_impl`: used when dim is the first dimension.
   //   The kernel may directly parallel on {index_size} or do blocking on
   //   {inner_size} so as to further extend parallelism. Therefore we may
-  //   efficiently handle both thin tall shapes and flat shapes.
+  //   efficiently handle both thin tall shapes and flat shapes. The rows are
+  //   prefetched ahead and, for sources larger than the LLC, visited by
+  //   page within blocks of indices.
   //
   // 3. `index_select_non_firstdim_impl`: the most generic case.
   //   The kernel parallels on {outer_size, index_size} and do vectorized copy
   //   on {inner_size}
   //
   // Lower the default grain size by half since index_select is indirect memory
-  // access.
+  // access. Outputs larger than the LLC are written with non-temporal stores.
   //
   int64_t max_value = std::numeric_limits<int32_t>::max();
   bool can_use_32bit_indexing = (dim_size * inner_size) < max_value;
@@ -244,7 +381,7 @@ void cpu_index_select_dispatch(
         result_data, self_data, index_data, outer_size, dim_size, index_size);
   } else if (outer_size == 1) {
     index_select_firstdim_impl<scalar_t, index_t>(
-        result_data, self_data, index_data, index_size, inner_size);
+        result_data, self_data, index_data, dim_size, index_size, inner_size);
   } else {
     index_select_non_firstdim_impl<scalar_t, index_t>(
         result_data,
@@ -277,6 +414,185 @@ void index_select_contig_kernel(
       });
 }
 
+template <typename scalar_t>
+static inline void add_row(
+    scalar_t* self,
+    const scalar_t* source,
+    scalar_t alpha,
+    int64_t size) {
+  using Vec = at::vec::Vectorized<scalar_t>;
+  const Vec alpha_vec(alpha);
+  int64_t d = 0;
+  for (; d < size - (size % Vec::size()); d += Vec::size()) {
+    Vec out = Vec::loadu(self + d) + Vec::loadu(source + d) * alpha_vec;
+    out.store(self + d);
+  }
+  for (; d < size; ++d) {
+    self[d] += source[d] * alpha;
+  }
+}
+
+static inline void add_row(
+    at::BFloat16* self,
+    const at::BFloat16* source,
+    float alpha,
+    int64_t size) {
+  using bVec = at::vec::Vectorized<at::BFloat16>;
+  using fVec = at::vec::Vectorized<float>;
+  const fVec alpha_vec(alpha);
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec self_fvec0, self_fvec1, source_fvec0, source_fvec1;
+    std::tie(self_fvec0, self_fvec1) =
+        at::vec::convert_bfloat16_float(bVec::loadu(self + d));
+    std::tie(source_fvec0, source_fvec1) =
+        at::vec::convert_bfloat16_float(bVec::loadu(source + d));
+    bVec out = at::vec::convert_float_bfloat16(
+        self_fvec0 + source_fvec0 * alpha_vec,
+        self_fvec1 + source_fvec1 * alpha_vec);
+    out.store(self + d);
+  }
+  for (; d < size; ++d) {
+    self[d] = float(self[d]) + float(source[d]) * alpha;
+  }
+}
+
+// index_add on [outer_size, dim_size, inner_size] with duplicated indices,
+// without sorting them nor atomics:
+//
+// 1. outer_size > 1: the outer rows are independent, the kernel parallels on
+//   {outer_size} and adds the {index_size} rows in order.
+//
+// 2. outer_size == 1: thread t owns the rows [t * dim_size / nthr,
+//   (t + 1) * dim_size / nthr) of self. The indices are bucketed by owner in
+//   two passes over chunks of them (count, then scatter at the scanned
+//   positions), and every thread adds the source rows of its bucket. The
+//   duplicates of a row all land in one bucket, in the order of the indices,
+//   so the result is deterministic and the work is O(index_size).
+template <typename scalar_t, typename index_t>
+void cpu_index_add_dispatch(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha) {
+  using acc_t = at::opmath_type<scalar_t>;
+  auto self_sizes = self.sizes();
+  int64_t outer_size = c10::size_to_dim_(dim, self_sizes);
+  int64_t dim_size = self_sizes[dim];
+  int64_t inner_size = c10::size_from_dim_(dim + 1, self_sizes);
+  int64_t index_size = index.numel();
+
+  scalar_t* self_data = self.data_ptr<scalar_t>();
+  scalar_t* source_data = source.data_ptr<scalar_t>();
+  index_t* index_data = index.data_ptr<index_t>();
+  const acc_t alpha_value = alpha.to<acc_t>();
+
+  check_indexarray_range<index_t>(index_data, index_size, dim_size);
+
+  constexpr int64_t grain_size = at::internal::GRAIN_SIZE / 2;
+  if (outer_size > 1) {
+    at::parallel_for(
+        0,
+        outer_size,
+        grain_size / (index_size * inner_size),
+        [&](int64_t begin, int64_t end) {
+          for (const auto i : c10::irange(begin, end)) {
+            scalar_t* self_ptr = self_data + i * dim_size * inner_size;
+            scalar_t* source_ptr = source_data + i * index_size * inner_size;
+            for (const auto j : c10::irange(index_size)) {
+              add_row(
+                  self_ptr + index_data[j] * inner_size,
+                  source_ptr + j * inner_size,
+                  alpha_value,
+                  inner_size);
+            }
+          }
+        });
+    return;
+  }
+
+  const int64_t nthr = std::min<int64_t>(
+      {int64_t(at::get_num_threads()),
+       dim_size,
+       std::max<int64_t>(1, index_size * inner_size / grain_size)});
+  if (nthr == 1) {
+    for (const auto j : c10::irange(index_size)) {
+      add_row(
+          self_data + index_data[j] * inner_size,
+          source_data + j * inner_size,
+          alpha_value,
+          inner_size);
+    }
+    return;
+  }
+  auto owner = [&](index_t idx) -> int64_t {
+    return ((int64_t(idx) + 1) * nthr - 1) / dim_size;
+  };
+  // counts[t * nthr + o]: indices of chunk t owned by thread o, then their
+  // position in `rows`
+  std::vector<int64_t> counts(nthr * nthr, 0);
+  std::vector<int64_t> rows(index_size);
+  at::parallel_for(0, nthr, 1, [&](int64_t begin, int64_t end) {
+    for (const auto t : c10::irange(begin, end)) {
+      int64_t* chunk_counts = counts.data() + t * nthr;
+      for (int64_t j = t * index_size / nthr; j < (t + 1) * index_size / nthr;
+           j++) {
+        chunk_counts[owner(index_data[j])]++;
+      }
+    }
+  });
+  // exclusive scan in (owner, chunk) order
+  int64_t offset = 0;
+  for (const auto o : c10::irange(nthr)) {
+    for (const auto t : c10::irange(nthr)) {
+      auto count = counts[t * nthr + o];
+      counts[t * nthr + o] = offset;
+      offset += count;
+    }
+  }
+  at::parallel_for(0, nthr, 1, [&](int64_t begin, int64_t end) {
+    for (const auto t : c10::irange(begin, end)) {
+      int64_t* chunk_counts = counts.data() + t * nthr;
+      for (int64_t j = t * index_size / nthr; j < (t + 1) * index_size / nthr;
+           j++) {
+        rows[chunk_counts[owner(index_data[j])]++] = j;
+      }
+    }
+  });
+  // the positions of the last chunk now point at the end of every bucket
+  const int64_t* bucket_ends = counts.data() + (nthr - 1) * nthr;
+  at::parallel_for(0, nthr, 1, [&](int64_t begin, int64_t end) {
+    for (const auto o : c10::irange(begin, end)) {
+      for (int64_t r = o == 0 ? 0 : bucket_ends[o - 1]; r < bucket_ends[o];
+           r++) {
+        int64_t j = rows[r];
+        add_row(
+            self_data + index_data[j] * inner_size,
+            source_data + j * inner_size,
+            alpha_value,
+            inner_size);
+      }
+    }
+  });
+}
+
+void index_add_contig_kernel(
+    const at::Tensor& self,
+    int64_t dim,
+    const at::Tensor& index,
+    const at::Tensor& source,
+    const at::Scalar& alpha) {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(), "index_add_contig", [&] {
+        AT_DISPATCH_INDEX_TYPES(
+            index.scalar_type(), "cpu_index_add_contig", [&] {
+              cpu_index_add_dispatch<scalar_t, index_t>(
+                  self, dim, index, source, alpha);
+            });
+      });
+}
+
 void direct_copy_kernel(at::TensorIteratorBase& iter) {
   // TODO: we don't actually need separate instantiations per dtype;
   // we only need a separate instantiation per dtype size. This would
@@ -316,6 +632,7 @@ void copy_kernel(at::TensorIterator& iter, bool /*non_blocking*/) {
 } // anonymous namespace
 
 REGISTER_DISPATCH(index_select_contig_stub, &index_select_contig_kernel);
+REGISTER_DISPATCH(index_add_contig_stub, &index_add_contig_kernel);
 REGISTER_DISPATCH(copy_stub, &copy_kernel);
 
 } // namespace cpu
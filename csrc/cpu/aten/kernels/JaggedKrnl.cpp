@@ -0,0 +1,856 @@
+#include <ATen/Dispatch.h>
+#include <ATen/OpMathType.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/accumulate.h>
+#include <torch/csrc/autograd/custom_function.h>
+
+#include <aten/Jagged.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using namespace at::vec;
+
+inline int64_t divup(int64_t x, int64_t y) {
+  return (x + y - 1) / y;
+}
+
+// Elements of the rows after the first `dim` dims.
+inline int64_t row_size(const at::Tensor& t, int64_t dim) {
+  return c10::multiply_integers(t.sizes().slice(dim));
+}
+
+// Runs fn(b, row, len) over the rows [begin, end) of a jagged tensor, one
+// piece of a sequence at a time: b is the sequence of the rows
+// [row, row + len).
+template <typename F>
+inline void for_each_piece(
+    const int64_t* offsets,
+    int64_t B,
+    int64_t begin,
+    int64_t end,
+    const F& fn) {
+  if (begin >= end) {
+    return;
+  }
+  // the offsets end with the total length, which is past any row
+  int64_t b = std::upper_bound(offsets, offsets + B + 1, begin) - offsets - 1;
+  for (int64_t row = begin; row < end;) {
+    while (offsets[b + 1] <= row) {
+      b++;
+    }
+    int64_t piece_end = std::min(offsets[b + 1], end);
+    fn(b, row, piece_end - row);
+    row = piece_end;
+  }
+}
+
+// Splits the rows of a jagged tensor in tasks of the same size whatever the
+// lengths of the sequences.
+template <typename F>
+inline void parallel_for_pieces(
+    const int64_t* offsets,
+    int64_t B,
+    int64_t row_size,
+    const F& fn) {
+  const int64_t grain_size =
+      divup(at::internal::GRAIN_SIZE, std::max<int64_t>(row_size, 1));
+  at::parallel_for(
+      0, offsets[B], grain_size, [&](int64_t begin, int64_t end) {
+        for_each_piece(offsets, B, begin, end, fn);
+      });
+}
+
+at::Tensor jagged_to_padded_dense_forward(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    int64_t max_length,
+    double padding_value) {
+  const int64_t B = offsets.numel() - 1;
+  const int64_t D = row_size(values, 1);
+  std::vector<int64_t> sizes{B, max_length};
+  sizes.insert(sizes.end(), values.sizes().begin() + 1, values.sizes().end());
+  auto dense = at::empty(sizes, values.options());
+  if (dense.numel() == 0) {
+    return dense;
+  }
+
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  AT_DISPATCH_ALL_TYPES_AND3(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      at::ScalarType::Bool,
+      values.scalar_type(),
+      "jagged_to_padded_dense",
+      [&] {
+        const scalar_t* src = values.data_ptr<scalar_t>();
+        scalar_t* dst = dense.data_ptr<scalar_t>();
+        const scalar_t padding = static_cast<scalar_t>(padding_value);
+        at::parallel_for(
+            0,
+            B * max_length,
+            divup(at::internal::GRAIN_SIZE, D),
+            [&](int64_t begin, int64_t end) {
+              for (int64_t i = begin; i < end; i++) {
+                int64_t b = i / max_length;
+                int64_t l = i % max_length;
+                scalar_t* out = dst + i * D;
+                if (l < offsets_data[b + 1] - offsets_data[b]) {
+                  std::copy_n(src + (offsets_data[b] + l) * D, D, out);
+                } else {
+                  std::fill_n(out, D, padding);
+                }
+              }
+            });
+      });
+  return dense;
+}
+
+// The rows past the max length of the dense tensor are zeros.
+at::Tensor dense_to_jagged_forward(
+    const at::Tensor& dense,
+    const at::Tensor& offsets) {
+  const int64_t B = offsets.numel() - 1;
+  const int64_t L = dense.size(1);
+  const int64_t D = row_size(dense, 2);
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  std::vector<int64_t> sizes{offsets_data[B]};
+  sizes.insert(sizes.end(), dense.sizes().begin() + 2, dense.sizes().end());
+  auto values = at::empty(sizes, dense.options());
+  if (values.numel() == 0) {
+    return values;
+  }
+
+  AT_DISPATCH_ALL_TYPES_AND3(
+      at::ScalarType::Half,
+      at::ScalarType::BFloat16,
+      at::ScalarType::Bool,
+      dense.scalar_type(),
+      "dense_to_jagged",
+      [&] {
+        const scalar_t* src = dense.data_ptr<scalar_t>();
+        scalar_t* dst = values.data_ptr<scalar_t>();
+        parallel_for_pieces(
+            offsets_data, B, D, [&](int64_t b, int64_t row, int64_t len) {
+              int64_t l = row - offsets_data[b];
+              int64_t copied = std::max<int64_t>(0, std::min(len, L - l));
+              if (copied > 0) {
+                std::copy_n(src + (b * L + l) * D, copied * D, dst + row * D);
+              }
+              std::fill_n(
+                  dst + (row + copied) * D, (len - copied) * D, scalar_t(0));
+            });
+      });
+  return values;
+}
+
+// out = values op dense, the dense tensor being padded with zeros past its
+// max length.
+at::Tensor jagged_dense_elementwise_forward(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense,
+    JaggedDenseOp op) {
+  const int64_t B = offsets.numel() - 1;
+  const int64_t L = dense.size(1);
+  const int64_t D = row_size(values, 1);
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  auto out = at::empty_like(values);
+  if (out.numel() == 0) {
+    return out;
+  }
+
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16,
+      values.scalar_type(),
+      "jagged_dense_elementwise",
+      [&] {
+        const scalar_t* src = values.data_ptr<scalar_t>();
+        const scalar_t* dense_data = dense.data_ptr<scalar_t>();
+        scalar_t* dst = out.data_ptr<scalar_t>();
+        auto run = [&](const auto& vec_op) {
+          parallel_for_pieces(
+              offsets_data, B, D, [&](int64_t b, int64_t row, int64_t len) {
+                int64_t l = row - offsets_data[b];
+                int64_t n = std::max<int64_t>(0, std::min(len, L - l)) * D;
+                if (n > 0) {
+                  at::vec::map2(
+                      vec_op,
+                      dst + row * D,
+                      src + row * D,
+                      dense_data + (b * L + l) * D,
+                      n);
+                }
+                int64_t padded = len * D - n;
+                if (op == JaggedDenseOp::Add) {
+                  std::copy_n(src + row * D + n, padded, dst + row * D + n);
+                } else {
+                  std::fill_n(dst + row * D + n, padded, scalar_t(0));
+                }
+              });
+        };
+        if (op == JaggedDenseOp::Add) {
+          run([](auto x, auto y) { return x + y; });
+        } else {
+          run([](auto x, auto y) { return x * y; });
+        }
+      });
+  return out;
+}
+
+// Softmax of each column over the rows of each sequence, computed in
+// acc_t. A sequence of 1-D values is reduced as a whole.
+template <typename scalar_t>
+void jagged_softmax_kernel(
+    const scalar_t* src,
+    scalar_t* dst,
+    const int64_t* offsets,
+    int64_t B,
+    int64_t D) {
+  using acc_t = at::opmath_type<scalar_t>;
+  using Vec = Vectorized<acc_t>;
+  at::parallel_for(0, B, 1, [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> buffer;
+    std::vector<acc_t> col_max(D);
+    std::vector<acc_t> col_sum(D);
+    for (int64_t b = begin; b < end; b++) {
+      const int64_t row = offsets[b];
+      const int64_t len = offsets[b + 1] - row;
+      if (len == 0) {
+        continue;
+      }
+      buffer.resize(len * D);
+      acc_t* x = buffer.data();
+      at::vec::convert(src + row * D, x, len * D);
+      if (D == 1) {
+        acc_t seq_max = at::vec::reduce_all<acc_t>(
+            [](Vec a, Vec b) { return maximum(a, b); }, x, len);
+        at::vec::map<acc_t>(
+            [seq_max](Vec v) { return (v - Vec(seq_max)).exp(); }, x, x, len);
+        acc_t seq_sum = at::vec::reduce_all<acc_t>(
+            [](Vec a, Vec b) { return a + b; }, x, len);
+        acc_t inv_sum = acc_t(1) / seq_sum;
+        at::vec::map<acc_t>(
+            [inv_sum](Vec v) { return v * Vec(inv_sum); }, x, x, len);
+      } else {
+        std::copy_n(x, D, col_max.data());
+        for (int64_t r = 1; r < len; r++) {
+          at::vec::map2<acc_t>(
+              [](Vec a, Vec b) { return maximum(a, b); },
+              col_max.data(),
+              col_max.data(),
+              x + r * D,
+              D);
+        }
+        std::fill(col_sum.begin(), col_sum.end(), acc_t(0));
+        for (int64_t r = 0; r < len; r++) {
+          acc_t* x_row = x + r * D;
+          at::vec::map2<acc_t>(
+              [](Vec v, Vec m) { return (v - m).exp(); },
+              x_row,
+              x_row,
+              col_max.data(),
+              D);
+          at::vec::map2<acc_t>(
+              [](Vec a, Vec b) { return a + b; },
+              col_sum.data(),
+              col_sum.data(),
+              x_row,
+              D);
+        }
+        at::vec::map<acc_t>(
+            [](Vec s) { return Vec(1) / s; },
+            col_sum.data(),
+            col_sum.data(),
+            D);
+        for (int64_t r = 0; r < len; r++) {
+          at::vec::map2<acc_t>(
+              [](Vec v, Vec s) { return v * s; },
+              x + r * D,
+              x + r * D,
+              col_sum.data(),
+              D);
+        }
+      }
+      at::vec::convert(x, dst + row * D, len * D);
+    }
+  });
+}
+
+// grad_input = output * (grad - sum(grad * output)), the sums being over the
+// rows of each sequence.
+template <typename scalar_t>
+void jagged_softmax_backward_kernel(
+    const scalar_t* grad,
+    const scalar_t* output,
+    scalar_t* grad_input,
+    const int64_t* offsets,
+    int64_t B,
+    int64_t D) {
+  using acc_t = at::opmath_type<scalar_t>;
+  using Vec = Vectorized<acc_t>;
+  at::parallel_for(0, B, 1, [&](int64_t begin, int64_t end) {
+    std::vector<acc_t> g_buffer;
+    std::vector<acc_t> y_buffer;
+    std::vector<acc_t> col_dot(D);
+    for (int64_t b = begin; b < end; b++) {
+      const int64_t row = offsets[b];
+      const int64_t len = offsets[b + 1] - row;
+      if (len == 0) {
+        continue;
+      }
+      g_buffer.resize(len * D);
+      y_buffer.resize(len * D);
+      acc_t* g = g_buffer.data();
+      acc_t* y = y_buffer.data();
+      at::vec::convert(grad + row * D, g, len * D);
+      at::vec::convert(output + row * D, y, len * D);
+      if (D == 1) {
+        acc_t dot = at::vec::map2_reduce_all<acc_t>(
+            [](Vec a, Vec b) { return a * b; },
+            [](Vec a, Vec b) { return a + b; },
+            g,
+            y,
+            len);
+        at::vec::map2<acc_t>(
+            [dot](Vec gv, Vec yv) { return yv * (gv - Vec(dot)); },
+            g,
+            g,
+            y,
+            len);
+      } else {
+        std::fill(col_dot.begin(), col_dot.end(), acc_t(0));
+        for (int64_t r = 0; r < len; r++) {
+          for (int64_t i = 0; i < D; i++) {
+            col_dot[i] += g[r * D + i] * y[r * D + i];
+          }
+        }
+        for (int64_t r = 0; r < len; r++) {
+          at::vec::map3<acc_t>(
+              [](Vec gv, Vec yv, Vec dot) { return yv * (gv - dot); },
+              g + r * D,
+              g + r * D,
+              y + r * D,
+              col_dot.data(),
+              D);
+        }
+      }
+      at::vec::convert(g, grad_input + row * D, len * D);
+    }
+  });
+}
+
+at::Tensor jagged_softmax_forward(
+    const at::Tensor& values,
+    const at::Tensor& offsets) {
+  auto out = at::empty_like(values);
+  if (out.numel() == 0) {
+    return out;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, values.scalar_type(), "jagged_softmax", [&] {
+        jagged_softmax_kernel<scalar_t>(
+            values.data_ptr<scalar_t>(),
+            out.data_ptr<scalar_t>(),
+            offsets.data_ptr<int64_t>(),
+            offsets.numel() - 1,
+            row_size(values, 1));
+      });
+  return out;
+}
+
+at::Tensor jagged_softmax_backward(
+    const at::Tensor& grad,
+    const at::Tensor& output,
+    const at::Tensor& offsets) {
+  auto grad_input = at::empty_like(output);
+  if (grad_input.numel() == 0) {
+    return grad_input;
+  }
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16,
+      output.scalar_type(),
+      "jagged_softmax_backward",
+      [&] {
+        jagged_softmax_backward_kernel<scalar_t>(
+            grad.data_ptr<scalar_t>(),
+            output.data_ptr<scalar_t>(),
+            grad_input.data_ptr<scalar_t>(),
+            offsets.data_ptr<int64_t>(),
+            offsets.numel() - 1,
+            row_size(output, 1));
+      });
+  return grad_input;
+}
+
+// Runs fn(b) for each sequence. With fewer sequences than threads, each GEMM
+// runs on all the threads instead.
+template <typename F>
+inline void for_each_sequence(int64_t B, const F& fn) {
+  if (B >= at::get_num_threads()) {
+    at::parallel_for(0, B, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; b++) {
+        fn(b);
+      }
+    });
+  } else {
+    for (int64_t b = 0; b < B; b++) {
+      fn(b);
+    }
+  }
+}
+
+// out[offsets[b]:offsets[b + 1]] = x[offsets[b]:offsets[b + 1]] @ y[b]
+at::Tensor jagged_dense_bmm_forward(
+    const at::Tensor& x,
+    const at::Tensor& offsets,
+    const at::Tensor& y) {
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  auto out = at::empty({x.size(0), y.size(2)}, x.options());
+  for_each_sequence(offsets.numel() - 1, [&](int64_t b) {
+    const int64_t len = offsets_data[b + 1] - offsets_data[b];
+    if (len == 0) {
+      return;
+    }
+    auto out_b = out.narrow(0, offsets_data[b], len);
+    at::mm_out(out_b, x.narrow(0, offsets_data[b], len), y[b]);
+  });
+  return out;
+}
+
+// out[b] = x[offsets[b]:offsets[b + 1]]^T @ y[offsets[b]:offsets[b + 1]]
+at::Tensor jagged_jagged_bmm_forward(
+    const at::Tensor& x,
+    const at::Tensor& y,
+    const at::Tensor& offsets) {
+  const int64_t B = offsets.numel() - 1;
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  auto out = at::empty({B, x.size(1), y.size(1)}, x.options());
+  for_each_sequence(B, [&](int64_t b) {
+    const int64_t len = offsets_data[b + 1] - offsets_data[b];
+    auto out_b = out[b];
+    if (len == 0) {
+      out_b.zero_();
+      return;
+    }
+    at::mm_out(
+        out_b,
+        x.narrow(0, offsets_data[b], len).t(),
+        y.narrow(0, offsets_data[b], len));
+  });
+  return out;
+}
+
+std::tuple<at::Tensor, at::Tensor> jagged_index_select_forward(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& indices) {
+  const int64_t num_indices = indices.numel();
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  auto out_offsets = at::empty({num_indices + 1}, offsets.options());
+  int64_t* out_offsets_data = out_offsets.data_ptr<int64_t>();
+  out_offsets_data[0] = 0;
+  for (int64_t i = 0; i < num_indices; i++) {
+    int64_t s = indices_data[i];
+    out_offsets_data[i + 1] =
+        out_offsets_data[i] + offsets_data[s + 1] - offsets_data[s];
+  }
+
+  std::vector<int64_t> sizes{out_offsets_data[num_indices]};
+  sizes.insert(sizes.end(), values.sizes().begin() + 1, values.sizes().end());
+  auto out = at::empty(sizes, values.options());
+  if (out.numel() == 0) {
+    return std::make_tuple(out, out_offsets);
+  }
+  // the rows of a sequence are copied at once, whatever the dtype
+  const int64_t D = row_size(values, 1);
+  const int64_t row_bytes = D * values.element_size();
+  const char* src = static_cast<const char*>(values.data_ptr());
+  char* dst = static_cast<char*>(out.data_ptr());
+  parallel_for_pieces(
+      out_offsets_data,
+      num_indices,
+      D,
+      [&](int64_t i, int64_t row, int64_t len) {
+        int64_t src_row =
+            offsets_data[indices_data[i]] + row - out_offsets_data[i];
+        std::memcpy(
+            dst + row * row_bytes, src + src_row * row_bytes, len * row_bytes);
+      });
+  return std::make_tuple(out, out_offsets);
+}
+
+// Each task owns a range of the sequences of grad_values and adds the grads
+// of the selected copies of its sequences, so the repeated indices do not
+// race.
+at::Tensor jagged_index_select_backward(
+    const at::Tensor& grad,
+    const at::Tensor& offsets,
+    const at::Tensor& indices,
+    const at::Tensor& out_offsets) {
+  std::vector<int64_t> sizes{offsets[-1].item<int64_t>()};
+  sizes.insert(sizes.end(), grad.sizes().begin() + 1, grad.sizes().end());
+  auto grad_values = at::zeros(sizes, grad.options());
+  if (grad_values.numel() == 0) {
+    return grad_values;
+  }
+  const int64_t B = offsets.numel() - 1;
+  const int64_t num_indices = indices.numel();
+  const int64_t D = row_size(grad, 1);
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  const int64_t* out_offsets_data = out_offsets.data_ptr<int64_t>();
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16,
+      grad.scalar_type(),
+      "jagged_index_select_backward",
+      [&] {
+        const scalar_t* src = grad.data_ptr<scalar_t>();
+        scalar_t* dst = grad_values.data_ptr<scalar_t>();
+        at::parallel_for(0, B, 1, [&](int64_t begin, int64_t end) {
+          for (int64_t i = 0; i < num_indices; i++) {
+            int64_t s = indices_data[i];
+            if (s < begin || s >= end) {
+              continue;
+            }
+            int64_t n = (offsets_data[s + 1] - offsets_data[s]) * D;
+            scalar_t* dst_ptr = dst + offsets_data[s] * D;
+            at::vec::map2(
+                [](auto x, auto y) { return x + y; },
+                dst_ptr,
+                dst_ptr,
+                src + out_offsets_data[i] * D,
+                n);
+          }
+        });
+      });
+  return grad_values;
+}
+
+class JaggedToPaddedDenseOp
+    : public torch::autograd::Function<JaggedToPaddedDenseOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& values,
+      const at::Tensor& offsets,
+      int64_t max_length,
+      double padding_value) {
+    RECORD_FUNCTION(
+        "IPEXJaggedToPaddedDenseOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    ctx->save_for_backward({offsets});
+    return jagged_to_padded_dense_forward(
+        values, offsets, max_length, padding_value);
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXJaggedToPaddedDenseOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+    auto offsets = ctx->get_saved_variables()[0];
+    auto grad_values =
+        dense_to_jagged_forward(grad_outputs[0].contiguous(), offsets);
+    return {grad_values, at::Tensor(), at::Tensor(), at::Tensor()};
+  }
+};
+
+class DenseToJaggedOp : public torch::autograd::Function<DenseToJaggedOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& dense,
+      const at::Tensor& offsets) {
+    RECORD_FUNCTION(
+        "IPEXDenseToJaggedOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    ctx->save_for_backward({offsets});
+    ctx->saved_data["max_length"] = dense.size(1);
+    return dense_to_jagged_forward(dense, offsets);
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXDenseToJaggedOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+    auto offsets = ctx->get_saved_variables()[0];
+    auto grad_dense = jagged_to_padded_dense_forward(
+        grad_outputs[0].contiguous(),
+        offsets,
+        ctx->saved_data["max_length"].toInt(),
+        0);
+    return {grad_dense, at::Tensor()};
+  }
+};
+
+class JaggedDenseElementwiseOp
+    : public torch::autograd::Function<JaggedDenseElementwiseOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& values,
+      const at::Tensor& offsets,
+      const at::Tensor& dense,
+      JaggedDenseOp op) {
+    RECORD_FUNCTION(
+        "IPEXJaggedDenseElementwiseOp::forward",
+        c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    ctx->save_for_backward({values, offsets, dense});
+    ctx->saved_data["mul"] = op == JaggedDenseOp::Mul;
+    return jagged_dense_elementwise_forward(values, offsets, dense, op);
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXJaggedDenseElementwiseOp::backward",
+        c10::ArrayRef<c10::IValue>({}));
+
+    auto saved = ctx->get_saved_variables();
+    auto values = saved[0];
+    auto offsets = saved[1];
+    auto dense = saved[2];
+    auto grad = grad_outputs[0].contiguous();
+    const int64_t max_length = dense.size(1);
+    if (!ctx->saved_data["mul"].toBool()) {
+      auto grad_dense =
+          jagged_to_padded_dense_forward(grad, offsets, max_length, 0);
+      return {grad, at::Tensor(), grad_dense, at::Tensor()};
+    }
+    auto grad_values = jagged_dense_elementwise_forward(
+        grad, offsets, dense, JaggedDenseOp::Mul);
+    auto grad_dense = jagged_to_padded_dense_forward(
+        grad * values, offsets, max_length, 0);
+    return {grad_values, at::Tensor(), grad_dense, at::Tensor()};
+  }
+};
+
+class JaggedSoftmaxOp : public torch::autograd::Function<JaggedSoftmaxOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& values,
+      const at::Tensor& offsets) {
+    RECORD_FUNCTION(
+        "IPEXJaggedSoftmaxOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    auto output = jagged_softmax_forward(values, offsets);
+    ctx->save_for_backward({output, offsets});
+    return output;
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXJaggedSoftmaxOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+    auto saved = ctx->get_saved_variables();
+    auto grad_values = jagged_softmax_backward(
+        grad_outputs[0].contiguous(), saved[0], saved[1]);
+    return {grad_values, at::Tensor()};
+  }
+};
+
+class JaggedDenseBmmOp : public torch::autograd::Function<JaggedDenseBmmOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& x,
+      const at::Tensor& offsets,
+      const at::Tensor& y) {
+    RECORD_FUNCTION(
+        "IPEXJaggedDenseBmmOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    ctx->save_for_backward({x, offsets, y});
+    return jagged_dense_bmm_forward(x, offsets, y);
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXJaggedDenseBmmOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+    auto saved = ctx->get_saved_variables();
+    auto x = saved[0];
+    auto offsets = saved[1];
+    auto y = saved[2];
+    auto grad = grad_outputs[0].contiguous();
+    auto grad_x = jagged_dense_bmm_forward(grad, offsets, y.transpose(1, 2));
+    auto grad_y = jagged_jagged_bmm_forward(x, grad, offsets);
+    return {grad_x, at::Tensor(), grad_y};
+  }
+};
+
+class JaggedJaggedBmmOp : public torch::autograd::Function<JaggedJaggedBmmOp> {
+ public:
+  static at::Tensor forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& x,
+      const at::Tensor& y,
+      const at::Tensor& offsets) {
+    RECORD_FUNCTION(
+        "IPEXJaggedJaggedBmmOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    ctx->save_for_backward({x, y, offsets});
+    return jagged_jagged_bmm_forward(x, y, offsets);
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXJaggedJaggedBmmOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+    auto saved = ctx->get_saved_variables();
+    auto x = saved[0];
+    auto y = saved[1];
+    auto offsets = saved[2];
+    auto grad = grad_outputs[0];
+    auto grad_x = jagged_dense_bmm_forward(y, offsets, grad.transpose(1, 2));
+    auto grad_y = jagged_dense_bmm_forward(x, offsets, grad);
+    return {grad_x, grad_y, at::Tensor()};
+  }
+};
+
+class JaggedIndexSelectOp
+    : public torch::autograd::Function<JaggedIndexSelectOp> {
+ public:
+  static torch::autograd::variable_list forward(
+      torch::autograd::AutogradContext* ctx,
+      const at::Tensor& values,
+      const at::Tensor& offsets,
+      const at::Tensor& indices) {
+    RECORD_FUNCTION(
+        "IPEXJaggedIndexSelectOp::forward", c10::ArrayRef<c10::IValue>({}));
+
+    at::AutoDispatchBelowADInplaceOrView g;
+    auto result = jagged_index_select_forward(values, offsets, indices);
+    auto out_offsets = std::get<1>(result);
+    ctx->mark_non_differentiable({out_offsets});
+    ctx->save_for_backward({offsets, indices, out_offsets});
+    return {std::get<0>(result), out_offsets};
+  }
+
+  static torch::autograd::tensor_list backward(
+      torch::autograd::AutogradContext* ctx,
+      torch::autograd::tensor_list grad_outputs) {
+    RECORD_FUNCTION(
+        "IPEXJaggedIndexSelectOp::backward", c10::ArrayRef<c10::IValue>({}));
+
+    auto saved = ctx->get_saved_variables();
+    auto grad_values = jagged_index_select_backward(
+        grad_outputs[0].contiguous(), saved[0], saved[1], saved[2]);
+    return {grad_values, at::Tensor(), at::Tensor()};
+  }
+};
+
+at::Tensor jagged_to_padded_dense_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    int64_t max_length,
+    double padding_value) {
+  if (at::GradMode::is_enabled() && values.requires_grad())
+    return JaggedToPaddedDenseOp::apply(
+        values, offsets, max_length, padding_value);
+  return jagged_to_padded_dense_forward(
+      values, offsets, max_length, padding_value);
+}
+
+at::Tensor dense_to_jagged_kernel_impl(
+    const at::Tensor& dense,
+    const at::Tensor& offsets) {
+  if (at::GradMode::is_enabled() && dense.requires_grad())
+    return DenseToJaggedOp::apply(dense, offsets);
+  return dense_to_jagged_forward(dense, offsets);
+}
+
+at::Tensor jagged_dense_elementwise_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& dense,
+    JaggedDenseOp op) {
+  if (at::GradMode::is_enabled() &&
+      (values.requires_grad() || dense.requires_grad()))
+    return JaggedDenseElementwiseOp::apply(values, offsets, dense, op);
+  return jagged_dense_elementwise_forward(values, offsets, dense, op);
+}
+
+at::Tensor jagged_softmax_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets) {
+  if (at::GradMode::is_enabled() && values.requires_grad())
+    return JaggedSoftmaxOp::apply(values, offsets);
+  return jagged_softmax_forward(values, offsets);
+}
+
+at::Tensor jagged_dense_bmm_kernel_impl(
+    const at::Tensor& x,
+    const at::Tensor& offsets,
+    const at::Tensor& y) {
+  if (at::GradMode::is_enabled() && (x.requires_grad() || y.requires_grad()))
+    return JaggedDenseBmmOp::apply(x, offsets, y);
+  return jagged_dense_bmm_forward(x, offsets, y);
+}
+
+at::Tensor jagged_jagged_bmm_kernel_impl(
+    const at::Tensor& x,
+    const at::Tensor& y,
+    const at::Tensor& offsets) {
+  if (at::GradMode::is_enabled() && (x.requires_grad() || y.requires_grad()))
+    return JaggedJaggedBmmOp::apply(x, y, offsets);
+  return jagged_jagged_bmm_forward(x, y, offsets);
+}
+
+std::tuple<at::Tensor, at::Tensor> jagged_index_select_kernel_impl(
+    const at::Tensor& values,
+    const at::Tensor& offsets,
+    const at::Tensor& indices) {
+  if (at::GradMode::is_enabled() && values.requires_grad()) {
+    auto result = JaggedIndexSelectOp::apply(values, offsets, indices);
+    return std::make_tuple(result[0], result[1]);
+  }
+  return jagged_index_select_forward(values, offsets, indices);
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    jagged_to_padded_dense_kernel_stub,
+    &jagged_to_padded_dense_kernel_impl);
+REGISTER_DISPATCH(dense_to_jagged_kernel_stub, &dense_to_jagged_kernel_impl);
+REGISTER_DISPATCH(
+    jagged_dense_elementwise_kernel_stub,
+    &jagged_dense_elementwise_kernel_impl);
+REGISTER_DISPATCH(jagged_softmax_kernel_stub, &jagged_softmax_kernel_impl);
+REGISTER_DISPATCH(jagged_dense_bmm_kernel_stub, &jagged_dense_bmm_kernel_impl);
+REGISTER_DISPATCH(
+    jagged_jagged_bmm_kernel_stub,
+    &jagged_jagged_bmm_kernel_impl);
+REGISTER_DISPATCH(
+    jagged_index_select_kernel_stub,
+    &jagged_index_select_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
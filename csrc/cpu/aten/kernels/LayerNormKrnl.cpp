@@ -0,0 +1,288 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <cmath>
+
+#include <aten/LayerNorm.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+
+// Rows are handed out in blocks of roughly GRAIN_SIZE elements so that small
+// hidden sizes (e.g. 768) still give every task enough work.
+inline int64_t layer_norm_row_grain(int64_t N) {
+  return std::max<int64_t>(
+      1, at::internal::GRAIN_SIZE / std::max<int64_t>(N, 1));
+}
+
+// Single pass Welford over one row: every lane keeps its own running
+// mean/M2, lanes are merged with Chan's formula and the tail is folded in
+// one element at a time. Returns (mean, biased variance).
+std::pair<float, float> welford_row(const float* x, int64_t N) {
+  constexpr int64_t kVecSize = Vec::size();
+  const int64_t num_vecs = N / kVecSize;
+  Vec m(0.f);
+  Vec m2(0.f);
+  for (const auto c : c10::irange(num_vecs)) {
+    auto v = Vec::loadu(x + c * kVecSize);
+    auto delta = v - m;
+    m = m + delta * Vec(1.f / static_cast<float>(c + 1));
+    m2 = m2 + delta * (v - m);
+  }
+
+  float mean = 0.f;
+  float M2 = 0.f;
+  int64_t count = 0;
+  if (num_vecs > 0) {
+    __at_align__ float lane_m[kVecSize];
+    __at_align__ float lane_m2[kVecSize];
+    m.store(lane_m);
+    m2.store(lane_m2);
+    for (const auto lane : c10::irange(kVecSize)) {
+      int64_t n = count + num_vecs;
+      float delta = lane_m[lane] - mean;
+      mean += delta * static_cast<float>(num_vecs) / static_cast<float>(n);
+      M2 += lane_m2[lane] +
+          delta * delta * static_cast<float>(count) *
+              static_cast<float>(num_vecs) / static_cast<float>(n);
+      count = n;
+    }
+  }
+  for (int64_t i = num_vecs * kVecSize; i < N; i++) {
+    count++;
+    float delta = x[i] - mean;
+    mean += delta / static_cast<float>(count);
+    M2 += delta * (x[i] - mean);
+  }
+  return std::make_pair(mean, M2 / static_cast<float>(N));
+}
+
+template <typename T>
+inline const float* row_as_float(const T* src, float* buf, int64_t N) {
+  at::vec::convert(src, buf, N);
+  return buf;
+}
+
+template <>
+inline const float* row_as_float<float>(
+    const float* src,
+    float* buf,
+    int64_t N) {
+  return src;
+}
+
+template <typename T>
+void LayerNormKernelImpl(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t M,
+    int64_t N,
+    float eps,
+    at::Tensor& Y,
+    at::Tensor& mean,
+    at::Tensor& rstd) {
+  const T* X_data = X.data_ptr<T>();
+  const float* gamma_data = gamma.data_ptr<float>();
+  const float* beta_data = beta.data_ptr<float>();
+  T* Y_data = Y.data_ptr<T>();
+  float* mean_data = mean.data_ptr<float>();
+  float* rstd_data = rstd.data_ptr<float>();
+
+  at::parallel_for(
+      0, M, layer_norm_row_grain(N), [&](int64_t start, int64_t end) {
+        std::vector<float> buf(2 * N);
+        for (const auto i : c10::irange(start, end)) {
+          const float* x = row_as_float(X_data + i * N, buf.data(), N);
+          float* y = buf.data() + N;
+          auto moments = welford_row(x, N);
+          const float rstd_val = 1.f / std::sqrt(moments.second + eps);
+          const Vec scale(rstd_val);
+          const Vec shift(-moments.first * rstd_val);
+          at::vec::map3<float>(
+              [scale, shift](Vec x, Vec g, Vec b) {
+                return at::vec::fmadd(at::vec::fmadd(x, scale, shift), g, b);
+              },
+              y,
+              x,
+              gamma_data,
+              beta_data,
+              N);
+          at::vec::convert(y, Y_data + i * N, N);
+          mean_data[i] = moments.first;
+          rstd_data[i] = rstd_val;
+        }
+      });
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> layer_norm_kernel_impl(
+    const at::Tensor& X,
+    const at::Tensor& gamma,
+    const at::Tensor& beta,
+    int64_t M,
+    int64_t N,
+    double eps) {
+  auto float_opts = X.options().dtype(at::kFloat);
+  auto gamma_ = gamma.defined() ? gamma.to(at::kFloat).contiguous()
+                                : at::ones({N}, float_opts);
+  auto beta_ = beta.defined() ? beta.to(at::kFloat).contiguous()
+                              : at::zeros({N}, float_opts);
+  auto X_ = X.contiguous();
+  at::Tensor Y = at::empty_like(X_, at::MemoryFormat::Contiguous);
+  at::Tensor mean = at::empty({M}, float_opts);
+  at::Tensor rstd = at::empty({M}, float_opts);
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16,
+      at::ScalarType::Half,
+      X_.scalar_type(),
+      "layer_norm_kernel_impl",
+      [&] {
+        LayerNormKernelImpl<scalar_t>(
+            X_, gamma_, beta_, M, N, eps, Y, mean, rstd);
+      });
+  return std::make_tuple(Y, mean, rstd);
+}
+
+// dX, dgamma and dbeta in one sweep over the rows: every row reads dY and X
+// once for the row sums (accumulating the per-thread dgamma/dbeta partials at
+// the same time) and once more to write dX.
+template <typename T>
+void LayerNormBackwardKernelImpl(
+    const at::Tensor& dY,
+    const at::Tensor& X,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const at::Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    at::Tensor& dX,
+    at::Tensor& dgamma_buf,
+    at::Tensor& dbeta_buf) {
+  const T* dY_data = dY.data_ptr<T>();
+  const T* X_data = X.data_ptr<T>();
+  const float* mean_data = mean.data_ptr<float>();
+  const float* rstd_data = rstd.data_ptr<float>();
+  const float* gamma_data = gamma.data_ptr<float>();
+  T* dX_data = dX.defined() ? dX.data_ptr<T>() : nullptr;
+  float* dgamma_data =
+      dgamma_buf.defined() ? dgamma_buf.data_ptr<float>() : nullptr;
+  float* dbeta_data =
+      dbeta_buf.defined() ? dbeta_buf.data_ptr<float>() : nullptr;
+  constexpr int64_t kVecSize = Vec::size();
+  const float scale = 1.f / static_cast<float>(N);
+
+  at::parallel_for(
+      0, M, layer_norm_row_grain(N), [&](int64_t start, int64_t end) {
+        int64_t tid = at::get_thread_num();
+        float* dgamma_acc = dgamma_data ? dgamma_data + tid * N : nullptr;
+        float* dbeta_acc = dbeta_data ? dbeta_data + tid * N : nullptr;
+        std::vector<float> buf(3 * N);
+        for (const auto i : c10::irange(start, end)) {
+          const float* dy = row_as_float(dY_data + i * N, buf.data(), N);
+          const float* x = row_as_float(X_data + i * N, buf.data() + N, N);
+          float* dx = buf.data() + 2 * N;
+          const Vec mean_vec(mean_data[i]);
+          const Vec rstd_vec(rstd_data[i]);
+          Vec ds_vec(0.f);
+          Vec db_vec(0.f);
+          for (int64_t j = 0; j < N; j += kVecSize) {
+            int64_t count = std::min(kVecSize, N - j);
+            auto dy_vec = Vec::loadu(dy + j, count);
+            auto x_vec = Vec::loadu(x + j, count);
+            auto dyg = dy_vec * Vec::loadu(gamma_data + j, count);
+            ds_vec = at::vec::fmadd(dyg, x_vec, ds_vec);
+            db_vec = db_vec + dyg;
+            if (dgamma_acc) {
+              auto xhat = (x_vec - mean_vec) * rstd_vec;
+              auto acc = Vec::loadu(dgamma_acc + j, count);
+              at::vec::fmadd(dy_vec, xhat, acc).store(dgamma_acc + j, count);
+            }
+            if (dbeta_acc) {
+              auto acc = Vec::loadu(dbeta_acc + j, count);
+              (acc + dy_vec).store(dbeta_acc + j, count);
+            }
+          }
+          if (!dX_data) {
+            continue;
+          }
+          const float ds = at::vec::vec_reduce_all<float>(
+              [](Vec& a, Vec& b) { return a + b; }, ds_vec);
+          const float db = at::vec::vec_reduce_all<float>(
+              [](Vec& a, Vec& b) { return a + b; }, db_vec);
+          // dx = rstd * dy * gamma + c1 * x + c2
+          const float r = rstd_data[i];
+          const float c1 = (db * mean_data[i] - ds) * r * r * r * scale;
+          const float c2 = -c1 * mean_data[i] - db * r * scale;
+          const Vec c1_vec(c1);
+          const Vec c2_vec(c2);
+          at::vec::map3<float>(
+              [rstd_vec, c1_vec, c2_vec](Vec dy, Vec g, Vec x) {
+                return at::vec::fmadd(
+                    rstd_vec * dy, g, at::vec::fmadd(c1_vec, x, c2_vec));
+              },
+              dx,
+              dy,
+              gamma_data,
+              x,
+              N);
+          at::vec::convert(dx, dX_data + i * N, N);
+        }
+      });
+}
+
+std::tuple<at::Tensor, at::Tensor, at::Tensor> layer_norm_backward_kernel_impl(
+    const at::Tensor& dY,
+    const at::Tensor& X,
+    const at::Tensor& mean,
+    const at::Tensor& rstd,
+    const at::Tensor& gamma,
+    int64_t M,
+    int64_t N,
+    std::array<bool, 3> grad_input_mask) {
+  auto float_opts = X.options().dtype(at::kFloat);
+  auto dY_ = dY.contiguous();
+  auto X_ = X.contiguous();
+  auto mean_ = mean.to(at::kFloat).contiguous();
+  auto rstd_ = rstd.to(at::kFloat).contiguous();
+  auto gamma_ = gamma.defined() ? gamma.to(at::kFloat).contiguous()
+                                : at::ones({N}, float_opts);
+  at::Tensor dX = grad_input_mask[0]
+      ? at::empty_like(X_, at::MemoryFormat::Contiguous)
+      : at::Tensor();
+  int64_t num_threads = at::get_num_threads();
+  at::Tensor dgamma_buf = grad_input_mask[1]
+      ? at::zeros({num_threads, N}, float_opts)
+      : at::Tensor();
+  at::Tensor dbeta_buf = grad_input_mask[2]
+      ? at::zeros({num_threads, N}, float_opts)
+      : at::Tensor();
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16,
+      at::ScalarType::Half,
+      X_.scalar_type(),
+      "layer_norm_backward_kernel_impl",
+      [&] {
+        LayerNormBackwardKernelImpl<scalar_t>(
+            dY_, X_, mean_, rstd_, gamma_, M, N, dX, dgamma_buf, dbeta_buf);
+      });
+  at::Tensor dgamma = dgamma_buf.defined() ? dgamma_buf.sum(0) : at::Tensor();
+  at::Tensor dbeta = dbeta_buf.defined() ? dbeta_buf.sum(0) : at::Tensor();
+  return std::make_tuple(dX, dgamma, dbeta);
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(layer_norm_kernel_stub, &layer_norm_kernel_impl);
+REGISTER_DISPATCH(
+    layer_norm_backward_kernel_stub,
+    &layer_norm_backward_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
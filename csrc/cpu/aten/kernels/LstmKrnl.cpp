@@ -0,0 +1,191 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <algorithm>
+
+#include <aten/RNN.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+constexpr int64_t kVecsPerBlock = kLstmFusedBlockSize / Vec::size();
+
+inline Vec lstm_sigmoid(const Vec& x) {
+  const Vec one(1.f);
+  return one / (one + x.neg().exp());
+}
+
+// Accumulate `len` elements of `src` against one gate-interleaved block of
+// the packed weight. The block is laid out [k][gate][kLstmFusedBlockSize].
+inline void lstm_block_gemv(
+    const float* src,
+    int64_t len,
+    const float* w,
+    Vec (&acc)[4][kVecsPerBlock]) {
+  for (const auto k : c10::irange(len)) {
+    const Vec s(src[k]);
+    for (const auto g : c10::irange(4)) {
+      for (const auto v : c10::irange(kVecsPerBlock)) {
+        acc[g][v] = at::vec::fmadd(
+            s,
+            Vec::loadu(w + g * kLstmFusedBlockSize + v * Vec::size()),
+            acc[g][v]);
+      }
+    }
+    w += 4 * kLstmFusedBlockSize;
+  }
+}
+
+// One time step of one hidden block for the whole batch: the gate GEMM
+// result never leaves registers before the elementwise cell update.
+template <typename scalar_t>
+void lstm_cell_block(
+    const float* x_t,
+    const float* h_prev,
+    const float* w_block,
+    const float* b_block,
+    float* c,
+    float* h_next,
+    scalar_t* out_t,
+    int64_t batch,
+    int64_t input_size,
+    int64_t hidden_size,
+    int64_t offset,
+    int64_t len) {
+  for (const auto n : c10::irange(batch)) {
+    Vec acc[4][kVecsPerBlock];
+    for (const auto g : c10::irange(4)) {
+      for (const auto v : c10::irange(kVecsPerBlock)) {
+        acc[g][v] =
+            Vec::loadu(b_block + g * kLstmFusedBlockSize + v * Vec::size());
+      }
+    }
+    lstm_block_gemv(x_t + n * input_size, input_size, w_block, acc);
+    lstm_block_gemv(
+        h_prev + n * hidden_size,
+        hidden_size,
+        w_block + input_size * 4 * kLstmFusedBlockSize,
+        acc);
+
+    float* c_row = c + n * hidden_size + offset;
+    float* h_row = h_next + n * hidden_size + offset;
+    for (const auto v : c10::irange(kVecsPerBlock)) {
+      int64_t count = std::min<int64_t>(Vec::size(), len - v * Vec::size());
+      if (count <= 0) {
+        break;
+      }
+      auto i_gate = lstm_sigmoid(acc[0][v]);
+      auto f_gate = lstm_sigmoid(acc[1][v]);
+      auto g_gate = acc[2][v].tanh();
+      auto o_gate = lstm_sigmoid(acc[3][v]);
+      auto c_new = f_gate * Vec::loadu(c_row + v * Vec::size(), count) +
+          i_gate * g_gate;
+      auto h_new = o_gate * c_new.tanh();
+      c_new.store(c_row + v * Vec::size(), count);
+      h_new.store(h_row + v * Vec::size(), count);
+    }
+    scalar_t* out_row = out_t + n * hidden_size + offset;
+    for (const auto j : c10::irange(len)) {
+      out_row[j] = static_cast<scalar_t>(h_row[j]);
+    }
+  }
+}
+
+template <typename scalar_t>
+void lstm_fused_forward(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    const at::Tensor& hx,
+    const at::Tensor& cx,
+    at::Tensor& output,
+    at::Tensor& hy,
+    at::Tensor& cy,
+    bool reverse) {
+  int64_t seq_length = input.size(0);
+  int64_t batch = input.size(1);
+  int64_t input_size = input.size(2);
+  int64_t hidden_size = hx.size(-1);
+  int64_t num_blocks = weight.size(0);
+  int64_t block_stride = weight.stride(0);
+
+  auto h_buf = at::empty({2, batch, hidden_size}, hx.options());
+  h_buf[0].copy_(hx.view({batch, hidden_size}));
+  auto c_buf = cx.reshape({batch, hidden_size}).clone();
+
+  const float* x_data = input.data_ptr<float>();
+  const float* w_data = weight.data_ptr<float>();
+  const float* b_data = bias.data_ptr<float>();
+  float* h_data = h_buf.data_ptr<float>();
+  float* c_data = c_buf.data_ptr<float>();
+  scalar_t* out_data = output.data_ptr<scalar_t>();
+
+  for (const auto step : c10::irange(seq_length)) {
+    int64_t t = reverse ? seq_length - 1 - step : step;
+    const float* x_t = x_data + t * batch * input_size;
+    const float* h_prev = h_data + (step % 2) * batch * hidden_size;
+    float* h_next = h_data + ((step + 1) % 2) * batch * hidden_size;
+    scalar_t* out_t = out_data + t * batch * hidden_size;
+    // Hidden blocks are statically partitioned, so every thread works on the
+    // same weight slice at each step and the slice stays in its L2.
+    at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+      for (const auto jb : c10::irange(begin, end)) {
+        int64_t offset = jb * kLstmFusedBlockSize;
+        lstm_cell_block<scalar_t>(
+            x_t,
+            h_prev,
+            w_data + jb * block_stride,
+            b_data + jb * 4 * kLstmFusedBlockSize,
+            c_data,
+            h_next,
+            out_t,
+            batch,
+            input_size,
+            hidden_size,
+            offset,
+            std::min(kLstmFusedBlockSize, hidden_size - offset));
+      }
+    });
+  }
+
+  hy.view({batch, hidden_size}).copy_(h_buf[seq_length % 2]);
+  cy.view({batch, hidden_size}).copy_(c_buf);
+}
+
+void lstm_fused_forward_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& weight,
+    const at::Tensor& bias,
+    const at::Tensor& hx,
+    const at::Tensor& cx,
+    at::Tensor& output,
+    at::Tensor& hy,
+    at::Tensor& cy,
+    bool reverse) {
+  TORCH_CHECK(
+      input.scalar_type() == at::kFloat && hx.scalar_type() == at::kFloat &&
+          cx.scalar_type() == at::kFloat,
+      "lstm_fused_forward: expects float input and hidden states");
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16,
+      output.scalar_type(),
+      "lstm_fused_forward",
+      [&] {
+        lstm_fused_forward<scalar_t>(
+            input, weight, bias, hx, cx, output, hy, cy, reverse);
+      });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(
+    lstm_fused_forward_kernel_stub,
+    &lstm_fused_forward_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -26,89 +26,369 @@ at::Tensor nms_cpu_kernel(
     const float threshold,
     float bias = 1.0);
 
-template <typename scalar_t, bool sorted>
-at::Tensor nms_cpu_kernel(
-    const at::Tensor& dets,
-    const at::Tensor& scores,
+/*
+ The NMS below is a blocked, bitmask based version of the classic greedy
+ NMS. The boxes are gathered in descending score order and processed in
+ blocks of kNmsBlockSize candidates:
+  1. Every candidate of the block is checked (in parallel) against the boxes
+     already kept by the previous blocks.
+  2. The suppression bitmask of the block, i.e. IoU(i, j) >= threshold for
+     i < j inside the block, is computed in parallel over the rows.
+  3. A short serial pass walks the block in score order, keeps the boxes which
+     are not removed yet and ORs their rows into the removed bitmask.
+ A box is suppressed iff one of the kept boxes with higher score overlaps it,
+ so the result is identical to the serial greedy NMS.
+*/
+constexpr int64_t kNmsBlockSize = 1024;
+constexpr int64_t kNmsBitsPerWord = 64;
+constexpr int64_t kNmsWordsPerBlock = kNmsBlockSize / kNmsBitsPerWord;
+
+template <typename scalar_t>
+inline bool nms_is_overlapped(
+    scalar_t ix1,
+    scalar_t iy1,
+    scalar_t ix2,
+    scalar_t iy2,
+    scalar_t iarea,
+    scalar_t jx1,
+    scalar_t jy1,
+    scalar_t jx2,
+    scalar_t jy2,
+    scalar_t jarea,
     const float threshold,
-    float bias) {
-  AT_ASSERTM(!dets.is_cuda(), "dets must be a CPU tensor");
-  AT_ASSERTM(!scores.is_cuda(), "scores must be a CPU tensor");
-  AT_ASSERTM(
-      dets.scalar_type() == scores.scalar_type(),
-      "dets should have the same type as scores");
+    const scalar_t bias) {
+  auto xx1 = std::max(ix1, jx1);
+  auto yy1 = std::max(iy1, jy1);
+  auto xx2 = std::min(ix2, jx2);
+  auto yy2 = std::min(iy2, jy2);
+
+  auto w = std::max(static_cast<scalar_t>(0), xx2 - xx1 + bias);
+  auto h = std::max(static_cast<scalar_t>(0), yy2 - yy1 + bias);
+  auto inter = w * h;
+  auto ovr = inter / (iarea + jarea - inter);
+  return ovr >= threshold;
+}
 
-  if (dets.numel() == 0) {
-    return at::empty({0}, dets.options().dtype(at::kLong).device(at::kCPU));
+// Set bit (j - base) of mask for every box j in [start, end) which is
+// overlapped by box i. `boxes` is the SoA buffer [x1, y1, x2, y2, areas] with
+// a stride of `ndets` elements.
+template <typename scalar_t>
+inline void nms_overlap_row(
+    const scalar_t* boxes,
+    int64_t ndets,
+    int64_t i,
+    int64_t base,
+    int64_t start,
+    int64_t end,
+    const float threshold,
+    const scalar_t bias,
+    uint64_t* mask) {
+  auto x1 = boxes;
+  auto y1 = boxes + ndets;
+  auto x2 = boxes + 2 * ndets;
+  auto y2 = boxes + 3 * ndets;
+  auto areas = boxes + 4 * ndets;
+  for (int64_t j = start; j < end; j++) {
+    if (nms_is_overlapped(
+            x1[i],
+            y1[i],
+            x2[i],
+            y2[i],
+            areas[i],
+            x1[j],
+            y1[j],
+            x2[j],
+            y2[j],
+            areas[j],
+            threshold,
+            bias)) {
+      mask[(j - base) / kNmsBitsPerWord] |= uint64_t(1)
+          << ((j - base) % kNmsBitsPerWord);
+    }
   }
+}
 
-  auto x1_t = dets.select(1, 0).contiguous();
-  auto y1_t = dets.select(1, 1).contiguous();
-  auto x2_t = dets.select(1, 2).contiguous();
-  auto y2_t = dets.select(1, 3).contiguous();
+// Return true if box j of `boxes` is overlapped by any of the `nkept` boxes
+// in the SoA buffer `kept` (stride `ndets`).
+template <typename scalar_t>
+inline bool nms_overlap_any(
+    const scalar_t* boxes,
+    const scalar_t* kept,
+    int64_t ndets,
+    int64_t nkept,
+    int64_t j,
+    const float threshold,
+    const scalar_t bias) {
+  for (int64_t k = 0; k < nkept; k++) {
+    if (nms_is_overlapped(
+            kept[k],
+            kept[ndets + k],
+            kept[2 * ndets + k],
+            kept[3 * ndets + k],
+            kept[4 * ndets + k],
+            boxes[j],
+            boxes[ndets + j],
+            boxes[2 * ndets + j],
+            boxes[3 * ndets + j],
+            boxes[4 * ndets + j],
+            threshold,
+            bias)) {
+      return true;
+    }
+  }
+  return false;
+}
 
-  at::Tensor areas_t = (x2_t - x1_t + bias) * (y2_t - y1_t + bias);
+#if defined(CPU_CAPABILITY_AVX512)
+// IoU of the broadcasted box i against the 16 boxes starting at offset j.
+// Same operation order as nms_is_overlapped to get bitwise identical results.
+inline __mmask16 _nms_overlap_mask16(
+    __m512 m512_ix1,
+    __m512 m512_iy1,
+    __m512 m512_ix2,
+    __m512 m512_iy2,
+    __m512 m512_iarea,
+    const float* boxes,
+    int64_t ndets,
+    int64_t j,
+    __mmask16 load_mask,
+    __m512 m512_threshold,
+    __m512 m512_bias) {
+  __m512 m512_zero = _mm512_setzero_ps();
+  __m512 m512_x1 = _mm512_maskz_loadu_ps(load_mask, boxes + j);
+  __m512 m512_y1 = _mm512_maskz_loadu_ps(load_mask, boxes + ndets + j);
+  __m512 m512_x2 = _mm512_maskz_loadu_ps(load_mask, boxes + 2 * ndets + j);
+  __m512 m512_y2 = _mm512_maskz_loadu_ps(load_mask, boxes + 3 * ndets + j);
+  __m512 m512_areas = _mm512_maskz_loadu_ps(load_mask, boxes + 4 * ndets + j);
+
+  __m512 m512_xx1 = _mm512_max_ps(m512_ix1, m512_x1);
+  __m512 m512_yy1 = _mm512_max_ps(m512_iy1, m512_y1);
+  __m512 m512_xx2 = _mm512_min_ps(m512_ix2, m512_x2);
+  __m512 m512_yy2 = _mm512_min_ps(m512_iy2, m512_y2);
+
+  __m512 m512_w = _mm512_max_ps(
+      m512_zero, _mm512_add_ps(_mm512_sub_ps(m512_xx2, m512_xx1), m512_bias));
+  __m512 m512_h = _mm512_max_ps(
+      m512_zero, _mm512_add_ps(_mm512_sub_ps(m512_yy2, m512_yy1), m512_bias));
+  __m512 m512_inter = _mm512_mul_ps(m512_w, m512_h);
+  __m512 m512_over = _mm512_div_ps(
+      m512_inter,
+      _mm512_sub_ps(_mm512_add_ps(m512_iarea, m512_areas), m512_inter));
+  return _mm512_mask_cmp_ps_mask(
+      load_mask, m512_over, m512_threshold, _CMP_GE_OS);
+}
 
-  auto ndets = dets.size(0);
-  // If scores and dets are already sorted in descending order, we don't need to
-  // sort it again.
-  auto order_t = sorted
-      ? at::arange(0, ndets, scores.options().dtype(at::kLong))
-      : std::get<1>(scores.sort(0, /* descending=*/true));
-
-  at::Tensor suppressed_t =
-      at::zeros({ndets}, dets.options().dtype(at::kByte).device(at::kCPU));
-
-  auto suppressed = suppressed_t.data_ptr<uint8_t>();
-  auto order = order_t.data_ptr<int64_t>();
-  auto x1 = x1_t.data_ptr<scalar_t>();
-  auto y1 = y1_t.data_ptr<scalar_t>();
-  auto x2 = x2_t.data_ptr<scalar_t>();
-  auto y2 = y2_t.data_ptr<scalar_t>();
-  auto areas = areas_t.data_ptr<scalar_t>();
-  for (int64_t _i = 0; _i < ndets; _i++) {
-    auto i = order[_i];
-    if (suppressed[i] == 1)
-      continue;
-    auto ix1 = x1[i];
-    auto iy1 = y1[i];
-    auto ix2 = x2[i];
-    auto iy2 = y2[i];
-    auto iarea = areas[i];
+template <>
+inline void nms_overlap_row<float>(
+    const float* boxes,
+    int64_t ndets,
+    int64_t i,
+    int64_t base,
+    int64_t start,
+    int64_t end,
+    const float threshold,
+    const float bias,
+    uint64_t* mask) {
+  __m512 m512_ix1 = _mm512_set1_ps(boxes[i]);
+  __m512 m512_iy1 = _mm512_set1_ps(boxes[ndets + i]);
+  __m512 m512_ix2 = _mm512_set1_ps(boxes[2 * ndets + i]);
+  __m512 m512_iy2 = _mm512_set1_ps(boxes[3 * ndets + i]);
+  __m512 m512_iarea = _mm512_set1_ps(boxes[4 * ndets + i]);
+  __m512 m512_threshold = _mm512_set1_ps(threshold);
+  __m512 m512_bias = _mm512_set1_ps(bias);
+  // Start from a 16-aligned offset (relative to base) so that each __mmask16
+  // lands in a single 64-bit word. The extra bits at or before i are never
+  // read by the reduction pass.
+  for (int64_t j = base + (start - base) / 16 * 16; j < end; j += 16) {
+    int64_t left = end - j;
+    __mmask16 load_mask = left >= 16 ? 0xffff : (1 << left) - 1;
+    __mmask16 mask_sus = _nms_overlap_mask16(
+        m512_ix1,
+        m512_iy1,
+        m512_ix2,
+        m512_iy2,
+        m512_iarea,
+        boxes,
+        ndets,
+        j,
+        load_mask,
+        m512_threshold,
+        m512_bias);
+    mask[(j - base) / kNmsBitsPerWord] |= static_cast<uint64_t>(mask_sus)
+        << ((j - base) % kNmsBitsPerWord);
+  }
+}
 
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
+template <>
+inline bool nms_overlap_any<float>(
+    const float* boxes,
+    const float* kept,
+    int64_t ndets,
+    int64_t nkept,
+    int64_t j,
+    const float threshold,
+    const float bias) {
+  // IoU is symmetric, so broadcast box j and compare it with 16 kept boxes
+  // per instruction.
+  __m512 m512_jx1 = _mm512_set1_ps(boxes[j]);
+  __m512 m512_jy1 = _mm512_set1_ps(boxes[ndets + j]);
+  __m512 m512_jx2 = _mm512_set1_ps(boxes[2 * ndets + j]);
+  __m512 m512_jy2 = _mm512_set1_ps(boxes[3 * ndets + j]);
+  __m512 m512_jarea = _mm512_set1_ps(boxes[4 * ndets + j]);
+  __m512 m512_threshold = _mm512_set1_ps(threshold);
+  __m512 m512_bias = _mm512_set1_ps(bias);
+  for (int64_t k = 0; k < nkept; k += 16) {
+    int64_t left = nkept - k;
+    __mmask16 load_mask = left >= 16 ? 0xffff : (1 << left) - 1;
+    if (_nms_overlap_mask16(
+            m512_jx1,
+            m512_jy1,
+            m512_jx2,
+            m512_jy2,
+            m512_jarea,
+            kept,
+            ndets,
+            k,
+            load_mask,
+            m512_threshold,
+            m512_bias)) {
+      return true;
+    }
+  }
+  return false;
+}
 #endif
-    for (int64_t _j = _i + 1; _j < ndets; _j++) {
-      auto j = order[_j];
-      if (suppressed[j] == 1)
+
+// Reusable buffers of the blocked NMS. One workspace is owned by each thread
+// of the batched NMS kernels, so the buffers are only allocated once per call.
+template <typename scalar_t>
+struct NmsWorkspace {
+  // SoA buffer [x1, y1, x2, y2, areas] of the candidates in score order.
+  std::vector<scalar_t> boxes;
+  // Kept boxes, same layout as boxes.
+  std::vector<scalar_t> kept;
+  std::vector<uint64_t> removed;
+  std::vector<uint64_t> block_mask;
+  // Positions (in score order) of the kept candidates.
+  std::vector<int64_t> kept_pos;
+
+  NmsWorkspace()
+      : removed(kNmsWordsPerBlock),
+        block_mask(kNmsBlockSize * kNmsWordsPerBlock) {}
+
+  void resize(int64_t ndets) {
+    // std::vector::resize never shrinks the capacity, so the workspace only
+    // grows to the largest candidate number it has seen.
+    boxes.resize(5 * ndets);
+    kept.resize(5 * ndets);
+    kept_pos.clear();
+  }
+};
+
+// Greedy NMS over the ndets candidates gathered in ws.boxes. The positions of
+// the kept candidates are appended to ws.kept_pos in ascending order.
+template <typename scalar_t>
+void nms_sorted_boxes(
+    NmsWorkspace<scalar_t>& ws,
+    int64_t ndets,
+    const float threshold,
+    const scalar_t bias) {
+  auto boxes = ws.boxes.data();
+  auto kept = ws.kept.data();
+  auto& removed = ws.removed;
+  auto& block_mask = ws.block_mask;
+  int64_t nkept = 0;
+  for (int64_t block_begin = 0; block_begin < ndets;
+       block_begin += kNmsBlockSize) {
+    auto block_end = std::min(block_begin + kNmsBlockSize, ndets);
+    auto block_words = (block_end - block_begin + kNmsBitsPerWord - 1) /
+        kNmsBitsPerWord;
+
+    // Step1: suppress the candidates overlapped by boxes kept in the previous
+    // blocks. Each thread owns whole words of the removed bitmask.
+    std::fill(removed.begin(), removed.end(), 0);
+    if (nkept > 0) {
+      at::parallel_for(0, block_words, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t w = begin; w < end; w++) {
+          auto j_begin = block_begin + w * kNmsBitsPerWord;
+          auto j_end = std::min(j_begin + kNmsBitsPerWord, block_end);
+          uint64_t bits = 0;
+          for (int64_t j = j_begin; j < j_end; j++) {
+            if (nms_overlap_any<scalar_t>(
+                    boxes, kept, ndets, nkept, j, threshold, bias)) {
+              bits |= uint64_t(1) << (j - j_begin);
+            }
+          }
+          removed[w] = bits;
+        }
+      });
+    }
+
+    // Step2: suppression bitmask inside the block, one row per candidate.
+    at::parallel_for(
+        block_begin, block_end, 16, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; i++) {
+            auto local = i - block_begin;
+            auto row = block_mask.data() + local * kNmsWordsPerBlock;
+            std::fill(row, row + block_words, 0);
+            if ((removed[local / kNmsBitsPerWord] >>
+                 (local % kNmsBitsPerWord)) &
+                1) {
+              // Never kept, so its row is never read.
+              continue;
+            }
+            nms_overlap_row<scalar_t>(
+                boxes,
+                ndets,
+                i,
+                block_begin,
+                i + 1,
+                block_end,
+                threshold,
+                bias,
+                row);
+          }
+        });
+
+    // Step3: serial greedy reduction over the block.
+    for (int64_t i = block_begin; i < block_end; i++) {
+      auto local = i - block_begin;
+      auto word = local / kNmsBitsPerWord;
+      if ((removed[word] >> (local % kNmsBitsPerWord)) & 1) {
         continue;
-      auto xx1 = std::max(ix1, x1[j]);
-      auto yy1 = std::max(iy1, y1[j]);
-      auto xx2 = std::min(ix2, x2[j]);
-      auto yy2 = std::min(iy2, y2[j]);
-
-      auto w = std::max(static_cast<scalar_t>(0), xx2 - xx1 + bias);
-      auto h = std::max(static_cast<scalar_t>(0), yy2 - yy1 + bias);
-      auto inter = w * h;
-      auto ovr = inter / (iarea + areas[j] - inter);
-      if (ovr >= threshold)
-        suppressed[j] = 1;
+      }
+      for (int64_t c = 0; c < 5; c++) {
+        kept[c * ndets + nkept] = boxes[c * ndets + i];
+      }
+      ws.kept_pos.push_back(i);
+      nkept++;
+      auto row = block_mask.data() + local * kNmsWordsPerBlock;
+      for (int64_t w = word; w < block_words; w++) {
+        removed[w] |= row[w];
+      }
     }
   }
-  return at::nonzero(suppressed_t == 0).squeeze(1);
 }
 
-#ifdef CPU_CAPABILITY_AVX512
-// Optimized nms_cpu_kernel specialized for data type: float32 and sorted_score
-template <>
-at::Tensor nms_cpu_kernel</*scalar_t*/ float, /*sorted*/ true>(
+// Gather the box `src` (4 contiguous coordinates) into position i of the SoA
+// buffer of ws.
+template <typename scalar_t>
+inline void nms_gather_box(
+    NmsWorkspace<scalar_t>& ws,
+    int64_t ndets,
+    int64_t i,
+    const scalar_t* src,
+    const scalar_t bias) {
+  auto boxes = ws.boxes.data();
+  boxes[i] = src[0];
+  boxes[ndets + i] = src[1];
+  boxes[2 * ndets + i] = src[2];
+  boxes[3 * ndets + i] = src[3];
+  boxes[4 * ndets + i] = (src[2] - src[0] + bias) * (src[3] - src[1] + bias);
+}
+
+template <typename scalar_t, bool sorted>
+at::Tensor nms_cpu_kernel(
     const at::Tensor& dets,
     const at::Tensor& scores,
     const float threshold,
@@ -119,265 +399,163 @@ at::Tensor nms_cpu_kernel</*scalar_t*/ float, /*sorted*/ true>(
       dets.scalar_type() == scores.scalar_type(),
       "dets should have the same type as scores");
 
-  AT_ASSERTM(dets.sizes().size() == 2, "dets should have 2 dimension");
-  AT_ASSERTM(scores.sizes().size() == 1, "scores should have 1 dimension");
+  if (dets.numel() == 0) {
+    return at::empty({0}, dets.options().dtype(at::kLong).device(at::kCPU));
+  }
 
-  at::Tensor dets_bbox_number_in_lastdim = dets.permute({1, 0}).contiguous();
+  AT_ASSERTM(dets.sizes().size() == 2, "dets should have 2 dimension");
   AT_ASSERTM(
-      dets_bbox_number_in_lastdim.size(1) == scores.size(0),
-      "dets should have number of bboxs as scores");
+      dets.size(1) == 4, "each bbox in dets should have 4 coordinates");
   AT_ASSERTM(
-      dets_bbox_number_in_lastdim.size(0) == 4,
-      "each bbox in dets should have 4 coordinates");
-
-  if (dets_bbox_number_in_lastdim.numel() == 0) {
-    return at::empty(
-        {0},
-        dets_bbox_number_in_lastdim.options().dtype(at::kLong).device(
-            at::kCPU));
+      dets.size(0) == scores.size(0),
+      "dets should have number of bboxs as scores");
+
+  auto ndets = dets.size(0);
+  // If scores and dets are already sorted in descending order, we don't need to
+  // sort it again.
+  at::Tensor order_t;
+  if (!sorted) {
+    order_t = std::get<1>(scores.sort(0, /* descending=*/true));
   }
+  auto order = sorted ? nullptr : order_t.data_ptr<int64_t>();
+  auto scalar_bias = static_cast<scalar_t>(bias);
+
+  // Gather the boxes in score order, so that all the passes of the NMS read
+  // contiguous memory.
+  auto dets_contig = dets.contiguous();
+  auto dets_data = dets_contig.data_ptr<scalar_t>();
+  NmsWorkspace<scalar_t> ws;
+  ws.resize(ndets);
+  at::parallel_for(0, ndets, 2048, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      nms_gather_box(
+          ws, ndets, i, dets_data + (sorted ? i : order[i]) * 4, scalar_bias);
+    }
+  });
 
-  auto x1_t = dets_bbox_number_in_lastdim.select(0, 0).contiguous();
-  auto y1_t = dets_bbox_number_in_lastdim.select(0, 1).contiguous();
-  auto x2_t = dets_bbox_number_in_lastdim.select(0, 2).contiguous();
-  auto y2_t = dets_bbox_number_in_lastdim.select(0, 3).contiguous();
-
-  auto ndets = dets_bbox_number_in_lastdim.size(1);
-  auto ndets_up_scale = (ndets / 16 + 1) * 16;
-  auto ndets_down_scale = (ndets / 16) * 16;
-  at::Tensor&& areas_t =
-      at::zeros({ndets}, dets_bbox_number_in_lastdim.options()).contiguous();
-  auto areas = areas_t.data_ptr<float>();
-  auto x1 = x1_t.data_ptr<float>();
-  auto y1 = y1_t.data_ptr<float>();
-  auto x2 = x2_t.data_ptr<float>();
-  auto y2 = y2_t.data_ptr<float>();
-  __m512 m512_zero = _mm512_setzero_ps();
-  __m512 m512_bias = _mm512_set1_ps(bias);
-  __m128i m128_zeroi = _mm_setzero_si128();
+  nms_sorted_boxes(ws, ndets, threshold, scalar_bias);
 
-  // Step1: Calculate the area of all bbox's
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  for (int i = 0; i < ndets_up_scale; i += 16) {
-    __m512 m512_x1;
-    __m512 m512_x2;
-    __m512 m512_y1;
-    __m512 m512_y2;
-    __m512 m512_result;
-    if (i < ndets_down_scale) {
-      // vector
-      m512_x1 = _mm512_loadu_ps(x1 + i);
-      m512_x2 = _mm512_loadu_ps(x2 + i);
-      m512_y1 = _mm512_loadu_ps(y1 + i);
-      m512_y2 = _mm512_loadu_ps(y2 + i);
-      if (bias == 0) {
-        m512_result = _mm512_mul_ps(
-            _mm512_sub_ps(m512_x2, m512_x1), _mm512_sub_ps(m512_y2, m512_y1));
-      } else {
-        m512_result = _mm512_mul_ps(
-            _mm512_add_ps(_mm512_sub_ps(m512_x2, m512_x1), m512_bias),
-            _mm512_add_ps(_mm512_sub_ps(m512_y2, m512_y1), m512_bias));
-      }
-      _mm512_storeu_ps(areas + i, m512_result);
-    } else {
-      // tail case
-      unsigned short left_idx = ndets - ndets_down_scale;
-      __mmask16 mask = (1 << left_idx) - 1; // 0x03ff;
-      m512_x1 = _mm512_mask_loadu_ps(m512_zero, mask, x1 + i);
-      m512_x2 = _mm512_mask_loadu_ps(m512_zero, mask, x2 + i);
-      m512_y1 = _mm512_mask_loadu_ps(m512_zero, mask, y1 + i);
-      m512_y2 = _mm512_mask_loadu_ps(m512_zero, mask, y2 + i);
-      if (bias == 0) {
-        m512_result = _mm512_mask_mul_ps(
-            m512_zero,
-            mask,
-            _mm512_mask_sub_ps(m512_zero, mask, m512_x2, m512_x1),
-            _mm512_mask_sub_ps(m512_zero, mask, m512_y2, m512_y1));
-      } else {
-        m512_result = _mm512_mask_mul_ps(
-            m512_zero,
-            mask,
-            _mm512_mask_add_ps(
-                m512_zero,
-                mask,
-                _mm512_mask_sub_ps(m512_zero, mask, m512_x2, m512_x1),
-                m512_bias),
-            _mm512_mask_add_ps(
-                m512_zero,
-                mask,
-                _mm512_mask_sub_ps(m512_zero, mask, m512_y2, m512_y1),
-                m512_bias));
-      }
-      _mm512_mask_storeu_ps(areas + i, mask, m512_result);
-    }
+  auto nkept = static_cast<int64_t>(ws.kept_pos.size());
+  at::Tensor keep_t =
+      at::empty({nkept}, dets.options().dtype(at::kLong).device(at::kCPU));
+  auto keep = keep_t.data_ptr<int64_t>();
+  for (int64_t k = 0; k < nkept; k++) {
+    keep[k] = sorted ? ws.kept_pos[k] : order[ws.kept_pos[k]];
   }
-  // Step2: Go through the NMS flow
-  at::Tensor suppressed_t = at::zeros(
-      {ndets},
-      dets_bbox_number_in_lastdim.options().dtype(at::kByte).device(at::kCPU));
-  auto suppressed = suppressed_t.data_ptr<uint8_t>();
-  for (int64_t i = 0; i < ndets; i++) {
-    if (suppressed[i] == 1)
-      continue;
-    auto ix1 = x1[i];
-    auto iy1 = y1[i];
-    auto ix2 = x2[i];
-    auto iy2 = y2[i];
-    auto iarea = areas[i];
-
-    __m512 m512_ix1 = _mm512_set1_ps(ix1);
-    __m512 m512_ix2 = _mm512_set1_ps(ix2);
-    __m512 m512_iy1 = _mm512_set1_ps(iy1);
-    __m512 m512_iy2 = _mm512_set1_ps(iy2);
-    __m512 m512_iarea = _mm512_set1_ps(iarea);
-    __m512 m512_threshold = _mm512_set1_ps(threshold);
-
-    auto ndets_i_up_scale = ((ndets - i - 1) / 16 + 1) * 16;
-    auto ndets_i_down_scale = ((ndets - i - 1) / 16) * 16;
+  // Return the kept indexes in ascending order as the nonzero based version
+  // did.
+  if (!sorted) {
+    std::sort(keep, keep + nkept);
+  }
+  return keep_t;
+}
 
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-    for (int64_t _j = 0; _j < ndets_i_up_scale; _j += 16) {
-      if (_j < ndets_i_down_scale) {
-        int64_t j = _j + i + 1;
-        __m512 m512_x1 = _mm512_loadu_ps(x1 + j);
-        __m512 m512_x2 = _mm512_loadu_ps(x2 + j);
-        __m512 m512_y1 = _mm512_loadu_ps(y1 + j);
-        __m512 m512_y2 = _mm512_loadu_ps(y2 + j);
-
-        __m512 m512_xx1 = _mm512_max_ps(m512_ix1, m512_x1);
-        __m512 m512_yy1 = _mm512_max_ps(m512_iy1, m512_y1);
-        __m512 m512_xx2 = _mm512_min_ps(m512_ix2, m512_x2);
-        __m512 m512_yy2 = _mm512_min_ps(m512_iy2, m512_y2);
-
-        __m512 m512_w;
-        __m512 m512_h;
-        if (bias == 0) {
-          m512_w = _mm512_max_ps(m512_zero, _mm512_sub_ps(m512_xx2, m512_xx1));
-          m512_h = _mm512_max_ps(m512_zero, _mm512_sub_ps(m512_yy2, m512_yy1));
-        } else {
-          m512_w = _mm512_max_ps(
-              m512_zero,
-              _mm512_add_ps(_mm512_sub_ps(m512_xx2, m512_xx1), m512_bias));
-          m512_h = _mm512_max_ps(
-              m512_zero,
-              _mm512_add_ps(_mm512_sub_ps(m512_yy2, m512_yy1), m512_bias));
-        }
+// Detections of one (image, class) pair: indexes of the kept boxes in the
+// source and their scores.
+template <typename scalar_t>
+struct ClassDetections {
+  std::vector<int64_t> index;
+  std::vector<scalar_t> score;
+};
 
-        __m512 m512_inter = _mm512_mul_ps(m512_w, m512_h);
-        __m512 m512_areas = _mm512_loadu_ps(areas + j);
-        __m512 m512_over = _mm512_div_ps(
-            m512_inter,
-            _mm512_sub_ps(_mm512_add_ps(m512_iarea, m512_areas), m512_inter));
-        __mmask16 mask_sus =
-            _mm512_cmp_ps_mask(m512_over, m512_threshold, _CMP_GE_OS);
-        __m128i res_sus = _mm_mask_set1_epi8(m128_zeroi, mask_sus, 1);
-        _mm_mask_storeu_epi8(suppressed + j, mask_sus, res_sus);
-
-      } else {
-        // Tail case
-        int64_t j = _j + i + 1;
-        int64_t idx_left = ndets - j;
-        __mmask16 load_mask = (1 << idx_left) - 1;
-
-        __m512 m512_x1 = _mm512_mask_loadu_ps(m512_zero, load_mask, x1 + j);
-        __m512 m512_x2 = _mm512_mask_loadu_ps(m512_zero, load_mask, x2 + j);
-        __m512 m512_y1 = _mm512_mask_loadu_ps(m512_zero, load_mask, y1 + j);
-        __m512 m512_y2 = _mm512_mask_loadu_ps(m512_zero, load_mask, y2 + j);
-
-        __m512 m512_xx1 =
-            _mm512_mask_max_ps(m512_zero, load_mask, m512_ix1, m512_x1);
-        __m512 m512_yy1 =
-            _mm512_mask_max_ps(m512_zero, load_mask, m512_iy1, m512_y1);
-        __m512 m512_xx2 =
-            _mm512_mask_min_ps(m512_zero, load_mask, m512_ix2, m512_x2);
-        __m512 m512_yy2 =
-            _mm512_mask_min_ps(m512_zero, load_mask, m512_iy2, m512_y2);
-
-        __m512 m512_w;
-        __m512 m512_h;
-        if (bias == 0) {
-          m512_w = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_sub_ps(m512_zero, load_mask, m512_xx2, m512_xx1));
-          m512_h = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_sub_ps(m512_zero, load_mask, m512_yy2, m512_yy1));
-        } else {
-          m512_w = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_add_ps(
-                  m512_zero,
-                  load_mask,
-                  _mm512_mask_sub_ps(m512_zero, load_mask, m512_xx2, m512_xx1),
-                  m512_bias));
-          m512_h = _mm512_mask_max_ps(
-              m512_zero,
-              load_mask,
-              m512_zero,
-              _mm512_mask_add_ps(
-                  m512_zero,
-                  load_mask,
-                  _mm512_mask_sub_ps(m512_zero, load_mask, m512_yy2, m512_yy1),
-                  m512_bias));
-        }
-        __m512 m512_inter =
-            _mm512_mask_mul_ps(m512_zero, load_mask, m512_w, m512_h);
-        __m512 m512_areas =
-            _mm512_mask_loadu_ps(m512_zero, load_mask, areas + j);
-        __m512 m512_over = _mm512_mask_div_ps(
-            m512_zero,
-            load_mask,
-            m512_inter,
-            _mm512_mask_sub_ps(
-                m512_zero,
-                load_mask,
-                _mm512_mask_add_ps(
-                    m512_zero, load_mask, m512_iarea, m512_areas),
-                m512_inter));
-        __mmask16 mask_sus = _mm512_mask_cmp_ps_mask(
-            load_mask, m512_over, m512_threshold, _CMP_GE_OS);
-        __m128i res_sus = _mm_mask_set1_epi8(m128_zeroi, mask_sus, 1);
-        _mm_mask_storeu_epi8(suppressed + j, mask_sus, res_sus);
+template <typename scalar_t>
+using ScoreIndex = std::pair<scalar_t, int64_t>;
+
+// Descending score, ascending index for the equal scores.
+template <typename scalar_t>
+inline bool score_index_greater(
+    const ScoreIndex<scalar_t>& a,
+    const ScoreIndex<scalar_t>& b) {
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+/*
+ Fused post-processing of one (image, class) pair, shared by batch_score_nms
+ and box_head_nms. No tensor is materialized:
+  1. the boxes whose score is larger than score_thresh are filtered in place;
+  2. the top_k highest scores are kept with a bounded min-heap (top_k <= 0
+     keeps all of them) and sorted in descending order;
+  3. the candidates are gathered into the per-thread workspace and go through
+     the blocked NMS, unless run_nms is false.
+ The kept detections are written to `out` in descending score order, or in
+ ascending source index order when `source_order` is true.
+
+ Box b is the 4 contiguous coordinates at dets + b * det_stride and its score
+ is scores[b * score_stride].
+*/
+template <typename scalar_t>
+void class_score_nms(
+    const scalar_t* dets,
+    int64_t det_stride,
+    const scalar_t* scores,
+    int64_t score_stride,
+    int64_t ndets,
+    const scalar_t score_thresh,
+    const int64_t top_k,
+    const float threshold,
+    const bool run_nms,
+    const scalar_t bias,
+    const bool source_order,
+    std::vector<ScoreIndex<scalar_t>>& candidates,
+    NmsWorkspace<scalar_t>& ws,
+    ClassDetections<scalar_t>& out) {
+  auto greater = score_index_greater<scalar_t>;
+  candidates.clear();
+  for (int64_t b = 0; b < ndets; b++) {
+    auto s = scores[b * score_stride];
+    if (!(s > score_thresh)) {
+      continue;
+    }
+    if (top_k <= 0 || static_cast<int64_t>(candidates.size()) < top_k) {
+      candidates.emplace_back(s, b);
+      if (static_cast<int64_t>(candidates.size()) == top_k) {
+        // The heap front is the lowest score kept so far.
+        std::make_heap(candidates.begin(), candidates.end(), greater);
       }
+    } else if (greater(ScoreIndex<scalar_t>(s, b), candidates.front())) {
+      std::pop_heap(candidates.begin(), candidates.end(), greater);
+      candidates.back() = ScoreIndex<scalar_t>(s, b);
+      std::push_heap(candidates.begin(), candidates.end(), greater);
     }
   }
-  return at::nonzero(suppressed_t == 0).squeeze(1);
-}
-#endif
-
-std::vector<at::Tensor> remove_empty(
-    std::vector<at::Tensor>& candidate,
-    int64_t start,
-    int64_t end) {
-  std::vector<at::Tensor> valid_candidate;
-  for (int64_t i = start; i < end; i++) {
-    if (candidate[i].defined()) {
-      valid_candidate.push_back(candidate[i]);
+  std::sort(candidates.begin(), candidates.end(), greater);
+
+  out.index.clear();
+  out.score.clear();
+  int64_t ncandidates = candidates.size();
+  if (run_nms) {
+    ws.resize(ncandidates);
+    for (int64_t p = 0; p < ncandidates; p++) {
+      nms_gather_box(
+          ws,
+          ncandidates,
+          p,
+          dets + candidates[p].second * det_stride,
+          bias);
+    }
+    nms_sorted_boxes(ws, ncandidates, threshold, bias);
+    // Compact the kept candidates to the front of the candidate buffer.
+    int64_t nkept = ws.kept_pos.size();
+    for (int64_t k = 0; k < nkept; k++) {
+      candidates[k] = candidates[ws.kept_pos[k]];
     }
+    candidates.resize(nkept);
+  }
+
+  if (source_order) {
+    std::sort(
+        candidates.begin(),
+        candidates.end(),
+        [](const ScoreIndex<scalar_t>& a, const ScoreIndex<scalar_t>& b) {
+          return a.second < b.second;
+        });
+  }
+  out.index.reserve(candidates.size());
+  out.score.reserve(candidates.size());
+  for (const auto& c : candidates) {
+    out.score.push_back(c.first);
+    out.index.push_back(c.second);
   }
-  return valid_candidate;
 }
 
 template <typename scalar_t>
@@ -396,110 +574,123 @@ batch_score_nms_kernel(
   auto ndets = batch_scores.size(1); // number of boxes
   auto nscore = batch_scores.size(2); // number of labels
 
+  auto dets_contig = batch_dets.contiguous();
+  auto scores_contig = batch_scores.contiguous();
+  auto dets_data = dets_contig.data_ptr<scalar_t>();
+  auto scores_data = scores_contig.data_ptr<scalar_t>();
+
   auto nbatch_x_nscore =
       nbatch * nscore; // (number of batches) * (number of labels)
-  std::vector<at::Tensor> bboxes_out(nbatch_x_nscore);
-  std::vector<at::Tensor> scores_out(nbatch_x_nscore);
-  std::vector<at::Tensor> labels_out(nbatch_x_nscore);
+  std::vector<ClassDetections<scalar_t>> detections(nbatch_x_nscore);
+  int max_threads = at::get_num_threads();
+  std::vector<NmsWorkspace<scalar_t>> workspaces(max_threads);
+  std::vector<std::vector<ScoreIndex<scalar_t>>> candidates(max_threads);
+
+  // Parallel in the dimentaion of: batch * nscore
+  at::parallel_for(0, nbatch_x_nscore, 1, [&](int64_t begin, int64_t end) {
+    int tid = at::get_thread_num();
+    for (int64_t index = begin; index < end; index++) {
+      auto bs = index / nscore;
+      auto i = index % nscore;
+
+      // skip background (i = 0)
+      if (i == 0) {
+        continue;
+      }
 
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  // skip background (i = 0)
-  for (int index = 0; index < nbatch_x_nscore; index++) {
-    // Parallel in the dimentaion of: batch * nscore
-    auto bs = index / nscore;
-    auto i = index % nscore;
-
-    // skip background (i = 0)
-    if (i == 0) {
-      continue;
+      class_score_nms<scalar_t>(
+          dets_data + bs * ndets * 4,
+          /*det_stride*/ 4,
+          scores_data + bs * ndets * nscore + i,
+          /*score_stride*/ nscore,
+          ndets,
+          /*score_thresh*/ static_cast<scalar_t>(0.05),
+          /*top_k*/ max_output,
+          threshold,
+          // a non-positive threshold suppresses every overlapping box
+          /*run_nms*/ true,
+          /*bias*/ 0,
+          /*source_order*/ false,
+          candidates[tid],
+          workspaces[tid],
+          detections[index]);
     }
+  });
 
-    at::Tensor dets = batch_dets[bs].squeeze(
-        0); // dets for boxes per image: (num_bbox, 4); For example: (15130, 4)
-    at::Tensor scores =
-        batch_scores[bs].squeeze(0); // scores for boxes per image: (num_bbox,
-                                     // 81); For example: (15130, 81)
-
-    at::Tensor score = scores.slice(1, i, i + 1)
-                           .squeeze(1); // score for boxes per image per class:
-                                        // (num_bbox); For example: (15130)
-
-    at::Tensor mask_index = at::nonzero(score > 0.05).squeeze(1);
-    at::Tensor bboxes = at::index_select(dets, /*dim*/ 0, mask_index);
-    score = at::index_select(score, /*dim*/ 0, mask_index);
-
-    if (score.size(0) == 0) {
-      continue;
+  // Post process the detections to get the top max_output(number) for each
+  // Batchsize. The per class detections are already sorted, so a k-way merge
+  // gives the top scores without the concatenation and the global sort.
+  // (label, position in the class detections) of the selected outputs, in
+  // descending score order.
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> selected(nbatch);
+  at::parallel_for(0, nbatch, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bs = begin; bs < end; bs++) {
+      // (score, label) heads of the class lists, ordered by descending score
+      // and ascending label.
+      std::vector<ScoreIndex<scalar_t>> heads;
+      std::vector<int64_t> cursor(nscore, 0);
+      for (int64_t i = 1; i < nscore; i++) {
+        auto& det = detections[bs * nscore + i];
+        if (det.score.size() > 0) {
+          heads.emplace_back(det.score[0], i);
+        }
+      }
+      // The heap front is the highest score.
+      auto heap_less = [](const ScoreIndex<scalar_t>& a,
+                          const ScoreIndex<scalar_t>& b) {
+        return score_index_greater(b, a);
+      };
+      std::make_heap(heads.begin(), heads.end(), heap_less);
+      auto& sel = selected[bs];
+      sel.reserve(max_output);
+      while (heads.size() > 0 && static_cast<int>(sel.size()) < max_output) {
+        std::pop_heap(heads.begin(), heads.end(), heap_less);
+        auto label = heads.back().second;
+        auto& det = detections[bs * nscore + label];
+        sel.emplace_back(label, cursor[label]);
+        cursor[label]++;
+        if (cursor[label] < static_cast<int64_t>(det.score.size())) {
+          heads.back().first = det.score[cursor[label]];
+          std::push_heap(heads.begin(), heads.end(), heap_less);
+        } else {
+          heads.pop_back();
+        }
+      }
     }
+  });
 
-    at::Tensor score_sliced, score_idx_sorted;
-    // select max_output highest' score and bboxes
-    std::tie(score_sliced, score_idx_sorted) = at::topk(
-        score, (max_output > score.size(0)) ? score.size(0) : max_output, 0);
-    at::Tensor bboxes_sliced =
-        at::index_select(bboxes, /*dim*/ 0, score_idx_sorted);
-
-    at::Tensor keep = nms_cpu_kernel<scalar_t, /*sorted*/ true>(
-        bboxes_sliced, score_sliced, threshold, /*bias*/ 0);
-
-    bboxes_out[index] = at::index_select(bboxes_sliced, /*dim*/ 0, keep);
-    scores_out[index] = at::index_select(score_sliced, /*dim*/ 0, keep);
-    // TODO optimize the fill_
-    labels_out[index] = at::empty({keep.sizes()}).fill_(i);
-  }
-
-  std::vector<at::Tensor> output_bboxes_(nbatch);
-  std::vector<at::Tensor> output_labels_(nbatch);
-  std::vector<at::Tensor> output_scores_(nbatch);
-  std::vector<at::Tensor> output_length_(nbatch);
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  for (int bs = 0; bs < nbatch; bs++) {
-    // Post process the tensors to get the top max_output(number) for each
-    // Batchsize
-    std::vector<at::Tensor> valid_bboxes_out =
-        remove_empty(bboxes_out, bs * nscore, (bs + 1) * nscore);
-    std::vector<at::Tensor> valid_scores_out =
-        remove_empty(scores_out, bs * nscore, (bs + 1) * nscore);
-    std::vector<at::Tensor> valid_labels_out =
-        remove_empty(labels_out, bs * nscore, (bs + 1) * nscore);
-
-    at::Tensor bboxes_out_ = at::cat(valid_bboxes_out, 0);
-    at::Tensor labels_out_ = at::cat(valid_labels_out, 0);
-    at::Tensor scores_out_ = at::cat(valid_scores_out, 0);
-
-    std::tuple<at::Tensor, at::Tensor> sort_result = scores_out_.sort(0);
-    at::Tensor max_ids = std::get<1>(sort_result);
-    max_ids = max_ids.slice(
-        /*dim*/ 0,
-        /*start*/
-        std::max(max_ids.size(0) - max_output, static_cast<int64_t>(0)),
-        /*end*/ max_ids.size(0));
-    output_bboxes_[bs] = bboxes_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
-    output_labels_[bs] = labels_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
-    output_scores_[bs] = scores_out_.index_select(/*dim*/ 0, /*index*/ max_ids);
-    output_length_[bs] = torch::tensor(max_ids.size(0), {torch::kInt32});
+  std::vector<int64_t> output_offset(nbatch + 1, 0);
+  for (int64_t bs = 0; bs < nbatch; bs++) {
+    output_offset[bs + 1] = output_offset[bs] + selected[bs].size();
   }
+  auto noutput = output_offset[nbatch];
+  at::Tensor output_bboxes = at::empty({noutput, 4}, dets_contig.options());
+  at::Tensor output_labels = at::empty({noutput}, at::kFloat);
+  at::Tensor output_scores = at::empty({noutput}, scores_contig.options());
+  at::Tensor output_length = at::empty({nbatch}, at::kInt);
+  auto bboxes_ptr = output_bboxes.data_ptr<scalar_t>();
+  auto labels_ptr = output_labels.data_ptr<float>();
+  auto scores_ptr = output_scores.data_ptr<scalar_t>();
+  auto length_ptr = output_length.data_ptr<int32_t>();
+  at::parallel_for(0, nbatch, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bs = begin; bs < end; bs++) {
+      auto& sel = selected[bs];
+      int64_t nsel = sel.size();
+      length_ptr[bs] = nsel;
+      // The outputs are in ascending score order.
+      for (int64_t k = 0; k < nsel; k++) {
+        auto o = output_offset[bs] + nsel - 1 - k;
+        auto label = sel[k].first;
+        auto& det = detections[bs * nscore + label];
+        auto src = dets_data + (bs * ndets + det.index[sel[k].second]) * 4;
+        std::copy(src, src + 4, bboxes_ptr + o * 4);
+        labels_ptr[o] = label;
+        scores_ptr[o] = det.score[sel[k].second];
+      }
+    }
+  });
   return std::tuple<at::Tensor, at::Tensor, at::Tensor, at::Tensor>(
-      at::cat(output_bboxes_),
-      at::cat(output_labels_),
-      at::cat(output_scores_),
-      at::stack(output_length_));
+      output_bboxes, output_labels, output_scores, output_length);
 }
 
 template <typename scalar_t>
@@ -577,96 +768,118 @@ box_head_nms_kernel(
   auto nbatch_x_nclass =
       nbatch * num_classes; // (number of batches) * (number of labels)
 
-  std::vector<at::Tensor> bboxes_out(nbatch_x_nclass);
-  std::vector<at::Tensor> scores_out(nbatch_x_nclass);
-  std::vector<at::Tensor> labels_out(nbatch_x_nclass);
+  std::vector<at::Tensor> bboxes_in(nbatch);
+  std::vector<at::Tensor> scores_in(nbatch);
+  at::parallel_for(0, nbatch, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bs = begin; bs < end; bs++) {
+      at::Tensor bboxes = batch_bboxes[bs].reshape({-1, 4});
+      auto image_shape = image_shapes[bs];
+      bboxes.slice(1, 0, 1).clamp_(0, std::get<0>(image_shape) - 1);
+      bboxes.slice(1, 1, 2).clamp_(0, std::get<1>(image_shape) - 1);
+      bboxes.slice(1, 2, 3).clamp_(0, std::get<0>(image_shape) - 1);
+      bboxes.slice(1, 3, 4).clamp_(0, std::get<1>(image_shape) - 1);
+      bboxes_in[bs] = bboxes.reshape({-1, num_classes * 4}).contiguous();
+      scores_in[bs] =
+          batch_scores[bs].reshape({-1, num_classes}).contiguous();
+    }
+  });
 
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  for (int bs = 0; bs < nbatch; bs++) {
-    at::Tensor bboxes = batch_bboxes[bs].reshape({-1, 4});
-    at::Tensor scores = batch_scores[bs];
-    auto image_shape = image_shapes[bs];
-    bboxes.slice(1, 0, 1).clamp_(0, std::get<0>(image_shape) - 1);
-    bboxes.slice(1, 1, 2).clamp_(0, std::get<1>(image_shape) - 1);
-    bboxes.slice(1, 2, 3).clamp_(0, std::get<0>(image_shape) - 1);
-    bboxes.slice(1, 3, 4).clamp_(0, std::get<1>(image_shape) - 1);
-    bboxes = bboxes.reshape({-1, num_classes * 4});
-    scores = scores.reshape({-1, num_classes});
-    at::Tensor indexes = scores > score_thresh;
-
-    for (int j = 1; j < num_classes; j++) {
-      at::Tensor index =
-          at::nonzero(indexes.slice(1, j, j + 1).squeeze(1)).squeeze(1);
-      at::Tensor score =
-          scores.slice(1, j, j + 1).squeeze(1).index_select(0, index);
-      at::Tensor bbox =
-          bboxes.slice(1, j * 4, (j + 1) * 4).index_select(0, index);
-      if (score.size(0) == 0) {
+  std::vector<ClassDetections<scalar_t>> detections(nbatch_x_nclass);
+  int max_threads = at::get_num_threads();
+  std::vector<NmsWorkspace<scalar_t>> workspaces(max_threads);
+  std::vector<std::vector<ScoreIndex<scalar_t>>> candidates(max_threads);
+  at::parallel_for(0, nbatch_x_nclass, 1, [&](int64_t begin, int64_t end) {
+    int tid = at::get_thread_num();
+    for (int64_t iter = begin; iter < end; iter++) {
+      auto bs = iter / num_classes;
+      auto j = iter % num_classes;
+      // skip background (j = 0)
+      if (j == 0) {
         continue;
       }
-      auto iter = bs * num_classes + j;
-      if (threshold > 0) {
-        at::Tensor keep =
-            nms_cpu_kernel<scalar_t, /*sorted*/ false>(bbox, score, threshold);
-        bboxes_out[iter] = bbox.index_select(0, keep);
-        scores_out[iter] = score.index_select(0, keep);
-        labels_out[iter] = at::full({keep.sizes()}, j, torch::kInt64);
-      } else {
-        bboxes_out[iter] = bbox;
-        scores_out[iter] = score;
-        labels_out[iter] = at::full({score.sizes()}, j, torch::kInt64);
-      }
+      class_score_nms<scalar_t>(
+          bboxes_in[bs].data_ptr<scalar_t>() + j * 4,
+          /*det_stride*/ num_classes * 4,
+          scores_in[bs].data_ptr<scalar_t>() + j,
+          /*score_stride*/ num_classes,
+          scores_in[bs].size(0),
+          static_cast<scalar_t>(score_thresh),
+          /*top_k*/ 0,
+          threshold,
+          /*run_nms*/ threshold > 0,
+          /*bias*/ 1,
+          /*source_order*/ true,
+          candidates[tid],
+          workspaces[tid],
+          detections[iter]);
     }
-  }
+  });
 
   std::vector<at::Tensor> bboxes_out_(nbatch);
   std::vector<at::Tensor> scores_out_(nbatch);
   std::vector<at::Tensor> labels_out_(nbatch);
 
-#ifdef _OPENMP
-#if (_OPENMP >= 201307)
-#pragma omp parallel for simd schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#else
-#pragma omp parallel for schedule( \
-    static) if (omp_get_max_threads() > 1 && !omp_in_parallel())
-#endif
-#endif
-  for (int bs = 0; bs < nbatch; bs++) {
-    std::vector<at::Tensor> valid_bboxes_out =
-        remove_empty(bboxes_out, bs * num_classes, (bs + 1) * num_classes);
-    std::vector<at::Tensor> valid_scores_out =
-        remove_empty(scores_out, bs * num_classes, (bs + 1) * num_classes);
-    std::vector<at::Tensor> valid_labels_out =
-        remove_empty(labels_out, bs * num_classes, (bs + 1) * num_classes);
-    if (valid_bboxes_out.size() > 0) {
-      bboxes_out_[bs] = at::cat(valid_bboxes_out, 0);
-      scores_out_[bs] = at::cat(valid_scores_out, 0);
-      labels_out_[bs] = at::cat(valid_labels_out, 0);
-    } else {
-      bboxes_out_[bs] = at::empty({0, 4}, torch::kFloat);
-      scores_out_[bs] = at::empty({0}, torch::kFloat);
-      labels_out_[bs] = at::empty({0}, torch::kInt64);
-    }
-    auto number_of_detections = bboxes_out_[bs].size(0);
-    if (number_of_detections > detections_per_img && detections_per_img > 0) {
-      auto out_ = scores_out_[bs].kthvalue(
-          number_of_detections - detections_per_img + 1);
-      at::Tensor keep =
-          at::nonzero(scores_out_[bs] >= std::get<0>(out_).item()).squeeze(1);
-      bboxes_out_[bs] = bboxes_out_[bs].index_select(0, keep);
-      scores_out_[bs] = scores_out_[bs].index_select(0, keep);
-      labels_out_[bs] = labels_out_[bs].index_select(0, keep);
+  at::parallel_for(0, nbatch, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t bs = begin; bs < end; bs++) {
+      int64_t number_of_detections = 0;
+      for (int j = 1; j < num_classes; j++) {
+        number_of_detections += detections[bs * num_classes + j].score.size();
+      }
+      if (number_of_detections == 0) {
+        bboxes_out_[bs] = at::empty({0, 4}, torch::kFloat);
+        scores_out_[bs] = at::empty({0}, torch::kFloat);
+        labels_out_[bs] = at::empty({0}, torch::kInt64);
+        continue;
+      }
+      // Keep the detections whose score is not smaller than the
+      // detections_per_img-th highest score.
+      bool filter =
+          number_of_detections > detections_per_img && detections_per_img > 0;
+      scalar_t image_thresh = 0;
+      if (filter) {
+        std::vector<scalar_t> all_scores;
+        all_scores.reserve(number_of_detections);
+        for (int j = 1; j < num_classes; j++) {
+          auto& score = detections[bs * num_classes + j].score;
+          all_scores.insert(all_scores.end(), score.begin(), score.end());
+        }
+        auto kth = all_scores.begin() + number_of_detections -
+            detections_per_img;
+        std::nth_element(all_scores.begin(), kth, all_scores.end());
+        image_thresh = *kth;
+        number_of_detections = std::count_if(
+            all_scores.begin(), all_scores.end(), [&](scalar_t s) {
+              return s >= image_thresh;
+            });
+      }
+
+      auto bboxes =
+          at::empty({number_of_detections, 4}, bboxes_in[bs].options());
+      auto scores = at::empty({number_of_detections}, scores_in[bs].options());
+      auto labels = at::empty({number_of_detections}, torch::kInt64);
+      auto bboxes_ptr = bboxes.data_ptr<scalar_t>();
+      auto scores_ptr = scores.data_ptr<scalar_t>();
+      auto labels_ptr = labels.data_ptr<int64_t>();
+      auto src = bboxes_in[bs].data_ptr<scalar_t>();
+      int64_t o = 0;
+      for (int j = 1; j < num_classes; j++) {
+        auto& det = detections[bs * num_classes + j];
+        for (size_t k = 0; k < det.score.size(); k++) {
+          if (filter && !(det.score[k] >= image_thresh)) {
+            continue;
+          }
+          auto box = src + det.index[k] * num_classes * 4 + j * 4;
+          std::copy(box, box + 4, bboxes_ptr + o * 4);
+          scores_ptr[o] = det.score[k];
+          labels_ptr[o] = j;
+          o++;
+        }
+      }
+      bboxes_out_[bs] = bboxes;
+      scores_out_[bs] = scores;
+      labels_out_[bs] = labels;
     }
-  }
+  });
   return std::make_tuple(bboxes_out_, scores_out_, labels_out_);
 }
 
@@ -1,8 +1,13 @@
 #include <aten/RMSNorm.h>
 
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
 #include <torch/csrc/autograd/function.h>
 #include "vec/vec.h"
 
+#include <cmath>
+
 namespace torch_ipex {
 namespace cpu {
 
@@ -32,37 +37,127 @@ void RMSNormKernelImpl(
 }
 #endif
 
+// Row-wise `s = x + r; y = s * rsqrt(mean(s^2) + eps) * w` with fp32
+// accumulation for float, bfloat16 and half inputs. The sum is written back
+// to residual_out when a residual is given; when output is int8, each row is
+// quantized symmetrically with its own scale.
+template <typename scalar_t>
+void AddRMSNormKernelImpl(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    float eps,
+    at::Tensor& output,
+    at::Tensor& residual_out,
+    at::Tensor& scales) {
+  using Vec = at::vec::Vectorized<float>;
+  const int64_t N = input.size(-1);
+  const int64_t M = input.numel() / N;
+  const scalar_t* x_data = input.data_ptr<scalar_t>();
+  const scalar_t* r_data =
+      residual.defined() ? residual.data_ptr<scalar_t>() : nullptr;
+  const float* w_data = weight.data_ptr<float>();
+  scalar_t* r_out_data = r_data ? residual_out.data_ptr<scalar_t>() : nullptr;
+  const bool quant_out = output.scalar_type() == at::kChar;
+  float* scales_data = quant_out ? scales.data_ptr<float>() : nullptr;
+
+  at::parallel_for(0, M, 1, [&](int64_t start, int64_t end) {
+    std::vector<float> buf(r_data ? 2 * N : N);
+    float* s = buf.data();
+    float* tmp = s + N;
+    for (const auto i : c10::irange(start, end)) {
+      at::vec::convert(x_data + i * N, s, N);
+      if (r_data) {
+        at::vec::convert(r_data + i * N, tmp, N);
+        at::vec::map2([](Vec a, Vec b) { return a + b; }, s, s, tmp, N);
+        at::vec::convert(s, r_out_data + i * N, N);
+      }
+      float sum_sq = at::vec::map_reduce_all<float>(
+          [](Vec x) { return x * x; },
+          [](Vec a, Vec b) { return a + b; },
+          s,
+          N);
+      const Vec scale(1.f / std::sqrt(sum_sq / N + eps));
+      at::vec::map2(
+          [scale](Vec x, Vec w) { return x * scale * w; }, s, s, w_data, N);
+      if (!quant_out) {
+        at::vec::convert(s, output.data_ptr<scalar_t>() + i * N, N);
+        continue;
+      }
+      float amax = at::vec::map_reduce_all<float>(
+          [](Vec x) { return x.abs(); },
+          [](Vec a, Vec b) { return at::vec::maximum(a, b); },
+          s,
+          N);
+      float q_scale = amax > 0.f ? amax / 127.f : 1.f;
+      float inv_scale = 1.f / q_scale;
+      int8_t* q = output.data_ptr<int8_t>() + i * N;
+      for (const auto j : c10::irange(N)) {
+        float v = std::nearbyint(s[j] * inv_scale);
+        q[j] = static_cast<int8_t>(std::max(-127.f, std::min(127.f, v)));
+      }
+      scales_data[i] = q_scale;
+    }
+  });
+}
+
+void add_rmsnorm_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& residual,
+    const at::Tensor& weight,
+    float eps,
+    at::Tensor& output,
+    at::Tensor& residual_out,
+    at::Tensor& scales) {
+  AT_DISPATCH_FLOATING_TYPES_AND2(
+      at::ScalarType::BFloat16,
+      at::ScalarType::Half,
+      input.scalar_type(),
+      "add_rmsnorm",
+      [&] {
+        AddRMSNormKernelImpl<scalar_t>(
+            input, residual, weight, eps, output, residual_out, scales);
+      });
+}
+
 at::Tensor rmsnorm_kernel_impl(
     const at::Tensor& input,
     const at::Tensor& b,
     float eps) {
-#if defined(CPU_CAPABILITY_AVX512)
-  const auto input_shape = input.sizes();
-  const auto input_ndim = input.dim();
-  const int axis = input_ndim - 1;
-  const int64_t M =
-      c10::multiply_integers(input_shape.cbegin(), input_shape.cbegin() + axis);
-  const int64_t N =
-      c10::multiply_integers(input_shape.cbegin() + axis, input_shape.cend());
   auto X = input.contiguous();
-  at::Tensor Y = at::native::empty_like(
-      X,
-      c10::nullopt /* dtype */,
-      c10::nullopt /* layout */,
-      c10::nullopt /* device */,
-      c10::nullopt /* pin_memory */,
-      at::MemoryFormat::Contiguous);
-  RMSNormKernelImpl<float, float>(X, b, M, N, eps, Y);
-  return Y;
-#else
-  auto variance = at::mean(at::pow(input, 2), -1, true);
-  auto hidden_states = at::rsqrt(at::add(variance, eps));
-  return at::mul(b, at::mul(input, hidden_states));
+#if defined(CPU_CAPABILITY_AVX512)
+  if (X.scalar_type() == at::kFloat &&
+      (!b.defined() || b.scalar_type() == at::kFloat)) {
+    const auto input_shape = input.sizes();
+    const auto input_ndim = input.dim();
+    const int axis = input_ndim - 1;
+    const int64_t M = c10::multiply_integers(
+        input_shape.cbegin(), input_shape.cbegin() + axis);
+    const int64_t N = c10::multiply_integers(
+        input_shape.cbegin() + axis, input_shape.cend());
+    at::Tensor Y = at::native::empty_like(
+        X,
+        c10::nullopt /* dtype */,
+        c10::nullopt /* layout */,
+        c10::nullopt /* device */,
+        c10::nullopt /* pin_memory */,
+        at::MemoryFormat::Contiguous);
+    RMSNormKernelImpl<float, float>(X, b, M, N, eps, Y);
+    return Y;
+  }
 #endif
+  auto w = b.defined() ? b.to(at::kFloat).contiguous()
+                       : at::ones({X.size(-1)}, X.options().dtype(at::kFloat));
+  auto Y = at::empty_like(X);
+  at::Tensor residual_out, scales;
+  add_rmsnorm_kernel_impl(X, at::Tensor(), w, eps, Y, residual_out, scales);
+  return Y;
 }
 
 } // namespace
 
 REGISTER_DISPATCH(rmsnorm_kernel_stub, &rmsnorm_kernel_impl);
+REGISTER_DISPATCH(add_rmsnorm_kernel_stub, &add_rmsnorm_kernel_impl);
+
 } // namespace cpu
 } // namespace torch_ipex
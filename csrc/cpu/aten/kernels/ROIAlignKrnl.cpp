@@ -2,11 +2,16 @@
 #include <ATen/ATen.h>
 #include <ATen/Parallel.h>
 #include <ATen/cpu/vec/vec.h>
+#include <ATen/quantized/Quantizer.h>
 #include <aten/ROIAlign.h>
+#include <immintrin.h>
 #include <torch/library.h>
 #include "autocast/autocast_mode.h"
 #include "utils/library.h"
 
+#include <cmath>
+#include <limits>
+
 // use float as accumulation type for BFloat16
 template <typename scalar_t>
 struct AccType {
@@ -351,6 +356,142 @@ inline void roi_align_single_framework_channels_last_forward<
   } // for ph
 }
 
+// Geometry of one ROI, shared by all the channels.
+template <typename ACC_T>
+struct RoiGeometry {
+  int roi_batch_ind;
+  ACC_T roi_start_h;
+  ACC_T roi_start_w;
+  ACC_T bin_size_h;
+  ACC_T bin_size_w;
+  int roi_bin_grid_h;
+  int roi_bin_grid_w;
+  ACC_T count;
+};
+
+template <typename ACC_T>
+inline RoiGeometry<ACC_T> roi_align_geometry(
+    const ACC_T* offset_rois,
+    const ACC_T& spatial_scale,
+    int pooled_height,
+    int pooled_width,
+    int sampling_ratio,
+    bool aligned) {
+  RoiGeometry<ACC_T> geo;
+  geo.roi_batch_ind = offset_rois[0];
+
+  // Do not using rounding; this implementation detail is critical
+  ACC_T offset = aligned ? (ACC_T)0.5 : (ACC_T)0.0;
+  geo.roi_start_w = offset_rois[1] * spatial_scale - offset;
+  geo.roi_start_h = offset_rois[2] * spatial_scale - offset;
+  ACC_T roi_end_w = offset_rois[3] * spatial_scale - offset;
+  ACC_T roi_end_h = offset_rois[4] * spatial_scale - offset;
+
+  ACC_T roi_width = roi_end_w - geo.roi_start_w;
+  ACC_T roi_height = roi_end_h - geo.roi_start_h;
+  if (!aligned) {
+    // Force malformed ROIs to be 1x1
+    roi_width = std::max(roi_width, (ACC_T)1.);
+    roi_height = std::max(roi_height, (ACC_T)1.);
+  }
+
+  geo.bin_size_h =
+      static_cast<ACC_T>(roi_height) / static_cast<ACC_T>(pooled_height);
+  geo.bin_size_w =
+      static_cast<ACC_T>(roi_width) / static_cast<ACC_T>(pooled_width);
+
+  // We use roi_bin_grid to sample the grid and mimic integral
+  geo.roi_bin_grid_h = (sampling_ratio > 0)
+      ? sampling_ratio
+      : ceil(roi_height / pooled_height); // e.g., = 2
+  geo.roi_bin_grid_w =
+      (sampling_ratio > 0) ? sampling_ratio : ceil(roi_width / pooled_width);
+
+  // We do average (integral) pooling inside a bin
+  // When the grid is empty, output zeros.
+  geo.count = std::max(geo.roi_bin_grid_h * geo.roi_bin_grid_w, 1); // e.g. = 4
+  return geo;
+}
+
+// ROI-batch scheduler of the forward kernels. With sampling_ratio <= 0 the
+// number of sampling points of a ROI grows with its area, so the ROIs of a
+// batch can cost very different. Instead of a static split on the ROI number,
+// the ROIs are split into contiguous chunks of (roughly) equal sampling cost,
+// one chunk per thread. Each chunk reuses a single bilinear table buffer for
+// all of its ROIs.
+//
+// f(n, geometry, pre_calc) is called for every ROI n, with the bilinear table
+// of the ROI already computed into pre_calc.
+template <typename ACC_T, typename F>
+void roi_align_balanced_parallel_for(
+    int n_rois,
+    const ACC_T* rois,
+    const ACC_T& spatial_scale,
+    int height,
+    int width,
+    int pooled_height,
+    int pooled_width,
+    int sampling_ratio,
+    bool aligned,
+    const F& f) {
+  std::vector<RoiGeometry<ACC_T>> geometry(n_rois);
+  // cost_prefix[n] is the total cost of the ROIs before n.
+  std::vector<int64_t> cost_prefix(n_rois + 1, 0);
+  for (int n = 0; n < n_rois; n++) {
+    geometry[n] = roi_align_geometry(
+        rois + n * 5,
+        spatial_scale,
+        pooled_height,
+        pooled_width,
+        sampling_ratio,
+        aligned);
+    // Also count the fixed cost of the output bins for the empty grids.
+    int64_t cost = static_cast<int64_t>(pooled_height) * pooled_width *
+        (std::max(geometry[n].roi_bin_grid_h, 0) *
+             std::max(geometry[n].roi_bin_grid_w, 0) +
+         1);
+    cost_prefix[n + 1] = cost_prefix[n] + cost;
+  }
+
+  int64_t num_chunks = std::min<int64_t>(at::get_num_threads(), n_rois);
+  std::vector<int> chunk_begin(num_chunks + 1, n_rois);
+  chunk_begin[0] = 0;
+  for (int64_t t = 1; t < num_chunks; t++) {
+    // First ROI whose cost starts at or after t / num_chunks of the total.
+    auto target = cost_prefix[n_rois] * t / num_chunks;
+    chunk_begin[t] =
+        std::lower_bound(cost_prefix.begin(), cost_prefix.end() - 1, target) -
+        cost_prefix.begin();
+  }
+
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    std::vector<PreCalc<ACC_T>> pre_calc;
+    for (int64_t t = begin; t < end; t++) {
+      for (int n = chunk_begin[t]; n < chunk_begin[t + 1]; n++) {
+        const auto& geo = geometry[n];
+        // we want to precalculate indices and weights shared by all channels,
+        // this is the key point of optimization
+        pre_calc.resize(
+            geo.roi_bin_grid_h * geo.roi_bin_grid_w * pooled_width *
+            pooled_height);
+        pre_calc_for_bilinear_interpolate(
+            height,
+            width,
+            pooled_height,
+            pooled_width,
+            geo.roi_start_h,
+            geo.roi_start_w,
+            geo.bin_size_h,
+            geo.bin_size_w,
+            geo.roi_bin_grid_h,
+            geo.roi_bin_grid_w,
+            pre_calc);
+        f(n, geo, pre_calc);
+      }
+    }
+  });
+}
+
 template <typename T, typename ACC_T>
 void roi_align_forward_kernel_body(
     int n_rois,
@@ -367,91 +508,298 @@ void roi_align_forward_kernel_body(
     T* output,
     bool is_channels_last) {
   // (n, c, ph, pw) is an element in the pooled output
-  // can be parallelized using omp
-  at::parallel_for(0, n_rois, 1, [&](int begin, int end) {
-    for (int n = begin; n < end; n++) {
-      const ACC_T* offset_rois = rois + n * 5;
-      int roi_batch_ind = offset_rois[0];
-
-      // Do not using rounding; this implementation detail is critical
-      ACC_T offset = aligned ? (ACC_T)0.5 : (ACC_T)0.0;
-      ACC_T roi_start_w = offset_rois[1] * spatial_scale - offset;
-      ACC_T roi_start_h = offset_rois[2] * spatial_scale - offset;
-      ACC_T roi_end_w = offset_rois[3] * spatial_scale - offset;
-      ACC_T roi_end_h = offset_rois[4] * spatial_scale - offset;
-
-      ACC_T roi_width = roi_end_w - roi_start_w;
-      ACC_T roi_height = roi_end_h - roi_start_h;
-      if (!aligned) {
-        // Force malformed ROIs to be 1x1
-        roi_width = std::max(roi_width, (ACC_T)1.);
-        roi_height = std::max(roi_height, (ACC_T)1.);
-      }
+  roi_align_balanced_parallel_for(
+      n_rois,
+      rois,
+      spatial_scale,
+      height,
+      width,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      [&](int n,
+          const RoiGeometry<ACC_T>& geo,
+          const std::vector<PreCalc<ACC_T>>& pre_calc) {
+        if (is_channels_last) {
+          roi_align_single_framework_channels_last_forward<T, ACC_T>(
+              input + geo.roi_batch_ind * height * width * channels,
+              geo.count,
+              channels,
+              height,
+              width,
+              pooled_height,
+              pooled_width,
+              geo.roi_bin_grid_h,
+              geo.roi_bin_grid_w,
+              pre_calc,
+              output + n * pooled_width * pooled_height * channels);
+        } else {
+          roi_align_single_framework_forward<T, ACC_T>(
+              input + geo.roi_batch_ind * channels * height * width,
+              geo.count,
+              channels,
+              height,
+              width,
+              pooled_height,
+              pooled_width,
+              geo.roi_bin_grid_h,
+              geo.roi_bin_grid_w,
+              pre_calc,
+              output + n * channels * pooled_width * pooled_height);
+        }
+      });
+}
 
-      ACC_T bin_size_h =
-          static_cast<ACC_T>(roi_height) / static_cast<ACC_T>(pooled_height);
-      ACC_T bin_size_w =
-          static_cast<ACC_T>(roi_width) / static_cast<ACC_T>(pooled_width);
-
-      // We use roi_bin_grid to sample the grid and mimic integral
-      int roi_bin_grid_h = (sampling_ratio > 0)
-          ? sampling_ratio
-          : ceil(roi_height / pooled_height); // e.g., = 2
-      int roi_bin_grid_w = (sampling_ratio > 0)
-          ? sampling_ratio
-          : ceil(roi_width / pooled_width);
-
-      // We do average (integral) pooling inside a bin
-      // When the grid is empty, output zeros.
-      const ACC_T count =
-          std::max(roi_bin_grid_h * roi_bin_grid_w, 1); // e.g. = 4
-
-      // we want to precalculate indices and weights shared by all channels,
-      // this is the key point of optimization
-      std::vector<PreCalc<ACC_T>> pre_calc(
-          roi_bin_grid_h * roi_bin_grid_w * pooled_width * pooled_height);
-      pre_calc_for_bilinear_interpolate(
-          height,
-          width,
-          pooled_height,
-          pooled_width,
-          roi_start_h,
-          roi_start_w,
-          bin_size_h,
-          bin_size_w,
-          roi_bin_grid_h,
-          roi_bin_grid_w,
-          pre_calc);
+// acc[c] += w1 * in1[c] + w2 * in2[c] + w3 * in3[c] + w4 * in4[c] on the raw
+// (not dequantized) INT8 values.
+template <typename in_t>
+inline void qroi_align_accumulate(
+    float* acc,
+    const in_t* in1,
+    const in_t* in2,
+    const in_t* in3,
+    const in_t* in4,
+    const PreCalc<float>& pc,
+    int channels) {
+  for (int c = 0; c < channels; c++) {
+    acc[c] += pc.w1 * static_cast<float>(in1[c]) +
+        pc.w2 * static_cast<float>(in2[c]) +
+        pc.w3 * static_cast<float>(in3[c]) +
+        pc.w4 * static_cast<float>(in4[c]);
+  }
+}
+
+// out[c] = clamp(round((acc[c] + shift) * scale) + o_zp)
+template <typename out_t>
+inline void qroi_align_requantize(
+    out_t* out,
+    const float* acc,
+    int channels,
+    float scale,
+    float shift,
+    int32_t o_zp) {
+  constexpr int32_t qmin = std::numeric_limits<out_t>::min();
+  constexpr int32_t qmax = std::numeric_limits<out_t>::max();
+  for (int c = 0; c < channels; c++) {
+    int32_t q =
+        static_cast<int32_t>(std::nearbyint((acc[c] + shift) * scale)) + o_zp;
+    out[c] = static_cast<out_t>(std::min(std::max(q, qmin), qmax));
+  }
+}
+
+#if defined(CPU_CAPABILITY_AVX512)
+inline __m512 _load_int8_as_ps(const int8_t* p, __mmask16 mask) {
+  return _mm512_cvtepi32_ps(
+      _mm512_cvtepi8_epi32(_mm_maskz_loadu_epi8(mask, p)));
+}
+
+inline __m512 _load_int8_as_ps(const uint8_t* p, __mmask16 mask) {
+  return _mm512_cvtepi32_ps(
+      _mm512_cvtepu8_epi32(_mm_maskz_loadu_epi8(mask, p)));
+}
+
+template <typename in_t>
+inline void qroi_align_accumulate_avx512(
+    float* acc,
+    const in_t* in1,
+    const in_t* in2,
+    const in_t* in3,
+    const in_t* in4,
+    const PreCalc<float>& pc,
+    int channels) {
+  __m512 w1 = _mm512_set1_ps(pc.w1);
+  __m512 w2 = _mm512_set1_ps(pc.w2);
+  __m512 w3 = _mm512_set1_ps(pc.w3);
+  __m512 w4 = _mm512_set1_ps(pc.w4);
+  for (int c = 0; c < channels; c += 16) {
+    int left = channels - c;
+    __mmask16 mask = left >= 16 ? 0xffff : (1 << left) - 1;
+    __m512 sum = _mm512_maskz_loadu_ps(mask, acc + c);
+    sum = _mm512_fmadd_ps(w1, _load_int8_as_ps(in1 + c, mask), sum);
+    sum = _mm512_fmadd_ps(w2, _load_int8_as_ps(in2 + c, mask), sum);
+    sum = _mm512_fmadd_ps(w3, _load_int8_as_ps(in3 + c, mask), sum);
+    sum = _mm512_fmadd_ps(w4, _load_int8_as_ps(in4 + c, mask), sum);
+    _mm512_mask_storeu_ps(acc + c, mask, sum);
+  }
+}
 
-      if (is_channels_last) {
-        roi_align_single_framework_channels_last_forward<T, ACC_T>(
-            input + roi_batch_ind * height * width * channels,
-            count,
+template <>
+inline void qroi_align_accumulate<int8_t>(
+    float* acc,
+    const int8_t* in1,
+    const int8_t* in2,
+    const int8_t* in3,
+    const int8_t* in4,
+    const PreCalc<float>& pc,
+    int channels) {
+  qroi_align_accumulate_avx512(acc, in1, in2, in3, in4, pc, channels);
+}
+
+template <>
+inline void qroi_align_accumulate<uint8_t>(
+    float* acc,
+    const uint8_t* in1,
+    const uint8_t* in2,
+    const uint8_t* in3,
+    const uint8_t* in4,
+    const PreCalc<float>& pc,
+    int channels) {
+  qroi_align_accumulate_avx512(acc, in1, in2, in3, in4, pc, channels);
+}
+
+template <typename out_t>
+inline void qroi_align_requantize_avx512(
+    out_t* out,
+    const float* acc,
+    int channels,
+    float scale,
+    float shift,
+    int32_t o_zp) {
+  __m512 scale_vec = _mm512_set1_ps(scale);
+  __m512 shift_vec = _mm512_set1_ps(shift);
+  __m512i zp_vec = _mm512_set1_epi32(o_zp);
+  __m512i qmin_vec = _mm512_set1_epi32(std::numeric_limits<out_t>::min());
+  __m512i qmax_vec = _mm512_set1_epi32(std::numeric_limits<out_t>::max());
+  for (int c = 0; c < channels; c += 16) {
+    int left = channels - c;
+    __mmask16 mask = left >= 16 ? 0xffff : (1 << left) - 1;
+    __m512 val = _mm512_mul_ps(
+        _mm512_add_ps(_mm512_maskz_loadu_ps(mask, acc + c), shift_vec),
+        scale_vec);
+    // Rounds to nearest even with the default MXCSR, as std::nearbyint.
+    __m512i q = _mm512_add_epi32(_mm512_cvtps_epi32(val), zp_vec);
+    q = _mm512_min_epi32(_mm512_max_epi32(q, qmin_vec), qmax_vec);
+    _mm512_mask_cvtepi32_storeu_epi8(out + c, mask, q);
+  }
+}
+
+template <>
+inline void qroi_align_requantize<int8_t>(
+    int8_t* out,
+    const float* acc,
+    int channels,
+    float scale,
+    float shift,
+    int32_t o_zp) {
+  qroi_align_requantize_avx512(out, acc, channels, scale, shift, o_zp);
+}
+
+template <>
+inline void qroi_align_requantize<uint8_t>(
+    uint8_t* out,
+    const float* acc,
+    int channels,
+    float scale,
+    float shift,
+    int32_t o_zp) {
+  qroi_align_requantize_avx512(out, acc, channels, scale, shift, o_zp);
+}
+#endif
+
+// INT8 channels last ROIAlign of one ROI with fused dequantize and requantize.
+// Since the bilinear weights of a sampling point sum up to 1 (or 0 when it is
+// out of the feature map), the input zero point is applied once per bin:
+//   out = in_scale * (sum(w * q) - in_zp * sum(w)) / count
+template <typename in_t, typename out_t>
+inline void qroi_align_single_framework_channels_last_forward(
+    const in_t* input,
+    const float count,
+    int channels,
+    int height,
+    int width,
+    int pooled_height,
+    int pooled_width,
+    int roi_bin_grid_h,
+    int roi_bin_grid_w,
+    const std::vector<PreCalc<float>>& pre_calc,
+    float in_scale,
+    int32_t in_zp,
+    float o_scale,
+    int32_t o_zp,
+    float* acc,
+    out_t* output) {
+  float scale = in_scale / count / o_scale;
+  int pre_calc_index = 0;
+  for (int ph = 0; ph < pooled_height; ph++) {
+    for (int pw = 0; pw < pooled_width; pw++) {
+      out_t* out = output + (ph * pooled_width + pw) * channels;
+      std::fill(acc, acc + channels, 0.f);
+      float weight_sum = 0.f;
+      for (int iy = 0; iy < roi_bin_grid_h; iy++) {
+        for (int ix = 0; ix < roi_bin_grid_w; ix++) {
+          const PreCalc<float>& pc = pre_calc[pre_calc_index];
+          weight_sum += pc.w1 + pc.w2 + pc.w3 + pc.w4;
+          qroi_align_accumulate(
+              acc,
+              input + pc.pos1 * channels,
+              input + pc.pos2 * channels,
+              input + pc.pos3 * channels,
+              input + pc.pos4 * channels,
+              pc,
+              channels);
+          pre_calc_index += 1;
+        }
+      }
+      qroi_align_requantize(
+          out, acc, channels, scale, -in_zp * weight_sum, o_zp);
+    } // for pw
+  } // for ph
+}
+
+template <typename in_t, typename out_t>
+void qroi_align_forward_kernel_body(
+    int n_rois,
+    const in_t* input,
+    float in_scale,
+    int32_t in_zp,
+    const float& spatial_scale,
+    int channels,
+    int height,
+    int width,
+    int pooled_height,
+    int pooled_width,
+    int sampling_ratio,
+    bool aligned,
+    const float* rois,
+    float o_scale,
+    int32_t o_zp,
+    out_t* output) {
+  // Per thread FP32 accumulator of one output bin, reused across ROIs.
+  std::vector<std::vector<float>> acc_buf(at::get_num_threads());
+  roi_align_balanced_parallel_for(
+      n_rois,
+      rois,
+      spatial_scale,
+      height,
+      width,
+      pooled_height,
+      pooled_width,
+      sampling_ratio,
+      aligned,
+      [&](int n,
+          const RoiGeometry<float>& geo,
+          const std::vector<PreCalc<float>>& pre_calc) {
+        auto& acc = acc_buf[at::get_thread_num()];
+        acc.resize(channels);
+        qroi_align_single_framework_channels_last_forward<in_t, out_t>(
+            input + geo.roi_batch_ind * height * width * channels,
+            geo.count,
             channels,
             height,
             width,
             pooled_height,
             pooled_width,
-            roi_bin_grid_h,
-            roi_bin_grid_w,
+            geo.roi_bin_grid_h,
+            geo.roi_bin_grid_w,
             pre_calc,
+            in_scale,
+            in_zp,
+            o_scale,
+            o_zp,
+            acc.data(),
             output + n * pooled_width * pooled_height * channels);
-      } else {
-        roi_align_single_framework_forward<T, ACC_T>(
-            input + roi_batch_ind * channels * height * width,
-            count,
-            channels,
-            height,
-            width,
-            pooled_height,
-            pooled_width,
-            roi_bin_grid_h,
-            roi_bin_grid_w,
-            pre_calc,
-            output + n * channels * pooled_width * pooled_height);
-      }
-    } // for n
-  });
+      });
 }
 
 template <class T>
@@ -722,6 +1070,94 @@ at::Tensor roi_align_forward_kernel_impl(
   return output;
 }
 
+at::Tensor qroi_align_forward_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& rois,
+    double spatial_scale,
+    int64_t pooled_height,
+    int64_t pooled_width,
+    int64_t sampling_ratio,
+    bool aligned,
+    double o_scale,
+    int64_t o_zp,
+    at::ScalarType o_dtype) {
+  TORCH_CHECK(input.device().is_cpu(), "input must be a CPU tensor");
+  TORCH_CHECK(rois.device().is_cpu(), "rois must be a CPU tensor");
+  TORCH_CHECK(rois.size(1) == 5, "rois must have shape as Tensor[K, 5]");
+  TORCH_CHECK(
+      input.is_quantized() && input.qscheme() == at::kPerTensorAffine,
+      "qroi_align: input must be a per tensor quantized tensor");
+  TORCH_CHECK(
+      input.scalar_type() == at::kQInt8 || input.scalar_type() == at::kQUInt8,
+      "qroi_align: only support qint8 and quint8 input");
+  TORCH_CHECK(
+      o_dtype == at::kQInt8 || o_dtype == at::kQUInt8,
+      "qroi_align: only support qint8 and quint8 output");
+
+  auto num_rois = rois.size(0);
+  auto channels = input.size(1);
+  auto height = input.size(2);
+  auto width = input.size(3);
+
+  // The INT8 kernel only has the channels last path, which is the layout the
+  // quantized backbone produces.
+  at::Tensor output = at::_empty_affine_quantized(
+      {num_rois, channels, pooled_height, pooled_width},
+      input.options().dtype(o_dtype),
+      o_scale,
+      o_zp,
+      at::MemoryFormat::ChannelsLast);
+
+  if (output.numel() == 0)
+    return output;
+
+  auto input_ = input.contiguous(at::MemoryFormat::ChannelsLast);
+  auto rois_ = rois.to(at::kFloat).contiguous();
+  float in_scale = at::native::q_scale_quant(input_);
+  int32_t in_zp = input_.q_zero_point();
+
+  auto run = [&](auto* input_data, auto* output_data) {
+    using in_t = std::remove_pointer_t<decltype(input_data)>;
+    using out_t = std::remove_pointer_t<decltype(output_data)>;
+    qroi_align_forward_kernel_body<in_t, out_t>(
+        num_rois,
+        input_data,
+        in_scale,
+        in_zp,
+        spatial_scale,
+        channels,
+        height,
+        width,
+        pooled_height,
+        pooled_width,
+        sampling_ratio,
+        aligned,
+        rois_.data_ptr<float>(),
+        o_scale,
+        o_zp,
+        output_data);
+  };
+  auto input_data = input_.data_ptr();
+  auto output_data = output.data_ptr();
+  if (input.scalar_type() == at::kQInt8) {
+    if (o_dtype == at::kQInt8) {
+      run(static_cast<int8_t*>(input_data), static_cast<int8_t*>(output_data));
+    } else {
+      run(static_cast<int8_t*>(input_data),
+          static_cast<uint8_t*>(output_data));
+    }
+  } else {
+    if (o_dtype == at::kQInt8) {
+      run(static_cast<uint8_t*>(input_data),
+          static_cast<int8_t*>(output_data));
+    } else {
+      run(static_cast<uint8_t*>(input_data),
+          static_cast<uint8_t*>(output_data));
+    }
+  }
+  return output;
+}
+
 at::Tensor roi_align_backward_kernel_impl(
     const at::Tensor& grad,
     const at::Tensor& rois,
@@ -791,6 +1227,9 @@ REGISTER_DISPATCH(
 REGISTER_DISPATCH(
     roi_align_backward_kernel_stub,
     &roi_align_backward_kernel_impl);
+REGISTER_DISPATCH(
+    qroi_align_forward_kernel_stub,
+    &qroi_align_forward_kernel_impl);
 
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,286 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec/functional.h>
+#include <ATen/cpu/vec/vec.h>
+#include <c10/util/irange.h>
+
+#include <aten/WoqLinear.h>
+
+#include <immintrin.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+namespace {
+
+using Vec = at::vec::Vectorized<float>;
+
+// rows of the activation sharing one dequantized weight block
+constexpr int64_t kBlockM = 4;
+// number of fp32 vectors holding one block of kWoqBlockN channels
+constexpr int64_t kVecs = kWoqBlockN / Vec::size();
+// From this many rows the linear is compute bound and the weight is
+// dequantized once for the regular GEMM instead of once per row block.
+constexpr int64_t kDequantGemmRows = 64;
+
+// Dequantizes the kWoqBlockN channels of one input channel, without the
+// scale which is applied once per group.
+template <int64_t bits>
+inline void dequant_block(const uint8_t* q, Vec (&w)[kVecs]) {
+#if defined(CPU_CAPABILITY_AVX512)
+  if (bits == 8) {
+    auto v = _mm512_cvtepi8_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(q)));
+    w[0] = Vec(_mm512_cvtepi32_ps(v));
+  } else {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    auto b = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(q));
+    auto lo = _mm_and_si128(b, mask);
+    auto hi = _mm_and_si128(_mm_srli_epi16(b, 4), mask);
+    auto v = _mm512_cvtepu8_epi32(_mm_unpacklo_epi64(lo, hi));
+    w[0] = Vec(_mm512_cvtepi32_ps(_mm512_sub_epi32(v, _mm512_set1_epi32(8))));
+  }
+#else
+  __at_align__ float buf[kWoqBlockN];
+  if (bits == 8) {
+    const int8_t* q8 = reinterpret_cast<const int8_t*>(q);
+    for (const auto j : c10::irange(kWoqBlockN)) {
+      buf[j] = static_cast<float>(q8[j]);
+    }
+  } else {
+    for (const auto j : c10::irange(kWoqBlockN / 2)) {
+      buf[j] = static_cast<float>(q[j] & 0x0F) - 8.f;
+      buf[j + kWoqBlockN / 2] = static_cast<float>(q[j] >> 4) - 8.f;
+    }
+  }
+  for (const auto v : c10::irange(kVecs)) {
+    w[v] = Vec::loadu(buf + v * Vec::size());
+  }
+#endif
+}
+
+// out[rows, 16] = x[rows, K] @ dequant(qw)[K, 16] + bias for one block of
+// output channels. The weights of an input channel are dequantized once into
+// registers and used by all the rows; the products of a group are summed
+// before being scaled so that the scale costs one FMA per group.
+template <int64_t bits, int64_t rows>
+void woq_gemm_block(
+    const float* x,
+    int64_t K,
+    const uint8_t* qw,
+    const float* scales,
+    int64_t group_size,
+    const float* bias,
+    float* out,
+    int64_t ldo) {
+  constexpr int64_t qstride = bits == 8 ? kWoqBlockN : kWoqBlockN / 2;
+  Vec acc[rows][kVecs];
+  for (const auto v : c10::irange(kVecs)) {
+    auto b = bias ? Vec::loadu(bias + v * Vec::size()) : Vec(0.f);
+    for (const auto i : c10::irange(rows)) {
+      acc[i][v] = b;
+    }
+  }
+  for (int64_t k0 = 0, g = 0; k0 < K; k0 += group_size, g++) {
+    const int64_t k1 = std::min(K, k0 + group_size);
+    Vec part[rows][kVecs];
+    for (const auto i : c10::irange(rows)) {
+      for (const auto v : c10::irange(kVecs)) {
+        part[i][v] = Vec(0.f);
+      }
+    }
+    for (int64_t k = k0; k < k1; k++) {
+      Vec w[kVecs];
+      dequant_block<bits>(qw + k * qstride, w);
+      for (const auto i : c10::irange(rows)) {
+        Vec xi(x[i * K + k]);
+        for (const auto v : c10::irange(kVecs)) {
+          part[i][v] = at::vec::fmadd(xi, w[v], part[i][v]);
+        }
+      }
+    }
+    for (const auto v : c10::irange(kVecs)) {
+      auto s = Vec::loadu(scales + g * kWoqBlockN + v * Vec::size());
+      for (const auto i : c10::irange(rows)) {
+        acc[i][v] = at::vec::fmadd(part[i][v], s, acc[i][v]);
+      }
+    }
+  }
+  for (const auto i : c10::irange(rows)) {
+    for (const auto v : c10::irange(kVecs)) {
+      acc[i][v].store(out + i * ldo + v * Vec::size());
+    }
+  }
+}
+
+template <int64_t bits>
+void woq_gemm_rows(
+    int64_t rows,
+    const float* x,
+    int64_t K,
+    const uint8_t* qw,
+    const float* scales,
+    int64_t group_size,
+    const float* bias,
+    float* out,
+    int64_t ldo) {
+  switch (rows) {
+    case 1:
+      return woq_gemm_block<bits, 1>(
+          x, K, qw, scales, group_size, bias, out, ldo);
+    case 2:
+      return woq_gemm_block<bits, 2>(
+          x, K, qw, scales, group_size, bias, out, ldo);
+    case 3:
+      return woq_gemm_block<bits, 3>(
+          x, K, qw, scales, group_size, bias, out, ldo);
+    default:
+      return woq_gemm_block<bits, kBlockM>(
+          x, K, qw, scales, group_size, bias, out, ldo);
+  }
+}
+
+template <int64_t bits>
+void woq_gemm(
+    const at::Tensor& x,
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    const at::Tensor& bias,
+    int64_t group_size,
+    at::Tensor& out) {
+  const int64_t M = x.size(0);
+  const int64_t K = x.size(1);
+  const int64_t num_blocks = qweight.size(0);
+  const int64_t num_groups = scales.size(1);
+  const int64_t ldo = out.size(1);
+  const int64_t m_blocks = (M + kBlockM - 1) / kBlockM;
+  const int64_t qblock = K * (bits == 8 ? kWoqBlockN : kWoqBlockN / 2);
+  const float* x_data = x.data_ptr<float>();
+  const uint8_t* qw_data = static_cast<const uint8_t*>(qweight.data_ptr());
+  const float* s_data = scales.data_ptr<float>();
+  const float* b_data = bias.defined() ? bias.data_ptr<float>() : nullptr;
+  float* out_data = out.data_ptr<float>();
+  // consecutive tasks share the same weight block, which is the bulk of the
+  // memory traffic when M is small
+  at::parallel_for(
+      0, num_blocks * m_blocks, 1, [&](int64_t begin, int64_t end) {
+        for (const auto t : c10::irange(begin, end)) {
+          const int64_t nb = t / m_blocks;
+          const int64_t m0 = (t % m_blocks) * kBlockM;
+          woq_gemm_rows<bits>(
+              std::min(kBlockM, M - m0),
+              x_data + m0 * K,
+              K,
+              qw_data + nb * qblock,
+              s_data + nb * num_groups * kWoqBlockN,
+              group_size,
+              b_data ? b_data + nb * kWoqBlockN : nullptr,
+              out_data + m0 * ldo + nb * kWoqBlockN,
+              ldo);
+        }
+      });
+}
+
+// Dequantizes the packed weight into a [num_blocks * kWoqBlockN, K] weight of
+// dtype T for the regular GEMM. Each task writes the rows of one block of
+// output channels straight into the result, so no full-size fp32 temporaries
+// are created on the way.
+template <int64_t bits, typename T>
+void woq_dequant_weight(
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    int64_t group_size,
+    at::Tensor& weight) {
+  constexpr int64_t qstride = bits == 8 ? kWoqBlockN : kWoqBlockN / 2;
+  const int64_t num_blocks = qweight.size(0);
+  const int64_t K = qweight.size(1);
+  const int64_t num_groups = scales.size(1);
+  const uint8_t* qw_data = static_cast<const uint8_t*>(qweight.data_ptr());
+  const float* s_data = scales.data_ptr<float>();
+  T* w_data = weight.data_ptr<T>();
+  at::parallel_for(0, num_blocks, 1, [&](int64_t begin, int64_t end) {
+    __at_align__ float buf[kWoqBlockN];
+    for (const auto nb : c10::irange(begin, end)) {
+      const uint8_t* qw = qw_data + nb * K * qstride;
+      const float* s = s_data + nb * num_groups * kWoqBlockN;
+      T* w = w_data + nb * kWoqBlockN * K;
+      for (const auto k : c10::irange(K)) {
+        Vec v[kVecs];
+        dequant_block<bits>(qw + k * qstride, v);
+        const float* sk = s + (k / group_size) * kWoqBlockN;
+        for (const auto i : c10::irange(kVecs)) {
+          (v[i] * Vec::loadu(sk + i * Vec::size()))
+              .store(buf + i * Vec::size());
+        }
+        for (const auto j : c10::irange(kWoqBlockN)) {
+          w[j * K + k] = static_cast<T>(buf[j]);
+        }
+      }
+    }
+  });
+}
+
+template <int64_t bits>
+at::Tensor woq_dequant_weight(
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    int64_t group_size,
+    const at::TensorOptions& options) {
+  auto weight =
+      at::empty({qweight.size(0) * kWoqBlockN, qweight.size(1)}, options);
+  if (weight.scalar_type() == at::kBFloat16) {
+    woq_dequant_weight<bits, at::BFloat16>(qweight, scales, group_size, weight);
+  } else {
+    woq_dequant_weight<bits, float>(qweight, scales, group_size, weight);
+  }
+  return weight;
+}
+
+at::Tensor woq_linear_kernel_impl(
+    const at::Tensor& input,
+    const at::Tensor& qweight,
+    const at::Tensor& scales,
+    const at::Tensor& bias,
+    int64_t out_features,
+    int64_t bits,
+    int64_t group_size) {
+  const int64_t K = input.size(-1);
+  const int64_t M = input.numel() / K;
+  auto out_sizes = input.sizes().vec();
+  out_sizes.back() = out_features;
+  const int64_t group = group_size > 0 ? group_size : K;
+  if (M >= kDequantGemmRows) {
+    // The dequantized weight is one [N, K] buffer in the input dtype, alive
+    // only for this call.
+    auto weight = bits == 8
+        ? woq_dequant_weight<8>(qweight, scales, group, input.options())
+        : woq_dequant_weight<4>(qweight, scales, group, input.options());
+    return at::linear(
+        input,
+        weight.narrow(0, 0, out_features),
+        bias.defined() ? bias.to(input.scalar_type()) : bias);
+  }
+
+  const int64_t padded_n = qweight.size(0) * kWoqBlockN;
+  auto x = input.to(at::kFloat).contiguous().view({M, K});
+  auto bias_ = bias.defined()
+      ? at::constant_pad_nd(
+            bias.to(at::kFloat).view({-1}), {0, padded_n - out_features})
+      : bias;
+  auto out = at::empty({M, padded_n}, x.options());
+  if (bits == 8) {
+    woq_gemm<8>(x, qweight, scales, bias_, group, out);
+  } else {
+    woq_gemm<4>(x, qweight, scales, bias_, group, out);
+  }
+  return out.narrow(1, 0, out_features)
+      .to(input.scalar_type())
+      .reshape(out_sizes);
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(woq_linear_kernel_stub, &woq_linear_kernel_impl);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -2,8 +2,12 @@
 
 #include "library.h"
 
+#include <array>
+#include <atomic>
 #include <exception>
 #include <iostream>
+#include <list>
+#include <mutex>
 
 namespace torch_ipex {
 namespace autocast {
@@ -16,6 +20,185 @@ using val_type = std::tuple<weakref_type, at::Tensor>;
 thread_local std::unordered_map<c10::TensorImpl*, val_type> cached_casts;
 
 thread_local at::ScalarType current_target_dtype = at::kBFloat16;
+
+// Cast cache shared by all threads, so that the streams of a multi-stream
+// TaskModule cast and keep every weight only once. An entry is keyed on the
+// weight TensorImpl and target dtype and is only valid for the version of the
+// weight it was cast from, so in-place updates of the weight invalidate it.
+// The cache is split into stripes keyed on the TensorImpl address, each with
+// its own lock and LRU list. The memory cap applies to all the stripes
+// together; beyond it the least recently used cast of each stripe is evicted
+// in turn.
+class SharedCastCache {
+ public:
+  static SharedCastCache& get() {
+    static SharedCastCache cache;
+    return cache;
+  }
+
+  c10::optional<Tensor> lookup(const Tensor& arg, at::ScalarType to_type) {
+    Key key{arg.unsafeGetTensorImpl(), to_type};
+    auto& stripe = stripe_for(key.impl);
+    std::lock_guard<std::mutex> lock(stripe.mutex);
+    auto it = stripe.entries.find(key);
+    if (it == stripe.entries.end()) {
+      misses_++;
+      return c10::nullopt;
+    }
+    if (it->second.weakref.expired() ||
+        it->second.version != current_version(arg)) {
+      erase_locked(stripe, it);
+      misses_++;
+      return c10::nullopt;
+    }
+    stripe.lru.splice(stripe.lru.begin(), stripe.lru, it->second.lru_it);
+    hits_++;
+    return it->second.casted;
+  }
+
+  // Returns false if the cast does not fit in the whole capacity, in which
+  // case the caller keeps it in its thread-local cache instead.
+  bool insert(const Tensor& arg, at::ScalarType to_type, const Tensor& casted) {
+    Key key{arg.unsafeGetTensorImpl(), to_type};
+    int64_t nbytes = casted.nbytes();
+    if (nbytes > capacity_.load()) {
+      return false;
+    }
+    {
+      auto& stripe = stripe_for(key.impl);
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      auto it = stripe.entries.find(key);
+      if (it != stripe.entries.end()) {
+        erase_locked(stripe, it);
+      }
+      stripe.lru.push_front(key);
+      stripe.entries.emplace(
+          key,
+          Entry{
+              weakref_type(arg.getIntrusivePtr()),
+              current_version(arg),
+              casted,
+              stripe.lru.begin()});
+      stripe.bytes += nbytes;
+      bytes_ += nbytes;
+    }
+    evict_to(capacity_.load());
+    return true;
+  }
+
+  void clear() {
+    for (auto& stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      stripe.entries.clear();
+      stripe.lru.clear();
+      bytes_ -= stripe.bytes;
+      stripe.bytes = 0;
+    }
+  }
+
+  void set_capacity(int64_t capacity) {
+    TORCH_CHECK(
+        capacity >= 0, "autocast shared cache capacity should be >= 0");
+    capacity_ = capacity;
+    evict_to(capacity);
+  }
+
+  int64_t capacity() const {
+    return capacity_.load();
+  }
+
+  std::unordered_map<std::string, int64_t> stats() {
+    int64_t entries = 0;
+    int64_t bytes = 0;
+    for (auto& stripe : stripes_) {
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      entries += stripe.entries.size();
+      bytes += stripe.bytes;
+    }
+    return {
+        {"hits", hits_.load()},
+        {"misses", misses_.load()},
+        {"evictions", evictions_.load()},
+        {"entries", entries},
+        {"bytes", bytes}};
+  }
+
+ private:
+  static constexpr int64_t kNumStripes = 16;
+  static constexpr int64_t kDefaultCapacity = int64_t(4) << 30;
+
+  struct Key {
+    c10::TensorImpl* impl;
+    at::ScalarType dtype;
+    bool operator==(const Key& other) const {
+      return impl == other.impl && dtype == other.dtype;
+    }
+  };
+  struct KeyHash {
+    size_t operator()(const Key& key) const {
+      return std::hash<c10::TensorImpl*>()(key.impl) ^
+          static_cast<size_t>(key.dtype);
+    }
+  };
+  struct Entry {
+    weakref_type weakref;
+    uint32_t version;
+    at::Tensor casted;
+    std::list<Key>::iterator lru_it;
+  };
+  using EntryMap = std::unordered_map<Key, Entry, KeyHash>;
+  struct Stripe {
+    std::mutex mutex;
+    EntryMap entries;
+    std::list<Key> lru;
+    int64_t bytes = 0;
+  };
+
+  static uint32_t current_version(const Tensor& arg) {
+    return arg.unsafeGetTensorImpl()->version_counter().current_version();
+  }
+
+  Stripe& stripe_for(c10::TensorImpl* impl) {
+    // drop the low bits, a TensorImpl is far larger than 64 bytes
+    return stripes_[(reinterpret_cast<uintptr_t>(impl) >> 6) % kNumStripes];
+  }
+
+  void erase_locked(Stripe& stripe, EntryMap::iterator it) {
+    stripe.bytes -= it->second.casted.nbytes();
+    bytes_ -= it->second.casted.nbytes();
+    stripe.lru.erase(it->second.lru_it);
+    stripe.entries.erase(it);
+  }
+
+  // Evicts the least recently used cast of each stripe in turn until the
+  // cache fits in `capacity`. Casts of released weights are never touched
+  // again, so they reach the LRU ends first. Only one stripe is locked at a
+  // time.
+  void evict_to(int64_t capacity) {
+    int64_t empty_stripes = 0;
+    while (bytes_.load() > capacity && empty_stripes < kNumStripes) {
+      auto& stripe = stripes_[evict_cursor_++ % kNumStripes];
+      std::lock_guard<std::mutex> lock(stripe.mutex);
+      if (stripe.lru.empty()) {
+        empty_stripes++;
+        continue;
+      }
+      empty_stripes = 0;
+      erase_locked(stripe, stripe.entries.find(stripe.lru.back()));
+      evictions_++;
+    }
+  }
+
+  std::array<Stripe, kNumStripes> stripes_;
+  std::atomic<int64_t> capacity_{kDefaultCapacity};
+  std::atomic<int64_t> bytes_{0};
+  std::atomic<uint64_t> evict_cursor_{0};
+  std::atomic<int64_t> hits_{0};
+  std::atomic<int64_t> misses_{0};
+  std::atomic<int64_t> evictions_{0};
+};
+
+std::atomic<bool> shared_cache_enabled{false};
 } // namespace
 
 at::ScalarType get_autocast_dtype() {
@@ -27,9 +210,39 @@ void set_autocast_dtype(at::ScalarType dtype) {
 }
 
 void clear_autocast_cache() {
+  // The shared cache outlives the autocast regions of every single thread,
+  // its entries are dropped by the version check and weakref expiration
+  // instead, or explicitly by clear_autocast_shared_cache.
   cached_casts.clear();
 }
 
+void set_autocast_shared_cache_enabled(bool enabled) {
+  shared_cache_enabled = enabled;
+  if (!enabled) {
+    SharedCastCache::get().clear();
+  }
+}
+
+bool is_autocast_shared_cache_enabled() {
+  return shared_cache_enabled.load();
+}
+
+void set_autocast_shared_cache_capacity(int64_t capacity) {
+  SharedCastCache::get().set_capacity(capacity);
+}
+
+int64_t get_autocast_shared_cache_capacity() {
+  return SharedCastCache::get().capacity();
+}
+
+void clear_autocast_shared_cache() {
+  SharedCastCache::get().clear();
+}
+
+std::unordered_map<std::string, int64_t> get_autocast_shared_cache_stats() {
+  return SharedCastCache::get().stats();
+}
+
 Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg) {
   if (is_eligible_cpu(arg) && (arg.scalar_type() != to_type)) {
     bool can_try_cache =
@@ -37,6 +250,16 @@ Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg) {
          arg.requires_grad() && arg.is_leaf() && !arg.is_view() &&
          at::autocast::is_autocast_cache_enabled());
 
+    // inference tensors have no version counter to validate a shared entry
+    bool use_shared_cache =
+        can_try_cache && shared_cache_enabled.load() && !arg.is_inference();
+    if (use_shared_cache) {
+      auto cached = SharedCastCache::get().lookup(arg, to_type);
+      if (cached.has_value()) {
+        return cached.value();
+      }
+    }
+    // also holds the casts too large for the shared cache
     if (can_try_cache) {
       auto it = cached_casts.find(arg.unsafeGetTensorImpl());
       if (it != cached_casts.end()) {
@@ -54,7 +277,9 @@ Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg) {
       casted_arg = arg.to(at::kFloat);
       // casted_arg = arg.to_dense(at::kFloat);
     }
-    if (can_try_cache) {
+    bool shared = use_shared_cache &&
+        SharedCastCache::get().insert(arg, to_type, casted_arg);
+    if (can_try_cache && !shared) {
       cached_casts.emplace(
           arg.unsafeGetTensorImpl(),
           val_type{weakref_type(arg.getIntrusivePtr()), casted_arg});
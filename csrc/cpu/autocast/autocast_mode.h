@@ -42,6 +42,19 @@ TORCH_API at::ScalarType get_autocast_dtype();
 TORCH_API void set_autocast_dtype(at::ScalarType dtype);
 TORCH_API void clear_autocast_cache();
 
+// Process-wide autocast cast cache shared by all threads, used instead of the
+// per-thread cache when enabled. See SharedCastCache in autocast_mode.cpp.
+TORCH_API void set_autocast_shared_cache_enabled(bool enabled);
+TORCH_API bool is_autocast_shared_cache_enabled();
+// Memory cap of the cast weights in bytes, least recently used entries are
+// evicted beyond it.
+TORCH_API void set_autocast_shared_cache_capacity(int64_t capacity);
+TORCH_API int64_t get_autocast_shared_cache_capacity();
+TORCH_API void clear_autocast_shared_cache();
+// Returns {"hits", "misses", "evictions", "entries", "bytes"}.
+TORCH_API std::unordered_map<std::string, int64_t>
+get_autocast_shared_cache_stats();
+
 Tensor cpu_cached_cast(at::ScalarType to_type, const Tensor& arg);
 
 inline c10::optional<Tensor> cpu_cached_cast(
@@ -4,6 +4,8 @@
 #include <c10/core/ScalarType.h>
 #include <c10/util/Exception.h>
 
+#include "../utils/op_counters.h"
+
 #include <atomic>
 #include <type_traits>
 
@@ -17,6 +19,9 @@ using namespace c10;
 // the fastest available kernel is chosen based on the features reported by
 // cpuinfo.
 //
+// Every call through a stub is counted by the op counters (see
+// utils/op_counters.h) under the name torch_ipex::<stub name>.
+//
 // Example:
 //
 // In csrc/cpu/aten/MyKernel.h:
@@ -194,6 +199,7 @@ struct DispatchStub<rT (*)(Args...), T> {
   template <typename... ArgTypes>
   rT operator()(DeviceType device_type, ArgTypes&&... args) {
     FnPtr call_ptr = get_call_ptr(device_type);
+    IPEX_OP_COUNTER(counter, T::op_counter_name());
     return (*call_ptr)(std::forward<ArgTypes>(args)...);
   }
 
@@ -252,6 +258,9 @@ struct RegisterHIPDispatch {
     name() = default;                      \
     name(const name&) = delete;            \
     name& operator=(const name&) = delete; \
+    static const char* op_counter_name() { \
+      return "torch_ipex::" #name;         \
+    }                                      \
   };                                       \
   extern TORCH_API struct name name
 
@@ -218,10 +218,7 @@ at::Tensor mkldnn_to_dense(
   return cpu_tensor;
 }
 
-// Init a aten tensor according to ideep tensor's desc.
-at::Tensor empty_aten_tensor_from_desc(
-    const ideep::tensor::desc& desc,
-    const at::TensorOptions& options) {
+std::vector<int64_t> aten_sizes_from_desc(const ideep::tensor::desc& desc) {
   auto ndims = dynamic_cast<const dnnl::memory::desc*>(&desc)
                    ->get_ndims(); // desc.data.ndims;
   auto nblks = desc.get_inner_nblks(); // desc.blocking_desc().inner_nblks;
@@ -237,7 +234,14 @@ at::Tensor empty_aten_tensor_from_desc(
   for (auto i = 0; i < ndims; i++) {
     at_sizes[i] = padded_dims[i] / blk_size_per_dim[i];
   }
-  return at::empty(at_sizes, options);
+  return at_sizes;
+}
+
+// Init a aten tensor according to ideep tensor's desc.
+at::Tensor empty_aten_tensor_from_desc(
+    const ideep::tensor::desc& desc,
+    const at::TensorOptions& options) {
+  return at::empty(aten_sizes_from_desc(desc), options);
 }
 
 } // namespace cpu
@@ -35,6 +35,10 @@ at::Tensor mkldnn_to_dense(
     const at::Tensor& self,
     c10::optional<at::ScalarType> dtype = c10::nullopt);
 
+// Sizes of the ATen tensor holding a (blocked) ideep desc, the inner blocks
+// are appended as extra dims.
+std::vector<int64_t> aten_sizes_from_desc(const ideep::tensor::desc& desc);
+
 at::Tensor empty_aten_tensor_from_desc(
     const ideep::tensor::desc& desc,
     const at::TensorOptions& options);
@@ -72,7 +72,8 @@ inline void omp_reduce_buf(
 static std::vector<at::Tensor> fused_self_attention_fwd_unpad(
     double p,
     std::vector<at::Tensor> inputs,
-    bool training) {
+    bool training,
+    bool need_attention_output) {
   GlobalPass _gp(FWD);
   if (inputs[6].dtype() == at::kFloat) {
     typedef float T;
@@ -222,7 +223,7 @@ namespace {
 TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
   m.def(
       torch::schema(
-          "torch_ipex::fused_self_attention_fwd_unpad(float p, Tensor[] inputs,  bool training) -> Tensor[]",
+          "torch_ipex::fused_self_attention_fwd_unpad(float p, Tensor[] inputs,  bool training, bool need_attention_output=True) -> Tensor[]",
           c10::AliasAnalysisKind::PURE_FUNCTION),
       torch_ipex::tpp::fused_self_attention_fwd_unpad);
 
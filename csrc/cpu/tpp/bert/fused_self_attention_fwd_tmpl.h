@@ -29,6 +29,11 @@ float one_by_sqrt_H = 1.0 / sqrt(H);
 bool null_EHS = false;
 bool dt_bf16 = (t_HS.dtype() == at::kBFloat16);
 bool bf16_training = (training && dt_bf16);
+// Without backward, dropout or a request for the probabilities, the context
+// is computed block by block with an online softmax and the [N][SS1][S2][S2]
+// attention probabilities are never materialized.
+bool use_flash =
+    !training && !need_attention_output && p == 0 && t_HM.numel() == 0;
 auto t_EHS_orig = t_EHS;
 
 // std::cout << "B: " << B << " S1: " << S1 << " S2: " << S2 << " N: " << N << "
@@ -58,11 +63,13 @@ auto t_VL_V = t_EHS.new_empty({S1, N, S2, H});
 if (dt_bf16)
   t_VL_V = t_VL_V.view({S1, N, S2 / 2, H, 2});
 auto t_VL_TV = t_VL_V;
-auto t_AP = t_QL.new_empty({N, SS1, S2, S2});
+auto t_AP = use_flash ? t_QL.new_empty({0}) : t_QL.new_empty({N, SS1, S2, S2});
 auto t_CL = t_AP.new_empty({S1, N, S2, H});
 
 auto t_APD = t_AP;
-auto t_APD_mask = at::empty({N, SS1, (S2 * S2 + 15) / 16}, at::kShort);
+auto t_APD_mask = use_flash
+    ? at::empty({0}, at::kShort)
+    : at::empty({N, SS1, (S2 * S2 + 15) / 16}, at::kShort);
 if (p > 0 || t_HM.numel() != 0) {
   t_APD = at::empty_like(t_AP);
 }
@@ -140,6 +147,12 @@ if (training) {
       SCOPEIT(XformExtTPP<T>(S2, S2, XformTPP::XFORM_XPOSE_TPP), XPOSE);
   auto c_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
       S2, H, S2, S2 * S2, N * S2 * H, 0.0, XformTPP::XFORM_NONE_TPP, 0, S1)));
+  auto flash_softmax_tpp = SCOPEIT(FlashSoftMaxFwdTPP<T>(S2, S2), SOFTMAX);
+  auto flash_zero_tpp = SCOPEIT(SetZeroTPP<float>(S2 * H), EW_ZERO);
+  auto flash_scale_tpp = SCOPEIT((ScaleTPP<float, float>(H)), EW_SCL);
+  auto flash_out_tpp = SCOPEIT((ScaleTPP<float, T>(H)), EW_SCL);
+  auto flash_c_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, float>(
+      S2, H, S2, S2 * S2, N * S2 * H, 1.0, XformTPP::XFORM_NONE_TPP, 0, 1)));
 
   {
     RECORD_SCOPE(q_gemm, {t_HS, t_Wq_V});
@@ -297,7 +310,49 @@ if (training) {
   }
   // Take the dot product between "query" and "key" to get the raw attention
   // scores.
-  {
+  if (use_flash) {
+    RECORD_SCOPE(ac_gemm, {t_QL, t_KL_TV});
+    {
+      RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel for collapse(2) schedule(static, 1)
+      for (int b = 0; b < B; b++) {
+        for (int n = 0; n < N; n++) {
+          long start = offs[b];
+          long end = offs[b + 1];
+          for (int s11 = start; s11 < end; s11++) {
+            // only one block of scores and probabilities is live at a time,
+            // the context rows are accumulated in fp32 and rescaled whenever
+            // a new block raises their max
+            float AS[S2][S2];
+            T PB[S2][S2];
+            float CA[S2][H];
+            float rmax[S2], rsum[S2], corr[S2];
+            flash_zero_tpp(CA[0]);
+            for (int s2 = 0; s2 < S2; s2++) {
+              rmax[s2] = -FLT_MAX;
+              rsum[s2] = 0.0f;
+            }
+            for (int s21 = start; s21 < end; s21++) {
+              a_gemm_tpp(QL[s11][n], KL_TV[s21][n], AS[0], 1);
+              scale_tpp(AS[0], AS[0], one_by_sqrt_H);
+              if (t_AM.numel() != 0)
+                add_mask_tpp(AM[s21], AS[0]);
+              flash_softmax_tpp(AS[0], rmax, rsum, corr, PB[0]);
+              if (s21 != start) {
+                for (int s2 = 0; s2 < S2; s2++) {
+                  flash_scale_tpp(CA[s2], CA[s2], corr[s2]);
+                }
+              }
+              flash_c_gemm_tpp(PB[0], VL_V[s21][n], CA[0], 1);
+            }
+            for (int s2 = 0; s2 < S2; s2++) {
+              flash_out_tpp(CA[s2], CL[s11][n] + s2 * H, 1.0f / rsum[s2]);
+            }
+          }
+        }
+      }
+    }
+  } else {
     RECORD_SCOPE(ac_gemm, {t_QL, t_KL_TV});
     {
       RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
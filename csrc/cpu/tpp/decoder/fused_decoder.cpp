@@ -0,0 +1,89 @@
+
+#include <ATen/record_function.h>
+
+#include <dyndisp/DispatchStub.h>
+#include <torch/all.h>
+#include <iostream>
+#include <vector>
+#include "ext_tpp.h"
+#include "tensor_helper.h"
+#include "threaded_loops.h"
+#include "timing.h"
+#include "xsmm_functors.h"
+
+namespace torch_ipex {
+namespace tpp {
+
+REGISTER_LOCAL_SCOPE(dec_norm, "dec_norm");
+REGISTER_LOCAL_SCOPE(dec_kv_copy, "dec_kv_copy");
+REGISTER_LOCAL_SCOPE(dec_qkv_gemm, "dec_qkv_gemm");
+REGISTER_LOCAL_SCOPE(dec_kv_xpose, "dec_kv_xpose");
+REGISTER_LOCAL_SCOPE(dec_attn, "dec_attn");
+REGISTER_LOCAL_SCOPE(dec_o_gemm, "dec_o_gemm");
+REGISTER_LOCAL_SCOPE(dec_gu_gemm, "dec_gu_gemm");
+REGISTER_LOCAL_SCOPE(dec_dn_gemm, "dec_dn_gemm");
+
+static at::Tensor fused_rmsnorm_fwd(
+    double eps,
+    at::Tensor t_in,
+    at::Tensor t_gamma) {
+  GlobalPass _gp(FWD);
+  if (t_in.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_rmsnorm_fwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_rmsnorm_fwd_tmpl.h"
+  }
+}
+
+static std::vector<at::Tensor> fused_decoder_attention_fwd(
+    std::vector<at::Tensor> inputs,
+    long B) {
+  GlobalPass _gp(FWD);
+  if (inputs[0].dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_decoder_attention_fwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_decoder_attention_fwd_tmpl.h"
+  }
+}
+
+static at::Tensor fused_swiglu_mlp_fwd(
+    at::Tensor t_in,
+    at::Tensor t_wg,
+    at::Tensor t_wu,
+    at::Tensor t_wd) {
+  GlobalPass _gp(FWD);
+  if (t_in.dtype() == at::kFloat) {
+    typedef float T;
+#include "fused_swiglu_mlp_fwd_tmpl.h"
+  } else {
+    typedef bfloat16 T;
+#include "fused_swiglu_mlp_fwd_tmpl.h"
+  }
+}
+} // namespace tpp
+} // namespace torch_ipex
+namespace {
+TORCH_LIBRARY_FRAGMENT(torch_ipex, m) {
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_rmsnorm_fwd(float eps, Tensor t_in, Tensor t_gamma) -> Tensor",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_rmsnorm_fwd);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_decoder_attention_fwd(Tensor[] inputs, int B) -> Tensor[]",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_decoder_attention_fwd);
+
+  m.def(
+      torch::schema(
+          "torch_ipex::fused_swiglu_mlp_fwd(Tensor t_in, Tensor t_wg, Tensor t_wu, Tensor t_wd) -> Tensor",
+          c10::AliasAnalysisKind::PURE_FUNCTION),
+      torch_ipex::tpp::fused_swiglu_mlp_fwd);
+}
+} // namespace
@@ -0,0 +1,250 @@
+RECORD_FUNCTION("decoder_fwd", std::vector<c10::IValue>());
+// B  - Batch size
+// S  - Number of new tokens per sequence
+// P  - Number of cached tokens per sequence
+// N  - Number of attention heads
+// H  - Head size
+// KB - Number of keys per attention block
+auto t_HS = inputs[0]; // [B][S][HS] --> [S1][Nc][S2][Hc]
+auto t_Wq = inputs[1]; // [NH][HS] --> [N][Nc][Hc][H]
+auto t_Wk = inputs[2]; // [NH][HS] --> [N][Nc][Hc][H]
+auto t_Wv = inputs[3]; // [NH][HS] --> [N][Nc][Hc][H]
+auto t_Wo = inputs[4]; // [HS][NH] --> [Nk][N][H][Hk]
+auto t_cos = inputs[5]; // [max_pos][H], float
+auto t_sin = inputs[6]; // [max_pos][H], float
+auto t_pos = inputs[7]; // [B][S]
+auto t_AM = inputs[8]; // Optional [B][P + S], float
+auto t_K_past = inputs[9]; // Optional [B][N][P][H]
+auto t_V_past = inputs[10]; // Optional [B][N][P][H]
+// Optional cache buffers returned by the previous step, holding the past keys
+// and values in their first P rows. C is a multiple of KB.
+bool has_buf = inputs.size() > 11;
+auto t_K_buf = has_buf ? inputs[11] : at::Tensor(); // [B][N][C][H]
+auto t_V_buf = has_buf ? inputs[12] : at::Tensor(); // [B][N][C][H]
+auto t_KT_buf = has_buf ? inputs[13] : at::Tensor(); // [B][N][C/KB][H * KB]
+auto t_VV_buf = has_buf ? inputs[14] : at::Tensor(); // [B][N][C/KB][KB * H]
+
+auto sizes = t_HS.sizes();
+long S1 = sizes[0];
+long Nc = sizes[1];
+long S2 = sizes[2];
+long Hc = sizes[3];
+auto wt_sizes = t_Wq.sizes();
+long N = wt_sizes[0];
+long H = wt_sizes[3];
+auto o_sizes = t_Wo.sizes();
+long Nk = o_sizes[0];
+long Hk = o_sizes[3];
+long S1b = S1 / B;
+long S = S1b * S2;
+long P = t_K_past.numel() == 0 ? 0 : t_K_past.size(2);
+long T_ = P + S;
+const long KB = 64;
+long NKB = (T_ + KB - 1) / KB;
+long Tpad = NKB * KB;
+float one_by_sqrt_H = 1.0 / sqrt(H);
+bool dt_bf16 = (t_HS.dtype() == at::kBFloat16);
+PCL_ASSERT(S1 % B == 0, "Token blocks are not evenly split among sequences\n");
+
+// The new keys and values are appended to the buffers in place, and only the
+// key blocks from the one holding row P on are transposed again. The caller
+// passes the buffers only if no later step appended to them yet. Without
+// buffers, or without room for S more rows, new buffers of twice the length
+// are allocated and the past rows are copied once, so that the copies cost
+// O(1) per token amortized. Rows past the end are zero, so that the padding
+// keys of the last block, masked as future positions, add nothing to the
+// context.
+long C = 0;
+if (t_K_buf.defined() && t_K_buf.numel() != 0) {
+  auto buf_sizes = t_K_buf.sizes();
+  bool fits = t_K_buf.dtype() == t_HS.dtype() && t_K_buf.dim() == 4 &&
+      buf_sizes[0] == B && buf_sizes[1] == N && buf_sizes[3] == H &&
+      buf_sizes[2] % KB == 0 && buf_sizes[2] >= T_ &&
+      t_K_buf.is_contiguous() && t_V_buf.is_contiguous() &&
+      t_V_buf.sizes() == buf_sizes && t_KT_buf.is_contiguous() &&
+      t_KT_buf.numel() == t_K_buf.numel() &&
+      (!dt_bf16 ||
+       (t_VV_buf.is_contiguous() && t_VV_buf.numel() == t_K_buf.numel()));
+  if (fits)
+    C = buf_sizes[2];
+}
+bool in_place = C > 0;
+long kb0 = in_place ? P / KB : 0; // first key block to transpose
+if (!in_place) {
+  C = std::max(Tpad, (2 * T_ + KB - 1) / KB * KB);
+  t_K_buf = at::zeros({B, N, C, H}, t_HS.options());
+  t_V_buf = at::zeros({B, N, C, H}, t_HS.options());
+  t_KT_buf = t_HS.new_empty({B, N, C / KB, H * KB}); // VNNI for bf16
+  t_VV_buf = dt_bf16 ? t_HS.new_empty({B, N, C / KB, KB * H}) : t_V_buf;
+  // the past rows of a head have to be contiguous, other strides are free
+  if (P > 0 && !(t_K_past.stride(3) == 1 && t_K_past.stride(2) == H))
+    t_K_past = t_K_past.contiguous();
+  if (P > 0 && !(t_V_past.stride(3) == 1 && t_V_past.stride(2) == H))
+    t_V_past = t_V_past.contiguous();
+} else if (!dt_bf16) {
+  t_VV_buf = t_V_buf;
+}
+long NKBC = C / KB;
+
+auto t_Wq_V = wt_tensor_for_fwd(N, H, Nc, Hc, t_Wq);
+auto t_Wk_V = wt_tensor_for_fwd(N, H, Nc, Hc, t_Wk);
+auto t_Wv_V = wt_tensor_for_fwd(N, H, Nc, Hc, t_Wv);
+auto t_Wo_V = wt_tensor_for_fwd(Nk, Hk, N, H, t_Wo);
+
+auto t_QL = t_HS.new_empty({S1, N, S2, H});
+auto t_M = at::zeros({B, Tpad}, at::kFloat);
+if (t_AM.numel() != 0)
+  t_M.narrow(1, 0, T_).copy_(t_AM.view({B, T_}));
+auto t_CL = t_HS.new_empty({S1, N, S2, H});
+auto t_out = t_HS.new_empty({S1, Nk, S2, Hk});
+
+{
+  DECL_VLA_PTR_PT(T, K, [N][C * H], t_K_buf);
+  DECL_VLA_PTR_PT(T, V, [N][C * H], t_V_buf);
+  DECL_VLA_PTR_PT(T, KT, [N][NKBC][H * KB], t_KT_buf);
+  DECL_VLA_PTR_PT(T, VV, [N][NKBC][KB * H], t_VV_buf);
+  DECL_VLA_PTR_PT(T, QL, [N][S2 * H], t_QL);
+  DECL_VLA_PTR_PT(T, CL, [N][S2 * H], t_CL);
+  DECL_VLA_PTR_PT(float, M, [Tpad], t_M);
+  auto cos = t_cos.data_ptr<float>();
+  auto sin = t_sin.data_ptr<float>();
+  auto pos = t_pos.data_ptr<long>();
+
+  auto qkv_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+      S2, H, Hc, S2 * Hc, Hc * H, 0.0, XformTPP::XFORM_NONE_TPP, 0, Nc)));
+  auto rope_tpp = SCOPEIT(RoPEFwdTPP<T>(S2, H), EW_MUL);
+  auto k_xpose_tpp = SCOPEIT(
+      XformExtTPP<T>(KB, H, XformTPP::XFORM_XPOSE_N2V_TPP, true), XPOSE);
+  auto v_n2v_tpp =
+      SCOPEIT(XformExtTPP<T>(KB, H, XformTPP::XFORM_N2V_TPP, true), VNNI);
+  auto a_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, float>(
+      S2, KB, H, S2 * H, H * KB, 0.0, XformTPP::XFORM_NONE_TPP, 0, 1)));
+  auto scale_tpp = SCOPEIT((ScaleTPP<float, float>(S2 * KB)), EW_SCL);
+  auto add_mask_tpp = SCOPEIT(AddBiasTPP<float>(S2, KB), EW_ADD);
+  auto softmax_fwd_tpp = SCOPEIT(FlashSoftMaxFwdTPP<T>(S2, KB), SOFTMAX);
+  auto zero_tpp = SCOPEIT(SetZeroTPP<float>(S2 * H), EW_ZERO);
+  auto rescale_tpp = SCOPEIT((ScaleTPP<float, float>(H)), EW_SCL);
+  auto out_tpp = SCOPEIT((ScaleTPP<float, T>(H)), EW_SCL);
+  auto c_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, float>(
+      S2, H, KB, S2 * KB, KB * H, 1.0, XformTPP::XFORM_NONE_TPP, 0, 1)));
+  auto o_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+      S2, Hk, H, S2 * H, H * Hk, 0.0, XformTPP::XFORM_NONE_TPP, 0, N)));
+
+  if (!in_place && P > 0) {
+    RECORD_SCOPE(dec_kv_copy, {t_K_past, t_V_past});
+    RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel for collapse(2)
+    for (int b = 0; b < B; b++) {
+      for (int n = 0; n < N; n++) {
+        auto K_past = t_K_past.data_ptr<T>() + b * t_K_past.stride(0) +
+            n * t_K_past.stride(1);
+        auto V_past = t_V_past.data_ptr<T>() + b * t_V_past.stride(0) +
+            n * t_V_past.stride(1);
+        memcpy(K[b][n], K_past, P * H * sizeof(T));
+        memcpy(V[b][n], V_past, P * H * sizeof(T));
+      }
+    }
+  }
+
+  {
+    RECORD_SCOPE(dec_qkv_gemm, {t_HS, t_Wq_V, t_Wk_V, t_Wv_V});
+    auto qkv_loop = ThreadedLoop<2>({LoopSpecs{S1}, LoopSpecs{N}}, "AB");
+    qkv_loop(
+        [&](int* ind) {
+          int s1 = ind[0], nk = ind[1];
+          DECL_VLA_PTR_PT(T, HS, [Nc][S2 * Hc], t_HS);
+          DECL_VLA_PTR_PT(T, Wq_V, [Nc][Hc * H], t_Wq_V);
+          DECL_VLA_PTR_PT(T, Wk_V, [Nc][Hc * H], t_Wk_V);
+          DECL_VLA_PTR_PT(T, Wv_V, [Nc][Hc * H], t_Wv_V);
+          long b = s1 / S1b;
+          long t0 = P + (s1 % S1b) * S2;
+          // new keys and values go straight to their cache rows
+          T* KL = K[b][nk] + t0 * H;
+          T* VL = V[b][nk] + t0 * H;
+          qkv_gemm_tpp(HS[s1][0], Wq_V[nk][0], QL[s1][nk], Nc, true);
+          rope_tpp(QL[s1][nk], cos, sin, &pos[s1 * S2], QL[s1][nk]);
+          qkv_gemm_tpp(HS[s1][0], Wk_V[nk][0], KL, Nc, true);
+          rope_tpp(KL, cos, sin, &pos[s1 * S2], KL);
+          qkv_gemm_tpp(HS[s1][0], Wv_V[nk][0], VL, Nc, true);
+        },
+        [&]() { qkv_gemm_tpp.config(); },
+        [&]() { qkv_gemm_tpp.release(); });
+  }
+
+  {
+    RECORD_SCOPE(dec_kv_xpose, {t_K_buf, t_V_buf});
+    RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel for collapse(3)
+    for (int b = 0; b < B; b++) {
+      for (int n = 0; n < N; n++) {
+        for (int kb = kb0; kb < NKB; kb++) {
+          k_xpose_tpp(K[b][n] + kb * KB * H, KT[b][n][kb]);
+          if (dt_bf16)
+            v_n2v_tpp(V[b][n] + kb * KB * H, VV[b][n][kb]);
+        }
+      }
+    }
+  }
+
+  {
+    RECORD_SCOPE(dec_attn, {t_QL, t_KT_buf});
+    RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel for collapse(2) schedule(static, 1)
+    for (int b = 0; b < B; b++) {
+      for (int n = 0; n < N; n++) {
+        for (int ls1 = 0; ls1 < S1b; ls1++) {
+          long s1 = b * S1b + ls1;
+          long q0 = P + ls1 * S2;
+          long nkb = (q0 + S2 + KB - 1) / KB;
+          float AS[S2][KB];
+          T PB[S2][KB];
+          float CA[S2][H];
+          float rmax[S2], rsum[S2], corr[S2];
+          zero_tpp(CA[0]);
+          for (int s2 = 0; s2 < S2; s2++) {
+            rmax[s2] = -FLT_MAX;
+            rsum[s2] = 0.0f;
+          }
+          for (int kb = 0; kb < nkb; kb++) {
+            a_gemm_tpp(QL[s1][n], KT[b][n][kb], AS[0], 1);
+            scale_tpp(AS[0], AS[0], one_by_sqrt_H);
+            if (t_AM.numel() != 0)
+              add_mask_tpp(M[b] + kb * KB, AS[0]);
+            if ((kb + 1) * KB > q0 + 1) {
+              // causal mask on the blocks crossing the diagonal
+              for (int s2 = 0; s2 < S2; s2++) {
+                for (int k = std::max(0L, q0 + s2 + 1 - kb * KB); k < KB; k++)
+                  AS[s2][k] = -FLT_MAX;
+              }
+            }
+            softmax_fwd_tpp(AS[0], rmax, rsum, corr, PB[0]);
+            if (kb > 0) {
+              for (int s2 = 0; s2 < S2; s2++) {
+                rescale_tpp(CA[s2], CA[s2], corr[s2]);
+              }
+            }
+            c_gemm_tpp(PB[0], VV[b][n][kb], CA[0], 1);
+          }
+          for (int s2 = 0; s2 < S2; s2++) {
+            out_tpp(CA[s2], CL[s1][n] + s2 * H, 1.0f / rsum[s2]);
+          }
+        }
+      }
+    }
+  }
+
+  {
+    RECORD_SCOPE(dec_o_gemm, {t_CL, t_Wo_V});
+    auto o_loop = ThreadedLoop<2>({LoopSpecs{S1}, LoopSpecs{Nk}}, "AB");
+    o_loop(
+        [&](int* ind) {
+          int s1 = ind[0], nk = ind[1];
+          DECL_VLA_PTR_PT(T, Wo_V, [N][H * Hk], t_Wo_V);
+          DECL_VLA_PTR_PT(T, out, [Nk][S2 * Hk], t_out);
+          o_gemm_tpp(CL[s1][0], Wo_V[nk][0], out[s1][nk], N, true);
+        },
+        [&]() { o_gemm_tpp.config(); },
+        [&]() { o_gemm_tpp.release(); });
+  }
+}
+return std::vector<at::Tensor>({t_out, t_K_buf, t_V_buf, t_KT_buf, t_VV_buf});
@@ -0,0 +1,25 @@
+RECORD_FUNCTION("decoder_fwd", std::vector<c10::IValue>());
+auto in_sizes = t_in.sizes(); // [S1][Nc][S2][Hc]
+auto S1 = in_sizes[0];
+auto Nc = in_sizes[1];
+auto S2 = in_sizes[2];
+auto Hc = in_sizes[3];
+
+auto t_out = t_in.new_empty({S1, Nc, S2, Hc});
+auto t_rstd = t_in.new_empty({S1, S2}, at::kFloat);
+
+auto rms_norm_fwd_tpp = SCOPEIT(RMSNormFwdTPP<T>(Nc, S2, Hc, eps), LAYER_NORM);
+
+{
+  RECORD_SCOPE(dec_norm, {t_in, t_gamma});
+  DECL_VLA_PTR_PT(T, in, [Nc * S2 * Hc], t_in);
+  DECL_VLA_PTR_PT(T, gamma, [Hc], t_gamma);
+  DECL_VLA_PTR_PT(float, rstd, [S2], t_rstd);
+  DECL_VLA_PTR_PT(T, out, [Nc * S2 * Hc], t_out);
+  RECORD_FUNCTION("parallel_for", std::vector<c10::IValue>());
+#pragma omp parallel for
+  for (int s1 = 0; s1 < S1; s1++) {
+    rms_norm_fwd_tpp(in[s1], gamma[0], rstd[s1], out[s1]);
+  }
+}
+return t_out;
@@ -0,0 +1,96 @@
+RECORD_FUNCTION("decoder_fwd", std::vector<c10::IValue>());
+auto in_sizes = t_in.sizes(); // [S1][Nc][S2][Hc]
+auto wt_sizes = t_wg.sizes(); // [Ni][Nc][Hc][Hi]
+auto S1 = in_sizes[0];
+auto Nc = in_sizes[1];
+auto S2 = in_sizes[2];
+auto Hc = in_sizes[3];
+
+auto Ni = wt_sizes[0];
+auto Hi = wt_sizes[3];
+
+auto t_wg_V = wt_tensor_for_fwd(Ni, Hi, Nc, Hc, t_wg);
+auto t_wu_V = wt_tensor_for_fwd(Ni, Hi, Nc, Hc, t_wu);
+auto t_wd_V = wt_tensor_for_fwd(Nc, Hc, Ni, Hi, t_wd);
+
+auto t_act = t_in.new_empty({S1, Ni, S2, Hi});
+auto t_out = t_in.new_empty({S1, Nc, S2, Hc});
+
+auto Ncb = Nc;
+if (Nc > Ni && Nc % Ni == 0) {
+  Ncb = Ni;
+}
+auto Nib = Ni;
+if (Ni > Nc && Ni % Nc == 0) {
+  Nib = Nc;
+}
+// Create TPPs
+auto gate_up_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+    S2,
+    Hi,
+    Hc,
+    S2* Hc,
+    Hi* Hc,
+    1.0,
+    XformTPP::XFORM_NONE_TPP,
+    0,
+    Ncb)));
+auto down_gemm_tpp = SCOPEITGEMM((BrgemmExtTPP<T, T>(
+    S2,
+    Hc,
+    Hi,
+    S2* Hi,
+    Hc* Hi,
+    1.0,
+    XformTPP::XFORM_NONE_TPP,
+    0,
+    Nib)));
+auto zero_i_tpp = SCOPEIT(SetZeroTPP<T>(S2 * Hi), EW_ZERO);
+auto zero_c_tpp = SCOPEIT(SetZeroTPP<T>(S2 * Hc), EW_ZERO);
+auto silu_fwd_tpp = SCOPEIT(SiLUFwdTPP<T>(S2 * Hi), ACT);
+auto mul_tpp = SCOPEIT((MulTPP<T, T>(S2 * Hi)), EW_MUL);
+
+{
+  RECORD_SCOPE(dec_gu_gemm, {t_in, t_wg_V, t_wu_V});
+  auto gemm_loop = ThreadedLoop<2>({LoopSpecs{S1}, LoopSpecs{Ni}}, "AB");
+  gemm_loop(
+      [&](int* ind) {
+        int s1 = ind[0], ni = ind[1];
+        DECL_VLA_PTR_PT(T, in, [Nc][S2 * Hc], t_in);
+        DECL_VLA_PTR_PT(T, wg_V, [Nc][Hc * Hi], t_wg_V);
+        DECL_VLA_PTR_PT(T, wu_V, [Nc][Hc * Hi], t_wu_V);
+        DECL_VLA_PTR_PT(T, act, [Ni][S2 * Hi], t_act);
+        // the gate and its SiLU never leave the thread
+        T gate[S2 * Hi], sig[S2 * Hi];
+        zero_i_tpp(gate);
+        zero_i_tpp(act[s1][ni]);
+        for (int nc = 0; nc < Nc; nc += Ncb) {
+          gate_up_gemm_tpp(in[s1][nc], wg_V[ni][nc], gate, Ncb, true);
+          gate_up_gemm_tpp(in[s1][nc], wu_V[ni][nc], act[s1][ni], Ncb, true);
+        }
+        silu_fwd_tpp(gate, gate, sig);
+        mul_tpp(gate, act[s1][ni], act[s1][ni]);
+      },
+      [&]() { gate_up_gemm_tpp.config(); },
+      [&]() { gate_up_gemm_tpp.release(); });
+}
+
+{
+  RECORD_SCOPE(dec_dn_gemm, {t_act, t_wd_V});
+  auto gemm_loop = ThreadedLoop<3>(
+      {LoopSpecs{0, Ni, Nib, false}, LoopSpecs{S1}, LoopSpecs{Nc}}, "acB");
+  gemm_loop(
+      [&](int* ind) {
+        int ni = ind[0], s1 = ind[1], nc = ind[2];
+        DECL_VLA_PTR_PT(T, act, [Ni][S2 * Hi], t_act);
+        DECL_VLA_PTR_PT(T, wd_V, [Ni][Hi * Hc], t_wd_V);
+        DECL_VLA_PTR_PT(T, out, [Nc][S2 * Hc], t_out);
+        if (ni == 0) {
+          zero_c_tpp(out[s1][nc]);
+        }
+        down_gemm_tpp(act[s1][ni], wd_V[nc][ni], out[s1][nc], Nib, true);
+      },
+      [&]() { down_gemm_tpp.config(); },
+      [&]() { down_gemm_tpp.release(); });
+}
+return t_out;
@@ -12,6 +12,7 @@
 #endif
 
 #include <atomic>
+#include <vector>
 
 namespace torch_ipex {
 namespace tpp {
@@ -95,6 +96,77 @@ static int sparse_add_use_lock_free() {
   return lock_free;
 }
 
+// Sparse row ids grouped by the thread owning their dense row, kept per
+// calling thread so that the buffers are reused by the following steps.
+struct SparseRowBuckets {
+  std::vector<long> counts;
+  std::vector<long> rows;
+};
+
+// Lock free update of the dense rows indexed by a sparse tensor: thread t
+// owns the dense rows [t * M / nthr, (t + 1) * M / nthr). The sparse rows are
+// first bucketed by owner in parallel, then every thread only applies the
+// rows of its bucket, so the work is O(NS) instead of every thread scanning
+// all the NS indices. Each dense row still receives its updates in the order
+// of the sparse rows.
+template <typename F>
+static void bucketed_sparse_update(
+    const long* indices,
+    long NS,
+    long M,
+    int nthr,
+    const F& update) {
+  static thread_local SparseRowBuckets buckets;
+  auto& counts = buckets.counts;
+  auto& rows = buckets.rows;
+  counts.assign((long)nthr * nthr, 0);
+  if ((long)rows.size() < NS)
+    rows.resize(NS);
+#pragma omp parallel num_threads(nthr)
+  {
+    const int nt = omp_get_num_threads();
+    const int tid = omp_get_thread_num();
+    auto owner = [&](long ind) -> long {
+      return (ind >= 0 && ind < M) ? ((ind + 1) * nt - 1) / M : -1;
+    };
+    const long i_begin = (tid * NS) / nt;
+    const long i_end = ((tid + 1) * NS) / nt;
+    long* my_counts = &counts[(long)tid * nt];
+    for (long i = i_begin; i < i_end; i++) {
+      auto o = owner(indices[i]);
+      if (o >= 0)
+        my_counts[o]++;
+    }
+#pragma omp barrier
+#pragma omp single
+    {
+      // exclusive scan in (owner, chunk) order
+      long offset = 0;
+      for (int o = 0; o < nt; o++) {
+        for (int t = 0; t < nt; t++) {
+          auto count = counts[(long)t * nt + o];
+          counts[(long)t * nt + o] = offset;
+          offset += count;
+        }
+      }
+    }
+    for (long i = i_begin; i < i_end; i++) {
+      auto o = owner(indices[i]);
+      if (o >= 0)
+        rows[my_counts[o]++] = i;
+    }
+#pragma omp barrier
+    // the positions of the last chunk now point at the end of every bucket
+    const long* bucket_ends = &counts[(long)(nt - 1) * nt];
+    const long r_begin = tid == 0 ? 0 : bucket_ends[tid - 1];
+    const long r_end = bucket_ends[tid];
+    for (long r = r_begin; r < r_end; r++) {
+      auto i = rows[r];
+      update(i, indices[i]);
+    }
+  }
+}
+
 template <typename scalar_t>
 void dense_sparse_add_tmpl(
     at::Tensor t_dense,
@@ -123,20 +195,13 @@ void dense_sparse_add_tmpl(
     int nthr = max_thr;
     if (M < nthr)
       nthr = M;
-#pragma omp parallel num_threads(nthr)
-    {
-      int tid = omp_get_thread_num();
-      long j_begin = (tid * M) / nthr;
-      long j_end = ((tid + 1) * M) / nthr;
-      for (long i = 0; i < NS; i++) {
-        auto ind = indices[i];
-        if (ind >= j_begin && ind < j_end) {
-          auto wa = &dense[ind * E];
-          auto va = &values[i * E];
-          embbag_upd(va, wa, lr);
-        }
-      }
-    }
+    if (NS == 0 || nthr == 0)
+      return;
+    bucketed_sparse_update(indices, NS, M, nthr, [&](long i, long ind) {
+      auto wa = &dense[ind * E];
+      auto va = &values[i * E];
+      embbag_upd(va, wa, lr);
+    });
   } else {
 #ifdef ENABLE_RTM
     SimpleSpinLock fallBackLock;
@@ -202,21 +267,14 @@ void bf16_split_add_(
       int nthr = max_thr;
       if (M < nthr)
         nthr = M;
-#pragma omp parallel num_threads(nthr)
-      {
-        int tid = omp_get_thread_num();
-        long j_begin = (tid * M) / nthr;
-        long j_end = ((tid + 1) * M) / nthr;
-        for (long i = 0; i < NS; i++) {
-          auto ind = indices_data[i];
-          if (ind >= j_begin && ind < j_end) {
-            auto ha = &hi_data[ind * E];
-            auto la = &lo_data[ind * E];
-            auto va = &values_data[i * E];
-            split_sgd_kernel((at::BFloat16*)ha, (at::BFloat16*)la, va, lr);
-          }
-        }
-      }
+      if (NS == 0 || nthr == 0)
+        return;
+      bucketed_sparse_update(indices_data, NS, M, nthr, [&](long i, long ind) {
+        auto ha = &hi_data[ind * E];
+        auto la = &lo_data[ind * E];
+        auto va = &values_data[i * E];
+        split_sgd_kernel((at::BFloat16*)ha, (at::BFloat16*)la, va, lr);
+      });
     } else {
 #ifdef ENABLE_RTM
       SimpleSpinLock fallBackLock;
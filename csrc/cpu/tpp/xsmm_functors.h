@@ -12,6 +12,7 @@
 //#else
 // include <pytorch_extension_wrapper.h>
 //#endif
+#include <cfloat>
 #include <string>
 #include <unordered_map>
 
@@ -770,6 +771,46 @@ class AddTPP {
   BinaryTPP kernel;
 };
 
+template <typename Tin, typename Tout = Tin>
+class MulTPP {
+ public:
+  MulTPP() {}
+  MulTPP(int N) : MulTPP(1, N) {}
+  MulTPP(int rows, int cols) : MulTPP(rows, cols, cols, cols) {}
+  MulTPP(int rows, int cols, int ldi, int ldo)
+      : rows(rows),
+        cols(cols),
+        ldi(ldi),
+        ldo(ldo),
+        kernel(
+            rows,
+            cols,
+            ldi,
+            ldo,
+            XsmmDtype<Tin>(),
+            XsmmDtype<Tout>(),
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_BINARY_NONE,
+            LIBXSMM_MELTW_TYPE_BINARY_MUL) {}
+  void operator()(Tin* in0, Tin* in1, Tout* out) {
+    kernel((void*)in0, (void*)in1, (void*)out);
+  }
+  void ref(Tin* in0, Tin* in1, Tout* out) {
+    for (int r = 0; r < rows; r++) {
+      for (int c = 0; c < cols; c++) {
+        out[r * ldo + c] = (float)in0[r * ldi + c] * (float)in1[r * ldi + c];
+      }
+    }
+  }
+
+ private:
+  int rows = 0;
+  int cols = 0;
+  int ldi;
+  int ldo;
+  BinaryTPP kernel;
+};
+
 template <typename Tin>
 class GradBiasTPP {
  public:
@@ -2985,6 +3026,113 @@ class VarSoftMaxFwdTPP {
   BinaryTPP kmul;
 };
 
+// Online softmax over one [S2][S3] block of attention scores at a time.
+// max and sum keep the running row max and sum of exponentials over the
+// blocks seen so far and start at -FLT_MAX and 0 (a finite max keeps corr at 0
+// rather than NaN for the first block). corr returns the factor by which the
+// previous partial results of each row have to be rescaled and out gets the
+// unnormalized probabilities exp(in - max) of the block.
+template <typename Tout>
+class FlashSoftMaxFwdTPP {
+ public:
+  FlashSoftMaxFwdTPP() {}
+  FlashSoftMaxFwdTPP(int S2, int S3)
+      : S2(S2),
+        S3(S3),
+        kmax(
+            1,
+            S3,
+            S3,
+            S3,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_REDUCE_ROWS,
+            LIBXSMM_MELTW_TYPE_UNARY_REDUCE_X_OP_MAX),
+        ksub(
+            1,
+            S3,
+            S3,
+            S3,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_BINARY_BCAST_SCALAR_IN_1,
+            LIBXSMM_MELTW_TYPE_BINARY_SUB),
+        kexp(
+            1,
+            S3,
+            S3,
+            S3,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_NONE,
+            LIBXSMM_MELTW_TYPE_UNARY_EXP),
+        ksum(
+            1,
+            S3,
+            S3,
+            S3,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_REDUCE_ROWS,
+            LIBXSMM_MELTW_TYPE_UNARY_REDUCE_X_OP_ADD),
+        kcvt(
+            1,
+            S3,
+            S3,
+            S3,
+            LIBXSMM_DATATYPE_F32,
+            XsmmDtype<Tout>(),
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_NONE,
+            LIBXSMM_MELTW_TYPE_UNARY_IDENTITY) {}
+  void operator()(float* in, float* max, float* sum, float* corr, Tout* out) {
+    for (int s2 = 0; s2 < S2; s2++) {
+      LIBXSMM_ALIGNED(float tmp[S3], 64);
+      float rmax = 0;
+      kmax(&in[s2 * S3], &rmax);
+      float new_max = max[s2] < rmax ? rmax : max[s2];
+      corr[s2] = expf(max[s2] - new_max);
+      max[s2] = new_max;
+      ksub(&in[s2 * S3], &new_max, tmp);
+      kexp(tmp, tmp);
+      float lsum;
+      ksum(tmp, &lsum);
+      sum[s2] = sum[s2] * corr[s2] + lsum;
+      kcvt(tmp, &out[s2 * S3]);
+    }
+  }
+  void ref(float* in, float* max, float* sum, float* corr, Tout* out) {
+    for (int s2 = 0; s2 < S2; s2++) {
+      float new_max = max[s2];
+      for (int s3 = 0; s3 < S3; s3++) {
+        if (new_max < in[s2 * S3 + s3])
+          new_max = in[s2 * S3 + s3];
+      }
+      corr[s2] = expf(max[s2] - new_max);
+      max[s2] = new_max;
+      float lsum = 0.0f;
+      for (int s3 = 0; s3 < S3; s3++) {
+        float z = expf(in[s2 * S3 + s3] - new_max);
+        lsum += z;
+        out[s2 * S3 + s3] = z;
+      }
+      sum[s2] = sum[s2] * corr[s2] + lsum;
+    }
+  }
+
+ private:
+  int S2, S3;
+  UnaryTPP kmax;
+  BinaryTPP ksub;
+  UnaryTPP kexp;
+  UnaryTPP ksum;
+  UnaryTPP kcvt;
+};
+
 template <typename T1, typename T2, typename T3>
 class VarSoftMaxBwdTPP {
  public:
@@ -3326,6 +3474,143 @@ class LayerNormFwdTPP {
   Eqn eqn;
 };
 
+// RMSNorm over the S1 x S3 features of each of the S2 rows of a
+// [S1][S2][S3] blocked input: out = in / sqrt(mean(in^2) + eps) * gamma.
+template <typename T>
+class RMSNormFwdTPP {
+ public:
+  RMSNormFwdTPP() {}
+  RMSNormFwdTPP(int S1, int S2, int S3, float eps)
+      : S1(S1),
+        S2(S2),
+        S3(S3),
+        eps(eps),
+        reduce_cols_kernel(
+            S1,
+            S3,
+            S2 * S3,
+            S3,
+            XsmmDtype<T>(),
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_REDUCE_COLS,
+            LIBXSMM_MELTW_TYPE_UNARY_REDUCE_X2_OP_ADD),
+        reduce_rows_kernel(
+            1,
+            S3,
+            S3,
+            1,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_UNARY_REDUCE_ROWS,
+            LIBXSMM_MELTW_TYPE_UNARY_REDUCE_X_OP_ADD),
+        scale_kernel(
+            S1,
+            S3,
+            S2 * S3,
+            1,
+            S3,
+            XsmmDtype<T>(),
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_BINARY_BCAST_SCALAR_IN_1,
+            LIBXSMM_MELTW_TYPE_BINARY_MUL),
+        gamma_kernel(
+            S1,
+            S3,
+            S3,
+            S3,
+            S2 * S3,
+            LIBXSMM_DATATYPE_F32,
+            XsmmDtype<T>(),
+            XsmmDtype<T>(),
+            LIBXSMM_DATATYPE_F32,
+            LIBXSMM_MELTW_FLAG_BINARY_NONE,
+            LIBXSMM_MELTW_TYPE_BINARY_MUL) {}
+  void operator()(T* inp, T* gamma, float* rstd, T* out) {
+    LIBXSMM_ALIGNED(float tmp[S1 * S3], 64);
+    const float c = 1.0 / ((float)S1 * S3);
+    for (int s2 = 0; s2 < S2; s2++) {
+      float v;
+      reduce_cols_kernel((void*)&inp[s2 * S3], (void*)tmp);
+      reduce_rows_kernel((void*)tmp, (void*)&v);
+      v = 1.0f / ((float)sqrt(v * c + eps));
+      rstd[s2] = v;
+      scale_kernel((void*)&inp[s2 * S3], (void*)&v, (void*)tmp);
+      gamma_kernel((void*)tmp, (void*)gamma, (void*)&out[s2 * S3]);
+    }
+  }
+  void ref(T* pinp, T* pgamma, float* rstd, T* pout) {
+    int s1, s2, s3;
+    LIBXSMM_VLA_DECL(3, T, inp, pinp, S2, S3);
+    LIBXSMM_VLA_DECL(3, T, out, pout, S2, S3);
+    LIBXSMM_VLA_DECL(2, T, gamma, pgamma, S3);
+    for (s2 = 0; s2 < S2; s2++) {
+      float v = 0;
+      float c = 1.0 / (S1 * S3);
+      for (s1 = 0; s1 < S1; s1++) {
+        for (s3 = 0; s3 < S3; s3++) {
+          float x = LIBXSMM_VLA_ACCESS(3, inp, s1, s2, s3, S2, S3);
+          v += x * x;
+        }
+      }
+      v = 1.0f / ((float)sqrt(v * c + eps));
+      rstd[s2] = v;
+      for (s1 = 0; s1 < S1; s1++) {
+        for (s3 = 0; s3 < S3; s3++) {
+          LIBXSMM_VLA_ACCESS(3, out, s1, s2, s3, S2, S3) =
+              (float)LIBXSMM_VLA_ACCESS(3, inp, s1, s2, s3, S2, S3) * v *
+              (float)LIBXSMM_VLA_ACCESS(2, gamma, s1, s3, S3);
+        }
+      }
+    }
+  }
+
+ private:
+  int S1, S2, S3;
+  float eps;
+  UnaryTPP reduce_cols_kernel;
+  UnaryTPP reduce_rows_kernel;
+  BinaryTPP scale_kernel;
+  BinaryTPP gamma_kernel;
+};
+
+// Rotary position embedding of [rows][H] head vectors in the rotate-half
+// convention: the first and second halves of each vector are rotated as
+// pairs (x[i], x[i + H / 2]). cos and sin are [max_pos][H] tables and pos
+// gives the position of each row.
+template <typename T>
+class RoPEFwdTPP {
+ public:
+  RoPEFwdTPP() {}
+  RoPEFwdTPP(int rows, int H) : rows(rows), H(H) {}
+  void operator()(T* in, float* cos, float* sin, long* pos, T* out) {
+    ref(in, cos, sin, pos, out);
+  }
+  void ref(T* in, float* cos, float* sin, long* pos, T* out) {
+    const int H2 = H / 2;
+    for (int r = 0; r < rows; r++) {
+      T* x = &in[r * H];
+      T* y = &out[r * H];
+      float* c = &cos[pos[r] * H];
+      float* s = &sin[pos[r] * H];
+#pragma omp simd
+      for (int i = 0; i < H2; i++) {
+        float x1 = x[i];
+        float x2 = x[i + H2];
+        y[i] = x1 * c[i] - x2 * s[i];
+        y[i + H2] = x2 * c[i + H2] + x1 * s[i + H2];
+      }
+    }
+  }
+
+ private:
+  int rows = 0;
+  int H = 0;
+};
+
 template <typename T>
 class LayerNormBwdTPP {
  public:
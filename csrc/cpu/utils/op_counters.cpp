@@ -0,0 +1,330 @@
+#include "op_counters.h"
+
+#include <c10/util/Exception.h>
+#include <c10/util/llvmMathExtras.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace torch_ipex {
+namespace utils {
+
+namespace {
+
+constexpr int64_t kMaxOpCounters = 1024;
+
+bool op_counters_enabled_from_env() {
+  const char* val = std::getenv("IPEX_OP_COUNTERS");
+  return val == nullptr || std::strcmp(val, "0") != 0;
+}
+
+// The counters of one op in one thread. Only the owner thread writes them,
+// so an update is a relaxed load and store instead of a locked instruction;
+// the snapshot reads them concurrently with relaxed loads.
+struct OpCounterSlot {
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> ticks{0};
+  std::atomic<uint64_t> flops{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> buckets[kOpCounterBuckets] = {};
+};
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t value) {
+  counter.store(
+      counter.load(std::memory_order_relaxed) + value,
+      std::memory_order_relaxed);
+}
+
+struct OpCounterTotals {
+  uint64_t count = 0;
+  uint64_t ticks = 0;
+  uint64_t flops = 0;
+  uint64_t bytes = 0;
+  uint64_t buckets[kOpCounterBuckets] = {};
+
+  void add(const OpCounterSlot& slot) {
+    count += slot.count.load(std::memory_order_relaxed);
+    ticks += slot.ticks.load(std::memory_order_relaxed);
+    flops += slot.flops.load(std::memory_order_relaxed);
+    bytes += slot.bytes.load(std::memory_order_relaxed);
+    for (int k = 0; k < kOpCounterBuckets; k++) {
+      buckets[k] += slot.buckets[k].load(std::memory_order_relaxed);
+    }
+  }
+
+  void add(const OpCounterTotals& other) {
+    count += other.count;
+    ticks += other.ticks;
+    flops += other.flops;
+    bytes += other.bytes;
+    for (int k = 0; k < kOpCounterBuckets; k++) {
+      buckets[k] += other.buckets[k];
+    }
+  }
+
+  void sub(const OpCounterTotals& other) {
+    count -= other.count;
+    ticks -= other.ticks;
+    flops -= other.flops;
+    bytes -= other.bytes;
+    for (int k = 0; k < kOpCounterBuckets; k++) {
+      buckets[k] -= other.buckets[k];
+    }
+  }
+};
+
+// The slots of one thread, allocated on the first call of each op and
+// published to the snapshot with a release store.
+struct ThreadOpCounters {
+  std::atomic<OpCounterSlot*> slots[kMaxOpCounters] = {};
+
+  ~ThreadOpCounters() {
+    for (auto& slot : slots) {
+      delete slot.load(std::memory_order_relaxed);
+    }
+  }
+
+  OpCounterSlot& get(int64_t id) {
+    auto* slot = slots[id].load(std::memory_order_relaxed);
+    if (C10_UNLIKELY(slot == nullptr)) {
+      slot = new OpCounterSlot();
+      slots[id].store(slot, std::memory_order_release);
+    }
+    return *slot;
+  }
+};
+
+class OpCounterRegistry {
+ public:
+  static OpCounterRegistry& get() {
+    // never destroyed, the threads may exit after the static destructors
+    static auto* registry = new OpCounterRegistry();
+    return *registry;
+  }
+
+  int64_t register_op(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    if (names_.size() == kMaxOpCounters) {
+      TORCH_WARN_ONCE(
+          "Op counters: too many ops, ",
+          name,
+          " and the next ones are not counted");
+      return -1;
+    }
+    names_.push_back(name);
+    retired_.emplace_back();
+    baseline_.emplace_back();
+    return ids_[name] = names_.size() - 1;
+  }
+
+  void add_thread(ThreadOpCounters* counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    threads_.push_back(counters);
+  }
+
+  // Keeps the counts of a thread which exits.
+  void retire_thread(ThreadOpCounters* counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t id = 0; id < names_.size(); id++) {
+      auto* slot = counters->slots[id].load(std::memory_order_acquire);
+      if (slot != nullptr) {
+        retired_[id].add(*slot);
+      }
+    }
+    threads_.erase(std::find(threads_.begin(), threads_.end(), counters));
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // the owner threads update their slots without locking, so a reset
+    // moves the baseline instead of zeroing the slots
+    auto totals = collect();
+    for (size_t id = 0; id < names_.size(); id++) {
+      baseline_[id].add(totals[id]);
+    }
+  }
+
+  std::string prometheus_text();
+
+ private:
+  OpCounterRegistry()
+      : start_ticks_(read_op_clock()),
+        start_time_(std::chrono::steady_clock::now()) {}
+
+  std::vector<OpCounterTotals> collect() {
+    std::vector<OpCounterTotals> totals(retired_);
+    for (auto* counters : threads_) {
+      for (size_t id = 0; id < names_.size(); id++) {
+        auto* slot = counters->slots[id].load(std::memory_order_acquire);
+        if (slot != nullptr) {
+          totals[id].add(*slot);
+        }
+      }
+    }
+    for (size_t id = 0; id < names_.size(); id++) {
+      totals[id].sub(baseline_[id]);
+    }
+    return totals;
+  }
+
+  // Frequency of read_op_clock(), measured against the steady clock since
+  // the registry was created.
+  double ticks_per_second() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+    auto elapsed = std::chrono::steady_clock::now() - start_time_;
+    if (elapsed < std::chrono::milliseconds(10)) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+    }
+    auto ticks = read_op_clock() - start_ticks_;
+    auto seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start_time_)
+                       .count();
+    return ticks / seconds;
+#else
+    return 1e9;
+#endif
+  }
+
+  std::mutex mutex_;
+  std::vector<std::string> names_;
+  std::unordered_map<std::string, int64_t> ids_;
+  std::vector<ThreadOpCounters*> threads_;
+  // counts of the exited threads
+  std::vector<OpCounterTotals> retired_;
+  // counts at the last reset
+  std::vector<OpCounterTotals> baseline_;
+  uint64_t start_ticks_;
+  std::chrono::steady_clock::time_point start_time_;
+};
+
+std::string escape_label(const std::string& value) {
+  std::string escaped;
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped += '\\';
+      escaped += c;
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string OpCounterRegistry::prometheus_text() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto totals = collect();
+  const double tick = 1.0 / ticks_per_second();
+  std::ostringstream os;
+  os.precision(9);
+
+  os << "# HELP ipex_op_latency_seconds Latency of the IPEX ops.\n";
+  os << "# TYPE ipex_op_latency_seconds histogram\n";
+  for (size_t id = 0; id < names_.size(); id++) {
+    const auto& t = totals[id];
+    if (t.count == 0) {
+      continue;
+    }
+    const auto op = "op=\"" + escape_label(names_[id]) + "\"";
+    uint64_t cumulative = 0;
+    for (int k = 0; k < kOpCounterBuckets - 1; k++) {
+      cumulative += t.buckets[k];
+      os << "ipex_op_latency_seconds_bucket{" << op << ",le=\""
+         << std::ldexp(tick, kOpCounterMinLog2 + k) << "\"} " << cumulative
+         << "\n";
+    }
+    os << "ipex_op_latency_seconds_bucket{" << op << ",le=\"+Inf\"} "
+       << t.count << "\n";
+    os << "ipex_op_latency_seconds_sum{" << op << "} " << t.ticks * tick
+       << "\n";
+    os << "ipex_op_latency_seconds_count{" << op << "} " << t.count << "\n";
+  }
+
+  os << "# HELP ipex_op_flops_total Floating point operations of the IPEX "
+        "ops.\n";
+  os << "# TYPE ipex_op_flops_total counter\n";
+  for (size_t id = 0; id < names_.size(); id++) {
+    if (totals[id].flops != 0) {
+      os << "ipex_op_flops_total{op=\"" << escape_label(names_[id]) << "\"} "
+         << totals[id].flops << "\n";
+    }
+  }
+
+  os << "# HELP ipex_op_bytes_total Bytes of the inputs, weights and outputs "
+        "of the IPEX ops.\n";
+  os << "# TYPE ipex_op_bytes_total counter\n";
+  for (size_t id = 0; id < names_.size(); id++) {
+    if (totals[id].bytes != 0) {
+      os << "ipex_op_bytes_total{op=\"" << escape_label(names_[id]) << "\"} "
+         << totals[id].bytes << "\n";
+    }
+  }
+  return os.str();
+}
+
+struct ThreadOpCountersHolder {
+  ThreadOpCounters* counters;
+
+  ThreadOpCountersHolder() : counters(new ThreadOpCounters()) {
+    OpCounterRegistry::get().add_thread(counters);
+  }
+
+  ~ThreadOpCountersHolder() {
+    OpCounterRegistry::get().retire_thread(counters);
+    delete counters;
+  }
+};
+
+} // anonymous namespace
+
+std::atomic<bool> op_counters_enabled_{op_counters_enabled_from_env()};
+
+void set_op_counters_enabled(bool enabled) {
+  op_counters_enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+int64_t register_op_counter(const std::string& name) {
+  return OpCounterRegistry::get().register_op(name);
+}
+
+void record_op(int64_t id, uint64_t ticks, uint64_t flops, uint64_t bytes) {
+  if (id < 0) {
+    return;
+  }
+  thread_local ThreadOpCountersHolder holder;
+  auto& slot = holder.counters->get(id);
+  int bucket = 0;
+  if (ticks != 0) {
+    // floor(log2(ticks)) + 1 - kOpCounterMinLog2
+    bucket = 64 - c10::llvm::countLeadingZeros(ticks) - kOpCounterMinLog2;
+    bucket = std::min(std::max(bucket, 0), kOpCounterBuckets - 1);
+  }
+  bump(slot.count, 1);
+  bump(slot.ticks, ticks);
+  bump(slot.flops, flops);
+  bump(slot.bytes, bytes);
+  bump(slot.buckets[bucket], 1);
+}
+
+void reset_op_counters() {
+  OpCounterRegistry::get().reset();
+}
+
+std::string op_counters_prometheus_text() {
+  return OpCounterRegistry::get().prometheus_text();
+}
+
+} // namespace utils
+} // namespace torch_ipex
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <c10/macros/Macros.h>
+#include <torch/csrc/Export.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/*
+
+Always-on op level performance counters.
+
+Every thread records into its own slots, so that counting an op costs two
+time stamp counter reads and a few uncontended stores. A snapshot sums the
+slots of all the threads and is exported in the Prometheus text format:
+per op latency histograms plus FLOP and byte counters.
+
+Usage:
+
+at::Tensor my_op_run(const at::Tensor& input) {
+    IPEX_OP_COUNTER(counter, "ipex_prepack::my_op_run");
+    auto output = ...;
+    counter.add_work(flops, bytes);
+    return output;
+}
+
+Counting is enabled by default and can be turned off with
+IPEX_OP_COUNTERS=0 or set_op_counters_enabled(false).
+*/
+
+namespace torch_ipex {
+namespace utils {
+
+// Bucket k of the latency histogram counts the ops that took less than
+// 2^(kOpCounterMinLog2 + k) ticks, the last bucket counts the others.
+constexpr int kOpCounterMinLog2 = 10;
+constexpr int kOpCounterBuckets = 24;
+
+extern TORCH_API std::atomic<bool> op_counters_enabled_;
+
+inline bool op_counters_enabled() {
+  return op_counters_enabled_.load(std::memory_order_relaxed);
+}
+
+TORCH_API void set_op_counters_enabled(bool enabled);
+
+// Returns the id of the counter of the op `name`, registering it on first
+// use. Returns -1 once the counter table is full.
+TORCH_API int64_t register_op_counter(const std::string& name);
+
+TORCH_API void record_op(
+    int64_t id,
+    uint64_t ticks,
+    uint64_t flops,
+    uint64_t bytes);
+
+// Starts the counters over from zero.
+TORCH_API void reset_op_counters();
+
+// Snapshot of all the counters in the Prometheus text exposition format.
+TORCH_API std::string op_counters_prometheus_text();
+
+inline uint64_t read_op_clock() {
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+class ScopedOpCounter {
+ public:
+  explicit ScopedOpCounter(int64_t id)
+      : id_(id), start_(op_counters_enabled() ? read_op_clock() : 0) {}
+
+  ~ScopedOpCounter() {
+    if (start_ != 0) {
+      record_op(id_, read_op_clock() - start_, flops_, bytes_);
+    }
+  }
+
+  // Whether the op is being counted, to skip computing its work otherwise.
+  explicit operator bool() const {
+    return start_ != 0;
+  }
+
+  void add_work(uint64_t flops, uint64_t bytes) {
+    flops_ += flops;
+    bytes_ += bytes;
+  }
+
+  ScopedOpCounter(const ScopedOpCounter&) = delete;
+  ScopedOpCounter& operator=(const ScopedOpCounter&) = delete;
+
+ private:
+  int64_t id_;
+  uint64_t start_;
+  uint64_t flops_ = 0;
+  uint64_t bytes_ = 0;
+};
+
+} // namespace utils
+} // namespace torch_ipex
+
+#define IPEX_OP_COUNTER(var, name)                    \
+  static const int64_t C10_CONCATENATE(var, _id) =    \
+      ::torch_ipex::utils::register_op_counter(name); \
+  ::torch_ipex::utils::ScopedOpCounter var(C10_CONCATENATE(var, _id))
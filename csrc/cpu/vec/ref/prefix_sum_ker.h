@@ -13,6 +13,86 @@ inline void prefix_sum(const T* src, T* dst, T init, int64_t n) {
   }
 }
 
+// Scans n elements from init, accumulated in acc_t, and returns the total.
+// In exclusive mode dst[i] is the sum of the elements before src[i]. src and
+// dst may be the same buffer.
+template <typename src_t, typename dst_t, typename acc_t>
+inline acc_t prefix_sum(
+    const src_t* src,
+    dst_t* dst,
+    acc_t init,
+    int64_t n,
+    bool exclusive) {
+  acc_t sum = init;
+  if (exclusive) {
+    for (int64_t i = 0; i < n; i++) {
+      acc_t val = static_cast<acc_t>(src[i]);
+      dst[i] = static_cast<dst_t>(sum);
+      sum += val;
+    }
+  } else {
+    for (int64_t i = 0; i < n; i++) {
+      sum += static_cast<acc_t>(src[i]);
+      dst[i] = static_cast<dst_t>(sum);
+    }
+  }
+  return sum;
+}
+
+// Scans `rows` rows of `width` elements, `stride` elements apart, column by
+// column. acc holds the running sums of the columns and is updated in place.
+template <typename src_t, typename dst_t, typename acc_t>
+inline void prefix_sum_rows(
+    const src_t* src,
+    dst_t* dst,
+    acc_t* acc,
+    int64_t rows,
+    int64_t width,
+    int64_t stride,
+    bool exclusive) {
+  for (int64_t r = 0; r < rows; r++) {
+    const src_t* src_row = src + r * stride;
+    dst_t* dst_row = dst + r * stride;
+    if (exclusive) {
+      for (int64_t i = 0; i < width; i++) {
+        acc_t val = static_cast<acc_t>(src_row[i]);
+        dst_row[i] = static_cast<dst_t>(acc[i]);
+        acc[i] += val;
+      }
+    } else {
+      for (int64_t i = 0; i < width; i++) {
+        acc[i] += static_cast<acc_t>(src_row[i]);
+        dst_row[i] = static_cast<dst_t>(acc[i]);
+      }
+    }
+  }
+}
+
+template <typename src_t, typename acc_t>
+inline acc_t reduce_sum(const src_t* src, acc_t init, int64_t n) {
+  acc_t sum = init;
+  for (int64_t i = 0; i < n; i++) {
+    sum += static_cast<acc_t>(src[i]);
+  }
+  return sum;
+}
+
+// Adds the columns of `rows` rows of `width` elements to acc.
+template <typename src_t, typename acc_t>
+inline void reduce_sum_rows(
+    const src_t* src,
+    acc_t* acc,
+    int64_t rows,
+    int64_t width,
+    int64_t stride) {
+  for (int64_t r = 0; r < rows; r++) {
+    const src_t* src_row = src + r * stride;
+    for (int64_t i = 0; i < width; i++) {
+      acc[i] += static_cast<acc_t>(src_row[i]);
+    }
+  }
+}
+
 } // namespace kernel
 } // namespace cpu
 } // namespace torch_ipex
@@ -17,9 +17,49 @@ class TORCH_API AutoOptConfig {
     return jit_fuse_;
   }
 
+  // Grouping independent same-shape linears into one batched GEMM changes
+  // which linear fusions apply, so it is opt-in.
+  inline void set_grouped_linear(bool grouped_linear) {
+    grouped_linear_ = grouped_linear;
+  }
+
+  inline bool get_grouped_linear() {
+    return grouped_linear_;
+  }
+
+  // Planning the outputs of prepacked ops into a per-thread arena keeps the
+  // arena alive between runs, so it is opt-in.
+  inline void set_memory_planning(bool memory_planning) {
+    memory_planning_ = memory_planning;
+  }
+
+  inline bool get_memory_planning() {
+    return memory_planning_;
+  }
+
+  // Weight-only quantization of the frozen linears with bits = 8 or 4 and
+  // one scale per group of group_size input channels (0 for per channel).
+  // It changes the numerics of the model, so it is off (bits = 0) by default.
+  inline void set_woq_linear(int64_t bits, int64_t group_size) {
+    woq_bits_ = bits;
+    woq_group_size_ = group_size;
+  }
+
+  inline int64_t get_woq_bits() {
+    return woq_bits_;
+  }
+
+  inline int64_t get_woq_group_size() {
+    return woq_group_size_;
+  }
+
  private:
   AutoOptConfig()
       : jit_fuse_(true),
+        grouped_linear_(false),
+        memory_planning_(false),
+        woq_bits_(0),
+        woq_group_size_(0),
         calibration_step_(false),
         qscheme_(at::QScheme::PER_TENSOR_AFFINE) {}
 
@@ -28,6 +68,10 @@ class TORCH_API AutoOptConfig {
   AutoOptConfig& operator=(const AutoOptConfig&) = default;
 
   bool jit_fuse_;
+  bool grouped_linear_;
+  bool memory_planning_;
+  int64_t woq_bits_;
+  int64_t woq_group_size_;
   // the flag for one iteration of calibration step whether end or not.
   bool calibration_step_;
   at::QScheme qscheme_;
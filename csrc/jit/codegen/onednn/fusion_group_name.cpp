@@ -15,6 +15,11 @@ const std::string& LlgaGuardName() {
   return LlgaGuardName;
 }
 
+const std::string& LlgaJoinName() {
+  static const std::string LlgaJoinName = "ipex::LlgaFusionJoin";
+  return LlgaJoinName;
+}
+
 } // namespace onednn
 } // namespace fuser
 } // namespace jit
@@ -7,11 +7,13 @@
 #include "kernel.h"
 #include "layout_propagation.h"
 #include "lift_up_quant.h"
+#include "partition_scheduler.h"
 #include "prepare_binary.h"
 #include "prepare_dequant.h"
 #include "prepare_silu.h"
 #include "quantization_patterns.h"
 #include "remove_mutation.h"
+#include "training.h"
 
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
@@ -84,7 +86,11 @@ void fuseGraph(std::shared_ptr<Graph>& g) {
     GRAPH_DUMP("After DeferSizeCheck. Before CreateLlgaSubgraphs", g);
     // CreateLlgaSubgraphs must be placed after all the preparation passes above
     CreateLlgaSubgraphs(g);
-    GRAPH_DUMP("After CreateLlgaSubgraphs. Before PropagateLayout", g);
+    GRAPH_DUMP("After CreateLlgaSubgraphs. Before PrepareLlgaTraining", g);
+    // PrepareLlgaTraining must be placed before PropagateLayout, the outputs
+    // of the training partitions keep their strided layout
+    PrepareLlgaTraining(g);
+    GRAPH_DUMP("After PrepareLlgaTraining. Before PropagateLayout", g);
     // PropagateLayout must be placed after CreateLlgaSubgraphs
     PropagateLayout(g);
     GRAPH_DUMP(
@@ -100,7 +106,12 @@ void fuseGraph(std::shared_ptr<Graph>& g) {
     RevertPrepareBinaryForLLGA(g);
     GRAPH_DUMP("After RevertPrepareBinaryForLLGA. Before IpexQuantFusion", g);
     IpexQuantFusion(g);
-    GRAPH_DUMP("After IpexQuantFusion. End of INT8 optimization pass", g);
+    GRAPH_DUMP("After IpexQuantFusion. Before ScheduleLlgaPartitions", g);
+    // ScheduleLlgaPartitions must be placed after the fusion groups are
+    // guarded
+    ScheduleLlgaPartitions(g);
+    GRAPH_DUMP(
+        "After ScheduleLlgaPartitions. End of INT8 optimization pass", g);
   }
 }
 
@@ -189,5 +200,30 @@ torch::jit::RegisterOperators LLGAGuardOp({
         AliasAnalysisKind::PURE_FUNCTION),
 });
 
+Operation createLlgaJoinKernel(const Node* node) {
+  const auto num_inputs = node->inputs().size();
+  return [num_inputs](Stack* stack) {
+    RECORD_FUNCTION(
+        fuser::onednn::LlgaJoinName(), c10::ArrayRef<c10::IValue>());
+
+    // the outputs are the inputs, left on the stack once their partition
+    // is done
+    for (size_t i = 0; i < num_inputs; i++) {
+      auto& input = peek(stack, i, num_inputs);
+      if (input.isTensor()) {
+        fuser::onednn::LlgaPartitionScheduler::join(input.toTensor());
+      }
+    }
+  };
+}
+
+// CONSERVATIVE so that the joins are not removed as dead code
+torch::jit::RegisterOperators LLGAJoinOp({
+    torch::jit::Operator(
+        Symbol::fromQualString(fuser::onednn::LlgaJoinName()),
+        createLlgaJoinKernel,
+        AliasAnalysisKind::CONSERVATIVE),
+});
+
 } // namespace jit
 } // namespace torch_ipex
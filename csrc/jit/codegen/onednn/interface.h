@@ -24,6 +24,23 @@ TORCH_API void setLlgaWeightCacheEnabled(bool enabled);
 
 TORCH_API bool getLlgaWeightCacheEnabled();
 
+// Lets the LLGA partitions write into the outputs of their previous runs
+// once the consumers released them, instead of allocating new ones. Off by
+// default, as each partition then keeps its last outputs resident.
+TORCH_API void setLlgaOutputReuseEnabled(bool enabled);
+
+TORCH_API bool getLlgaOutputReuseEnabled();
+
+// Runs the independent LLGA partitions of a graph concurrently on
+// `num_pools` disjoint sub-pools of the cores, 0 to turn it off. Applies to
+// the graphs optimized afterwards.
+TORCH_API void setLlgaConcurrentPartitions(int64_t num_pools);
+
+TORCH_API int64_t getLlgaConcurrentPartitions();
+
+// Number of partitions that actually ran on a sub-pool so far.
+TORCH_API int64_t getLlgaConcurrentLaunches();
+
 } // namespace onednn
 } // namespace fuser
 
@@ -1,12 +1,17 @@
 #include <omp.h>
+#include <atomic>
 
 #include "graph_helper.h"
+#include "interface.h"
 #include "kernel.h"
 #include "operator.h"
+#include "partition_scheduler.h"
 #include "runtime.h"
+#include "training.h"
 
 #include <ATen/core/functional.h>
 #include <ATen/quantized/Quantizer.h>
+#include <torch/csrc/autograd/functions/utils.h>
 #include <torch/csrc/jit/jit_log.h>
 
 namespace torch_ipex {
@@ -19,13 +24,39 @@ using namespace dnnl::graph;
 
 using data_type = dnnl::graph::logical_tensor::data_type;
 
+namespace {
+
+std::atomic<bool> llgaOutputReuseEnabled{false};
+
+// Sets the number of OpenMP threads of the calling thread, to compile a
+// partition for the threads of the sub-pool it runs on.
+struct NumThreadsGuard {
+  explicit NumThreadsGuard(int n_thread) : n_thread_(omp_get_max_threads()) {
+    if (n_thread != n_thread_) {
+      omp_set_num_threads(n_thread);
+    }
+  }
+
+  ~NumThreadsGuard() {
+    if (omp_get_max_threads() != n_thread_) {
+      omp_set_num_threads(n_thread_);
+    }
+  }
+
+  int n_thread_;
+};
+
+} // namespace
+
 LlgaKernel::LlgaKernel(const Node* fusionNode)
     : fusionNode_(fusionNode),
       graph_(fusionNode->g(attr::Subgraph)),
       nGraphInputs_(graph_->inputs().size()),
       nOutputs_(graph_->outputs().size()),
       debugName_(genDebugName()),
-      profileName_(genProfileName()) {
+      profileName_(genProfileName()),
+      concurrent_(fusionNode->hasAttribute(Symbol::attr("concurrent"))),
+      training_(isLlgaTrainingGroup(fusionNode)) {
   // TODO: This is a workaround to recreate the partitions here.
   // The ideal way is to use the partition serialization API (not available from
   // LLGA now) to carry a serialized string representation from graph rewrite
@@ -155,43 +186,166 @@ ArgSpecs LlgaKernel::initializeOutputSpecs() const {
   return outputSpecs;
 }
 
-std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
+std::shared_ptr<LlgaBindingPlan> LlgaKernel::buildBindingPlan() const {
+  using OutputKind = LlgaBindingPlan::OutputKind;
+  auto plan = std::make_shared<LlgaBindingPlan>();
+  plan->inputs = fmap(inputSpecs_, toLogicalTensor);
+  plan->outputs = fmap(outputSpecs_, toLogicalTensor);
+  for (size_t i = 0; i < nOutputs_; i++) {
+    const auto& spec = outputSpecs_[i];
+    auto opt = c10::TensorOptions(spec.aten_scalar_type()).device(device_);
+    auto kind = OutputKind::Strided;
+    if (useOpaqueLayout(i)) {
+      kind = OutputKind::Opaque;
+    } else if (spec.is_quantized()) {
+      kind = OutputKind::Quantized;
+    }
+    auto iter = inplacePairs_.find(spec.tid());
+    bool inplace = iter != inplacePairs_.end();
+    size_t inputOffset = inplace ? iter->second : 0;
+    plan->outputPlans.push_back({kind, spec, opt, inplace, inputOffset});
+  }
+  return plan;
+}
+
+std::shared_ptr<LlgaRunArgs> LlgaKernel::acquireRunArgs(
+    const std::shared_ptr<LlgaBindingPlan>& plan) const {
+  std::unique_ptr<LlgaRunArgs> args;
+  {
+    std::lock_guard<std::mutex> lock(plan->mutex);
+    if (!plan->freeRunArgs.empty()) {
+      args = std::move(plan->freeRunArgs.back());
+      plan->freeRunArgs.pop_back();
+    }
+  }
+  if (!args) {
+    // the data handles of the graph inputs and outputs are bound per run
+    args = std::make_unique<LlgaRunArgs>();
+    for (size_t i = 0; i < runArgsIdx_.size(); i++) {
+      args->runInputs.push_back(
+          {plan->inputs[i], Engine::getEngine(), nullptr});
+    }
+    for (size_t i = 0; i < constantInputs_.size(); i++) {
+      // constantInputSpecs are placed after graphInputSpecs
+      args->runInputs.push_back(
+          {plan->inputs[nGraphInputs_ + i],
+           Engine::getEngine(),
+           constantInputs_[i].data_ptr()});
+    }
+    for (size_t i = 0; i < nOutputs_; i++) {
+      args->runOutputs.push_back(
+          {plan->outputs[i], Engine::getEngine(), nullptr});
+    }
+    args->cachedOutputs.resize(nOutputs_);
+  }
+  return std::shared_ptr<LlgaRunArgs>(
+      args.release(), [plan](LlgaRunArgs* released) {
+        std::lock_guard<std::mutex> lock(plan->mutex);
+        plan->freeRunArgs.emplace_back(released);
+      });
+}
+
+namespace {
+
+// Whether the consumers of a cached output are done with it, i.e. the cache
+// holds the last reference to the tensor and to its storage.
+bool isReleased(const at::Tensor& tensor) {
+  return tensor.defined() && tensor.use_count() == 1 &&
+      tensor.unsafeGetTensorImpl()->unsafe_storage().use_count() == 1;
+}
+
+// Whether a cached output still has the dtype and layout the partition
+// writes. Its consumers may have changed its metadata in place (e.g. with
+// resize_ or t_) before releasing it.
+bool matchesSpec(
+    const LlgaBindingPlan::Output& plan,
+    const at::Tensor& tensor) {
+  using OutputKind = LlgaBindingPlan::OutputKind;
+  const auto& spec = plan.spec;
+  return tensor.scalar_type() == spec.aten_scalar_type() &&
+      tensor.is_quantized() == (plan.kind == OutputKind::Quantized) &&
+      tensor.sizes() == spec.sizes() && tensor.strides() == spec.strides() &&
+      tensor.storage_offset() == 0 &&
+      tensor.storage().nbytes() >= spec.storage_size();
+}
+
+void checkPreallocatedOutput(
+    const LlgaBindingPlan::Output& plan,
+    const at::Tensor& output,
+    size_t offset) {
+  using OutputKind = LlgaBindingPlan::OutputKind;
+  TORCH_CHECK(
+      plan.kind != OutputKind::Opaque,
+      "Output ",
+      offset,
+      " of the LLGA partition cannot be preallocated");
+  TORCH_CHECK(
+      output.scalar_type() == plan.spec.aten_scalar_type() &&
+          output.is_quantized() == (plan.kind == OutputKind::Quantized) &&
+          output.sizes() == plan.spec.sizes() &&
+          output.strides() == plan.spec.strides(),
+      "Preallocated output ",
+      offset,
+      " of the LLGA partition does not match its spec");
+}
+
+at::Tensor allocateOutput(const LlgaBindingPlan::Output& plan) {
+  using OutputKind = LlgaBindingPlan::OutputKind;
+  const auto& spec = plan.spec;
+  if (plan.kind == OutputKind::Opaque) {
+    // Wrap tensors between partitions with LlgaTensorImpl wrapper, so that we
+    // can bypass guard-check, as strides would be different than those
+    // expected.
+    return empty_llga(spec, plan.options);
+  }
+  if (plan.kind == OutputKind::Quantized) {
+    at::QuantizerPtr quantizer = spec.get_quantizer();
+    auto qtensor = at::new_qtensor(spec.sizes(), plan.options, quantizer);
+    // TODO: Setting strides is possible only on uniformly quantized tensor.
+    // Currently, only weight will use quantize_per_channel, data will
+    // always use quantize_per_tensor. We will only allocate buffer for data
+    // (output of a LlgaPartition). If in the future, we need allocate
+    // buffer for qensor that is quantized per channel, need implemeted
+    // as_strided_qtensorimpl for PER_CHANNEL QScheme.
+    qtensor.as_strided_(spec.sizes(), spec.strides());
+    return qtensor;
+  }
+  return at::empty_strided(spec.sizes(), spec.strides(), plan.options);
+}
+
+} // namespace
+
+std::shared_ptr<LlgaRunArgs> LlgaKernel::prepareRunArgs(
+    const std::shared_ptr<LlgaBindingPlan>& plan,
     const TensorArgs& inputs,
-    TensorArgs& outputs) const {
+    TensorArgs& outputs,
+    bool inplace) const {
   RECORD_FUNCTION(
       "LLGA_bridge::prepareRunArgs", c10::ArrayRef<c10::IValue>({}));
 
-  RunArgs runInputs, runOutputs;
+  auto args = acquireRunArgs(plan);
+  // the outputs of a run recording autograd history are not reused, as the
+  // backward pass may still read them
+  bool reuse = inplace && getLlgaOutputReuseEnabled();
   for (size_t i = 0; i < runArgsIdx_.size(); i++) {
-    auto spec = inputSpecs_[i];
-    auto input = inputs[runArgsIdx_[i]];
-    runInputs.push_back(
-        {spec.logical_tensor(), Engine::getEngine(), input.data_ptr()});
-  }
-  for (size_t i = 0; i < constantInputs_.size(); i++) {
-    // constantInputSpecs are placed after graphInputSpecs
-    auto constantInputSpecIdx = nGraphInputs_ + i;
-    auto constantInputSpec = inputSpecs_[constantInputSpecIdx];
-    runInputs.push_back(
-        {constantInputSpec.logical_tensor(),
-         Engine::getEngine(),
-         constantInputs_[i].data_ptr()});
+    args->runInputs[i].set_data_handle(inputs[runArgsIdx_[i]].data_ptr());
   }
 
   for (size_t i = 0; i < nOutputs_; i++) {
-    auto spec = outputSpecs_[i];
-    auto opt = c10::TensorOptions(spec.aten_scalar_type()).device(device_);
-
-    auto outputId = spec.tid();
-    auto iter = inplacePairs_.find(outputId);
-    if (iter != inplacePairs_.end()) {
+    const auto& outputPlan = plan->outputPlans[i];
+    auto& output = outputs[i];
+    if (output.defined()) {
+#ifdef GRAPH_DEBUG_ENABLED
+      GRAPH_DEBUG("Preallocated output");
+#endif
+      checkPreallocatedOutput(outputPlan, output, i);
+    } else if (outputPlan.inplace && inplace) {
       // output reuses one of input tensors
 #ifdef GRAPH_DEBUG_ENABLED
       GRAPH_DEBUG("Inplace computation");
 #endif
-      auto inputOffset = iter->second;
-      auto inputTensor = inputs[inputOffset];
-      auto dataType = spec.dtype();
+      auto inputTensor = inputs[outputPlan.inputOffset];
+      auto dataType = outputPlan.spec.dtype();
       if (C10_UNLIKELY(!useOpaqueLayout(i) && inputTensor.is_mkldnn())) {
         // If the input tensor was between two partitions, it would've been
         // wrapped with LlgaTensorImpl. But if it's being reused as the output
@@ -211,7 +365,7 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
           case data_type::s8:
           case data_type::u8:
             inputTensor = LlgaTensorImpl::llga_to_aten_tensor(
-                llgaImpl, spec.get_quantizer());
+                llgaImpl, outputPlan.spec.get_quantizer());
             break;
           case data_type::s32:
           default:
@@ -219,46 +373,29 @@ std::tuple<RunArgs, RunArgs> LlgaKernel::prepareRunArgs(
                 false, "Invalid data type ", static_cast<size_t>(dataType));
         }
       }
-      outputs.push_back(inputTensor);
-      runOutputs.push_back(
-          {spec.logical_tensor(), Engine::getEngine(), inputTensor.data_ptr()});
-    } else if (useOpaqueLayout(i)) {
-      // Wrap tensors between partitions with LlgaTensorImpl wrapper, so that we
-      // can bypass guard-check, as strides would be different than those
-      // expected.
-#ifdef GRAPH_DEBUG_ENABLED
-      GRAPH_DEBUG("Between partitions");
-#endif
-      auto tensor = empty_llga(spec, opt);
-      outputs.push_back(tensor);
-      runOutputs.push_back(llga_from_aten_tensor(tensor));
+      output = inputTensor;
     } else {
+      auto& cached = args->cachedOutputs[i];
+      if (reuse && isReleased(cached) && matchesSpec(outputPlan, cached)) {
 #ifdef GRAPH_DEBUG_ENABLED
-      GRAPH_DEBUG("Neither opaque nor inplace");
+        GRAPH_DEBUG("Reusing the output of the last run");
 #endif
-      if (spec.is_quantized()) {
-        at::QuantizerPtr quantizer = spec.get_quantizer();
-        auto qtensor = at::new_qtensor(spec.sizes(), opt, quantizer);
-        // TODO: Setting strides is possible only on uniformly quantized tensor.
-        // Currently, only weight will use quantize_per_channel, data will
-        // always use quantize_per_tensor. We will only allocate buffer for data
-        // (output of a LlgaPartition). If in the future, we need allocate
-        // buffer for qensor that is quantized per channel, need implemeted
-        // as_strided_qtensorimpl for PER_CHANNEL QScheme.
-        qtensor.as_strided_(spec.sizes(), spec.strides());
-        outputs.push_back(qtensor);
-        runOutputs.push_back(
-            {spec.logical_tensor(), Engine::getEngine(), qtensor.data_ptr()});
+        output = cached;
       } else {
-        auto tensor = at::empty_strided(spec.sizes(), spec.strides(), opt);
-        outputs.push_back(tensor);
-        runOutputs.push_back(
-            {spec.logical_tensor(), Engine::getEngine(), tensor.data_ptr()});
+#ifdef GRAPH_DEBUG_ENABLED
+        GRAPH_DEBUG("Allocating output");
+#endif
+        output = allocateOutput(outputPlan);
+        // An output still held by its consumers is dropped rather than
+        // replaced, so that the cache does not keep one more output resident
+        // for callers that never release them.
+        cached = reuse && !cached.defined() ? output : at::Tensor();
       }
     }
+    args->runOutputs[i].set_data_handle(output.data_ptr());
   }
 
-  return std::make_tuple(runInputs, runOutputs);
+  return args;
 }
 
 compiled_partition LlgaKernel::compile(const partition& partition) {
@@ -299,6 +436,7 @@ dnnl::graph::compiled_partition& LlgaKernel::compileAndCache(
   std::call_once(compilation_initialized_flags_[i_thread], [&]() {
     GRAPH_DEBUG("Compiling partition for i_thread ", i_thread);
     compilations_[i_thread] = compile(partition_);
+    bindingPlans_[i_thread] = buildBindingPlan();
   });
   return compilations_[i_thread];
 }
@@ -314,6 +452,25 @@ void LlgaKernel::run(Stack& stack) {
     return v.toTensor();
   });
 
+  TensorArgs outputs(nOutputs_);
+  run(inputs, outputs);
+
+  // Update the stack.
+  drop(stack, nGraphInputs_);
+  for (auto& o : outputs) {
+    push_one(stack, std::move(o));
+  }
+#ifdef GRAPH_DEBUG_ENABLED
+  GRAPH_DEBUG("Stack updated");
+#endif
+}
+
+void LlgaKernel::run(const TensorArgs& inputs, TensorArgs& outputs) {
+  TORCH_CHECK(
+      inputs.size() == nGraphInputs_ && outputs.size() == nOutputs_,
+      "Wrong number of inputs or outputs for ",
+      debugName());
+
   // Input and output specs are not related to omp_num_threads
   std::call_once(
       spec_initialized_flag_,
@@ -329,41 +486,74 @@ void LlgaKernel::run(Stack& stack) {
       },
       inputs);
 
-  TensorArgs outputs;
-  RunArgs runInputs, runOutputs;
   dnnl::graph::compiled_partition compilation;
-
-  int n_thread = omp_get_max_threads();
-  if (n_thread > 0 && n_thread <= MAX_COMPILATION_CACHE_SIZE) {
+  std::shared_ptr<LlgaBindingPlan> plan;
+
+  // The backward of a training partition reads its inputs and outputs, so
+  // it runs on the calling thread and does not overwrite its inputs.
+  bool requiresGrad = training_ &&
+      torch::autograd::compute_requires_grad(at::TensorList(inputs));
+
+  auto& scheduler = LlgaPartitionScheduler::get();
+  int64_t pool = concurrent_ && !requiresGrad ? scheduler.nextPool() : -1;
+  int n_thread = pool < 0 ? omp_get_max_threads() : scheduler.poolThreads(pool);
+  {
+    NumThreadsGuard guard(n_thread);
+    if (n_thread > 0 && n_thread <= MAX_COMPILATION_CACHE_SIZE) {
 #ifdef GRAPH_DEBUG_ENABLED
-    GRAPH_DEBUG("Cached compilation");
+      GRAPH_DEBUG("Cached compilation");
 #endif
-    compilation = compileAndCache(partition_, n_thread);
-  } else {
+      compilation = compileAndCache(partition_, n_thread);
+      plan = bindingPlans_[n_thread - 1];
+    } else {
 #ifdef GRAPH_DEBUG_ENABLED
-    GRAPH_DEBUG("Runtime compilation");
+      GRAPH_DEBUG("Runtime compilation");
 #endif
-    compilation = compile(partition_);
+      compilation = compile(partition_);
+      plan = buildBindingPlan();
+    }
   }
 #ifdef GRAPH_DEBUG_ENABLED
   GRAPH_DEBUG("Preparing runtime tensors");
 #endif
-  std::tie(runInputs, runOutputs) = prepareRunArgs(inputs, outputs);
+  auto args = prepareRunArgs(plan, inputs, outputs, !requiresGrad);
+  if (pool >= 0 && inplacePairs_.empty()) {
 #ifdef GRAPH_DEBUG_ENABLED
-  GRAPH_DEBUG("Executing partition");
+    GRAPH_DEBUG("Launching partition on sub-pool ", pool);
 #endif
-  compilation.execute(Stream::getStream(), runInputs, runOutputs);
+    // the inputs and outputs are kept alive, and the runtime tensors are not
+    // reused, until the partition is executed
+    scheduler.launch(
+        pool,
+        [compilation, args, inputs, outputs]() {
+          compilation.execute(
+              Stream::getStream(), args->runInputs, args->runOutputs);
+        },
+        outputs);
+  } else {
+    // an in-place output may overwrite an input of a pending partition
+    if (!inplacePairs_.empty() && !requiresGrad) {
+      LlgaPartitionScheduler::joinAll();
+    }
 #ifdef GRAPH_DEBUG_ENABLED
-  GRAPH_DEBUG("Partition executed");
+    GRAPH_DEBUG("Executing partition");
 #endif
-  // Update the stack.
-  drop(stack, nGraphInputs_);
-  for (auto& o : outputs) {
-    push_one(stack, std::move(o));
-  }
+    compilation.execute(Stream::getStream(), args->runInputs, args->runOutputs);
 #ifdef GRAPH_DEBUG_ENABLED
-  GRAPH_DEBUG("Stack updated");
+    GRAPH_DEBUG("Partition executed");
 #endif
+  }
+  if (requiresGrad) {
+    setLlgaPartitionHistory(graph_, inputs, outputs);
+  }
+}
+
+void setLlgaOutputReuseEnabled(bool enabled) {
+  llgaOutputReuseEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool getLlgaOutputReuseEnabled() {
+  return llgaOutputReuseEnabled.load(std::memory_order_relaxed);
 }
 
 } // namespace onednn
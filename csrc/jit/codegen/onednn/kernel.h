@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include <unordered_map>
 #include "codegen/LlgaTensorImpl.h"
 #include "graph_helper.h"
@@ -23,12 +24,52 @@ using TensorArgs = std::vector<at::Tensor>;
 
 constexpr int MAX_COMPILATION_CACHE_SIZE = 1024;
 
+// The runtime tensors of one run of a compiled partition. They are reused by
+// the next runs, which only rebind their data handles.
+struct LlgaRunArgs {
+  RunArgs runInputs;
+  RunArgs runOutputs;
+  // outputs allocated by a previous run, reused once their consumers are done
+  // when the output reuse is enabled
+  TensorArgs cachedOutputs;
+};
+
+// How the inputs and outputs of a compiled partition are bound, decided once
+// after the compilation instead of on every run.
+struct LlgaBindingPlan {
+  enum class OutputKind { Opaque, Quantized, Strided };
+
+  struct Output {
+    OutputKind kind;
+    ArgSpec spec;
+    at::TensorOptions options;
+    // whether the output may reuse the input at inputOffset
+    bool inplace;
+    size_t inputOffset;
+  };
+
+  std::vector<dnnl::graph::logical_tensor> inputs;
+  std::vector<dnnl::graph::logical_tensor> outputs;
+  std::vector<Output> outputPlans;
+
+  std::mutex mutex;
+  std::vector<std::unique_ptr<LlgaRunArgs>> freeRunArgs;
+};
+
 class LlgaKernel {
  public:
   explicit LlgaKernel(const torch::jit::Node* fusionNode);
 
   void run(torch::jit::Stack& stack);
 
+  // Runs the partition on `inputs`. The defined tensors of `outputs` are
+  // preallocated by the caller and written in place, they must have the
+  // sizes, strides and dtype of the outputs of the partition. The other
+  // outputs are allocated, or reused from a previous run when the output
+  // reuse is enabled and no input requires grad. When an input
+  // requires grad, the outputs get an LlgaPartitionBackward grad_fn.
+  void run(const TensorArgs& inputs, TensorArgs& outputs);
+
   const std::string& debugName() const {
     return debugName_;
   }
@@ -66,9 +107,20 @@ class LlgaKernel {
       const dnnl::graph::partition& partition,
       int n_thread);
 
-  std::tuple<RunArgs, RunArgs> prepareRunArgs(
+  std::shared_ptr<LlgaBindingPlan> buildBindingPlan() const;
+
+  // Takes the runtime tensors of a previous run off the plan, they go back to
+  // it when the returned pointer is released.
+  std::shared_ptr<LlgaRunArgs> acquireRunArgs(
+      const std::shared_ptr<LlgaBindingPlan>& plan) const;
+
+  // The in-place outputs are allocated instead of reusing their input, and
+  // the outputs of previous runs are not reused, unless `inplace` is set.
+  std::shared_ptr<LlgaRunArgs> prepareRunArgs(
+      const std::shared_ptr<LlgaBindingPlan>& plan,
       const TensorArgs& inputs,
-      TensorArgs& outputs) const;
+      TensorArgs& outputs,
+      bool inplace) const;
 
   static std::string genDebugName() {
     static size_t debugId = 0;
@@ -105,6 +157,8 @@ class LlgaKernel {
   // We cache the compilation for each omp_num_threads
   std::vector<dnnl::graph::compiled_partition> compilations_ =
       std::vector<dnnl::graph::compiled_partition>(MAX_COMPILATION_CACHE_SIZE);
+  std::vector<std::shared_ptr<LlgaBindingPlan>> bindingPlans_ =
+      std::vector<std::shared_ptr<LlgaBindingPlan>>(MAX_COMPILATION_CACHE_SIZE);
   std::set<size_t> initializedInputIds_;
   std::vector<torch::jit::Value*> constantValues_;
   TensorArgs constantInputs_;
@@ -113,6 +167,10 @@ class LlgaKernel {
   std::unordered_map<size_t, size_t> inplacePairs_; // output id -> input offset
   std::string debugName_;
   std::string profileName_;
+  // launched on a sub-pool and joined later, see ScheduleLlgaPartitions
+  bool concurrent_;
+  // differentiated by LlgaPartitionBackward, see PrepareLlgaTraining
+  bool training_;
   std::once_flag spec_initialized_flag_;
   std::vector<std::once_flag> compilation_initialized_flags_ =
       std::vector<std::once_flag>(MAX_COMPILATION_CACHE_SIZE);
@@ -1,6 +1,7 @@
 #include "layout_propagation.h"
 #include <torch/csrc/jit/jit_log.h>
 #include "graph_helper.h"
+#include "training.h"
 
 namespace torch_ipex {
 namespace jit {
@@ -33,7 +34,9 @@ void LayoutPropagation(Node* n) {
   for (auto input : n->inputs()) {
     auto prev = input->node();
     auto offset = input->offset();
-    if (LlgaGraphHelper::isLlgaSubgraph(prev)) {
+    // the backward of a training partition needs strided inputs and outputs
+    if (LlgaGraphHelper::isLlgaSubgraph(prev) && !isLlgaTrainingGroup(prev) &&
+        !isLlgaTrainingGroup(n)) {
       bool useOpaqueLayout = true;
       for (auto& use : input->uses()) {
         if (!couldSupportOpaqueLayout(use.user) &&
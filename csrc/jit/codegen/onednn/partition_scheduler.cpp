@@ -0,0 +1,241 @@
+#include "partition_scheduler.h"
+#include "fusion_group_name.h"
+#include "interface.h"
+
+#include "runtime/CPUPool.h"
+#include "runtime/TaskExecutor.h"
+
+#include <c10/util/Exception.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
+#include <future>
+#include <unordered_map>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+using namespace torch::jit;
+
+namespace {
+
+// Partitions launched by the calling (interpreter) thread and not joined yet,
+// by their outputs.
+thread_local std::unordered_map<c10::TensorImpl*, std::shared_future<void>>
+    pending_partitions;
+
+// Returns the LLGA fusion group of a node of the graph, which is either the
+// fusion group itself or the prim::If guarding it (see guard_shape.cpp).
+Node* getFusionGroup(Node* node) {
+  static const auto kind = Symbol::fromQualString(LlgaFusionGroupName());
+  if (node->kind() == kind) {
+    return node;
+  }
+  if (node->kind() == prim::If) {
+    auto* true_block = node->blocks().at(0);
+    auto* first = true_block->nodes().front();
+    if (first->kind() == kind && first->next() == true_block->return_node()) {
+      return first;
+    }
+  }
+  return nullptr;
+}
+
+// Returns the first node of the block of `unit` which must wait for its
+// outputs: their first user, or the first node which is neither a fusion
+// group, a guard nor a constant.
+Node* getJoinPoint(Node* unit) {
+  static const auto guard = Symbol::fromQualString(LlgaGuardName());
+  auto* block = unit->owningBlock();
+  Node* join_point = block->return_node();
+  for (auto* output : unit->outputs()) {
+    for (auto& use : output->uses()) {
+      auto* user = use.user;
+      while (user->owningBlock() != block) {
+        user = user->owningBlock()->owningNode();
+      }
+      if (user->isBefore(join_point)) {
+        join_point = user;
+      }
+    }
+  }
+  for (auto* node = unit->next(); node != join_point; node = node->next()) {
+    if (!getFusionGroup(node) && node->kind() != prim::Constant &&
+        node->kind() != guard) {
+      return node;
+    }
+  }
+  return join_point;
+}
+
+void scheduleBlock(Block* block) {
+  std::vector<Node*> units;
+  for (auto* node : block->nodes()) {
+    if (getFusionGroup(node)) {
+      units.push_back(node);
+    } else {
+      for (auto* sub_block : node->blocks()) {
+        scheduleBlock(sub_block);
+      }
+    }
+  }
+
+  // A partition runs concurrently when another partition is scheduled before
+  // it has to be joined, or when it is scheduled while another one is pending.
+  std::vector<Node*> join_points;
+  std::vector<bool> concurrent(units.size(), false);
+  for (size_t i = 0; i < units.size(); i++) {
+    join_points.push_back(getJoinPoint(units[i]));
+    for (size_t k = i + 1;
+         k < units.size() && units[k]->isBefore(join_points[i]);
+         k++) {
+      concurrent[i] = true;
+      concurrent[k] = true;
+    }
+  }
+
+  static const auto join_kind = Symbol::fromQualString(LlgaJoinName());
+  auto* graph = block->owningGraph();
+  for (size_t i = 0; i < units.size(); i++) {
+    if (!concurrent[i]) {
+      continue;
+    }
+    auto* unit = units[i];
+    getFusionGroup(unit)->i_(Symbol::attr("concurrent"), 1);
+    auto* join =
+        graph->create(join_kind, unit->outputs(), unit->outputs().size())
+            ->insertBefore(join_points[i]);
+    for (size_t j = 0; j < unit->outputs().size(); j++) {
+      join->output(j)->setType(unit->output(j)->type());
+      unit->output(j)->replaceAllUsesAfterNodeWith(join, join->output(j));
+    }
+  }
+}
+
+} // namespace
+
+void ScheduleLlgaPartitions(std::shared_ptr<Graph>& graph) {
+  if (getLlgaConcurrentPartitions() < 2) {
+    return;
+  }
+  scheduleBlock(graph->block());
+  GRAPH_DUMP("After ScheduleLlgaPartitions", graph);
+}
+
+LlgaPartitionScheduler& LlgaPartitionScheduler::get() {
+  static LlgaPartitionScheduler scheduler;
+  return scheduler;
+}
+
+void LlgaPartitionScheduler::setNumPools(int64_t num_pools) {
+  TORCH_CHECK(num_pools >= 0, "The number of sub-pools should not be negative");
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (num_pools != num_pools_) {
+    // the workers finish their queued partitions before they stop
+    pools_.clear();
+    num_pools_ = num_pools;
+  }
+}
+
+int64_t LlgaPartitionScheduler::getNumPools() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_pools_;
+}
+
+int64_t LlgaPartitionScheduler::nextPool() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (num_pools_ < 2) {
+    return -1;
+  }
+  if (pools_.empty()) {
+    if (!runtime::is_runtime_ext_enabled()) {
+      TORCH_WARN_ONCE(
+          "Concurrent LLGA partitions need IOMP to be preloaded, the "
+          "partitions run one after the other");
+      return -1;
+    }
+    auto cores = runtime::get_process_available_cores();
+    const int64_t num_pools =
+        std::min<int64_t>(num_pools_, static_cast<int64_t>(cores.size()));
+    if (num_pools < 2) {
+      return -1;
+    }
+    for (int64_t p = 0; p < num_pools; p++) {
+      std::vector<int32_t> pool_cores(
+          cores.begin() + cores.size() * p / num_pools,
+          cores.begin() + cores.size() * (p + 1) / num_pools);
+      SubPool pool;
+      pool.cpu_pool = std::make_unique<runtime::CPUPool>(pool_cores);
+      pool.executor = std::make_shared<runtime::TaskExecutor>(*pool.cpu_pool);
+      pools_.push_back(std::move(pool));
+    }
+  }
+  next_pool_ = (next_pool_ + 1) % pools_.size();
+  return next_pool_;
+}
+
+int64_t LlgaPartitionScheduler::poolThreads(int64_t pool) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pools_.at(pool).cpu_pool->get_cpu_core_list().size();
+}
+
+void LlgaPartitionScheduler::launch(
+    int64_t pool,
+    std::function<void()> fn,
+    const std::vector<at::Tensor>& outputs) {
+  auto task = std::make_shared<std::packaged_task<void()>>(std::move(fn));
+  std::shared_future<void> result = task->get_future().share();
+  std::shared_ptr<runtime::TaskExecutor> executor;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    executor = pools_.at(pool).executor;
+  }
+  {
+    std::unique_lock<std::mutex> lock(executor->get_mutex());
+    TORCH_CHECK(!executor->is_stop(), "LLGA sub-pool is stopped");
+    executor->get_tasks().emplace([task]() { (*task)(); });
+  }
+  executor->get_condition().notify_one();
+  num_launched_++;
+  for (const auto& output : outputs) {
+    pending_partitions[output.unsafeGetTensorImpl()] = result;
+  }
+}
+
+void LlgaPartitionScheduler::join(const at::Tensor& tensor) {
+  auto it = pending_partitions.find(tensor.unsafeGetTensorImpl());
+  if (it == pending_partitions.end()) {
+    return;
+  }
+  auto result = std::move(it->second);
+  pending_partitions.erase(it);
+  // rethrows the error of the partition, if any
+  result.get();
+}
+
+void LlgaPartitionScheduler::joinAll() {
+  auto pending = std::move(pending_partitions);
+  pending_partitions.clear();
+  for (auto& partition : pending) {
+    partition.second.get();
+  }
+}
+
+void setLlgaConcurrentPartitions(int64_t num_pools) {
+  LlgaPartitionScheduler::get().setNumPools(num_pools);
+}
+
+int64_t getLlgaConcurrentPartitions() {
+  return LlgaPartitionScheduler::get().getNumPools();
+}
+
+int64_t getLlgaConcurrentLaunches() {
+  return LlgaPartitionScheduler::get().numLaunched();
+}
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace torch_ipex {
+namespace runtime {
+class CPUPool;
+class TaskExecutor;
+} // namespace runtime
+
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+// Finds the LLGA fusion groups that have another fusion group scheduled
+// between them and the first consumer of their outputs, i.e. the partitions
+// of independent branches (Inception blocks, multi-tower models, FPN heads).
+// They are marked to run concurrently and an ipex::LlgaFusionJoin is
+// inserted before the first consumer of their outputs.
+void ScheduleLlgaPartitions(std::shared_ptr<torch::jit::Graph>& graph);
+
+// Runs the concurrent LLGA partitions on disjoint sub-pools of the cores of
+// the process, one pinned worker thread with its own stream per sub-pool.
+// Without sub-pools (fewer than 2 of them, or IOMP not preloaded), the
+// partitions run on the calling thread as usual.
+class LlgaPartitionScheduler {
+ public:
+  static LlgaPartitionScheduler& get();
+
+  // 0 turns the concurrent execution off, which is the default.
+  void setNumPools(int64_t num_pools);
+  int64_t getNumPools();
+
+  // Returns the sub-pool to run the next concurrent partition on, round
+  // robin, or -1 to run it on the calling thread.
+  int64_t nextPool();
+
+  int64_t poolThreads(int64_t pool);
+
+  // Runs `fn` on the worker of `pool`. The outputs are pending until joined.
+  void launch(
+      int64_t pool,
+      std::function<void()> fn,
+      const std::vector<at::Tensor>& outputs);
+
+  // Waits for the partition that produces `tensor`, if it is pending.
+  static void join(const at::Tensor& tensor);
+
+  // Waits for all the pending partitions of the calling thread.
+  static void joinAll();
+
+  // Number of partitions launched on the sub-pools so far.
+  int64_t numLaunched() {
+    return num_launched_.load();
+  }
+
+ private:
+  LlgaPartitionScheduler() = default;
+
+  struct SubPool {
+    std::unique_ptr<runtime::CPUPool> cpu_pool;
+    std::shared_ptr<runtime::TaskExecutor> executor;
+  };
+
+  std::mutex mutex_;
+  int64_t num_pools_ = 0;
+  std::vector<SubPool> pools_;
+  int64_t next_pool_ = 0;
+  std::atomic<int64_t> num_launched_{0};
+};
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
@@ -80,7 +80,11 @@ void IpexQuantFusion(std::shared_ptr<torch::jit::Graph>& graph) {
       graph);
   graph_rewrite::replaceInteractionWithQInteraction(graph);
   GRAPH_DUMP(
-      "After replaceInteractionWithQInteraction. Before preprocessSizeForQLstm",
+      "After replaceInteractionWithQInteraction. Before replaceROIAlignWithQROIAlign",
+      graph);
+  graph_rewrite::replaceROIAlignWithQROIAlign(graph);
+  GRAPH_DUMP(
+      "After replaceROIAlignWithQROIAlign. Before preprocessSizeForQLstm",
       graph);
   graph_rewrite::preprocessSizeForQLstm(graph);
   GRAPH_DUMP(
@@ -15,7 +15,8 @@ struct Engine {
 };
 
 struct Stream {
-  // CPU stream singleton
+  // CPU stream of the calling thread, the concurrent partitions run on their
+  // own threads (see partition_scheduler.h)
   static dnnl::graph::stream& getStream();
   Stream(const Stream&) = delete;
   void operator=(const Stream&) = delete;
@@ -0,0 +1,320 @@
+#include "training.h"
+#include "graph_helper.h"
+#include "operator.h"
+
+#include <ATen/ExpandUtils.h>
+#include <ATen/Functions.h>
+#include <torch/csrc/autograd/functions/utils.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/passes/utils/subgraph_utils.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+using namespace torch::jit;
+
+namespace {
+
+const Symbol& trainingAttr() {
+  static const auto attr = Symbol::attr("training");
+  return attr;
+}
+
+bool mayRequireGrad(const Value* v) {
+  auto type = v->type()->cast<TensorType>();
+  return type && type->requiresGrad().value_or(true);
+}
+
+// The values of a partition which are available to the backward without
+// saving the activations inside the partition.
+bool isSaved(const Value* v) {
+  return v->node()->kind() == prim::Param ||
+      v->node()->kind() == prim::Constant;
+}
+
+bool isPartitionOutput(const Value* v) {
+  for (auto& use : v->uses()) {
+    if (use.user->kind() == prim::Return) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool isTrainable(const Graph& subgraph) {
+  for (auto* node : subgraph.nodes()) {
+    switch (node->kind()) {
+      case prim::Constant:
+      case aten::add:
+      case aten::to:
+        break;
+      case aten::_convolution:
+      case aten::conv2d:
+      case aten::linear:
+        // input, weight and bias
+        for (size_t i = 0; i < 3; i++) {
+          if (!isSaved(node->input(i))) {
+            return false;
+          }
+        }
+        break;
+      case aten::relu:
+      case aten::sigmoid:
+      case aten::tanh:
+        // the derivative is a function of the output
+        if (!isPartitionOutput(node->output())) {
+          return false;
+        }
+        break;
+      default:
+        GRAPH_DEBUG("No LLGA backward for ", node->kind().toQualString());
+        return false;
+    }
+  }
+  return true;
+}
+
+std::vector<int64_t> sizesOf(
+    const Value* v,
+    const std::unordered_map<const Value*, at::Tensor>& values,
+    const at::Tensor& grad) {
+  auto it = values.find(v);
+  if (it != values.end()) {
+    return it->second.sizes().vec();
+  }
+  auto sizes = v->type()->expectRef<TensorType>().sizes().concrete_sizes();
+  return sizes ? *sizes : grad.sizes().vec();
+}
+
+} // namespace
+
+void PrepareLlgaTraining(std::shared_ptr<Graph>& graph) {
+  std::vector<Node*> groups;
+  for (auto* node : graph->block()->nodes()) {
+    if (LlgaGraphHelper::isLlgaSubgraph(node)) {
+      groups.push_back(node);
+    }
+  }
+  for (auto* group : groups) {
+    if (std::none_of(
+            group->inputs().begin(), group->inputs().end(), mayRequireGrad)) {
+      continue;
+    }
+    if (isTrainable(*group->g(attr::Subgraph))) {
+      group->i_(trainingAttr(), 1);
+    } else {
+      GRAPH_DEBUG("Unmerging untrainable ", getHeader(group));
+      SubgraphUtils::unmergeSubgraph(group);
+    }
+  }
+  GRAPH_DUMP("After PrepareLlgaTraining", graph);
+}
+
+bool isLlgaTrainingGroup(const Node* node) {
+  return node->hasAttribute(trainingAttr());
+}
+
+LlgaPartitionBackward::LlgaPartitionBackward(
+    std::shared_ptr<Graph> graph,
+    const std::vector<at::Tensor>& inputs)
+    : graph_(std::move(graph)) {
+  for (const auto& input : inputs) {
+    inputs_.emplace_back(input, /*is_output*/ false);
+    inputsRequireGrad_.push_back(input.requires_grad());
+  }
+}
+
+void LlgaPartitionBackward::saveOutputs(
+    const std::vector<at::Tensor>& outputs) {
+  for (const auto& output : outputs) {
+    outputs_.emplace_back(output, /*is_output*/ true);
+  }
+}
+
+void LlgaPartitionBackward::release_variables() {
+  for (auto& input : inputs_) {
+    input.reset_data();
+  }
+  for (auto& output : outputs_) {
+    output.reset_data();
+  }
+}
+
+torch::autograd::variable_list LlgaPartitionBackward::apply(
+    torch::autograd::variable_list&& grads) {
+  std::unordered_map<const Value*, at::Tensor> values;
+  std::unordered_set<const Value*> needsGrad;
+  for (size_t i = 0; i < inputs_.size(); i++) {
+    values[graph_->inputs()[i]] = inputs_[i].unpack();
+    if (inputsRequireGrad_[i]) {
+      needsGrad.insert(graph_->inputs()[i]);
+    }
+  }
+  for (size_t i = 0; i < outputs_.size(); i++) {
+    values[graph_->outputs()[i]] = outputs_[i].unpack(shared_from_this());
+  }
+  // only the ops on a path from an input which requires grad are
+  // differentiated
+  for (auto* node : graph_->nodes()) {
+    for (auto* input : node->inputs()) {
+      if (needsGrad.count(input)) {
+        needsGrad.insert(node->outputs().begin(), node->outputs().end());
+        break;
+      }
+    }
+  }
+
+  auto tensorOf = [&](const Value* v) -> at::Tensor {
+    if (v->node()->kind() == prim::Constant) {
+      auto ivalue = toIValue(v);
+      return ivalue->isTensor() ? ivalue->toTensor() : at::Tensor();
+    }
+    return values.at(v);
+  };
+
+  std::unordered_map<const Value*, at::Tensor> gradOf;
+  auto accumulate = [&](const Value* v, const at::Tensor& grad) {
+    if (!needsGrad.count(v) || !grad.defined()) {
+      return;
+    }
+    auto& acc = gradOf[v];
+    acc = acc.defined() ? acc + grad : grad;
+  };
+  for (size_t i = 0; i < grads.size(); i++) {
+    accumulate(graph_->outputs()[i], grads[i]);
+  }
+
+  auto nodes = graph_->nodes().reverse();
+  for (auto* node : nodes) {
+    if (node->kind() == prim::Constant) {
+      continue;
+    }
+    auto it = gradOf.find(node->output());
+    if (it == gradOf.end()) {
+      continue;
+    }
+    auto grad = it->second;
+    switch (node->kind()) {
+      case aten::relu:
+        accumulate(
+            node->input(0),
+            at::threshold_backward(grad, tensorOf(node->output()), 0));
+        break;
+      case aten::sigmoid:
+        accumulate(
+            node->input(0),
+            at::sigmoid_backward(grad, tensorOf(node->output())));
+        break;
+      case aten::tanh:
+        accumulate(
+            node->input(0), at::tanh_backward(grad, tensorOf(node->output())));
+        break;
+      case aten::add: {
+        accumulate(
+            node->input(0),
+            at::sum_to(grad, sizesOf(node->input(0), values, grad)));
+        if (node->input(1)->type()->cast<TensorType>()) {
+          auto alpha = toIValue(node->input(2))->toScalar();
+          auto other = alpha.equal(1) ? grad : grad.mul(alpha);
+          accumulate(
+              node->input(1),
+              at::sum_to(other, sizesOf(node->input(1), values, grad)));
+        }
+        break;
+      }
+      case aten::to: {
+        auto type = node->input(0)->type()->expect<TensorType>();
+        accumulate(
+            node->input(0),
+            type->scalarType() ? grad.to(*type->scalarType()) : grad);
+        break;
+      }
+      case aten::linear: {
+        auto input = tensorOf(node->input(0));
+        auto weight = tensorOf(node->input(1));
+        auto grad2d = grad.reshape({-1, grad.size(-1)});
+        if (needsGrad.count(node->input(0))) {
+          accumulate(node->input(0), grad.matmul(weight));
+        }
+        if (needsGrad.count(node->input(1))) {
+          accumulate(
+              node->input(1),
+              grad2d.t().mm(input.reshape({-1, input.size(-1)})));
+        }
+        if (needsGrad.count(node->input(2))) {
+          accumulate(node->input(2), grad2d.sum(0));
+        }
+        break;
+      }
+      case aten::_convolution:
+      case aten::conv2d: {
+        bool conv2d = node->kind() == aten::conv2d;
+        auto input = tensorOf(node->input(0));
+        auto weight = tensorOf(node->input(1));
+        auto bias = tensorOf(node->input(2));
+        c10::optional<at::IntArrayRef> biasSizes = c10::nullopt;
+        if (bias.defined()) {
+          biasSizes = bias.sizes();
+        }
+        auto outputPadding = conv2d ? std::vector<int64_t>{0}
+                                    : Operator::Ints(node, /* offset */ 7);
+        auto result = at::convolution_backward(
+            grad,
+            input,
+            weight,
+            biasSizes,
+            Operator::Ints(node, /* offset */ 3),
+            Operator::Ints(node, /* offset */ 4),
+            Operator::Ints(node, /* offset */ 5),
+            conv2d ? false : Operator::Bool(node, /* offset */ 6),
+            outputPadding,
+            Operator::Int(node, /* offset */ conv2d ? 6 : 8),
+            {needsGrad.count(node->input(0)) > 0,
+             needsGrad.count(node->input(1)) > 0,
+             needsGrad.count(node->input(2)) > 0});
+        accumulate(node->input(0), std::get<0>(result));
+        accumulate(node->input(1), std::get<1>(result));
+        accumulate(node->input(2), std::get<2>(result));
+        break;
+      }
+      default:
+        TORCH_CHECK(
+            false, "No LLGA backward for ", node->kind().toQualString());
+    }
+  }
+
+  torch::autograd::variable_list inputGrads(inputs_.size());
+  for (size_t i = 0; i < inputs_.size(); i++) {
+    auto it = gradOf.find(graph_->inputs()[i]);
+    if (it != gradOf.end()) {
+      inputGrads[i] = it->second;
+    }
+  }
+  return inputGrads;
+}
+
+void setLlgaPartitionHistory(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<at::Tensor>& inputs,
+    std::vector<at::Tensor>& outputs) {
+  if (!torch::autograd::compute_requires_grad(at::TensorList(inputs))) {
+    return;
+  }
+  auto gradFn = std::shared_ptr<LlgaPartitionBackward>(
+      new LlgaPartitionBackward(graph, inputs), torch::autograd::deleteNode);
+  gradFn->set_next_edges(
+      torch::autograd::collect_next_edges(at::TensorList(inputs)));
+  torch::autograd::set_history(outputs, gradFn);
+  gradFn->saveOutputs(outputs);
+}
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
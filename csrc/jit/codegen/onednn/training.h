@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/saved_variable.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+namespace fuser {
+namespace onednn {
+
+// Prepares the LLGA fusion groups whose inputs may require grad for
+// training. A group whose backward can be computed from its inputs and
+// outputs (convolution, linear, eltwise whose derivative is a function of
+// their output, add and type conversion) is marked with the `training` attr
+// and keeps strided outputs. The other ones are unmerged, their ops run
+// unfused.
+// PrepareLlgaTraining must be placed after CreateLlgaSubgraphs and before
+// PropagateLayout.
+void PrepareLlgaTraining(std::shared_ptr<torch::jit::Graph>& graph);
+
+bool isLlgaTrainingGroup(const torch::jit::Node* node);
+
+// The grad_fn of the outputs of an LLGA partition marked for training. It
+// computes the gradients of the inputs of the partition with the backward
+// kernels of its ops, from the saved inputs and outputs of the partition.
+struct LlgaPartitionBackward : public torch::autograd::Node {
+  LlgaPartitionBackward(
+      std::shared_ptr<torch::jit::Graph> graph,
+      const std::vector<at::Tensor>& inputs);
+
+  // Called once the outputs have this node as grad_fn.
+  void saveOutputs(const std::vector<at::Tensor>& outputs);
+
+  torch::autograd::variable_list apply(
+      torch::autograd::variable_list&& grads) override;
+
+  std::string name() const override {
+    return "LlgaPartitionBackward";
+  }
+
+  void release_variables() override;
+
+ private:
+  std::shared_ptr<torch::jit::Graph> graph_;
+  std::vector<torch::autograd::SavedVariable> inputs_;
+  std::vector<torch::autograd::SavedVariable> outputs_;
+  std::vector<bool> inputsRequireGrad_;
+};
+
+// Sets an LlgaPartitionBackward as grad_fn of the outputs of the partition
+// of `graph`, if any of its inputs requires grad.
+void setLlgaPartitionHistory(
+    const std::shared_ptr<torch::jit::Graph>& graph,
+    const std::vector<at::Tensor>& inputs,
+    std::vector<at::Tensor>& outputs);
+
+} // namespace onednn
+} // namespace fuser
+} // namespace jit
+} // namespace torch_ipex
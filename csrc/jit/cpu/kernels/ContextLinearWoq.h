@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+struct ContextLinearWoq final {
+  int64_t out_features_;
+  int64_t in_features_;
+  int64_t bits_;
+  int64_t group_size_;
+  at::Tensor at_weight_; // quantized weight in blocked format
+  at::Tensor scales_; // fp32 scales in blocked format
+  at::ScalarType weight_dtype_; // dtype of the original weight
+  c10::optional<at::Tensor> at_bias_;
+
+  ContextLinearWoq() = delete;
+
+  ContextLinearWoq(
+      int64_t out_features,
+      int64_t in_features,
+      int64_t bits,
+      int64_t group_size,
+      at::Tensor&& qweight,
+      at::Tensor&& scales,
+      at::ScalarType weight_dtype,
+      c10::optional<at::Tensor>&& bias)
+      : out_features_(out_features),
+        in_features_(in_features),
+        bits_(bits),
+        group_size_(group_size),
+        at_weight_(std::move(qweight)),
+        scales_(std::move(scales)),
+        weight_dtype_(weight_dtype),
+        at_bias_(std::move(bias)) {}
+
+  ContextLinearWoq(ContextLinearWoq&&) = default;
+  ContextLinearWoq& operator=(ContextLinearWoq&&) = default;
+
+  ~ContextLinearWoq() {}
+};
+
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -26,6 +26,23 @@ namespace convolution {
             torch_ipex::fpmath_mode));                              \
   }
 
+#define DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(FUSED_OP)          \
+  at::Tensor& convolution_##FUSED_OP##_run_out(                     \
+      const at::Tensor& input,                                      \
+      at::Tensor& output,                                           \
+      const c10::intrusive_ptr<ConvolutionOpContext>& op_context) { \
+    RECORD_FUNCTION(                                                \
+        "ipex_prepack::convolution_" #FUSED_OP "_run_out",          \
+        c10::ArrayRef<c10::IValue>({}));                            \
+    auto attr = ideep::attr_t::fuse_##FUSED_OP().set_fpmath_mode(   \
+        torch_ipex::fpmath_mode);                                   \
+    if (!output.defined()) {                                        \
+      output = op_context->run(input, attr);                        \
+      return output;                                                \
+    }                                                               \
+    return op_context->run(input, output, attr);                    \
+  }
+
 // follow check rules from
 // https://github.com/pytorch/pytorch/blob/master/aten/src/ATen/native/Convolution.cpp
 static void check_shape_forward(
@@ -193,6 +210,34 @@ DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(round);
 DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(sqrt);
 DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN(hardsigmoid);
 
+at::Tensor& convolution_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::convolution_run_out", c10::ArrayRef<c10::IValue>({}));
+  if (!output.defined()) {
+    output = op_context->run(input, ideep::attr_t(torch_ipex::fpmath_mode));
+    return output;
+  }
+  return op_context->run(
+      input, output, ideep::attr_t(torch_ipex::fpmath_mode));
+}
+
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(relu);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(sigmoid);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(swish);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(tanh);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(mish);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(abs);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(exp);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(hardswish);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(square);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(log);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(round);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(sqrt);
+DEFINE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(hardsigmoid);
+
 at::Tensor convolution_leaky_relu_run(
     const at::Tensor& input,
     at::Scalar alpha,
@@ -592,20 +637,13 @@ ContextConvolution create(
   ideep::data_type dtype = w.get_data_type();
   auto expected_desc =
       ideep::tensor::desc(conv_params.pd.weights_desc(), groups);
-  auto at_weight = empty_aten_tensor_from_desc(expected_desc, weight.options());
+  TORCH_CHECK(
+      ideep::data_type::f32 == dtype || ideep::data_type::bf16 == dtype ||
+          ideep::data_type::f16 == dtype,
+      "Only support bfloat16, float16 and float for weight prepack of convolution");
   ideep::tensor packed_weight;
-  if (ideep::data_type::f32 == dtype) {
-    packed_weight.init(expected_desc, at_weight.template data_ptr<float>());
-  } else if (ideep::data_type::bf16 == dtype) {
-    packed_weight.init(
-        expected_desc, at_weight.template data_ptr<c10::BFloat16>());
-  } else {
-    TORCH_CHECK(
-        ideep::data_type::f16 == dtype,
-        "Only support bfloat16, float16 and float for weight prepack of convolution");
-    packed_weight.init(expected_desc, at_weight.template data_ptr<c10::Half>());
-  }
-  packed_weight.feed_from(w);
+  auto at_weight =
+      pack_weight_to_desc(w, expected_desc, weight.options(), packed_weight);
 
   return ContextConvolution{
       std::move(ori_desc),
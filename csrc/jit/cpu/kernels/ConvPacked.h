@@ -16,6 +16,12 @@ namespace convolution {
       const at::Tensor& input,                          \
       const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
 
+#define DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(FUSED_OP) \
+  at::Tensor& convolution_##FUSED_OP##_run_out(             \
+      const at::Tensor& input,                              \
+      at::Tensor& output,                                   \
+      const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
+
 static void check_shape_forward(
     const at::IntArrayRef& input_sizes,
     const at::IntArrayRef& weight_sizes,
@@ -53,6 +59,28 @@ DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(round);
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(sqrt);
 DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN(hardsigmoid);
 
+// The _run_out variants write the result into the preallocated output, they
+// are used by the memory planning pass for frozen graphs. The result is
+// allocated instead if the output is undefined.
+at::Tensor& convolution_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<ConvolutionOpContext>& op_context);
+
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(relu);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(sigmoid);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(swish);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(tanh);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(mish);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(abs);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(exp);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(hardswish);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(square);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(log);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(round);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(sqrt);
+DECLARE_CONVOLUTION_UNARY_ELTWISE_RUN_OUT(hardsigmoid);
+
 at::Tensor convolution_leaky_relu_run(
     const at::Tensor& input,
     at::Scalar alpha,
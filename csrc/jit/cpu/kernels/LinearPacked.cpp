@@ -22,6 +22,23 @@ namespace linear {
             torch_ipex::fpmath_mode));                         \
   }
 
+#define DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(FUSED_OP)             \
+  at::Tensor& linear_##FUSED_OP##_run_out(                        \
+      const at::Tensor& input,                                    \
+      at::Tensor& output,                                         \
+      const c10::intrusive_ptr<LinearOpContext>& op_context) {    \
+    RECORD_FUNCTION(                                              \
+        "ipex_prepack::linear_" #FUSED_OP "_run_out",             \
+        c10::ArrayRef<c10::IValue>({}));                          \
+    auto attr = ideep::attr_t::fuse_##FUSED_OP().set_fpmath_mode( \
+        torch_ipex::fpmath_mode);                                 \
+    if (!output.defined()) {                                      \
+      output = op_context->run(input, attr);                      \
+      return output;                                              \
+    }                                                             \
+    return op_context->run(input, output, attr);                  \
+  }
+
 c10::intrusive_ptr<LinearOpContext> createLinearPrePackOpContext(
     at::Tensor&& weight,
     c10::optional<at::Tensor>&& bias,
@@ -56,6 +73,34 @@ DEFINE_LINEAR_UNARY_ELTWISE_RUN(round);
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(sqrt);
 DEFINE_LINEAR_UNARY_ELTWISE_RUN(hardsigmoid);
 
+at::Tensor& linear_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<LinearOpContext>& op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::linear_run_out", c10::ArrayRef<c10::IValue>({}));
+  if (!output.defined()) {
+    output = op_context->run(input, ideep::attr_t(torch_ipex::fpmath_mode));
+    return output;
+  }
+  return op_context->run(
+      input, output, ideep::attr_t(torch_ipex::fpmath_mode));
+}
+
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(relu);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(sigmoid);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(swish);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(tanh);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(mish);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(abs);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(exp);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(hardswish);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(square);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(log);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(round);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(sqrt);
+DEFINE_LINEAR_UNARY_ELTWISE_RUN_OUT(hardsigmoid);
+
 at::Tensor linear_leaky_relu_run(
     const at::Tensor& input,
     at::Scalar alpha,
@@ -188,19 +233,12 @@ ContextLinear create(
       input_size,
       /* weight dtype */ dtype,
       /* src dtype */ dtype);
-  auto at_weight = empty_aten_tensor_from_desc(packed_desc, weight.options());
-  if (ideep::data_type::f32 == dtype) {
-    packed_weight.init(packed_desc, at_weight.template data_ptr<float>());
-  } else if (ideep::data_type::bf16 == dtype) {
-    packed_weight.init(
-        packed_desc, at_weight.template data_ptr<c10::BFloat16>());
-  } else {
-    TORCH_CHECK(
-        ideep::data_type::f16 == dtype,
-        "Only support bfloat16, float16 and float for weight prepack of linear");
-    packed_weight.init(packed_desc, at_weight.template data_ptr<c10::Half>());
-  }
-  packed_weight.feed_from(w);
+  TORCH_CHECK(
+      ideep::data_type::f32 == dtype || ideep::data_type::bf16 == dtype ||
+          ideep::data_type::f16 == dtype,
+      "Only support bfloat16, float16 and float for weight prepack of linear");
+  auto at_weight =
+      pack_weight_to_desc(w, packed_desc, weight.options(), packed_weight);
   return ContextLinear{
       std::move(ori_desc),
       std::move(packed_weight),
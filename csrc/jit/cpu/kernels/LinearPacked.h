@@ -14,6 +14,12 @@ namespace linear {
       const at::Tensor& input,                     \
       const c10::intrusive_ptr<LinearOpContext>& op_context);
 
+#define DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(FUSED_OP) \
+  at::Tensor& linear_##FUSED_OP##_run_out(             \
+      const at::Tensor& input,                         \
+      at::Tensor& output,                              \
+      const c10::intrusive_ptr<LinearOpContext>& op_context);
+
 c10::intrusive_ptr<LinearOpContext> createLinearPrePackOpContext(
     at::Tensor&& weight,
     c10::optional<at::Tensor>&& bias,
@@ -37,6 +43,28 @@ DECLARE_LINEAR_UNARY_ELTWISE_RUN(round);
 DECLARE_LINEAR_UNARY_ELTWISE_RUN(sqrt);
 DECLARE_LINEAR_UNARY_ELTWISE_RUN(hardsigmoid);
 
+// The _run_out variants write the result into the preallocated output, they
+// are used by the memory planning pass for frozen graphs. The result is
+// allocated instead if the output is undefined.
+at::Tensor& linear_run_out(
+    const at::Tensor& input,
+    at::Tensor& output,
+    const c10::intrusive_ptr<LinearOpContext>& op_context);
+
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(relu);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(sigmoid);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(swish);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(tanh);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(mish);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(abs);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(exp);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(hardswish);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(square);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(log);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(round);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(sqrt);
+DECLARE_LINEAR_UNARY_ELTWISE_RUN_OUT(hardsigmoid);
+
 at::Tensor linear_leaky_relu_run(
     const at::Tensor& input,
     at::Scalar alpha,
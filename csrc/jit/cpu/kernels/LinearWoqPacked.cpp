@@ -0,0 +1,78 @@
+#include "LinearWoqPacked.h"
+#include "aten/WoqLinear.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace woq_linear {
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size) {
+  RECORD_FUNCTION(
+      "ipex_prepack::createWoqLinearPrePackOpContext",
+      c10::ArrayRef<c10::IValue>({}));
+
+  return IpexWoqLinearOpContext::create_context(
+      std::move(weight), std::move(bias), bits, group_size);
+}
+
+at::Tensor woq_linear_run(
+    const at::Tensor& input,
+    c10::intrusive_ptr<WoqLinearOpContext> op_context) {
+  RECORD_FUNCTION(
+      "ipex_prepack::woq_linear_run", c10::ArrayRef<c10::IValue>({}));
+
+  return op_context->run(input);
+}
+
+ContextLinearWoq create(
+    at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    int64_t bits,
+    int64_t group_size) {
+  auto packed = woq_linear_pack_weight(weight, bits, group_size);
+  // the original weight is not kept, unpack dequantizes the packed one
+  return ContextLinearWoq{
+      weight.size(0),
+      weight.size(1),
+      bits,
+      group_size,
+      std::move(std::get<0>(packed)),
+      std::move(std::get<1>(packed)),
+      weight.scalar_type(),
+      bias.has_value() ? c10::make_optional(*bias) : c10::nullopt,
+  };
+}
+
+at::Tensor run(ContextLinearWoq& context, const at::Tensor& input) {
+  TORCH_CHECK(
+      input.size(input.dim() - 1) == context.in_features_,
+      "Check the shapes of mat1 and mat2, they cannot be multiplied!");
+  return woq_linear(
+      input,
+      context.at_weight_,
+      context.scales_,
+      context.at_bias_,
+      context.out_features_,
+      context.bits_,
+      context.group_size_);
+}
+
+at::Tensor unpack(ContextLinearWoq& context) {
+  return woq_linear_unpack_weight(
+             context.at_weight_,
+             context.scales_,
+             context.out_features_,
+             context.in_features_,
+             context.bits_,
+             context.group_size_)
+      .to(context.weight_dtype_);
+}
+
+} // namespace woq_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include "ContextLinearWoq.h"
+#include "OpContext.h"
+
+namespace torch_ipex {
+namespace cpu {
+namespace detail {
+namespace woq_linear {
+
+c10::intrusive_ptr<WoqLinearOpContext> createWoqLinearPrePackOpContext(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size);
+
+at::Tensor woq_linear_run(
+    const at::Tensor& input,
+    c10::intrusive_ptr<WoqLinearOpContext> op_context);
+
+ContextLinearWoq create(
+    at::Tensor& weight,
+    const c10::optional<at::Tensor>& bias,
+    int64_t bits,
+    int64_t group_size);
+
+at::Tensor run(ContextLinearWoq& context, const at::Tensor& input);
+
+// Dequantize the packed weight back to [out_features, in_features]
+at::Tensor unpack(ContextLinearWoq& context);
+
+} // namespace woq_linear
+} // namespace detail
+} // namespace cpu
+} // namespace torch_ipex
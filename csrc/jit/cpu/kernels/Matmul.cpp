@@ -287,6 +287,22 @@ at::Tensor dil_bmm_add(
     const at::Tensor& batch1,
     const at::Tensor& batch2,
     const c10::Scalar& alpha) {
+  return dil_bmm_add(input, batch1, batch2, at::Tensor(), alpha);
+}
+
+/**
+ * output(out) = input + batch1 * batch2, with the add fused into the oneDNN
+ * matmul as a binary post op when both batches have the same rank >= 3.
+ *
+ * @param out Optional preallocated output, e.g. the result buffer of an NNC
+ * external call
+ */
+at::Tensor dil_bmm_add(
+    const at::Tensor& input,
+    const at::Tensor& batch1,
+    const at::Tensor& batch2,
+    at::Tensor out,
+    const c10::Scalar& alpha) {
   RECORD_FUNCTION("dil_bmm_add", c10::ArrayRef<c10::IValue>({}));
   auto batch1_dim = batch1.dim();
   auto batch2_dim = batch2.dim();
@@ -297,8 +313,9 @@ at::Tensor dil_bmm_add(
     auto op_attr = ideep::attr_t::fuse_binary(
         dnnl::algorithm::binary_add, onednn_input.get_desc());
     op_attr.set_fpmath_mode(torch_ipex::fpmath_mode);
-    return bmm_impl(
-        batch1, batch2, at::Tensor(), op_attr, {onednn_input}, 1.0f);
+    return bmm_impl(batch1, batch2, out, op_attr, {onednn_input}, 1.0f);
+  } else if (out.defined()) {
+    return at::baddbmm_out(out, input, batch1, batch2);
   } else {
     return at::baddbmm(input, batch1, batch2);
   }
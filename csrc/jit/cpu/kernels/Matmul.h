@@ -59,5 +59,12 @@ at::Tensor dil_bmm_add(
     const at::Tensor& batch2,
     const c10::Scalar& alpha);
 
+at::Tensor dil_bmm_add(
+    const at::Tensor& input,
+    const at::Tensor& batch1,
+    const at::Tensor& batch2,
+    at::Tensor out,
+    const c10::Scalar& alpha);
+
 } // namespace cpu
 } // namespace torch_ipex
@@ -0,0 +1,51 @@
+#include "MemoryPlan.h"
+
+#include <ATen/ATen.h>
+#include <c10/util/Exception.h>
+
+namespace torch_ipex {
+namespace cpu {
+
+at::Tensor MemoryPlanContext::arena() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& arena = arenas_[std::this_thread::get_id()];
+  if (!arena.defined()) {
+    arena = at::empty({nbytes_}, at::TensorOptions().dtype(at::kByte));
+  }
+  return arena;
+}
+
+at::Tensor memory_plan_arena(
+    const c10::intrusive_ptr<MemoryPlanContext>& plan) {
+  RECORD_FUNCTION("ipex::memory_plan_arena", c10::ArrayRef<c10::IValue>({}));
+  return plan->arena();
+}
+
+at::Tensor memory_plan_slot(
+    const at::Tensor& arena,
+    int64_t offset,
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    at::ScalarType dtype,
+    const at::Tensor& input,
+    at::IntArrayRef input_sizes,
+    at::IntArrayRef input_strides,
+    at::ScalarType input_dtype) {
+  if (input.sizes() != input_sizes || input.strides() != input_strides ||
+      input.scalar_type() != input_dtype) {
+    return at::Tensor();
+  }
+  auto itemsize = static_cast<int64_t>(c10::elementSize(dtype));
+  TORCH_CHECK(
+      offset % itemsize == 0,
+      "memory_plan_slot: offset ",
+      offset,
+      " is not aligned to the element size ",
+      itemsize);
+  auto slot = at::empty({0}, arena.options().dtype(dtype));
+  slot.set_(arena.storage(), offset / itemsize, sizes, strides);
+  return slot;
+}
+
+} // namespace cpu
+} // namespace torch_ipex
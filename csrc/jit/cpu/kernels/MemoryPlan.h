@@ -0,0 +1,61 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+
+#include <c10/core/Scalar.h>
+#include <torch/csrc/jit/runtime/custom_operator.h>
+#include <torch/custom_class.h>
+
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace torch_ipex {
+namespace cpu {
+
+using SerializationTypeMemoryPlan = std::tuple<int64_t, int64_t>;
+
+// Owns the byte buffers backing the memory plan plan_id, one buffer per
+// thread so that a frozen module can be run by several threads. The context
+// is a constant of the planned graph, so the buffers are freed together with
+// the graph.
+class MemoryPlanContext : public torch::jit::CustomClassHolder {
+ public:
+  MemoryPlanContext(int64_t plan_id, int64_t nbytes)
+      : plan_id_(plan_id), nbytes_(nbytes) {}
+
+  SerializationTypeMemoryPlan unpack() {
+    return std::make_tuple(plan_id_, nbytes_);
+  }
+
+  // Returns the buffer of the calling thread, allocated on its first call
+  // and reused by the later iterations.
+  at::Tensor arena();
+
+ private:
+  int64_t plan_id_;
+  int64_t nbytes_;
+  std::mutex mutex_;
+  std::unordered_map<std::thread::id, at::Tensor> arenas_;
+};
+
+at::Tensor memory_plan_arena(
+    const c10::intrusive_ptr<MemoryPlanContext>& plan);
+
+// Returns a tensor viewing the arena from the byte offset, with the given
+// sizes, strides and dtype. The slot was planned for the profiled input of
+// the op writing it, so an undefined tensor is returned instead if the input
+// has other sizes, strides or dtype, and the op allocates its output.
+at::Tensor memory_plan_slot(
+    const at::Tensor& arena,
+    int64_t offset,
+    at::IntArrayRef sizes,
+    at::IntArrayRef strides,
+    at::ScalarType dtype,
+    const at::Tensor& input,
+    at::IntArrayRef input_sizes,
+    at::IntArrayRef input_strides,
+    at::ScalarType input_dtype);
+
+} // namespace cpu
+} // namespace torch_ipex
@@ -4,10 +4,76 @@
 #include "ConvTransposePacked.h"
 #include "LinearMKLPacked.h"
 #include "LinearPacked.h"
+#include "LinearWoqPacked.h"
+#include "utils/op_counters.h"
 
 namespace torch_ipex {
 namespace cpu {
 
+namespace {
+
+// Counts the work of a convolution or a linear where each of the `outputs`
+// elements is a dot product of `dot_size` inputs and weights.
+void add_work(
+    utils::ScopedOpCounter& counter,
+    const at::Tensor& input,
+    const at::Tensor& output,
+    int64_t outputs,
+    int64_t dot_size,
+    int64_t weight_bytes) {
+  if (counter) {
+    counter.add_work(
+        2 * outputs * dot_size,
+        input.nbytes() + output.nbytes() + weight_bytes);
+  }
+}
+
+void add_work(
+    utils::ScopedOpCounter& counter,
+    const detail::ContextConvolution& context,
+    const at::Tensor& input,
+    const at::Tensor& output) {
+  add_work(
+      counter,
+      input,
+      output,
+      output.numel(),
+      context.original_desc_.nelems() / output.size(1),
+      context.weight_packed_.get_size());
+}
+
+void add_work(
+    utils::ScopedOpCounter& counter,
+    const detail::ContextLinear& context,
+    const at::Tensor& input,
+    const at::Tensor& output) {
+  add_work(
+      counter,
+      input,
+      output,
+      output.numel(),
+      context.original_desc_.nelems() / output.size(-1),
+      context.weight_packed_.get_size());
+}
+
+// Each input element of a transposed convolution is scattered to the
+// outputs through all the weights of its input channel.
+void add_work(
+    utils::ScopedOpCounter& counter,
+    const detail::ContextConvTranspose& context,
+    const at::Tensor& input,
+    const at::Tensor& output) {
+  add_work(
+      counter,
+      input,
+      output,
+      input.numel(),
+      context.original_desc_.nelems() / input.size(1),
+      context.weight_packed_.get_size());
+}
+
+} // namespace
+
 template <typename T1, typename T2>
 void load_from_ctx_template(T1* self, c10::intrusive_ptr<T2> other) {
   auto& other_ctx_ = other->get_context();
@@ -82,15 +148,22 @@ int64_t ConvolutionOpContext::get_groups() {
 at::Tensor IpexConvolutionOpContext::run(
     const at::Tensor& input,
     const ideep::attr_t& attr) {
-  return torch_ipex::cpu::detail::convolution::run(op_context_, input, attr);
+  IPEX_OP_COUNTER(counter, "ipex_prepack::convolution_run");
+  auto output =
+      torch_ipex::cpu::detail::convolution::run(op_context_, input, attr);
+  add_work(counter, op_context_, input, output);
+  return output;
 }
 
 at::Tensor& IpexConvolutionOpContext::run(
     const at::Tensor& input,
     at::Tensor& accumu,
     const ideep::attr_t& attr) {
-  return torch_ipex::cpu::detail::convolution::run(
+  IPEX_OP_COUNTER(counter, "ipex_prepack::convolution_run");
+  auto& output = torch_ipex::cpu::detail::convolution::run(
       op_context_, input, accumu, attr);
+  add_work(counter, op_context_, input, output);
+  return output;
 }
 
 std::tuple<at::Tensor, at::Tensor, at::Tensor> IpexConvolutionOpContext::
@@ -149,14 +222,21 @@ at::Tensor IpexLinearOpContext::get_data_handle() {
 at::Tensor IpexLinearOpContext::run(
     const at::Tensor& input,
     const ideep::attr_t& attr) {
-  return torch_ipex::cpu::detail::linear::run(op_context_, input, attr);
+  IPEX_OP_COUNTER(counter, "ipex_prepack::linear_run");
+  auto output = torch_ipex::cpu::detail::linear::run(op_context_, input, attr);
+  add_work(counter, op_context_, input, output);
+  return output;
 }
 
 at::Tensor& IpexLinearOpContext::run(
     const at::Tensor& input,
     at::Tensor& accumu,
     const ideep::attr_t& attr) {
-  return torch_ipex::cpu::detail::linear::run(op_context_, input, accumu, attr);
+  IPEX_OP_COUNTER(counter, "ipex_prepack::linear_run");
+  auto& output = torch_ipex::cpu::detail::linear::run(
+      op_context_, input, accumu, attr);
+  add_work(counter, op_context_, input, output);
+  return output;
 }
 
 std::tuple<at::Tensor, at::Tensor, at::Tensor> IpexLinearOpContext::
@@ -244,13 +324,32 @@ at::Tensor IpexLinearMKLOpContext::pack(const at::Tensor& tensor) {
 }
 
 at::Tensor IpexLinearMKLOpContext::run(const at::Tensor& input) {
-  return torch_ipex::cpu::detail::mkl_sgemm::run(op_context_, input);
+  IPEX_OP_COUNTER(counter, "ipex_prepack::mkl_sgemm_run");
+  auto output = torch_ipex::cpu::detail::mkl_sgemm::run(op_context_, input);
+  add_work(
+      counter,
+      input,
+      output,
+      output.numel(),
+      get_in_features(),
+      op_context_.at_weight_.nbytes());
+  return output;
 }
 
 at::Tensor& IpexLinearMKLOpContext::run(
     const at::Tensor& input,
     at::Tensor& accumu) {
-  return torch_ipex::cpu::detail::mkl_sgemm::run(op_context_, input, accumu);
+  IPEX_OP_COUNTER(counter, "ipex_prepack::mkl_sgemm_run");
+  auto& output =
+      torch_ipex::cpu::detail::mkl_sgemm::run(op_context_, input, accumu);
+  add_work(
+      counter,
+      input,
+      output,
+      output.numel(),
+      get_in_features(),
+      op_context_.at_weight_.nbytes());
+  return output;
 }
 
 at::Tensor IpexLinearMKLOpContext::to_public(const at::Tensor& tensor) {
@@ -274,18 +373,86 @@ void IpexLinearMKLOpContext::load_from_ctx(
   load_from_ctx_template(this, other);
 }
 
+c10::intrusive_ptr<WoqLinearOpContext> IpexWoqLinearOpContext::create_context(
+    at::Tensor&& weight,
+    c10::optional<at::Tensor>&& bias,
+    int64_t bits,
+    int64_t group_size) {
+  auto op_context = torch_ipex::cpu::detail::woq_linear::create(
+      weight, bias, bits, group_size);
+  return c10::make_intrusive<IpexWoqLinearOpContext>(std::move(op_context));
+}
+
+at::Tensor IpexWoqLinearOpContext::get_at_packed_weight() {
+  return op_context_.at_weight_;
+}
+
+at::Tensor IpexWoqLinearOpContext::get_data_handle() {
+  at::Tensor ptr = at::empty(1, at::kLong);
+  ptr[0] = reinterpret_cast<int64_t>(this);
+  return ptr;
+}
+
+at::Tensor IpexWoqLinearOpContext::run(const at::Tensor& input) {
+  IPEX_OP_COUNTER(counter, "ipex_prepack::woq_linear_run");
+  auto output = torch_ipex::cpu::detail::woq_linear::run(op_context_, input);
+  add_work(
+      counter,
+      input,
+      output,
+      output.numel(),
+      op_context_.in_features_,
+      op_context_.at_weight_.nbytes() + op_context_.scales_.nbytes());
+  return output;
+}
+
+at::Tensor IpexWoqLinearOpContext::to_public(const at::Tensor& tensor) {
+  return torch_ipex::cpu::detail::woq_linear::unpack(op_context_);
+}
+
+detail::ContextLinearWoq& IpexWoqLinearOpContext::get_context() {
+  return op_context_;
+}
+
+int64_t IpexWoqLinearOpContext::get_out_features() {
+  return op_context_.out_features_;
+}
+
+int64_t IpexWoqLinearOpContext::get_in_features() {
+  return op_context_.in_features_;
+}
+
+void IpexWoqLinearOpContext::load_from_ctx(
+    c10::intrusive_ptr<WoqLinearOpContext> other) {
+  auto& other_ctx_ = other->get_context();
+  TORCH_CHECK(
+      other_ctx_.bits_ == op_context_.bits_ &&
+          other_ctx_.group_size_ == op_context_.group_size_,
+      "WoqLinearOpContext: can not load from a context with another "
+      "quantization config");
+  load_from_ctx_template(this, other);
+  op_context_.scales_.copy_(other_ctx_.scales_);
+}
+
 at::Tensor IpexConvTransposeOpContext::run(
     const at::Tensor& input,
     const ideep::attr_t& attr) {
-  return torch_ipex::cpu::detail::conv_transpose::run(op_context_, input, attr);
+  IPEX_OP_COUNTER(counter, "ipex_prepack::conv_transpose_run");
+  auto output =
+      torch_ipex::cpu::detail::conv_transpose::run(op_context_, input, attr);
+  add_work(counter, op_context_, input, output);
+  return output;
 }
 
 at::Tensor& IpexConvTransposeOpContext::run(
     const at::Tensor& input,
     at::Tensor& accumu,
     const ideep::attr_t& attr) {
-  return torch_ipex::cpu::detail::conv_transpose::run(
+  IPEX_OP_COUNTER(counter, "ipex_prepack::conv_transpose_run");
+  auto& output = torch_ipex::cpu::detail::conv_transpose::run(
       op_context_, input, accumu, attr);
+  add_work(counter, op_context_, input, output);
+  return output;
 }
 
 std::tuple<at::Tensor, at::Tensor, at::Tensor> IpexConvTransposeOpContext::
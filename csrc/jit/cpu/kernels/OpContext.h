@@ -9,6 +9,7 @@
 #include "ContextConvolution.h"
 #include "ContextLinear.h"
 #include "ContextLinearMKL.h"
+#include "ContextLinearWoq.h"
 
 namespace torch_ipex {
 namespace cpu {
@@ -335,6 +336,73 @@ class IpexLinearMKLOpContext final : public MKLOpContext {
   virtual void load_from_ctx(c10::intrusive_ptr<MKLOpContext> other) override;
 };
 
+using SerializationTypeWoqLinearPrePack =
+    std::tuple<at::Tensor, c10::optional<at::Tensor>, int64_t, int64_t>;
+
+// Weight-only quantized linear: the weight is kept in int8/int4 with fp32
+// scales and dequantized inside the GEMM, the activations are not quantized.
+class WoqLinearOpContext : public torch::jit::CustomClassHolder {
+ public:
+  SerializationTypeWoqLinearPrePack unpack() {
+    auto orig_weight = this->to_public(this->get_at_packed_weight());
+    auto& context = this->get_context();
+    return std::make_tuple(
+        orig_weight, context.at_bias_, context.bits_, context.group_size_);
+  }
+
+  virtual at::Tensor get_at_packed_weight() = 0;
+
+  virtual at::Tensor get_data_handle() = 0;
+
+  virtual at::Tensor run(const at::Tensor& input) = 0;
+
+  // Dequantize the packed weight to the original public format
+  virtual at::Tensor to_public(const at::Tensor& tensor) = 0;
+
+  virtual int64_t get_out_features() = 0;
+
+  virtual int64_t get_in_features() = 0;
+
+  virtual detail::ContextLinearWoq& get_context() = 0;
+
+  // inplace copy of the quantized weight, scales and bias of another context
+  // with the same shape and quantization config, see
+  // LinearOpContext::load_from_ctx
+  virtual void load_from_ctx(c10::intrusive_ptr<WoqLinearOpContext> other) = 0;
+};
+
+class IpexWoqLinearOpContext final : public WoqLinearOpContext {
+ private:
+  detail::ContextLinearWoq op_context_;
+
+ public:
+  IpexWoqLinearOpContext(detail::ContextLinearWoq&& op_context)
+      : op_context_(std::move(op_context)) {}
+
+  virtual at::Tensor get_at_packed_weight() override;
+
+  virtual at::Tensor get_data_handle() override;
+
+  virtual at::Tensor run(const at::Tensor& input) override;
+
+  virtual at::Tensor to_public(const at::Tensor& tensor) override;
+
+  virtual detail::ContextLinearWoq& get_context() override;
+
+  virtual int64_t get_out_features() override;
+
+  virtual int64_t get_in_features() override;
+
+  static c10::intrusive_ptr<WoqLinearOpContext> create_context(
+      at::Tensor&& weight,
+      c10::optional<at::Tensor>&& bias,
+      int64_t bits,
+      int64_t group_size);
+
+  virtual void load_from_ctx(
+      c10::intrusive_ptr<WoqLinearOpContext> other) override;
+};
+
 // deconv op
 using SerializationTypeConvTransposePrePack = std::tuple<
     at::Tensor,
@@ -5,6 +5,8 @@
 #include "ConvTransposePacked.h"
 #include "LinearMKLPacked.h"
 #include "LinearPacked.h"
+#include "LinearWoqPacked.h"
+#include "MemoryPlan.h"
 #include "OpContext.h"
 
 namespace torch_ipex {
@@ -13,6 +15,7 @@ using detail::conv_transpose::createConvTransposePrePackOpContext;
 using detail::convolution::createConvolutionPrePackOpContext;
 using detail::linear::createLinearPrePackOpContext;
 using detail::mkl_sgemm::createLinearMKLPrePackOpContext;
+using detail::woq_linear::createWoqLinearPrePackOpContext;
 
 TORCH_LIBRARY(ipex_prepack, m) {
   m.class_<ConvolutionOpContext>("ConvolutionOpContext")
@@ -82,6 +85,30 @@ TORCH_LIBRARY(ipex_prepack, m) {
       .def("to_public", &torch_ipex::cpu::MKLOpContext::to_public)
       .def("get_data_handle", &torch_ipex::cpu::MKLOpContext::get_data_handle)
       .def("load_from_ctx", &torch_ipex::cpu::MKLOpContext::load_from_ctx);
+  m.class_<WoqLinearOpContext>("WoqLinearOpContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<WoqLinearOpContext>& op_context)
+              -> SerializationTypeWoqLinearPrePack { // __getstate__
+            return op_context->unpack();
+          },
+          [](SerializationTypeWoqLinearPrePack state)
+              -> c10::intrusive_ptr<WoqLinearOpContext> { // __setstate__
+            return createWoqLinearPrePackOpContext(
+                std::move(std::get<0>(state)),
+                std::move(std::get<1>(state)),
+                std::move(std::get<2>(state)),
+                std::move(std::get<3>(state)));
+          })
+      .def(
+          "get_weight",
+          &torch_ipex::cpu::WoqLinearOpContext::get_at_packed_weight)
+      .def("to_public", &torch_ipex::cpu::WoqLinearOpContext::to_public)
+      .def(
+          "get_data_handle",
+          &torch_ipex::cpu::WoqLinearOpContext::get_data_handle)
+      .def(
+          "load_from_ctx",
+          &torch_ipex::cpu::WoqLinearOpContext::load_from_ctx);
   m.class_<ConvTransposeOpContext>("ConvTransposeOpContext")
       .def_pickle(
           [](const c10::intrusive_ptr<ConvTransposeOpContext>& op_context)
@@ -112,6 +139,17 @@ TORCH_LIBRARY(ipex_prepack, m) {
       .def(
           "load_from_ctx",
           &torch_ipex::cpu::ConvTransposeOpContext::load_from_ctx);
+  m.class_<MemoryPlanContext>("MemoryPlanContext")
+      .def_pickle(
+          [](const c10::intrusive_ptr<MemoryPlanContext>& plan)
+              -> SerializationTypeMemoryPlan { // __getstate__
+            return plan->unpack();
+          },
+          [](SerializationTypeMemoryPlan state)
+              -> c10::intrusive_ptr<MemoryPlanContext> { // __setstate__
+            return c10::make_intrusive<MemoryPlanContext>(
+                std::get<0>(state), std::get<1>(state));
+          });
   m.def(
       "convolution_prepack(Tensor W, Tensor? B, int[] stride, "
       "int[] padding, int[] dilation, int groups, "
@@ -123,6 +161,9 @@ TORCH_LIBRARY(ipex_prepack, m) {
   m.def(
       "mkl_sgemm_prepack(Tensor W, Tensor? B, int? batch_size) "
       "-> __torch__.torch.classes.ipex_prepack.MKLOpContext");
+  m.def(
+      "woq_linear_prepack(Tensor W, Tensor? B, int bits, int group_size) "
+      "-> __torch__.torch.classes.ipex_prepack.WoqLinearOpContext");
   m.def(
       "conv_transpose_prepack(Tensor W, Tensor? B, int[] stride, "
       "int[] padding, int[] output_padding, int groups, int[] dilation, "
@@ -134,6 +175,7 @@ TORCH_LIBRARY_IMPL(ipex_prepack, CPU, m) {
   m.impl("convolution_prepack", TORCH_FN(createConvolutionPrePackOpContext));
   m.impl("linear_prepack", TORCH_FN(createLinearPrePackOpContext));
   m.impl("mkl_sgemm_prepack", TORCH_FN(createLinearMKLPrePackOpContext));
+  m.impl("woq_linear_prepack", TORCH_FN(createWoqLinearPrePackOpContext));
   m.impl(
       "conv_transpose_prepack", TORCH_FN(createConvTransposePrePackOpContext));
 }
@@ -84,5 +84,34 @@ at::Tensor& dil_softmax_(
   return input;
 }
 
+// softmax into a preallocated output (e.g. the result buffer of an NNC
+// external call), falls back to aten::softmax for the layouts oneDNN can not
+// handle in place of out
+at::Tensor& dil_softmax_out(
+    const at::Tensor& input,
+    const int64_t dim,
+    const at::IValue& dtype,
+    at::Tensor& out) {
+  RECORD_FUNCTION("dil_softmax_out", c10::ArrayRef<c10::IValue>({}));
+
+  auto input_ = input;
+  if (!dtype.isNone()) {
+    AT_ASSERTM(
+        input.scalar_type() != at::ScalarType::Half,
+        "softmax with half to float conversion is not supported on Mkldnn");
+    input_ = input.toType(dtype.toScalarType());
+  }
+  if (!input_.is_contiguous() || !out.is_contiguous() ||
+      out.scalar_type() != input_.scalar_type()) {
+    out.copy_(at::softmax(input_, dim));
+    return out;
+  }
+  const int64_t wrapped_dim = at::maybe_wrap_dim(dim, input_.dim());
+  ideep::tensor mkldnn_input = itensor_view_from_dense(input_);
+  ideep::tensor mkldnn_output = itensor_view_from_dense(out);
+  ideep::softmax_forward::compute(mkldnn_input, mkldnn_output, wrapped_dim);
+  return out;
+}
+
 } // namespace cpu
 } // namespace torch_ipex
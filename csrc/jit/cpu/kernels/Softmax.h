@@ -35,5 +35,11 @@ at::Tensor& dil_softmax_(
     const int64_t dim,
     const at::IValue& dtype = at::IValue());
 
+at::Tensor& dil_softmax_out(
+    const at::Tensor& input,
+    const int64_t dim,
+    const at::IValue& dtype,
+    at::Tensor& out);
+
 } // namespace cpu
 } // namespace torch_ipex
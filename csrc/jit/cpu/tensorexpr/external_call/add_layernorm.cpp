@@ -0,0 +1,104 @@
+#include "add_layernorm.h"
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/tensorexpr/fwd_decls.h>
+#include <torch/csrc/jit/tensorexpr/lowerings.h>
+#include <torch/library.h>
+
+#include "aten/AddLayerNorm.h"
+#include "csrc/jit/cpu/tensorexpr/nnc_lowering_register.h"
+#include "csrc/jit/cpu/tensorexpr/operator_schema.h"
+#include "csrc/jit/cpu/tensorexpr/utils.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace cpu {
+namespace tensorexpr {
+
+torch::jit::tensorexpr::Tensor computeAddLayerNorm(
+    const std::vector<torch::jit::tensorexpr::ArgValue>& inputs,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_shape,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_strides,
+    const c10::optional<torch::jit::tensorexpr::ScalarType>& output_type,
+    at::Device device) {
+  using PytTeBufHandle = torch::jit::tensorexpr::BufHandle;
+  using PytTeStmtPtr = torch::jit::tensorexpr::StmtPtr;
+  using PytTeExternalCall = torch::jit::tensorexpr::ExternalCall;
+  using PytTeTensor = torch::jit::tensorexpr::Tensor;
+
+  auto te_dtype = torch::jit::tensorexpr::Dtype(*output_type);
+  PytTeBufHandle result_buf(
+      "nnc_ipex_add_layernorm", output_shape, output_strides, te_dtype);
+  std::vector<PytTeBufHandle> bufs = {
+      c10::get<PytTeBufHandle>(inputs[0]), c10::get<PytTeBufHandle>(inputs[1])};
+  // weight and bias are optional, the extra args record which of them are
+  // part of bufs
+  auto weight = c10::get_if<PytTeBufHandle>(&inputs[4]);
+  auto bias = c10::get_if<PytTeBufHandle>(&inputs[5]);
+  if (weight) {
+    bufs.push_back(*weight);
+  }
+  if (bias) {
+    bufs.push_back(*bias);
+  }
+
+  // extra args: alpha, eps, has_weight, has_bias, ndims, normalized_shape...
+  const auto& normalized_shape = c10::get<pytnnc::IntList>(inputs[3]);
+  std::vector<torch::jit::tensorexpr::ExprHandle> extra_args = {
+      constant(inputs[2]),
+      doubleArg(inputs[6]),
+      pytnnc::LongImm::make(weight ? 1 : 0),
+      pytnnc::LongImm::make(bias ? 1 : 0),
+      pytnnc::LongImm::make(normalized_shape.size())};
+  for (auto dim : normalized_shape) {
+    extra_args.push_back(pytnnc::LongImm::make(dim));
+  }
+  PytTeStmtPtr s = PytTeExternalCall::make(
+      result_buf, "nnc_ipex_add_layernorm", bufs, extra_args);
+  return PytTeTensor(result_buf.node(), s);
+}
+
+void nncAddLayerNorm(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int64_t* buf_strides,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  std::vector<at::Tensor> tensors = constructTensors(
+      bufs_num, buf_data, buf_ranks, buf_dims, buf_strides, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  const at::Tensor& a = tensors[1];
+  const at::Tensor& b = tensors[2];
+  const int64_t alpha = extra_args[0];
+  const double eps = ((double*)extra_args)[1];
+  size_t buf_idx = 3;
+  c10::optional<at::Tensor> weight;
+  c10::optional<at::Tensor> bias;
+  if (extra_args[2]) {
+    weight = tensors[buf_idx++];
+  }
+  if (extra_args[3]) {
+    bias = tensors[buf_idx++];
+  }
+  at::IntArrayRef normalized_shape(extra_args + 5, extra_args[4]);
+  // the fused add+layernorm kernel allocates its own output
+  r.copy_(torch_ipex::cpu::dil_add_layernorm(
+      a, b, alpha, normalized_shape, weight, bias, eps, false));
+}
+
+} // namespace tensorexpr
+} // namespace cpu
+} // namespace jit
+} // namespace torch_ipex
+
+namespace {
+using namespace torch_ipex::jit::cpu::tensorexpr;
+static NNCOperatorRegister _nnc_ipex_add_layernorm(
+    kAddLayerNormSchema,
+    "nnc_ipex_add_layernorm",
+    computeAddLayerNorm,
+    nncAddLayerNorm);
+} // namespace
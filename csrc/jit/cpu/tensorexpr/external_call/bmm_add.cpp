@@ -0,0 +1,68 @@
+#include "bmm_add.h"
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/tensorexpr/fwd_decls.h>
+#include <torch/csrc/jit/tensorexpr/lowerings.h>
+#include <torch/library.h>
+
+#include "csrc/jit/cpu/kernels/Matmul.h"
+#include "csrc/jit/cpu/tensorexpr/nnc_lowering_register.h"
+#include "csrc/jit/cpu/tensorexpr/operator_schema.h"
+#include "csrc/jit/cpu/tensorexpr/utils.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace cpu {
+namespace tensorexpr {
+
+torch::jit::tensorexpr::Tensor computeBmmAdd(
+    const std::vector<torch::jit::tensorexpr::ArgValue>& inputs,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_shape,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_strides,
+    const c10::optional<torch::jit::tensorexpr::ScalarType>& output_type,
+    at::Device device) {
+  using PytTeBufHandle = torch::jit::tensorexpr::BufHandle;
+  using PytTeStmtPtr = torch::jit::tensorexpr::StmtPtr;
+  using PytTeExternalCall = torch::jit::tensorexpr::ExternalCall;
+  using PytTeTensor = torch::jit::tensorexpr::Tensor;
+
+  auto te_dtype = torch::jit::tensorexpr::Dtype(*output_type);
+  PytTeBufHandle result_buf(
+      "nnc_ipex_bmm_add", output_shape, output_strides, te_dtype);
+  const PytTeBufHandle& input = c10::get<PytTeBufHandle>(inputs[0]);
+  const PytTeBufHandle& batch1 = c10::get<PytTeBufHandle>(inputs[1]);
+  const PytTeBufHandle& batch2 = c10::get<PytTeBufHandle>(inputs[2]);
+  // alpha is ignored by dil_bmm_add, so it is not passed down
+  PytTeStmtPtr s = PytTeExternalCall::make(
+      result_buf, "nnc_ipex_bmm_add", {input, batch1, batch2}, {});
+  return PytTeTensor(result_buf.node(), s);
+}
+
+void nncBmmAdd(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int64_t* buf_strides,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  std::vector<at::Tensor> tensors = constructTensors(
+      bufs_num, buf_data, buf_ranks, buf_dims, buf_strides, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  const at::Tensor& input = tensors[1];
+  const at::Tensor& batch1 = tensors[2];
+  const at::Tensor& batch2 = tensors[3];
+  torch_ipex::cpu::dil_bmm_add(input, batch1, batch2, r, 1.0);
+}
+
+} // namespace tensorexpr
+} // namespace cpu
+} // namespace jit
+} // namespace torch_ipex
+
+namespace {
+using namespace torch_ipex::jit::cpu::tensorexpr;
+static NNCOperatorRegister _nnc_ipex_bmm_add(
+    kBmmAddSchema, "nnc_ipex_bmm_add", computeBmmAdd, nncBmmAdd);
+} // namespace
@@ -0,0 +1,86 @@
+#include "mha_scores_calc.h"
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/tensorexpr/fwd_decls.h>
+#include <torch/csrc/jit/tensorexpr/lowerings.h>
+#include <torch/library.h>
+
+#include "csrc/jit/cpu/kernels/Mha.h"
+#include "csrc/jit/cpu/tensorexpr/nnc_lowering_register.h"
+#include "csrc/jit/cpu/tensorexpr/operator_schema.h"
+#include "csrc/jit/cpu/tensorexpr/utils.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace cpu {
+namespace tensorexpr {
+
+torch::jit::tensorexpr::Tensor computeMhaScoresCalc(
+    const std::vector<torch::jit::tensorexpr::ArgValue>& inputs,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_shape,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_strides,
+    const c10::optional<torch::jit::tensorexpr::ScalarType>& output_type,
+    at::Device device) {
+  using PytTeBufHandle = torch::jit::tensorexpr::BufHandle;
+  using PytTeStmtPtr = torch::jit::tensorexpr::StmtPtr;
+  using PytTeExternalCall = torch::jit::tensorexpr::ExternalCall;
+  using PytTeTensor = torch::jit::tensorexpr::Tensor;
+
+  auto te_dtype = torch::jit::tensorexpr::Dtype(*output_type);
+  PytTeBufHandle result_buf(
+      "nnc_ipex_mha_scores_calc", output_shape, output_strides, te_dtype);
+  const PytTeBufHandle& q = c10::get<PytTeBufHandle>(inputs[0]);
+  const PytTeBufHandle& k = c10::get<PytTeBufHandle>(inputs[1]);
+  const PytTeBufHandle& rel_qk = c10::get<PytTeBufHandle>(inputs[2]);
+  // extra args: alpha, dim_per_head, softmax_dim, dtype (-1 for None)
+  std::vector<torch::jit::tensorexpr::ExprHandle> extra_args = {
+      doubleArg(inputs[3]),
+      doubleArg(inputs[4]),
+      constant(inputs[5]),
+      scalarTypeArg(inputs[6])};
+  PytTeStmtPtr s = PytTeExternalCall::make(
+      result_buf, "nnc_ipex_mha_scores_calc", {q, k, rel_qk}, extra_args);
+  return PytTeTensor(result_buf.node(), s);
+}
+
+void nncMhaScoresCalc(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int64_t* buf_strides,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  std::vector<at::Tensor> tensors = constructTensors(
+      bufs_num, buf_data, buf_ranks, buf_dims, buf_strides, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  const at::Tensor& q = tensors[1];
+  const at::Tensor& k = tensors[2];
+  const at::Tensor& rel_qk = tensors[3];
+  const double alpha = ((double*)extra_args)[0];
+  const double dim_per_head = ((double*)extra_args)[1];
+  // the fused div+add+softmax kernel allocates its own output
+  r.copy_(torch_ipex::cpu::dil_mha_scores_calc(
+      q,
+      k,
+      rel_qk,
+      alpha,
+      dim_per_head,
+      extra_args[2],
+      scalarTypeFromArg(extra_args[3])));
+}
+
+} // namespace tensorexpr
+} // namespace cpu
+} // namespace jit
+} // namespace torch_ipex
+
+namespace {
+using namespace torch_ipex::jit::cpu::tensorexpr;
+static NNCOperatorRegister _nnc_ipex_mha_scores_calc(
+    kMhaScoresCalcSchema,
+    "nnc_ipex_mha_scores_calc",
+    computeMhaScoresCalc,
+    nncMhaScoresCalc);
+} // namespace
@@ -0,0 +1,67 @@
+#include "softmax.h"
+
+#include <ATen/ATen.h>
+#include <torch/csrc/jit/tensorexpr/fwd_decls.h>
+#include <torch/csrc/jit/tensorexpr/lowerings.h>
+#include <torch/library.h>
+
+#include "csrc/jit/cpu/kernels/Softmax.h"
+#include "csrc/jit/cpu/tensorexpr/nnc_lowering_register.h"
+#include "csrc/jit/cpu/tensorexpr/operator_schema.h"
+#include "csrc/jit/cpu/tensorexpr/utils.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace cpu {
+namespace tensorexpr {
+
+torch::jit::tensorexpr::Tensor computeSoftmax(
+    const std::vector<torch::jit::tensorexpr::ArgValue>& inputs,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_shape,
+    const std::vector<torch::jit::tensorexpr::ExprHandle>& output_strides,
+    const c10::optional<torch::jit::tensorexpr::ScalarType>& output_type,
+    at::Device device) {
+  using PytTeBufHandle = torch::jit::tensorexpr::BufHandle;
+  using PytTeStmtPtr = torch::jit::tensorexpr::StmtPtr;
+  using PytTeExternalCall = torch::jit::tensorexpr::ExternalCall;
+  using PytTeTensor = torch::jit::tensorexpr::Tensor;
+
+  auto te_dtype = torch::jit::tensorexpr::Dtype(*output_type);
+  PytTeBufHandle result_buf(
+      "nnc_ipex_softmax", output_shape, output_strides, te_dtype);
+  const PytTeBufHandle& input = c10::get<PytTeBufHandle>(inputs[0]);
+  // extra args: dim, dtype (-1 for None)
+  std::vector<torch::jit::tensorexpr::ExprHandle> extra_args = {
+      constant(inputs[1]), scalarTypeArg(inputs[2])};
+  PytTeStmtPtr s = PytTeExternalCall::make(
+      result_buf, "nnc_ipex_softmax", {input}, extra_args);
+  return PytTeTensor(result_buf.node(), s);
+}
+
+void nncSoftmax(
+    int64_t bufs_num,
+    void** buf_data,
+    int64_t* buf_ranks,
+    int64_t* buf_dims,
+    int64_t* buf_strides,
+    int8_t* buf_dtypes,
+    int64_t args_num,
+    int64_t* extra_args) {
+  std::vector<at::Tensor> tensors = constructTensors(
+      bufs_num, buf_data, buf_ranks, buf_dims, buf_strides, buf_dtypes);
+  at::Tensor& r = tensors[0];
+  const at::Tensor& input = tensors[1];
+  torch_ipex::cpu::dil_softmax_out(
+      input, extra_args[0], scalarTypeFromArg(extra_args[1]), r);
+}
+
+} // namespace tensorexpr
+} // namespace cpu
+} // namespace jit
+} // namespace torch_ipex
+
+namespace {
+using namespace torch_ipex::jit::cpu::tensorexpr;
+static NNCOperatorRegister _nnc_ipex_softmax(
+    kSoftmaxSchema, "nnc_ipex_softmax", computeSoftmax, nncSoftmax);
+} // namespace
@@ -21,19 +21,21 @@ void clearCustomOp2NncFuser() {
 void registerCustomOp2NncFuser() {
   auto& _g_custom_operator_set = torch::jit::tensorexpr::getCustomOperatorSet();
   _g_custom_operator_set.insert(
-      {kMmDivSchema,       kConvNoneSchema,        kConvReluSchema,
-       kConvAbsSchema,     kConvClampSchema,       kConvEluSchema,
-       kConvExpSchema,     kConvGeluSchema,        kConvHardswishSchema,
-       kConvLogSchema,     kConvMishSchema,        kConvSigmoidSchema,
-       kConvPowSchema,     kConvRoundSchema,       kConvSqrtSchema,
-       kConvSquareSchema,  kConvTanhSchema,        kConvLeakyReluSchema,
-       kConvSiluSchema,    kConvHardsigmoidSchema, kLinearNoneSchema,
-       kLinearAbsSchema,   kLinearExpSchema,       kLinearHardswishSchema,
-       kLinearMishSchema,  kLinearSigmoidSchema,   kLinearReluSchema,
-       kLinearSqrtSchema,  kLinearSquareSchema,    kLinearTanhSchema,
-       kLinearSiluSchema,  kLinearLogSchema,       kLinearRoundSchema,
-       kLinearClampSchema, kLinearEluSchema,       kLinearGeluSchema,
-       kLinearPowSchema,   kLinearLeakyReluSchema, kLinearHardsigmoidSchema});
+      {kMmDivSchema,             kBmmAddSchema,       kMhaScoresCalcSchema,
+       kSoftmaxSchema,           kAddLayerNormSchema, kConvNoneSchema,
+       kConvReluSchema,          kConvAbsSchema,      kConvClampSchema,
+       kConvEluSchema,           kConvExpSchema,      kConvGeluSchema,
+       kConvHardswishSchema,     kConvLogSchema,      kConvMishSchema,
+       kConvSigmoidSchema,       kConvPowSchema,      kConvRoundSchema,
+       kConvSqrtSchema,          kConvSquareSchema,   kConvTanhSchema,
+       kConvLeakyReluSchema,     kConvSiluSchema,     kConvHardsigmoidSchema,
+       kLinearNoneSchema,        kLinearAbsSchema,    kLinearExpSchema,
+       kLinearHardswishSchema,   kLinearMishSchema,   kLinearSigmoidSchema,
+       kLinearReluSchema,        kLinearSqrtSchema,   kLinearSquareSchema,
+       kLinearTanhSchema,        kLinearSiluSchema,   kLinearLogSchema,
+       kLinearRoundSchema,       kLinearClampSchema,  kLinearEluSchema,
+       kLinearGeluSchema,        kLinearPowSchema,    kLinearLeakyReluSchema,
+       kLinearHardsigmoidSchema});
 }
 
 } // namespace tensorexpr
@@ -7,6 +7,14 @@ namespace tensorexpr {
 
 const char kMmDivSchema[] =
     "ipex::matmul_div(Tensor left, Tensor right,  Tensor div_input) -> Tensor";
+const char kBmmAddSchema[] =
+    "ipex::bmm_add(Tensor input, Tensor batch1, Tensor batch2, Scalar alpha) -> Tensor";
+const char kMhaScoresCalcSchema[] =
+    "ipex::mha_scores_calc(Tensor q, Tensor k, Tensor rel_qk, Scalar alpha, Scalar dim_per_head, int softmax_dim, ScalarType ? dtype) -> Tensor";
+const char kSoftmaxSchema[] =
+    "ipex::softmax(Tensor self, int dim, ScalarType ? dtype) -> Tensor";
+const char kAddLayerNormSchema[] =
+    "ipex::add_layernorm(Tensor a, Tensor b, int alpha, int[] normalized_shape, Tensor ? weight_opt, Tensor ? bias_opt, float eps, bool cuda_enable) -> Tensor";
 const char kConvNoneSchema[] =
     "ipex_prepack::convolution_run(Tensor input, __torch__.torch.classes.ipex_prepack.ConvolutionOpContext W_prepack) -> Tensor";
 const char kConvReluSchema[] =
@@ -6,6 +6,10 @@ namespace cpu {
 namespace tensorexpr {
 
 extern const char kMmDivSchema[];
+extern const char kBmmAddSchema[];
+extern const char kMhaScoresCalcSchema[];
+extern const char kSoftmaxSchema[];
+extern const char kAddLayerNormSchema[];
 extern const char kConvNoneSchema[];
 extern const char kConvReluSchema[];
 extern const char kConvAddReluSchema[];
@@ -92,6 +92,35 @@ pytnnc::ExprHandle constant(const pytnnc::ArgValue& v) {
   }
 }
 
+pytnnc::ExprHandle doubleArg(const pytnnc::ArgValue& v) {
+  if (auto d = c10::get_if<double>(&v)) {
+    return pytnnc::DoubleImm::make(*d);
+  } else if (auto i = c10::get_if<int64_t>(&v)) {
+    return pytnnc::DoubleImm::make(static_cast<double>(*i));
+  } else {
+    throw pytnnc::unsupported_dtype(
+        "Trying to convert unsupported dtype to double constant");
+  }
+}
+
+pytnnc::ExprHandle scalarTypeArg(const pytnnc::ArgValue& v) {
+  if (auto i = c10::get_if<int64_t>(&v)) {
+    return pytnnc::LongImm::make(*i);
+  } else if (c10::get_if<pytnnc::ArgNone>(&v)) {
+    return pytnnc::LongImm::make(-1);
+  } else {
+    throw pytnnc::unsupported_dtype(
+        "Trying to convert unsupported dtype to ScalarType constant");
+  }
+}
+
+at::IValue scalarTypeFromArg(int64_t arg) {
+  if (arg < 0) {
+    return at::IValue();
+  }
+  return at::IValue(static_cast<c10::ScalarType>(arg));
+}
+
 } // namespace tensorexpr
 } // namespace cpu
 } // namespace jit
@@ -31,6 +31,16 @@ std::vector<at::Tensor> constructTensors(
 
 pytnnc::ExprHandle constant(const pytnnc::ArgValue& v);
 
+// Extra args of an external call are stored as int64_t, except for floating
+// point ones which are stored as double and read back through
+// ((double*)extra_args)[i].
+pytnnc::ExprHandle doubleArg(const pytnnc::ArgValue& v);
+
+// ScalarType? is passed as its integer value and -1 stands for None.
+pytnnc::ExprHandle scalarTypeArg(const pytnnc::ArgValue& v);
+
+at::IValue scalarTypeFromArg(int64_t arg);
+
 } // namespace tensorexpr
 } // namespace cpu
 } // namespace jit
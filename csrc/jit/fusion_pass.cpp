@@ -1,5 +1,6 @@
 #include "fusion_pass.h"
 #include <string>
+#include "auto_opt_config.h"
 #include "codegen/onednn/interface.h"
 #include "cpu/kernels/Matmul.h"
 #include "passes/concat_linear.h"
@@ -7,6 +8,8 @@
 #include "passes/frozen_linear_folding.h"
 #include "passes/graph_rewrite.h"
 #include "passes/graph_rewrite_helper.h"
+#include "passes/grouped_linear.h"
+#include "passes/memory_planning.h"
 #include "passes/prepack_folding.h"
 #include "passes/remove_redundant_aliases.h"
 
@@ -128,13 +131,21 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
   torch_ipex::jit::FrozenConcatLinear(
       graph, aten_linear_recorder.get_records());
   graph_rewrite::FrozenLinearFolding(graph);
+  // group independent linears with different inputs of the same sizes into a
+  // single batched GEMM
+  if (AutoOptConfig::singleton().get_grouped_linear()) {
+    torch_ipex::jit::FrozenGroupedLinear(
+        graph, aten_linear_recorder.get_records());
+  }
 
   // linear fusion
   GRAPH_DUMP("After FrozenLinearFolding.Before insertPrePackedLinearOp", graph);
   graph_rewrite::insertPrePackedLinearOp(
       graph,
       aten_linear_recorder.get_records(),
-      aten_linear_recorder.use_mkl());
+      aten_linear_recorder.use_mkl(),
+      AutoOptConfig::singleton().get_woq_bits(),
+      AutoOptConfig::singleton().get_woq_group_size());
   GRAPH_DUMP(
       "After insertPrePackedLinearOp.Before fuseLinearWithEltwise", graph);
   graph_rewrite::fuseLinearWithEltwise(graph);
@@ -145,6 +156,8 @@ void IPEXFusionPass(std::shared_ptr<Graph>& graph) {
 
   // fuse rmsnorm
   graph_rewrite::FuseRMSNorm(graph);
+  // fuse add+rmsnorm
+  graph_rewrite::FuseAddRMSNorm(graph);
   // fuse add+layernorm
   graph_rewrite::FuseAddLayerNorm(graph);
 
@@ -292,6 +305,12 @@ void FusionPass(std::shared_ptr<Graph>& graph) {
   // Note: Since TE is with priority and it has not supported inplace op yet,
   //       we make inplace optimization after TE.
   ApplyInplaceOptimization(graph);
+  // Plan the outputs of the prepacked ops into one arena. It goes last since
+  // no later pass may change the live ranges, and before
+  // RemoveTensorTypeSpecializations since it needs the complete tensor types.
+  if (AutoOptConfig::singleton().get_memory_planning()) {
+    FrozenMemoryPlanning(graph);
+  }
   RemoveTensorTypeSpecializations(graph);
   GRAPH_DUMP(
       "After RemoveTensorTypeSpecializations. End of optimization pass", graph);
@@ -213,6 +213,35 @@ void FuseRMSNorm(std::shared_ptr<Graph>& graph) {
   rewriter_aten.runOnGraph(graph);
 }
 
+// Absorb the residual add in front of RMSNorm (LLaMA-style blocks). The sum
+// is also an output of the fused op since it is the next block's residual.
+void FuseAddRMSNorm(std::shared_ptr<Graph>& graph) {
+  std::string add_RMSNorm = R"(
+      graph(%add_a, %add_b, %alpha, %weight, %eps:float):
+        %s = aten::add(%add_a, %add_b, %alpha)
+        %r = ipex::RMSNorm(%s, %weight, %eps)
+        return (%r, %s) )";
+  std::string fused_add_RMSNorm = R"(
+      graph(%add_a, %add_b, %alpha, %weight, %eps:float):
+        %r : Tensor, %s : Tensor = ipex::add_RMSNorm(%add_a, %add_b, %alpha, %weight, %eps)
+        return (%r, %s) )";
+  // aten::add.Scalar shares the node kind, only fuse the Tensor overload
+  auto filter_tensor_add =
+      [](const Match& match,
+         const std::unordered_map<std::string, Value*>& vmap) {
+        const auto& match_vmap = match.values_map;
+        auto add_a = match_vmap.at(vmap.at("add_a"));
+        auto add_b = match_vmap.at(vmap.at("add_b"));
+        auto alpha = match_vmap.at(vmap.at("alpha"));
+        return add_a->type()->cast<TensorType>() &&
+            add_b->type()->cast<TensorType>() &&
+            alpha->type()->cast<IntType>();
+      };
+  SubgraphRewriter rewriter_add_RMSNorm;
+  rewriter_add_RMSNorm.RegisterRewritePattern(add_RMSNorm, fused_add_RMSNorm);
+  rewriter_add_RMSNorm.runOnGraph(graph, filter_tensor_add);
+}
+
 void FuseAddLayerNorm(std::shared_ptr<Graph>& graph) {
   std::string aten_add_layernorm = R"(
       graph(%add_a, %add_b, %alpha, %shape:int[], %w, %b, %eps:float, %cudnn_enable:bool):
@@ -678,6 +707,31 @@ void replaceEmbeddingBagWithQEmbeddingBag(std::shared_ptr<Graph>& graph) {
   rewriter_qembeddingbag.runOnGraph(graph);
 }
 
+void replaceROIAlignWithQROIAlign(std::shared_ptr<Graph>& graph) {
+  std::string qroi_align = R"(
+     graph(%a_quant, %rois, %spatial_scale, %pooled_height, %pooled_width, %sampling_ratio, %aligned, %o_scale, %o_zp, %o_dtype):
+        %r = ipex::qroi_align(%a_quant, %rois, %spatial_scale, %pooled_height, %pooled_width, %sampling_ratio, %aligned, %o_scale, %o_zp, %o_dtype)
+        return (%r) )";
+
+  // torchvision::roi_align is overridden by the IPEX kernel, so both ops
+  // share the INT8 kernel.
+  for (auto roi_align_op :
+       {"torch_ipex::ROIAlign_forward", "torchvision::roi_align"}) {
+    std::string roi_align_with_quant_dequant = std::string(R"(
+      graph(%a_quant, %rois, %spatial_scale, %pooled_height, %pooled_width, %sampling_ratio, %aligned, %o_scale, %o_zp, %o_dtype):
+        %a = aten::dequantize(%a_quant)
+        %r = )") + roi_align_op +
+        R"((%a, %rois, %spatial_scale, %pooled_height, %pooled_width, %sampling_ratio, %aligned)
+        %qout = aten::quantize_per_tensor(%r, %o_scale, %o_zp, %o_dtype)
+        return (%qout) )";
+
+    SubgraphRewriter rewriter_qroi_align;
+    rewriter_qroi_align.RegisterRewritePattern(
+        roi_align_with_quant_dequant, qroi_align);
+    rewriter_qroi_align.runOnGraph(graph);
+  }
+}
+
 void replaceInteractionWithQInteraction(std::shared_ptr<Graph>& graph) {
   std::vector<std::string> patterns;
   std::vector<std::string> replacements;
@@ -96,10 +96,13 @@ void replaceFrozenIPEXLinearWithAtenLinear(
 void insertPrePackedLinearOp(
     Block* b,
     std::unordered_set<Node*>& aten_linear,
-    const bool& use_mkl_sgemm) {
+    const bool& use_mkl_sgemm,
+    const int64_t& woq_bits,
+    const int64_t& woq_group_size) {
   for (Node* n : b->nodes()) {
     for (Block* block : n->blocks()) {
-      insertPrePackedLinearOp(block, aten_linear, use_mkl_sgemm);
+      insertPrePackedLinearOp(
+          block, aten_linear, use_mkl_sgemm, woq_bits, woq_group_size);
     }
     if (n->kind() != aten::linear)
       continue;
@@ -127,7 +130,14 @@ void insertPrePackedLinearOp(
       continue;
     }
     auto weight_dtype_option = tt->scalarType();
-    if (!(weight_dtype_option.has_value() &&
+    // weight-only quantization replaces every fp32/bf16 linear with a frozen
+    // weight, including the ones which would be kept as aten::linear
+    auto use_woq = woq_bits != 0 && weight_dtype_option.has_value() &&
+        (weight_dtype_option.value() == at::ScalarType::Float ||
+         weight_dtype_option.value() == at::ScalarType::BFloat16) &&
+        toIValue(n->inputs().at(1)).has_value();
+    if (!(use_woq ||
+          weight_dtype_option.has_value() &&
               (weight_dtype_option.value() == at::ScalarType::BFloat16) &&
               ideep::has_bf16_type_support() ||
           aten_linear.find(n) == aten_linear.end())) {
@@ -142,29 +152,36 @@ void insertPrePackedLinearOp(
     // the check since its graph element is not initialized. Details please
     // refer to
     // https://github.com/pytorch/pytorch/blob/master/torch/csrc/jit/ir/alias_analysis.cpp#L1956
-    auto use_mkl_sgemm_ = use_mkl_sgemm &&
+    auto use_mkl_sgemm_ = !use_woq && use_mkl_sgemm &&
         weight_dtype_option.value() != at::ScalarType::BFloat16;
-    auto prepack_node = graph->create(
-        use_mkl_sgemm_
-            ? Symbol::fromQualString("ipex_prepack::mkl_sgemm_prepack")
-            : Symbol::fromQualString("ipex_prepack::linear_prepack"),
-        1);
+    std::string prepack_op = "ipex_prepack::linear_prepack";
+    std::string run_op = "ipex_prepack::linear_run";
+    std::string op_context =
+        "__torch__.torch.classes.ipex_prepack.LinearOpContext";
+    if (use_woq) {
+      prepack_op = "ipex_prepack::woq_linear_prepack";
+      run_op = "ipex_prepack::woq_linear_run";
+      op_context = "__torch__.torch.classes.ipex_prepack.WoqLinearOpContext";
+    } else if (use_mkl_sgemm_) {
+      prepack_op = "ipex_prepack::mkl_sgemm_prepack";
+      run_op = "ipex_prepack::mkl_sgemm_run";
+      op_context = "__torch__.torch.classes.ipex_prepack.MKLOpContext";
+    }
+    auto prepack_node = graph->create(Symbol::fromQualString(prepack_op), 1);
     for (auto i = 1; i < n->inputs().size(); ++i) {
       Value* v = n->inputs().at(i);
       prepack_node->addInput(v);
     }
-    prepack_node->addInput(batch_size);
-    prepack_node->output()->setType(
-        use_mkl_sgemm_
-            ? getCustomClass(
-                  "__torch__.torch.classes.ipex_prepack.MKLOpContext")
-            : getCustomClass(
-                  "__torch__.torch.classes.ipex_prepack.LinearOpContext"));
+    if (use_woq) {
+      prepack_node->addInput(graph->insertConstant(woq_bits));
+      prepack_node->addInput(graph->insertConstant(woq_group_size));
+    } else {
+      prepack_node->addInput(batch_size);
+    }
+    prepack_node->output()->setType(getCustomClass(op_context));
     graph->insertNode(prepack_node);
-    auto prepack_linear = graph->insertNode(graph->create(
-        use_mkl_sgemm_ ? Symbol::fromQualString("ipex_prepack::mkl_sgemm_run")
-                       : Symbol::fromQualString("ipex_prepack::linear_run"),
-        1));
+    auto prepack_linear =
+        graph->insertNode(graph->create(Symbol::fromQualString(run_op), 1));
     prepack_linear->addInput(n->inputs().at(0));
     prepack_linear->addInput(prepack_node->output());
     prepack_linear->output()->setType(n->output()->type()->cast<TensorType>());
@@ -177,8 +194,11 @@ void insertPrePackedLinearOp(
 void insertPrePackedLinearOp(
     std::shared_ptr<Graph>& graph,
     std::unordered_set<Node*>& aten_linear,
-    const bool& use_mkl_sgemm) {
-  insertPrePackedLinearOp(graph->block(), aten_linear, use_mkl_sgemm);
+    const bool& use_mkl_sgemm,
+    const int64_t& woq_bits,
+    const int64_t& woq_group_size) {
+  insertPrePackedLinearOp(
+      graph->block(), aten_linear, use_mkl_sgemm, woq_bits, woq_group_size);
 }
 
 void RecordAtenLinearNodes(
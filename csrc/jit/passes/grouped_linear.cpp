@@ -0,0 +1,250 @@
+#include "grouped_linear.h"
+#include <ATen/Functions.h>
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <unordered_set>
+#include <vector>
+
+#include "folding_common_utils.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace {
+
+using Tensor = at::Tensor;
+using namespace torch::jit;
+
+class GroupLinearLayers {
+ public:
+  explicit GroupLinearLayers(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)) {}
+
+  bool run(std::unordered_set<Node*>& aten_linear) {
+    handleBlockAndSubblocks(graph_->block(), aten_linear);
+    return graph_modified;
+  }
+
+  AliasDb* getAliasDb() {
+    if (!aliasDb_) {
+      aliasDb_ = std::make_unique<AliasDb>(graph_);
+    }
+    return aliasDb_.get();
+  }
+
+  // Linear layers recorded in aten_linear are kept as aten::linear by the
+  // later passes, so only the ones going to the ipex linear are grouped.
+  // The input sizes need to be known to group linears of the same size.
+  bool isGroupCandidate(Node* n, std::unordered_set<Node*>& aten_linear) {
+    if (n->kind() != aten::linear || aten_linear.count(n) != 0) {
+      return false;
+    }
+    if (n->namedInput("weight")->type() == NoneType::get() ||
+        nonConstantParameters(n)) {
+      return false;
+    }
+    auto input_type = n->inputs().at(0)->type()->cast<TensorType>();
+    if (!input_type || !input_type->sizes().concrete_sizes().has_value() ||
+        !input_type->scalarType().has_value()) {
+      return false;
+    }
+    // The grouped kernel computes its epilogue in fp32, so double linears
+    // are left as they are.
+    auto weight = constant_as<Tensor>(n->namedInput("weight")).value();
+    auto dtype = weight.scalar_type();
+    return weight.dim() == 2 && input_type->scalarType().value() == dtype &&
+        (dtype == at::kFloat || dtype == at::kBFloat16 || dtype == at::kHalf);
+  }
+
+  bool isCompatible(Node* base_node, Node* node) {
+    auto base_weight =
+        constant_as<Tensor>(base_node->namedInput("weight")).value();
+    auto weight = constant_as<Tensor>(node->namedInput("weight")).value();
+    if (base_weight.sizes() != weight.sizes() ||
+        base_weight.dtype() != weight.dtype() ||
+        base_weight.device() != weight.device()) {
+      return false;
+    }
+    auto base_has_bias =
+        base_node->namedInput("bias")->type() != NoneType::get();
+    auto has_bias = node->namedInput("bias")->type() != NoneType::get();
+    if (base_has_bias != has_bias) {
+      return false;
+    }
+    // Only balances the groups: the sizes are not guarded, and
+    // grouped_linear also runs inputs of different leading sizes.
+    auto base_type = base_node->inputs().at(0)->type()->cast<TensorType>();
+    auto type = node->inputs().at(0)->type()->cast<TensorType>();
+    return base_type->sizes().concrete_sizes().value() ==
+        type->sizes().concrete_sizes().value();
+  }
+
+  // Returns the eltwise name if every linear of the group is only used by
+  // the same supported eltwise, "none" otherwise.
+  std::string collectPostOp(std::vector<Node*>& layers) {
+    static const std::unordered_map<Symbol, std::string> supported = {
+        {aten::relu, "relu"},
+        {aten::gelu, "gelu"},
+        {aten::silu, "silu"},
+        {aten::sigmoid, "sigmoid"}};
+    c10::optional<Symbol> kind;
+    for (Node* n : layers) {
+      auto uses = n->output(0)->uses();
+      if (uses.size() != 1 || supported.count(uses[0].user->kind()) == 0) {
+        return "none";
+      }
+      Node* user = uses[0].user;
+      if (!kind.has_value()) {
+        kind = user->kind();
+      } else if (kind.value() != user->kind()) {
+        return "none";
+      }
+      if (user->kind() == aten::gelu && user->inputs().size() > 1) {
+        auto approximate = toIValue(user->inputs().at(1));
+        if (!approximate.has_value() ||
+            approximate.value().toStringRef() != "none") {
+          return "none";
+        }
+      }
+    }
+    return supported.at(kind.value());
+  }
+
+  void mergeLinearLayers(std::vector<Node*>& compatible_layers) {
+    graph_modified = true;
+    TORCH_INTERNAL_ASSERT(compatible_layers.size() > 1);
+    // Layers were moved in front of each other, so the earliest one is the
+    // insert point where all the inputs are available.
+    Node* first_node = compatible_layers[0];
+    for (Node* n : compatible_layers) {
+      if (n->isBefore(first_node)) {
+        first_node = n;
+      }
+    }
+
+    std::string post_op = collectPostOp(compatible_layers);
+    const size_t groups = compatible_layers.size();
+    Node* grouped_node = nullptr;
+    {
+      WithInsertPoint guard(first_node);
+      // weights are stored as [G, K, N] so that the batched GEMM reads them
+      // without a transpose
+      auto weight_list = c10::fmap(compatible_layers, [](Node* n) {
+        return constant_as<Tensor>(n->namedInput("weight")).value().t();
+      });
+      Value* weight_value =
+          graph_->insertConstant(at::stack(weight_list).contiguous());
+
+      Value* bias_value = first_node->namedInput("bias");
+      if (bias_value->type() != NoneType::get()) {
+        auto bias_list = c10::fmap(compatible_layers, [](Node* n) {
+          return constant_as<Tensor>(n->namedInput("bias")).value();
+        });
+        bias_value = graph_->insertConstant(at::stack(bias_list));
+      }
+
+      auto input_list = c10::fmap(
+          compatible_layers, [](Node* n) { return n->inputs().at(0); });
+      Value* inputs_value =
+          graph_->insertNode(graph_->createList(TensorType::get(), input_list))
+              ->output();
+      Value* post_op_value = graph_->insertConstant(post_op);
+
+      grouped_node = graph_->create(
+          Symbol::fromQualString("torch_ipex::grouped_linear"),
+          {inputs_value, weight_value, bias_value, post_op_value});
+      grouped_node->output(0)->setType(ListType::ofTensors());
+      grouped_node->insertBefore(first_node);
+    }
+
+    auto unpack = graph_->create(
+        prim::ListUnpack, {grouped_node->output(0)}, groups);
+    unpack->insertAfter(grouped_node);
+    for (size_t i = 0; i < groups; i++) {
+      Node* layer = compatible_layers[i];
+      Value* orig_output = layer->output(0);
+      if (post_op != "none") {
+        Node* eltwise = orig_output->uses()[0].user;
+        unpack->output(i)->setType(eltwise->output(0)->type());
+        eltwise->output(0)->replaceAllUsesWith(unpack->output(i));
+        eltwise->destroy();
+      } else {
+        unpack->output(i)->setType(orig_output->type());
+        orig_output->replaceAllUsesWith(unpack->output(i));
+      }
+      layer->destroy();
+    }
+    // the graph has changed, alias info is rebuilt for the next group
+    aliasDb_ = nullptr;
+  }
+
+  void collectAndMergeLinearLayers(std::vector<Node*>& candidates) {
+    std::unordered_set<Node*> checked_nodes;
+    for (size_t i = 0; i < candidates.size(); i++) {
+      Node* base_node = candidates[i];
+      if (checked_nodes.count(base_node) != 0) {
+        continue;
+      }
+      std::vector<Node*> compatible_layers = {base_node};
+      for (size_t j = i + 1; j < candidates.size(); j++) {
+        Node* node = candidates[j];
+        if (checked_nodes.count(node) != 0 || !isCompatible(base_node, node)) {
+          continue;
+        }
+        bool can_move_before_all = true;
+        for (auto n : compatible_layers) {
+          can_move_before_all &=
+              getAliasDb()->moveBeforeTopologicallyValid(node, n);
+        }
+        if (!can_move_before_all) {
+          continue;
+        }
+        compatible_layers.push_back(node);
+        checked_nodes.insert(node);
+      }
+      if (compatible_layers.size() == 1) {
+        continue;
+      }
+      mergeLinearLayers(compatible_layers);
+    }
+  }
+
+  void handleBlockAndSubblocks(
+      Block* block,
+      std::unordered_set<Node*>& aten_linear) {
+    for (auto node : block->nodes()) {
+      for (Block* subblock : node->blocks()) {
+        handleBlockAndSubblocks(subblock, aten_linear);
+      }
+    }
+
+    std::vector<Node*> candidates;
+    for (Node* n : block->nodes()) {
+      if (isGroupCandidate(n, aten_linear)) {
+        candidates.push_back(n);
+      }
+    }
+    collectAndMergeLinearLayers(candidates);
+  }
+
+ private:
+  std::shared_ptr<Graph> graph_;
+  bool graph_modified = false;
+  std::unique_ptr<AliasDb> aliasDb_ = nullptr;
+};
+} // namespace
+
+TORCH_API bool FrozenGroupedLinear(
+    std::shared_ptr<Graph>& graph,
+    std::unordered_set<Node*>& aten_linear) {
+  GroupLinearLayers groupLayers(graph);
+  GRAPH_DUMP("Before FrozenGroupedLinear", graph);
+  bool changed = groupLayers.run(aten_linear);
+  if (changed) {
+    GRAPH_DUMP("After FrozenGroupedLinear", graph);
+  }
+  return changed;
+}
+
+} // namespace jit
+} // namespace torch_ipex
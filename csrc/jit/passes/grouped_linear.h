@@ -0,0 +1,17 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+// Groups independent linear ops that have different inputs of the same sizes
+// and weights of the same shape into a single torch_ipex::grouped_linear op,
+// which runs all of them with one batched GEMM. A following relu, gelu, silu
+// or sigmoid shared by every linear of a group is fused as a post op.
+TORCH_API bool FrozenGroupedLinear(
+    std::shared_ptr<torch::jit::Graph>& graph,
+    std::unordered_set<torch::jit::Node*>& aten_linear);
+
+} // namespace jit
+} // namespace torch_ipex
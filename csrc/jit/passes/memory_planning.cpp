@@ -0,0 +1,339 @@
+#include "memory_planning.h"
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/custom_class.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "cpu/kernels/MemoryPlan.h"
+
+namespace torch_ipex {
+namespace jit {
+namespace {
+
+using namespace torch::jit;
+
+// slots start on a cache line so that the oneDNN primitives see the same
+// alignment as with the default allocator
+constexpr int64_t kSlotAlignment = 64;
+
+std::mutex& memoryPlanStatsMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+std::vector<MemoryPlanStats>& memoryPlanStats() {
+  static std::vector<MemoryPlanStats> stats;
+  return stats;
+}
+
+int64_t alignSlot(int64_t nbytes) {
+  return (nbytes + kSlotAlignment - 1) / kSlotAlignment * kSlotAlignment;
+}
+
+const std::unordered_map<Symbol, Symbol>& outVariants() {
+  static const std::unordered_map<Symbol, Symbol> out_variants = [] {
+    const std::vector<std::string> prefixes = {
+        "ipex_prepack::convolution_", "ipex_prepack::linear_"};
+    const std::vector<std::string> post_ops = {
+        "",
+        "relu_",
+        "sigmoid_",
+        "swish_",
+        "tanh_",
+        "mish_",
+        "abs_",
+        "exp_",
+        "hardswish_",
+        "square_",
+        "log_",
+        "round_",
+        "sqrt_",
+        "hardsigmoid_"};
+    std::unordered_map<Symbol, Symbol> variants;
+    for (const auto& prefix : prefixes) {
+      for (const auto& post_op : post_ops) {
+        auto name = prefix + post_op + "run";
+        variants.emplace(
+            Symbol::fromQualString(name),
+            Symbol::fromQualString(name + "_out"));
+      }
+    }
+    return variants;
+  }();
+  return out_variants;
+}
+
+struct PlannedValue {
+  Value* value;
+  int64_t nbytes;
+  // index of the top level nodes defining the value and last using it or
+  // any of its aliases
+  size_t begin;
+  size_t end;
+  int64_t offset;
+};
+
+class MemoryPlanner {
+ public:
+  explicit MemoryPlanner(std::shared_ptr<Graph> graph)
+      : graph_(std::move(graph)), aliasDb_(graph_) {}
+
+  bool run() {
+    size_t index = 0;
+    for (Node* n : graph_->block()->nodes()) {
+      node_index_[n] = index++;
+    }
+    node_index_[graph_->return_node()] = index;
+
+    for (Node* n : graph_->block()->nodes()) {
+      if (outVariants().count(n->kind()) == 0) {
+        continue;
+      }
+      // the slot is only used for the profiled input, see memory_plan_slot
+      auto nbytes = storageBytes(n->output(0));
+      if (!nbytes.has_value() || !storageBytes(n->input(0)).has_value()) {
+        continue;
+      }
+      auto end = liveEnd(n->output(0));
+      if (!end.has_value()) {
+        continue;
+      }
+      planned_.push_back(
+          {n->output(0), nbytes.value(), node_index_[n], end.value(), 0});
+    }
+    if (planned_.empty()) {
+      return false;
+    }
+
+    auto arena_bytes = assignOffsets();
+    MemoryPlanStats stats = {
+        next_plan_id_++,
+        static_cast<int64_t>(planned_.size()),
+        0,
+        peakBytes(),
+        arena_bytes};
+    for (const auto& planned : planned_) {
+      stats.total_bytes += planned.nbytes;
+    }
+    rewrite(stats.plan_id, arena_bytes);
+
+    GRAPH_UPDATE(
+        "Memory plan ",
+        stats.plan_id,
+        ": ",
+        stats.num_values,
+        " values, ",
+        stats.total_bytes,
+        " bytes allocated per run, peak ",
+        stats.peak_bytes,
+        " bytes before and ",
+        stats.arena_bytes,
+        " bytes after planning");
+    std::lock_guard<std::mutex> lock(memoryPlanStatsMutex());
+    memoryPlanStats().push_back(stats);
+    return true;
+  }
+
+ private:
+  // Only CPU tensors with known sizes and strides have a fixed slot.
+  c10::optional<int64_t> storageBytes(Value* v) {
+    auto type = v->type()->cast<TensorType>();
+    if (!type || !type->isComplete() || !type->device()->is_cpu() ||
+        type->requiresGrad().value_or(true)) {
+      return c10::nullopt;
+    }
+    auto sizes = type->sizes().concrete_sizes().value();
+    auto strides = type->strides().concrete_sizes().value();
+    int64_t numel = 1;
+    for (size_t i = 0; i < sizes.size(); i++) {
+      if (sizes[i] == 0) {
+        return c10::nullopt;
+      }
+      numel += (sizes[i] - 1) * strides[i];
+    }
+    return numel * c10::elementSize(type->scalarType().value());
+  }
+
+  Node* topLevelNode(Node* n) {
+    while (n->owningBlock() != graph_->block()) {
+      n = n->owningBlock()->owningNode();
+    }
+    return n;
+  }
+
+  // Returns the index of the last top level node using v or a value which
+  // may alias or contain it, or nullopt if v escapes the graph. A use inside
+  // a sub-block keeps v alive until the end of the owning top level node.
+  c10::optional<size_t> liveEnd(Value* v) {
+    if (aliasDb_.mayContainAlias(v, graph_->inputs()) ||
+        aliasDb_.mayContainAlias(v, graph_->outputs())) {
+      return c10::nullopt;
+    }
+    size_t end = node_index_[v->node()];
+    std::vector<Value*> aliases = {v};
+    std::unordered_set<Value*> visited = {v};
+    for (size_t i = 0; i < aliases.size(); i++) {
+      for (const Use& use : aliases[i]->uses()) {
+        Node* user = topLevelNode(use.user);
+        if (user == graph_->return_node()) {
+          return c10::nullopt;
+        }
+        end = std::max(end, node_index_[user]);
+        for (Value* output : user->outputs()) {
+          if (visited.count(output) == 0 &&
+              aliasDb_.mayContainAlias(v, output)) {
+            visited.insert(output);
+            aliases.push_back(output);
+          }
+        }
+      }
+    }
+    return end;
+  }
+
+  // Places the largest values first, each one in the smallest gap left by
+  // the already placed values whose live ranges overlap with it. Returns the
+  // arena size.
+  int64_t assignOffsets() {
+    std::vector<PlannedValue*> order;
+    for (auto& planned : planned_) {
+      order.push_back(&planned);
+    }
+    std::stable_sort(
+        order.begin(), order.end(), [](PlannedValue* a, PlannedValue* b) {
+          return a->nbytes > b->nbytes;
+        });
+
+    int64_t arena_bytes = 0;
+    std::vector<PlannedValue*> placed;
+    for (PlannedValue* v : order) {
+      std::vector<PlannedValue*> overlaps;
+      for (PlannedValue* p : placed) {
+        if (p->begin <= v->end && v->begin <= p->end) {
+          overlaps.push_back(p);
+        }
+      }
+      std::sort(
+          overlaps.begin(),
+          overlaps.end(),
+          [](PlannedValue* a, PlannedValue* b) {
+            return a->offset < b->offset;
+          });
+      int64_t offset = 0;
+      int64_t best_offset = -1;
+      int64_t best_gap = std::numeric_limits<int64_t>::max();
+      for (PlannedValue* p : overlaps) {
+        int64_t gap = p->offset - offset;
+        if (gap >= v->nbytes && gap < best_gap) {
+          best_offset = offset;
+          best_gap = gap;
+        }
+        offset = std::max(offset, alignSlot(p->offset + p->nbytes));
+      }
+      v->offset = best_offset >= 0 ? best_offset : offset;
+      arena_bytes = std::max(arena_bytes, alignSlot(v->offset + v->nbytes));
+      placed.push_back(v);
+    }
+    return arena_bytes;
+  }
+
+  int64_t peakBytes() {
+    int64_t peak = 0;
+    for (size_t t = 0; t < node_index_.size(); t++) {
+      int64_t live = 0;
+      for (const auto& planned : planned_) {
+        if (planned.begin <= t && t <= planned.end) {
+          live += planned.nbytes;
+        }
+      }
+      peak = std::max(peak, live);
+    }
+    return peak;
+  }
+
+  void rewrite(int64_t plan_id, int64_t arena_bytes) {
+    Value* arena = nullptr;
+    {
+      WithInsertPoint guard(graph_->block()->nodes().front());
+      // The context owns the arenas, so they are freed with the graph. As for
+      // the folded prepack contexts, the constant does not hold an owning
+      // reference to its compilation unit.
+      auto plan = c10::IValue(
+          c10::make_intrusive<cpu::MemoryPlanContext>(plan_id, arena_bytes));
+      Value* plan_value =
+          graph_->insertConstant(
+                    plan.toObject()->copy_to_weak_compilation_ref())
+              ->setType(c10::getCustomClassType<
+                        c10::intrusive_ptr<cpu::MemoryPlanContext>>());
+      Node* arena_node = graph_->create(
+          Symbol::fromQualString("ipex::memory_plan_arena"), {plan_value});
+      arena = graph_->insertNode(arena_node)->output(0);
+      arena->setType(TensorType::get());
+    }
+
+    for (const auto& planned : planned_) {
+      Node* n = planned.value->node();
+      auto type = planned.value->type()->expect<TensorType>();
+      auto input_type = n->input(0)->type()->expect<TensorType>();
+      WithInsertPoint guard(n);
+      Node* slot_node = graph_->create(
+          Symbol::fromQualString("ipex::memory_plan_slot"),
+          {arena,
+           graph_->insertConstant(planned.offset),
+           graph_->insertConstant(type->sizes().concrete_sizes().value()),
+           graph_->insertConstant(type->strides().concrete_sizes().value()),
+           graph_->insertConstant(type->scalarType().value()),
+           n->input(0),
+           graph_->insertConstant(
+               input_type->sizes().concrete_sizes().value()),
+           graph_->insertConstant(
+               input_type->strides().concrete_sizes().value()),
+           graph_->insertConstant(input_type->scalarType().value())});
+      Value* slot = graph_->insertNode(slot_node)->output(0);
+      slot->setType(type);
+
+      Node* out_node = graph_->create(
+          outVariants().at(n->kind()), {n->input(0), slot, n->input(1)});
+      out_node->output(0)->setType(type);
+      graph_->insertNode(out_node);
+      planned.value->replaceAllUsesWith(out_node->output(0));
+      n->destroy();
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  AliasDb aliasDb_;
+  std::unordered_map<Node*, size_t> node_index_;
+  std::vector<PlannedValue> planned_;
+  static std::atomic<int64_t> next_plan_id_;
+};
+
+std::atomic<int64_t> MemoryPlanner::next_plan_id_{0};
+
+} // namespace
+
+TORCH_API bool FrozenMemoryPlanning(std::shared_ptr<Graph>& graph) {
+  GRAPH_DUMP("Before FrozenMemoryPlanning", graph);
+  MemoryPlanner planner(graph);
+  bool changed = planner.run();
+  if (changed) {
+    GRAPH_DUMP("After FrozenMemoryPlanning", graph);
+  }
+  return changed;
+}
+
+std::vector<MemoryPlanStats> getMemoryPlanStats() {
+  std::lock_guard<std::mutex> lock(memoryPlanStatsMutex());
+  return memoryPlanStats();
+}
+
+} // namespace jit
+} // namespace torch_ipex
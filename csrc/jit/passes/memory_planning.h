@@ -0,0 +1,34 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch_ipex {
+namespace jit {
+
+struct MemoryPlanStats {
+  int64_t plan_id;
+  // number of intermediates placed in the arena
+  int64_t num_values;
+  // bytes allocated by the planned ops in one run without the plan
+  int64_t total_bytes;
+  // peak bytes of the planned intermediates alive at the same time, which is
+  // what the allocator holds for them without the plan
+  int64_t peak_bytes;
+  // bytes of the arena holding all of them with the plan
+  int64_t arena_bytes;
+};
+
+// Assigns the fixed-shape outputs of the prepacked convolution and linear ops
+// of a frozen graph a slot in one arena from their live ranges, and rewrites
+// the ops to their _run_out variants writing into the slots. Intermediates
+// whose live ranges do not overlap share the same bytes, and the arena is
+// reused by the later runs instead of allocating every output again. The
+// slots are planned for the profiled input sizes, an op whose input has other
+// sizes at runtime allocates its output as without the plan.
+TORCH_API bool FrozenMemoryPlanning(std::shared_ptr<torch::jit::Graph>& graph);
+
+// Returns the stats of every memory plan made by FrozenMemoryPlanning.
+TORCH_API std::vector<MemoryPlanStats> getMemoryPlanStats();
+
+} // namespace jit
+} // namespace torch_ipex
@@ -6,6 +6,7 @@
 #include "aten/AddLayerNorm.h"
 #include "aten/ConcatBnRelu.h"
 #include "aten/RMSNorm.h"
+#include "aten/ROIAlign.h"
 #include "cpu/kernels/ConvPacked.h"
 #include "cpu/kernels/ConvTransposePacked.h"
 #include "cpu/kernels/Einsum.h"
@@ -13,9 +14,11 @@
 #include "cpu/kernels/Interaction.h"
 #include "cpu/kernels/LinearMKLPacked.h"
 #include "cpu/kernels/LinearPacked.h"
+#include "cpu/kernels/LinearWoqPacked.h"
 #include "cpu/kernels/LinearSwishCustomized.h"
 #include "cpu/kernels/Matmul.h"
 #include "cpu/kernels/MaxPool2D.h"
+#include "cpu/kernels/MemoryPlan.h"
 #include "cpu/kernels/Mha.h"
 #include "cpu/kernels/OpContext.h"
 #include "cpu/kernels/RNN.h"
@@ -31,6 +34,7 @@ using namespace torch_ipex::cpu::detail::convolution;
 using namespace torch_ipex::cpu::detail::linear;
 using namespace torch_ipex::cpu::detail::conv_transpose;
 using namespace torch_ipex::cpu::detail::mkl_sgemm;
+using namespace torch_ipex::cpu::detail::woq_linear;
 
 c10::AliasAnalysisKind aliasAnalysisFromSchema() {
   return c10::AliasAnalysisKind::FROM_SCHEMA;
@@ -91,6 +95,27 @@ at::Tensor toOptionalTensor(const IValue& v) {
       },                                                           \
       aliasAnalysisFromSchema())
 
+#define CreateConvUnaryPostOpRunOut(FUSED_OP)                      \
+  Operator(                                                        \
+      "ipex_prepack::convolution_" #FUSED_OP                       \
+      "(Tensor input, Tensor(a!) output, "                         \
+      "__torch__.torch.classes.ipex_prepack.ConvolutionOpContext " \
+      "W_prepack) -> Tensor(a!)",                                  \
+      [](const Node* node) -> Operation {                          \
+        return [](Stack* stack) {                                  \
+          auto output = (std::move(peek(stack, 1, 3))).toTensor(); \
+          auto result = convolution_##FUSED_OP(                    \
+              (std::move(peek(stack, 0, 3))).toTensor(),           \
+              output,                                              \
+              (std::move(peek(stack, 2, 3)))                       \
+                  .toCustomClass<ConvolutionOpContext>());         \
+          drop(stack, 3);                                          \
+          torch::jit::pack(stack, std::move(result));              \
+          return 0;                                                \
+        };                                                         \
+      },                                                           \
+      aliasAnalysisFromSchema())
+
 #define CreateConvBinaryPostOpPrepack(FUSED_OP, ATTR)                         \
   Operator(                                                                   \
       "ipex_prepack::convolution_" #FUSED_OP "_prepack(" CONV_PREPACK_ARGS    \
@@ -162,6 +187,27 @@ at::Tensor toOptionalTensor(const IValue& v) {
       },                                                      \
       aliasAnalysisFromSchema())
 
+#define CreateLinearUnaryPostOpRunOut(FUSED_OP)                    \
+  Operator(                                                        \
+      "ipex_prepack::linear_" #FUSED_OP                            \
+      "(Tensor input, Tensor(a!) output, "                         \
+      "__torch__.torch.classes.ipex_prepack.LinearOpContext "      \
+      "W_prepack) -> Tensor(a!)",                                  \
+      [](const Node* node) -> Operation {                          \
+        return [](Stack* stack) {                                  \
+          auto output = (std::move(peek(stack, 1, 3))).toTensor(); \
+          auto result = linear_##FUSED_OP(                         \
+              (std::move(peek(stack, 0, 3))).toTensor(),           \
+              output,                                              \
+              (std::move(peek(stack, 2, 3)))                       \
+                  .toCustomClass<LinearOpContext>());              \
+          drop(stack, 3);                                          \
+          torch::jit::pack(stack, std::move(result));              \
+          return 0;                                                \
+        };                                                         \
+      },                                                           \
+      aliasAnalysisFromSchema())
+
 #define CreateConvTransposeUnaryPostOpRun(FUSED_OP)                  \
   Operator(                                                          \
       "ipex_prepack::conv_transpose_" #FUSED_OP                      \
@@ -211,6 +257,21 @@ torch::jit::RegisterOperators op({
     CreateConvUnaryPostOpRun(sqrt_run),
     CreateConvUnaryPostOpRun(hardsigmoid_run),
 
+    CreateConvUnaryPostOpRunOut(run_out),
+    CreateConvUnaryPostOpRunOut(relu_run_out),
+    CreateConvUnaryPostOpRunOut(sigmoid_run_out),
+    CreateConvUnaryPostOpRunOut(swish_run_out),
+    CreateConvUnaryPostOpRunOut(tanh_run_out),
+    CreateConvUnaryPostOpRunOut(mish_run_out),
+    CreateConvUnaryPostOpRunOut(abs_run_out),
+    CreateConvUnaryPostOpRunOut(exp_run_out),
+    CreateConvUnaryPostOpRunOut(hardswish_run_out),
+    CreateConvUnaryPostOpRunOut(square_run_out),
+    CreateConvUnaryPostOpRunOut(log_run_out),
+    CreateConvUnaryPostOpRunOut(round_run_out),
+    CreateConvUnaryPostOpRunOut(sqrt_run_out),
+    CreateConvUnaryPostOpRunOut(hardsigmoid_run_out),
+
     CreateConvBinaryPostOpPrepack(add, fuse_sum),
     CreateConvBinaryPostOpPrepack(add_relu, residual),
     CreateConvBinaryPostOpPrepack(swish_add, fuse_swish_sum),
@@ -515,6 +576,21 @@ torch::jit::RegisterOperators op({
     CreateLinearUnaryPostOpRun(sqrt_run),
     CreateLinearUnaryPostOpRun(hardsigmoid_run),
 
+    CreateLinearUnaryPostOpRunOut(run_out),
+    CreateLinearUnaryPostOpRunOut(relu_run_out),
+    CreateLinearUnaryPostOpRunOut(sigmoid_run_out),
+    CreateLinearUnaryPostOpRunOut(swish_run_out),
+    CreateLinearUnaryPostOpRunOut(tanh_run_out),
+    CreateLinearUnaryPostOpRunOut(mish_run_out),
+    CreateLinearUnaryPostOpRunOut(abs_run_out),
+    CreateLinearUnaryPostOpRunOut(exp_run_out),
+    CreateLinearUnaryPostOpRunOut(hardswish_run_out),
+    CreateLinearUnaryPostOpRunOut(square_run_out),
+    CreateLinearUnaryPostOpRunOut(log_run_out),
+    CreateLinearUnaryPostOpRunOut(round_run_out),
+    CreateLinearUnaryPostOpRunOut(sqrt_run_out),
+    CreateLinearUnaryPostOpRunOut(hardsigmoid_run_out),
+
     Operator(
         "ipex_prepack::linear_leaky_relu_run(Tensor input, Scalar alpha, "
         "__torch__.torch.classes.ipex_prepack.LinearOpContext "
@@ -660,6 +736,22 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex_prepack::woq_linear_run(Tensor input, "
+        "__torch__.torch.classes.ipex_prepack.WoqLinearOpContext "
+        "W_prepack) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = woq_linear_run(
+                (std::move(peek(stack, 0, 2))).toTensor(),
+                (std::move(peek(stack, 1, 2)))
+                    .toCustomClass<WoqLinearOpContext>());
+            drop(stack, 2);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
 
     // ConvTranspose fusion run OP
     CreateConvTransposeUnaryPostOpRun(run),
@@ -1341,6 +1433,30 @@ torch::jit::RegisterOperators op({
         },
         aliasAnalysisFromSchema()),
 
+    Operator(
+        "ipex::qroi_align(Tensor input, Tensor rois, float spatial_scale, "
+        "int pooled_height, int pooled_width, int sampling_ratio, "
+        "bool aligned, float o_scale, int o_zp, ScalarType o_dtype) -> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = qroi_align(
+                (std::move(peek(stack, 0, 10))).toTensor(),
+                (std::move(peek(stack, 1, 10))).toTensor(),
+                (std::move(peek(stack, 2, 10))).toDouble(),
+                (std::move(peek(stack, 3, 10))).toInt(),
+                (std::move(peek(stack, 4, 10))).toInt(),
+                (std::move(peek(stack, 5, 10))).toInt(),
+                (std::move(peek(stack, 6, 10))).toBool(),
+                (std::move(peek(stack, 7, 10))).toDouble(),
+                (std::move(peek(stack, 8, 10))).toInt(),
+                (std::move(peek(stack, 9, 10))).toScalarType());
+            drop(stack, 10);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+
     Operator(
         "ipex::quantized_lstm(Tensor quantized_input, Tensor[] hx, Tensor [] quantized_weights, bool has_biases, int num_layers, float dropout_p, bool train, bool bidirectional, bool batch_first, float scale, int zp, int dtype) -> (Tensor, Tensor, Tensor)",
         [](const Node* node) -> Operation {
@@ -1402,6 +1518,23 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::add_RMSNorm(Tensor a, Tensor b, int alpha, Tensor weight, "
+        "float eps) -> (Tensor, Tensor)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = dil_add_RMSNorm(
+                (std::move(peek(stack, 0, 5))).toTensor(),
+                (std::move(peek(stack, 1, 5))).toTensor(),
+                (std::move(peek(stack, 2, 5))).toInt(),
+                (std::move(peek(stack, 3, 5))).toTensor(),
+                (std::move(peek(stack, 4, 5))).toDouble());
+            drop(stack, 5);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
     Operator(
         "ipex::add_layernorm(Tensor a, Tensor b, int alpha, int[] "
         "normalized_shape, Tensor ? "
@@ -1512,6 +1645,43 @@ torch::jit::RegisterOperators op({
           };
         },
         aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::memory_plan_arena("
+        "__torch__.torch.classes.ipex_prepack.MemoryPlanContext plan) "
+        "-> Tensor",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = memory_plan_arena(
+                (std::move(peek(stack, 0, 1)))
+                    .toCustomClass<MemoryPlanContext>());
+            drop(stack, 1);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
+    Operator(
+        "ipex::memory_plan_slot(Tensor(a) arena, int offset, int[] sizes, "
+        "int[] strides, ScalarType dtype, Tensor input, int[] input_sizes, "
+        "int[] input_strides, ScalarType input_dtype) -> Tensor(a)",
+        [](const Node* node) -> Operation {
+          return [](Stack* stack) {
+            auto result = memory_plan_slot(
+                (std::move(peek(stack, 0, 9))).toTensor(),
+                (std::move(peek(stack, 1, 9))).toInt(),
+                (std::move(peek(stack, 2, 9))).toIntVector(),
+                (std::move(peek(stack, 3, 9))).toIntVector(),
+                (std::move(peek(stack, 4, 9))).toScalarType(),
+                (std::move(peek(stack, 5, 9))).toTensor(),
+                (std::move(peek(stack, 6, 9))).toIntVector(),
+                (std::move(peek(stack, 7, 9))).toIntVector(),
+                (std::move(peek(stack, 8, 9))).toScalarType());
+            drop(stack, 9);
+            torch::jit::pack(stack, std::move(result));
+            return 0;
+          };
+        },
+        aliasAnalysisFromSchema()),
 });
 
 } // namespace jit
@@ -1,2 +1,9 @@
 from . import _autocast_mode
+from ._autocast_mode import (
+    set_shared_cache_enabled,
+    is_shared_cache_enabled,
+    get_shared_cache_capacity,
+    clear_shared_cache,
+    get_shared_cache_stats,
+)
 from . import _grad_scaler
@@ -108,5 +108,41 @@ class _autocast(autocast_cpu):
         return False
 
 
+def set_shared_cache_enabled(enabled: bool, capacity: Optional[int] = None):
+    r"""
+    Share the autocast weight casts across all threads instead of keeping one
+    cache per thread, e.g. for the streams of a multi-stream ``TaskModule``.
+    A cached cast is dropped when its weight is updated in-place or released,
+    and least recently used casts are evicted beyond ``capacity`` bytes in
+    total. A cast larger than ``capacity`` stays in the per-thread cache.
+    """
+    if capacity is not None:
+        core.set_autocast_shared_cache_capacity(capacity)
+    core.set_autocast_shared_cache_enabled(enabled)
+
+
+def is_shared_cache_enabled() -> bool:
+    return core.is_autocast_shared_cache_enabled()
+
+
+def get_shared_cache_capacity() -> int:
+    r"""
+    Returns the memory cap of the shared cast cache in bytes.
+    """
+    return core.get_autocast_shared_cache_capacity()
+
+
+def clear_shared_cache():
+    core.clear_autocast_shared_cache()
+
+
+def get_shared_cache_stats():
+    r"""
+    Returns a dict of the shared cast cache counters: ``hits``, ``misses``,
+    ``evictions``, and the current ``entries`` and ``bytes``.
+    """
+    return core.get_autocast_shared_cache_stats()
+
+
 if (core._has_cpu()):
     torch.cpu.amp.autocast = _autocast
\ No newline at end of file
@@ -75,6 +75,15 @@ For memory management, it configures NUMA binding and preload optimized memory a
 
    >>> ipexrun  --core_list "0-3" --ninstances 2 --ncore_per_instance 2 --instance_idx 0 python_script args
 
+3. Share the prepacked weights among the instances.
+   By default, every instance packs and holds its own copy of the weights. With weight_sharing_dir, the first
+   instance packing a weight stores it in a subdirectory private to the user and the others map it. The files
+   are kept for later runs, remove the directory once no instance runs to free them.
+
+::
+
+   >>> ipexrun  --ninstances 14 --ncore_per_instance 4 --weight_sharing_dir /dev/shm/ipex_weights python_script args
+
 *** Distributed Training ***
 
 spawns up multiple distributed training processes on each of the training nodes. For intel_extension_for_pytorch, oneCCL
@@ -492,6 +501,9 @@ class MultiInstanceLauncher(Launcher):
                                             args.enable_jemalloc,
                                             args.use_default_allocator,
                                             args.benchmark)
+        if args.weight_sharing_dir:
+            os.makedirs(args.weight_sharing_dir, exist_ok=True)
+            self.set_env("IPEX_WEIGHT_SHARING_DIR", args.weight_sharing_dir)
         os.environ["LAUNCH_CMD"] = "#"
 
         if args.auto_ipex:
@@ -816,6 +828,10 @@ def add_multi_instance_params(parser):
                        help="The log file directory. Default path is '', which means disable logging to files.")
     group.add_argument("--log_file_prefix", metavar='\b', default="run", type=str,
                        help="log file prefix")
+    group.add_argument("--weight_sharing_dir", metavar='\b', default="", type=str,
+                       help="Directory, e.g. under /dev/shm, where the instances store the prepacked weights and map them "
+                            "instead of packing their own copy. Files are keyed by the weight content, stored in a subdirectory "
+                            "private to the user and kept for later runs until the directory is removed.")
 
 def add_kmp_iomp_params(parser):
 
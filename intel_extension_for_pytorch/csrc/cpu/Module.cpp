@@ -23,8 +23,10 @@
 
 #include "jit/auto_opt_config.h"
 #include "jit/cpu/tensorexpr/nnc_fuser_register.h"
+#include "jit/passes/memory_planning.h"
 #include "utils/fpmath_mode.h"
 #include "utils/onednn_utils.h"
+#include "utils/op_counters.h"
 
 #include <c10/core/DeviceType.h>
 #include <torch/csrc/Exceptions.h>
@@ -35,6 +37,7 @@
 
 #include "TaskModule.h"
 #include "aten/EmbeddingBag.h"
+#include "aten/WeightPack.h"
 #include "runtime/CPUPool.h"
 #include "runtime/TaskExecutor.h"
 #include "toolkit/sklearn.h"
@@ -57,6 +60,10 @@ void InitIpexModuleBindings(py::module m) {
     torch_ipex::jit::cpu::tensorexpr::registerCustomOp2NncFuser();
   });
 
+  m.def("disable_custom_op_2_nnc_fuser", []() {
+    torch_ipex::jit::cpu::tensorexpr::clearCustomOp2NncFuser();
+  });
+
   m.def("_get_binary_info", []() { return GetBinaryInfo(); });
 
   m.def("_get_current_isa_level", []() {
@@ -105,6 +112,24 @@ void InitIpexModuleBindings(py::module m) {
     torch_ipex::autocast::set_autocast_dtype(target_dtype);
   });
   m.def("clear_autocast_cache", &torch_ipex::autocast::clear_autocast_cache);
+  m.def(
+      "set_autocast_shared_cache_enabled",
+      &torch_ipex::autocast::set_autocast_shared_cache_enabled);
+  m.def(
+      "is_autocast_shared_cache_enabled",
+      &torch_ipex::autocast::is_autocast_shared_cache_enabled);
+  m.def(
+      "set_autocast_shared_cache_capacity",
+      &torch_ipex::autocast::set_autocast_shared_cache_capacity);
+  m.def(
+      "get_autocast_shared_cache_capacity",
+      &torch_ipex::autocast::get_autocast_shared_cache_capacity);
+  m.def(
+      "clear_autocast_shared_cache",
+      &torch_ipex::autocast::clear_autocast_shared_cache);
+  m.def(
+      "get_autocast_shared_cache_stats",
+      &torch_ipex::autocast::get_autocast_shared_cache_stats);
 
   m.def("set_fp32_math_mode", [](FP32MathMode mode) {
     torch_ipex::setFP32MathModeCpu(mode);
@@ -130,6 +155,21 @@ void InitIpexModuleBindings(py::module m) {
   m.def(
       "_jit_llga_weight_cache_enabled",
       &torch_ipex::jit::fuser::onednn::getLlgaWeightCacheEnabled);
+  m.def(
+      "_jit_set_llga_output_reuse_enabled",
+      &torch_ipex::jit::fuser::onednn::setLlgaOutputReuseEnabled);
+  m.def(
+      "_jit_llga_output_reuse_enabled",
+      &torch_ipex::jit::fuser::onednn::getLlgaOutputReuseEnabled);
+  m.def(
+      "_jit_set_llga_concurrent_partitions",
+      &torch_ipex::jit::fuser::onednn::setLlgaConcurrentPartitions);
+  m.def(
+      "_jit_llga_concurrent_partitions",
+      &torch_ipex::jit::fuser::onednn::getLlgaConcurrentPartitions);
+  m.def(
+      "_jit_llga_concurrent_launches",
+      &torch_ipex::jit::fuser::onednn::getLlgaConcurrentLaunches);
 
   m.def("enable_jit_opt", []() {
     AutoOptConfig::singleton().set_jit_fuse(true);
@@ -140,6 +180,62 @@ void InitIpexModuleBindings(py::module m) {
   m.def("get_jit_opt", []() {
     return AutoOptConfig::singleton().get_jit_fuse();
   });
+  m.def("_jit_set_grouped_linear_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_grouped_linear(enabled);
+  });
+  m.def("_jit_grouped_linear_enabled", []() {
+    return AutoOptConfig::singleton().get_grouped_linear();
+  });
+  m.def("_jit_set_memory_planning_enabled", [](bool enabled) {
+    AutoOptConfig::singleton().set_memory_planning(enabled);
+  });
+  m.def("_jit_memory_planning_enabled", []() {
+    return AutoOptConfig::singleton().get_memory_planning();
+  });
+  m.def("_jit_set_woq_linear", [](int64_t bits, int64_t group_size) {
+    TORCH_CHECK(
+        bits == 0 || bits == 8 || bits == 4,
+        "weight-only quantization only supports 8 or 4 bits, or 0 to disable");
+    TORCH_CHECK(group_size >= 0, "group_size should not be negative");
+    AutoOptConfig::singleton().set_woq_linear(bits, group_size);
+  });
+  m.def("_jit_get_woq_linear", []() {
+    return std::make_tuple(
+        AutoOptConfig::singleton().get_woq_bits(),
+        AutoOptConfig::singleton().get_woq_group_size());
+  });
+  m.def("_jit_get_memory_plans", []() {
+    py::list plans;
+    for (const auto& stats : torch_ipex::jit::getMemoryPlanStats()) {
+      py::dict plan;
+      plan["plan_id"] = stats.plan_id;
+      plan["num_values"] = stats.num_values;
+      plan["total_bytes"] = stats.total_bytes;
+      plan["peak_bytes"] = stats.peak_bytes;
+      plan["arena_bytes"] = stats.arena_bytes;
+      plans.append(plan);
+    }
+    return plans;
+  });
+
+  m.def("_get_packed_weight_cache_stats", []() {
+    auto stats = torch_ipex::cpu::get_packed_weight_cache_stats();
+    py::dict result;
+    result["num_weights"] = std::get<0>(stats);
+    result["bytes"] = std::get<1>(stats);
+    return result;
+  });
+
+  m.def(
+      "_set_op_counters_enabled",
+      &torch_ipex::utils::set_op_counters_enabled);
+  m.def("_get_op_counters_enabled", &torch_ipex::utils::op_counters_enabled);
+  m.def("_reset_op_counters", &torch_ipex::utils::reset_op_counters);
+  m.def("_get_op_counters_prometheus", []() {
+    // the scrape may wait for the clock calibration
+    py::gil_scoped_release no_gil;
+    return torch_ipex::utils::op_counters_prometheus_text();
+  });
 
   // BF32
   py::enum_<FP32MathMode>(m, "FP32MathMode")
@@ -780,3 +780,62 @@ def fast_bert(model, dtype=torch.float, optimizer=None, unpad=False):
                 group['params'][i] = new_param
 
     return new_model, new_optimizer
+
+def fast_decoder(model, dtype=torch.float):
+    r"""
+    Use TPP to speedup inference of decoder-only models. fast_decoder API is an
+    experimental feature and replaces the LLaMA style decoder layers (RMSNorm,
+    rotary embedding, causal self attention with KV cache and SwiGLU MLP) of
+    the model with TPP fused kernels.
+
+    Args:
+        model (torch.nn.Module): User model to apply optimizations on. It should
+            have a ``config`` with the usual transformers decoder attributes.
+        dtype (torch.dtype): Only works for ``torch.bfloat16`` and ``torch.float`` .
+            The default value is torch.float.
+
+    .. warning::
+
+        Please invoke ``fast_decoder`` function AFTER loading weights to model via
+        ``model.load_state_dict(torch.load(PATH))``.
+
+    .. warning::
+
+        This API can't be used when you have applied the ipex.optimize, and
+        only supports inference: the attention probabilities are never
+        materialized, so ``output_attentions`` returns ``None`` for them.
+
+    Examples:
+
+        >>> # bfloat16 inference case.
+        >>> model = ...
+        >>> model.load_state_dict(torch.load(PATH))
+        >>> model.eval()
+        >>> optimized_model = ipex.fast_decoder(model, dtype=torch.bfloat16)
+        >>> # running generation.
+
+    """
+    assert dtype in [torch.float, torch.bfloat16], "TPP only supports torch.float and torch.bfloat16."
+    if model.training:
+        warnings.warn("fast_decoder only supports inference, the model is kept in training mode")
+    config = model.config
+    tpp.fused_decoder.layer_use_bf16 = True if dtype == torch.bfloat16 else False
+    new_model = copy.deepcopy(model)
+    num_replaced = 0
+    for module in new_model.modules():
+        if not isinstance(module, torch.nn.ModuleList):
+            continue
+        for i, layer in enumerate(module):
+            if not tpp.fused_decoder.is_supported_decoder_layer(layer, config):
+                continue
+            new_layer = tpp.fused_decoder.DecoderLayer(config)
+            #the rotary inv_freq is recomputed from the config
+            state_dict = {k: v for k, v in layer.state_dict().items() if not k.endswith("rotary_emb.inv_freq")}
+            new_layer.load_state_dict(state_dict)
+            tpp.block(new_layer)#get block format weights
+            module[i] = new_layer.train(layer.training)
+            num_replaced += 1
+    if num_replaced == 0:
+        warnings.warn("fast_decoder only supports LLaMA style decoder layers, return the origin model")
+        return model
+    return new_model
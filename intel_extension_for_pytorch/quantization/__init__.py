@@ -6,3 +6,4 @@ from ._qconfig import (
     default_dynamic_qconfig_mapping,
 )
 from ._autotune import autotune
+from ._observer import HistogramObserver
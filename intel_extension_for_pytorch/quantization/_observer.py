@@ -0,0 +1,28 @@
+import torch
+from torch.ao.quantization import HistogramObserver as _HistogramObserver
+
+
+class HistogramObserver(_HistogramObserver):
+    r"""
+    Drop-in replacement of ``torch.ao.quantization.HistogramObserver`` with
+    the same arguments, buffers and results.
+
+    The histogram update (min/max, histc and combining with the running
+    histogram) and the non-linear search of the clipping range each run in one
+    parallel C++ op instead of a sequence of Python level tensor ops, which
+    makes calibration of large models much faster.
+    """
+
+    def forward(self, x_orig: torch.Tensor) -> torch.Tensor:
+        if x_orig.numel() == 0 or x_orig.device.type != "cpu":
+            return super().forward(x_orig)
+        x = x_orig.detach()
+        torch.ops.torch_ipex.histogram_observer_update(
+            x, self.histogram, self.min_val, self.max_val, self.upsample_rate)
+        return x_orig
+
+    def _non_linear_param_search(self):
+        if self.histogram.device.type != "cpu":
+            return super()._non_linear_param_search()
+        return torch.ops.torch_ipex.histogram_observer_param_search(
+            self.histogram, self.min_val, self.max_val, self.dst_nbins)
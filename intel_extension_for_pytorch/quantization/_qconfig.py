@@ -2,10 +2,10 @@ import torch
 from torch.ao.quantization import (
     PlaceholderObserver,
     PerChannelMinMaxObserver,
-    HistogramObserver,
     QConfig,
     QConfigMapping,
 )
+from ._observer import HistogramObserver
 
 
 _default_weight_observer = PerChannelMinMaxObserver.with_args(dtype=torch.qint8, qscheme=torch.per_channel_symmetric)
@@ -13,6 +13,7 @@ from torch.quantization.qconfig import QConfig
 from intel_extension_for_pytorch.nn.functional import interaction
 
 from ._quantization_state_utils import QTensorInfo
+from . import _observer
 
 
 add_and_mul_ops = set([
@@ -498,7 +499,13 @@ def _create_observer(setting):
     if "dtype" in setting:
         setting["dtype"] = dtype_dict[setting["dtype"]]
 
-    if hasattr(torch.quantization.observer, setting["name"]):
+    # prefer the ipex observers, which are drop-in replacements of the
+    # torch observers with the same name.
+    if hasattr(_observer, setting["name"]):
+        observer = getattr(_observer, setting["name"])
+        setting.pop("name", None)
+        return observer.with_args(**setting)
+    elif hasattr(torch.quantization.observer, setting["name"]):
         observer = getattr(torch.quantization.observer, setting["name"])
         setting.pop("name", None)
         return observer.with_args(**setting)
@@ -1,6 +1,7 @@
 import pkg_resources
 import warnings 
 from . import fused_bert
+from . import fused_decoder
 from . import utils
 from . import optim
 from .utils.blocked_layout import block_model_params as block
@@ -158,7 +158,9 @@ class BertSelfAttentionFunction(torch.autograd.Function):
             ap,
             apd_t,
             ap_dp_mask,
-        ) = torch.ops.torch_ipex.fused_self_attention_fwd_unpad(p, inputs, training)
+        ) = torch.ops.torch_ipex.fused_self_attention_fwd_unpad(
+            p, inputs, training, need_attention_output
+        )
         (qw, qb, kw, kb, vw, vb, hs, am, hm, ehs, eam, offs, offs2) = inputs
         ctx.save_for_backward(
             qw,
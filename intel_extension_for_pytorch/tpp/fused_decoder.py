@@ -0,0 +1,311 @@
+import torch
+from torch import nn
+from .utils.blocked_layout import (
+    BlockedModule,
+    BlockedTensor,
+    get_blocking_signature,
+)
+from .fused_bert import DummyLinear
+
+USE_BF16_PARAMS = True
+layer_use_bf16 = False
+
+
+def _set_linear_blocking(linear, block_out, block_in, use_bf16):
+    # [out][in] --> [out / block_out][in / block_in][block_in][block_out],
+    # with the block_in dim in VNNI pairs for bf16
+    if use_bf16 and USE_BF16_PARAMS:
+        linear.weight.set_blocking_param(
+            ([block_out, [block_in // 2, 2]], [0, 2, 3, 1, 4], torch.bfloat16,)
+        )
+    else:
+        linear.weight.set_blocking_param(([block_out, block_in], [0, 2, 3, 1],))
+
+
+class RMSNorm(BlockedModule):
+    r"""RMSNorm on blocked [S1][Nc][S2][Hc] hidden states"""
+
+    def __init__(self, hidden_size, eps=1e-6):
+        super().__init__()
+        self.weight = nn.Parameter(torch.ones(hidden_size))
+        self.variance_epsilon = eps
+
+    def forward(self, hidden_states):
+        Nc, Hc = hidden_states.shape[1], hidden_states.shape[3]
+        gamma = self.weight.view(Nc, Hc).to(hidden_states.dtype)
+        return torch.ops.torch_ipex.fused_rmsnorm_fwd(
+            self.variance_epsilon, hidden_states, gamma
+        )
+
+
+class RotaryEmbedding(nn.Module):
+    def __init__(self, dim, max_position_embeddings=2048, base=10000):
+        super().__init__()
+        inv_freq = 1.0 / (base ** (torch.arange(0, dim, 2).float() / dim))
+        self.register_buffer("inv_freq", inv_freq, persistent=False)
+        self._set_cos_sin_cache(max_position_embeddings)
+
+    def _set_cos_sin_cache(self, seq_len):
+        self.max_seq_len_cached = seq_len
+        t = torch.arange(seq_len, dtype=torch.float)
+        freqs = torch.outer(t, self.inv_freq)
+        emb = torch.cat((freqs, freqs), dim=-1)
+        self.cos_cached = emb.cos().contiguous()
+        self.sin_cached = emb.sin().contiguous()
+
+    def forward(self, max_position):
+        if max_position >= self.max_seq_len_cached:
+            self._set_cos_sin_cache(max_position + 1)
+        return self.cos_cached, self.sin_cached
+
+
+class _KVBuffers(object):
+    # capacity-padded key and value buffers of one layer, with the keys also
+    # kept in transposed blocks, and the number of rows appended so far
+    def __init__(self, tensors, length):
+        self.tensors = tensors
+        self.length = length
+
+
+class KVCache(tuple):
+    r"""(key, value) cache returned by DecoderAttention, as [B, N, T, H] views
+    of capacity-padded buffers. It is used as the usual (key, value) tuple.
+    The next step appends to the buffers in place, unless another step
+    already appended to them, e.g. when two continuations of the same prefix
+    are decoded. Then the cache is copied to new buffers instead."""
+
+    def __new__(cls, buffers, length):
+        key = buffers.tensors[0][:, :, :length]
+        value = buffers.tensors[1][:, :, :length]
+        cache = super().__new__(cls, (key, value))
+        cache.buffers = buffers
+        return cache
+
+
+class DecoderAttention(BlockedModule):
+    r"""Causal self attention with rotary embedding and KV cache. The QKV
+    GEMMs, the rotary embedding, the cache update, the attention and the
+    output projection run in one fused op on blocked hidden states. The
+    returned KVCache keeps the keys and values in buffers padded to twice
+    their length, so that a decode step only appends its rows and transposes
+    the last key block instead of copying the whole cache."""
+
+    def __init__(self, config):
+        super().__init__()
+        self.hidden_size = config.hidden_size
+        self.num_heads = config.num_attention_heads
+        self.head_dim = self.hidden_size // self.num_heads
+        self.q_proj = DummyLinear(
+            self.hidden_size, self.num_heads * self.head_dim, bias=False
+        )
+        self.k_proj = DummyLinear(
+            self.hidden_size, self.num_heads * self.head_dim, bias=False
+        )
+        self.v_proj = DummyLinear(
+            self.hidden_size, self.num_heads * self.head_dim, bias=False
+        )
+        self.o_proj = DummyLinear(
+            self.num_heads * self.head_dim, self.hidden_size, bias=False
+        )
+        self.rotary_emb = RotaryEmbedding(
+            self.head_dim,
+            max_position_embeddings=config.max_position_embeddings,
+            base=getattr(config, "rope_theta", 10000),
+        )
+        self.use_bf16 = layer_use_bf16
+        for proj in [self.q_proj, self.k_proj, self.v_proj, self.o_proj]:
+            _set_linear_blocking(proj, self.head_dim, self.head_dim, self.use_bf16)
+
+    def maybe_block_params(self):
+        self.q_proj.weight.block()
+        self.k_proj.weight.block()
+        self.v_proj.weight.block()
+        self.o_proj.weight.block()
+
+    def forward(
+        self, hidden_states, position_ids, key_mask=None, past_key_value=None
+    ):
+        self.maybe_block_params()
+        B, S = position_ids.shape
+        cos, sin = self.rotary_emb(int(position_ids.max()))
+        inputs = [
+            hidden_states,
+            self.q_proj.weight,
+            self.k_proj.weight,
+            self.v_proj.weight,
+            self.o_proj.weight,
+            cos,
+            sin,
+            position_ids.contiguous().view(-1),
+            key_mask if key_mask is not None else torch.Tensor(),
+        ]
+        past_len = 0
+        buffers = None
+        if past_key_value is not None:
+            past_len = past_key_value[0].size(2)
+            inputs += [kv.to(hidden_states.dtype) for kv in past_key_value]
+            buffers = getattr(past_key_value, "buffers", None)
+            if buffers is not None and buffers.length == past_len:
+                inputs += buffers.tensors
+        else:
+            inputs += [torch.Tensor(), torch.Tensor()]
+        out, *tensors = torch.ops.torch_ipex.fused_decoder_attention_fwd(
+            inputs, B
+        )
+        length = past_len + S
+        if (
+            buffers is not None
+            and buffers.length == past_len
+            and tensors[0].data_ptr() == buffers.tensors[0].data_ptr()
+        ):
+            # appended in place, the caches of the earlier steps are copied
+            # if they are used again
+            buffers.length = length
+        else:
+            buffers = _KVBuffers(tensors, length)
+        return out, KVCache(buffers, length)
+
+
+class SwiGLUMLP(BlockedModule):
+    r"""down_proj(silu(gate_proj(x)) * up_proj(x)) on blocked hidden states"""
+
+    def __init__(self, config):
+        super().__init__()
+        self.hidden_size = config.hidden_size
+        self.intermediate_size = config.intermediate_size
+        head_dim = config.hidden_size // config.num_attention_heads
+        inter_block = BlockedModule.default_blocking_factors(
+            self.intermediate_size
+        )[1]
+        self.gate_proj = DummyLinear(
+            self.hidden_size, self.intermediate_size, bias=False
+        )
+        self.up_proj = DummyLinear(self.hidden_size, self.intermediate_size, bias=False)
+        self.down_proj = DummyLinear(
+            self.intermediate_size, self.hidden_size, bias=False
+        )
+        self.use_bf16 = layer_use_bf16
+        _set_linear_blocking(self.gate_proj, inter_block, head_dim, self.use_bf16)
+        _set_linear_blocking(self.up_proj, inter_block, head_dim, self.use_bf16)
+        _set_linear_blocking(self.down_proj, head_dim, inter_block, self.use_bf16)
+
+    def maybe_block_params(self):
+        self.gate_proj.weight.block()
+        self.up_proj.weight.block()
+        self.down_proj.weight.block()
+
+    def forward(self, hidden_states):
+        self.maybe_block_params()
+        return torch.ops.torch_ipex.fused_swiglu_mlp_fwd(
+            hidden_states,
+            self.gate_proj.weight,
+            self.up_proj.weight,
+            self.down_proj.weight,
+        )
+
+
+class DecoderLayer(BlockedModule):
+    r"""Pre-norm decoder block (RMSNorm, causal self attention with rotary
+    embedding and KV cache, SwiGLU MLP) with the same parameter names and call
+    convention as the LLaMA decoder layer of transformers. Inference only."""
+
+    def __init__(self, config):
+        super().__init__()
+        self.hidden_size = config.hidden_size
+        self.head_dim = config.hidden_size // config.num_attention_heads
+        self.self_attn = DecoderAttention(config)
+        self.mlp = SwiGLUMLP(config)
+        self.input_layernorm = RMSNorm(config.hidden_size, eps=config.rms_norm_eps)
+        self.post_attention_layernorm = RMSNorm(
+            config.hidden_size, eps=config.rms_norm_eps
+        )
+        self.blocked_input_signature = get_blocking_signature("SF", "SFSF")
+        self.use_bf16 = layer_use_bf16
+
+    def forward(
+        self,
+        hidden_states,
+        attention_mask=None,
+        position_ids=None,
+        past_key_value=None,
+        output_attentions=False,
+        use_cache=False,
+    ):
+        B, S, HS = hidden_states.shape
+        orig_dtype = hidden_states.dtype
+        past_len = past_key_value[0].size(2) if past_key_value is not None else 0
+        if position_ids is None:
+            position_ids = torch.arange(past_len, past_len + S)
+        position_ids = position_ids.view(-1, S).expand(B, S)
+        key_mask = None
+        if attention_mask is not None:
+            # the causal part of the mask is applied in the kernel, only the
+            # key padding is passed
+            if attention_mask.dim() == 4:
+                key_mask = attention_mask[:, 0, -1, :]
+            else:
+                key_mask = (1.0 - attention_mask.to(torch.float)) * torch.finfo(
+                    torch.float
+                ).min
+            key_mask = key_mask.to(torch.float).contiguous()
+        # token blocks must not straddle two sequences
+        S2 = BlockedModule.default_blocking_factors(S)[1]
+        hidden_states = self.get_blocked_tensor(
+            hidden_states.reshape(B * S, HS),
+            self.blocked_input_signature,
+            [S2, self.head_dim],
+        )
+        if self.use_bf16:
+            hidden_states = hidden_states.to(torch.bfloat16)
+
+        attn_output, present_key_value = self.self_attn(
+            self.input_layernorm(hidden_states),
+            position_ids,
+            key_mask,
+            past_key_value,
+        )
+        hidden_states = hidden_states + attn_output
+        hidden_states = hidden_states + self.mlp(
+            self.post_attention_layernorm(hidden_states)
+        )
+
+        hidden_states = (
+            BlockedTensor(hidden_states, self.blocked_input_signature, orig_dtype)
+            .unblocked_tensor()
+            .view(B, S, HS)
+        )
+        outputs = (hidden_states,)
+        if output_attentions:
+            # the attention probabilities are never materialized
+            outputs += (None,)
+        if use_cache:
+            outputs += (present_key_value,)
+        return outputs
+
+
+def is_supported_decoder_layer(layer, config):
+    r"""Whether ``layer`` is a LLaMA style decoder layer that DecoderLayer can
+    replace: RMSNorm, bias free projections, no grouped KV heads, plain
+    rotary embedding and SiLU gated MLP."""
+    attn = getattr(layer, "self_attn", None)
+    mlp = getattr(layer, "mlp", None)
+    if attn is None or mlp is None:
+        return False
+    for m, names in [
+        (attn, ["q_proj", "k_proj", "v_proj", "o_proj"]),
+        (mlp, ["gate_proj", "up_proj", "down_proj"]),
+    ]:
+        for name in names:
+            proj = getattr(m, name, None)
+            if not isinstance(proj, nn.Linear) or proj.bias is not None:
+                return False
+    for name in ["input_layernorm", "post_attention_layernorm"]:
+        if not hasattr(getattr(layer, name, None), "variance_epsilon"):
+            return False
+    num_heads = config.num_attention_heads
+    return (
+        getattr(config, "hidden_act", None) == "silu"
+        and getattr(config, "num_key_value_heads", num_heads) == num_heads
+        and getattr(config, "rope_scaling", None) is None
+        and (config.hidden_size // num_heads) % 2 == 0
+    )
@@ -0,0 +1,49 @@
+import intel_extension_for_pytorch._C as core
+
+
+def enable_op_counters(enabled=True):
+    r"""
+    Turns the op counters on or off. The counters are on by default, they can
+    also be turned off with the environment variable ``IPEX_OP_COUNTERS=0``.
+
+    Every call of an IPEX kernel and of a prepacked convolution or linear is
+    counted per op, with its latency and, for the prepacked ops, its floating
+    point operations and the bytes of its inputs, weights and outputs.
+
+    Args:
+        enabled (bool): whether to count the ops.
+    """
+    core._set_op_counters_enabled(enabled)
+
+
+def op_counters_enabled():
+    r"""
+    Returns whether the op counters are on.
+    """
+    return core._get_op_counters_enabled()
+
+
+def reset_op_counters():
+    r"""
+    Starts all the op counters over from zero.
+    """
+    core._reset_op_counters()
+
+
+def op_counters_prometheus():
+    r"""
+    Returns a snapshot of the op counters in the Prometheus text exposition
+    format, to be served on a metrics endpoint:
+
+    - ``ipex_op_latency_seconds``: histogram of the latency per op
+    - ``ipex_op_flops_total``: floating point operations per op
+    - ``ipex_op_bytes_total``: bytes read and written per op
+
+    .. highlight:: python
+    .. code-block:: python
+
+        from intel_extension_for_pytorch.utils import op_counters
+        model(data)
+        print(op_counters.op_counters_prometheus())
+    """
+    return core._get_op_counters_prometheus()
@@ -0,0 +1,51 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import argparse
+import time
+
+def bench(name, fn, numel, element_size, num_iter):
+    # warmup
+    for _ in range(5):
+        fn()
+    startT = time.time()
+    for _ in range(num_iter):
+        fn()
+    endT = time.time()
+    avg_elapsed = (endT - startT) / num_iter
+    gbytes = 2 * numel * element_size / 1e9
+    print("{}: {:.3f} ms, {:.2f} GB/s".format(
+        name, avg_elapsed * 1000, gbytes / avg_elapsed))
+
+def run():
+    parser = argparse.ArgumentParser(
+        description="benchmark for ipex cumsum and segment_cumsum"
+    )
+    parser.add_argument("--num-iter", type=int, default=20)
+    parser.add_argument("--numel", type=int, default=32 * 1024 * 1024)
+    parser.add_argument("--num-segments", type=int, default=1024 * 1024)
+    args = parser.parse_args()
+    for dtype in (torch.int32, torch.long, torch.float, torch.bfloat16):
+        x = torch.randint(0, 16, (args.numel,)).to(dtype)
+        for shape, dim in (((args.numel,), 0),
+                           ((16, args.numel // 16), 1),
+                           ((args.numel // 16, 16), 0),
+                           ((4, args.numel // 64, 16), 1)):
+            y = x.view(shape)
+            for exclusive in (False, True):
+                bench("cumsum: shape={}, dim={}, dtype={}, exclusive={}".format(
+                          list(shape), dim, dtype, exclusive),
+                      lambda: torch.ops.torch_ipex.cumsum(
+                          y, dim, exclusive=exclusive),
+                      args.numel, x.element_size(), args.num_iter)
+        lengths = torch.randint(0, 2 * args.numel // args.num_segments,
+                                (args.num_segments,))
+        offsets = torch.nn.functional.pad(lengths.cumsum(0), (1, 0))
+        y = x[:offsets[-1]]
+        bench("segment_cumsum: segments={}, dtype={}".format(
+                  args.num_segments, dtype),
+              lambda: torch.ops.torch_ipex.segment_cumsum(
+                  y, offsets, exclusive=True),
+              y.numel(), x.element_size(), args.num_iter)
+
+if __name__ == "__main__":
+    run()
@@ -0,0 +1,35 @@
+import torch
+import intel_extension_for_pytorch as ipex
+from torch.ao.quantization import HistogramObserver as TorchHistogramObserver
+from intel_extension_for_pytorch.quantization import HistogramObserver
+import argparse
+import time
+
+def run_bench(observer_cls, name, shape, num_observers, num_iter):
+    # one observer per activation tensor as in a calibrated model
+    observers = [observer_cls(reduce_range=False) for _ in range(num_observers)]
+    inputs = [torch.randn(shape) * (i + 1) for i in range(num_iter)]
+    startT = time.time()
+    for x in inputs:
+        for obs in observers:
+            obs(x)
+    for obs in observers:
+        obs.calculate_qparams()
+    endT = time.time()
+    print("{}: shape={}, observers={}, {:.2f} samples/s".format(
+        name, list(shape), num_observers, num_iter * shape[0] / (endT - startT)))
+
+def run():
+    parser = argparse.ArgumentParser(
+        description="calibration throughput of HistogramObserver"
+    )
+    parser.add_argument("--num-iter", type=int, default=20)
+    parser.add_argument("--num-observers", type=int, default=8)
+    args = parser.parse_args()
+    # BERT-large hidden states and ResNet-50 activations
+    for shape in ((8, 384, 1024), (32, 256, 56, 56)):
+        for observer_cls, name in ((TorchHistogramObserver, "torch"), (HistogramObserver, "ipex")):
+            run_bench(observer_cls, name, shape, args.num_observers, args.num_iter)
+
+if __name__ == "__main__":
+    run()
@@ -0,0 +1,59 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import argparse
+import time
+
+def make_indices(distribution, num_rows, num_indices):
+    if distribution == "uniform":
+        return torch.randint(num_rows, (num_indices,))
+    if distribution == "zipf":
+        # power law, as the ids of recsys features
+        ranks = torch.arange(1, num_rows + 1, dtype=torch.double)
+        probs = 1.0 / ranks
+        indices = torch.multinomial(probs / probs.sum(), num_indices, replacement=True)
+        # the hot rows are spread over the table
+        return torch.randperm(num_rows)[indices]
+    if distribution == "sorted":
+        return torch.randint(num_rows, (num_indices,)).sort()[0]
+    assert distribution == "sequential"
+    return torch.arange(num_indices) % num_rows
+
+def run_bench(op, distribution, num_rows, row_size, num_indices, dtype, num_iter):
+    x = torch.randn(num_rows, row_size).to(dtype)
+    indices = make_indices(distribution, num_rows, num_indices)
+    if op == "index_select":
+        fn = lambda: x.index_select(0, indices)
+    else:
+        source = torch.randn(num_indices, row_size).to(dtype)
+        fn = lambda: torch.ops.torch_ipex.index_add_(x, 0, indices, source)
+    # warmup
+    for _ in range(5):
+        fn()
+    startT = time.time()
+    for _ in range(num_iter):
+        fn()
+    endT = time.time()
+    avg_elapsed = (endT - startT) / num_iter
+    gbytes = 2 * num_indices * row_size * x.element_size() / 1e9
+    print("{}: {}, rows={}, row_size={}, indices={}, dtype={}, {:.3f} ms, {:.2f} GB/s".format(
+        op, distribution, num_rows, row_size, num_indices, dtype,
+        avg_elapsed * 1000, gbytes / avg_elapsed))
+
+def run():
+    parser = argparse.ArgumentParser(
+        description="benchmark for ipex index_select and index_add"
+    )
+    parser.add_argument("--num-iter", type=int, default=20)
+    parser.add_argument("--num-rows", type=int, default=4000000)
+    parser.add_argument("--num-indices", type=int, default=262144)
+    parser.add_argument("--bf16", action="store_true", default=False)
+    args = parser.parse_args()
+    dtype = torch.bfloat16 if args.bf16 else torch.float32
+    for op in ("index_select", "index_add"):
+        for row_size in (16, 64, 128, 512):
+            for distribution in ("uniform", "zipf", "sorted", "sequential"):
+                run_bench(op, distribution, args.num_rows, row_size,
+                          args.num_indices, dtype, args.num_iter)
+
+if __name__ == "__main__":
+    run()
@@ -0,0 +1,61 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import argparse
+import time
+
+def bench(name, fn, num_iter):
+    # warmup
+    for _ in range(5):
+        fn()
+    startT = time.time()
+    for _ in range(num_iter):
+        fn()
+    endT = time.time()
+    print("{}: {:.3f} ms".format(name, (endT - startT) / num_iter * 1000))
+
+def run():
+    parser = argparse.ArgumentParser(
+        description="benchmark for ipex jagged tensor ops"
+    )
+    parser.add_argument("--num-iter", type=int, default=20)
+    parser.add_argument("--batch-size", type=int, default=1024)
+    parser.add_argument("--max-length", type=int, default=256)
+    parser.add_argument("--embedding-dim", type=int, default=128)
+    parser.add_argument("--bf16", action="store_true", default=False)
+    args = parser.parse_args()
+    dtype = torch.bfloat16 if args.bf16 else torch.float32
+    B, L, D = args.batch_size, args.max_length, args.embedding_dim
+
+    # power law lengths, as the histories of recsys users
+    lengths = (L / torch.rand(B).mul(L - 1).add(1)).long().clamp(max=L)
+    offsets = torch.nn.functional.pad(lengths.cumsum(0), (1, 0))
+    values = torch.randn(int(offsets[-1]), D).to(dtype)
+    dense = torch.randn(B, L, D).to(dtype)
+    y = torch.randn(B, D, D).to(dtype)
+    indices = torch.randint(B, (B,))
+    print("batch_size={}, max_length={}, embedding_dim={}, rows={}, dtype={}".format(
+        B, L, D, values.size(0), dtype))
+
+    ops = torch.ops.torch_ipex
+    bench("jagged_to_padded_dense",
+          lambda: ops.jagged_to_padded_dense(values, offsets, L), args.num_iter)
+    bench("padded by python",
+          lambda: torch.nn.utils.rnn.pad_sequence(
+              values.split(lengths.tolist()), batch_first=True), args.num_iter)
+    bench("dense_to_jagged",
+          lambda: ops.dense_to_jagged(dense, offsets), args.num_iter)
+    bench("jagged_dense_elementwise_add",
+          lambda: ops.jagged_dense_elementwise_add(values, offsets, dense),
+          args.num_iter)
+    bench("jagged_softmax",
+          lambda: ops.jagged_softmax(values, offsets), args.num_iter)
+    bench("jagged_dense_bmm",
+          lambda: ops.jagged_dense_bmm(values, offsets, y), args.num_iter)
+    bench("jagged_jagged_bmm",
+          lambda: ops.jagged_jagged_bmm(values, values, offsets), args.num_iter)
+    bench("jagged_index_select",
+          lambda: ops.jagged_index_select(values, offsets, indices),
+          args.num_iter)
+
+if __name__ == "__main__":
+    run()
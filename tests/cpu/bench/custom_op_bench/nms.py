@@ -0,0 +1,45 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import argparse
+import time
+
+def make_boxes(ndets, sorted):
+    xy = torch.rand(ndets, 2) * 1333
+    wh = torch.rand(ndets, 2) * 200 + 1
+    dets = torch.cat((xy, xy + wh), dim=1)
+    scores = torch.rand(ndets)
+    if sorted:
+        scores, indices = scores.sort(descending=True)
+        dets = dets.index_select(0, indices)
+    return dets, scores
+
+def run_bench(ndets, threshold, sorted, dtype, num_iter):
+    dets, scores = make_boxes(ndets, sorted)
+    dets = dets.to(dtype)
+    scores = scores.to(dtype)
+    # warmup
+    for _ in range(5):
+        keep = torch.ops.torch_ipex.nms(dets, scores, threshold, sorted)
+    startT = time.time()
+    for _ in range(num_iter):
+        keep = torch.ops.torch_ipex.nms(dets, scores, threshold, sorted)
+    endT = time.time()
+    avg_elapsed = (endT - startT) / num_iter * 1000
+    print("nms: ndets={}, threshold={}, sorted={}, dtype={}, kept={}, {:.3f} ms".format(
+        ndets, threshold, sorted, dtype, keep.size(0), avg_elapsed))
+
+def run():
+    parser = argparse.ArgumentParser(
+        description="benchmark for ipex nms"
+    )
+    parser.add_argument("--num-iter", type=int, default=20)
+    parser.add_argument("--threshold", type=float, default=0.7)
+    parser.add_argument("--double", action="store_true", default=False)
+    args = parser.parse_args()
+    dtype = torch.float64 if args.double else torch.float32
+    for ndets in (1000, 10000, 50000, 100000):
+        for sorted in (True, False):
+            run_bench(ndets, args.threshold, sorted, dtype, args.num_iter)
+
+if __name__ == "__main__":
+    run()
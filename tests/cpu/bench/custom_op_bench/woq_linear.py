@@ -0,0 +1,100 @@
+import torch
+import torch.nn as nn
+import torch.nn.functional as F
+import intel_extension_for_pytorch as ipex
+import argparse
+import time
+
+class DecoderBlock(nn.Module):
+    def __init__(self, hidden_size, num_heads):
+        super(DecoderBlock, self).__init__()
+        self.num_heads = num_heads
+        self.ln1 = nn.LayerNorm(hidden_size)
+        self.qkv = nn.Linear(hidden_size, 3 * hidden_size)
+        self.out_proj = nn.Linear(hidden_size, hidden_size)
+        self.ln2 = nn.LayerNorm(hidden_size)
+        self.fc1 = nn.Linear(hidden_size, 4 * hidden_size)
+        self.fc2 = nn.Linear(4 * hidden_size, hidden_size)
+
+    def forward(self, h, k_cache, v_cache):
+        B, S, H = h.shape
+        q, k, v = self.qkv(self.ln1(h)).chunk(3, dim=-1)
+        # fixed size attention window so that the traced shapes do not change
+        k_cache = torch.cat([k_cache[:, S:], k], dim=1)
+        v_cache = torch.cat([v_cache[:, S:], v], dim=1)
+        T = k_cache.size(1)
+        head_dim = H // self.num_heads
+        q = q.view(B, S, self.num_heads, head_dim).transpose(1, 2)
+        k = k_cache.view(B, T, self.num_heads, head_dim).transpose(1, 2)
+        v = v_cache.view(B, T, self.num_heads, head_dim).transpose(1, 2)
+        scores = torch.matmul(q, k.transpose(-1, -2)) / (head_dim ** 0.5)
+        attn = torch.matmul(scores.softmax(-1), v).transpose(1, 2).reshape(B, S, H)
+        h = h + self.out_proj(attn)
+        h = h + self.fc2(F.gelu(self.fc1(self.ln2(h))))
+        return h, k_cache, v_cache
+
+class Decoder(nn.Module):
+    def __init__(self, vocab_size, hidden_size, num_heads, num_layers):
+        super(Decoder, self).__init__()
+        self.embed = nn.Embedding(vocab_size, hidden_size)
+        self.blocks = nn.ModuleList(
+            [DecoderBlock(hidden_size, num_heads) for _ in range(num_layers)])
+        self.ln_f = nn.LayerNorm(hidden_size)
+        self.lm_head = nn.Linear(hidden_size, vocab_size, bias=False)
+
+    def forward(self, ids, k_caches, v_caches):
+        h = self.embed(ids)
+        new_k = []
+        new_v = []
+        for i, block in enumerate(self.blocks):
+            h, k, v = block(h, k_caches[i], v_caches[i])
+            new_k.append(k)
+            new_v.append(v)
+        logits = self.lm_head(self.ln_f(h))
+        return logits, torch.stack(new_k), torch.stack(new_v)
+
+def run_bench(model, args, dtype, bits):
+    ori_config = ipex._C._jit_get_woq_linear()
+    ipex._C._jit_set_woq_linear(bits, args.group_size)
+    cache_shape = (args.num_layers, args.batch_size, args.window, args.hidden_size)
+    k_caches = torch.zeros(cache_shape, dtype=dtype)
+    v_caches = torch.zeros(cache_shape, dtype=dtype)
+    ids = torch.zeros(args.batch_size, 1, dtype=torch.long)
+    try:
+        with torch.no_grad(), torch.cpu.amp.autocast(enabled=dtype == torch.bfloat16):
+            model_jit = torch.jit.freeze(torch.jit.trace(model, (ids, k_caches, v_caches)))
+            for _ in range(3):
+                model_jit(ids, k_caches, v_caches)
+            startT = time.time()
+            # greedy decoding, one token per sequence and step
+            for _ in range(args.num_tokens):
+                logits, k_caches, v_caches = model_jit(ids, k_caches, v_caches)
+                ids = logits.argmax(-1)
+            endT = time.time()
+    finally:
+        ipex._C._jit_set_woq_linear(*ori_config)
+    name = "int{} weight".format(bits) if bits else "{} weight".format(dtype)
+    print("{}: batch={}, {:.2f} tokens/s".format(
+        name, args.batch_size, args.num_tokens * args.batch_size / (endT - startT)))
+
+def run():
+    parser = argparse.ArgumentParser(
+        description="decoding throughput of weight-only quantized linear"
+    )
+    parser.add_argument("--vocab-size", type=int, default=32000)
+    parser.add_argument("--hidden-size", type=int, default=2048)
+    parser.add_argument("--num-heads", type=int, default=16)
+    parser.add_argument("--num-layers", type=int, default=4)
+    parser.add_argument("--window", type=int, default=128)
+    parser.add_argument("--batch-size", type=int, default=1)
+    parser.add_argument("--num-tokens", type=int, default=64)
+    parser.add_argument("--group-size", type=int, default=128)
+    parser.add_argument("--bf16", action="store_true", default=False)
+    args = parser.parse_args()
+    model = Decoder(args.vocab_size, args.hidden_size, args.num_heads, args.num_layers).eval()
+    dtype = torch.bfloat16 if args.bf16 else torch.float32
+    for bits in (0, 8, 4):
+        run_bench(model, args, dtype, bits)
+
+if __name__ == "__main__":
+    run()
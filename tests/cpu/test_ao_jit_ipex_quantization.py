@@ -192,6 +192,37 @@ class TestIpexOps(JitLlgaTestCase):
         graph = self.checkQuantizeTrace(m, inputs, atol=1e-2, qconfig=static_qconfig[1])
         self.assertGraphContainsExactly(graph, 'ipex::qinteraction', 1)
 
+    def test_roi_align_int8(self):
+        class M(nn.Module):
+            def __init__(self, quantized):
+                super(M, self).__init__()
+                self.quantized = quantized
+                self.roi_align = ipex.nn.modules._roi_align.RoIAlign((5, 5), spatial_scale=1.0, sampling_ratio=-1)
+
+            def forward(self, x, rois):
+                if self.quantized:
+                    x = torch.quantize_per_tensor(x, 0.01, 0, torch.quint8).dequantize()
+                y = self.roi_align(x, rois)
+                if self.quantized:
+                    y = torch.quantize_per_tensor(y, 0.01, 0, torch.quint8).dequantize()
+                return y
+
+        x = torch.rand(1, 32, 10, 10).contiguous(memory_format=torch.channels_last)
+        rois = torch.tensor([[0, 0, 0, 9, 9],
+                             [0, 0, 5, 4, 9],
+                             [0, 5, 5, 9, 9]], dtype=torch.float)
+        with torch.no_grad():
+            traced_model = torch.jit.freeze(torch.jit.trace(M(True).eval(), (x, rois)))
+            # warm up run
+            traced_model(x, rois)
+            traced_model(x, rois)
+            graph = traced_model.graph_for(x, rois)
+            self.assertGraphContainsExactly(graph, 'ipex::qroi_align', 1)
+            y = traced_model(x, rois)
+            y_ref = M(False).eval()(x, rois)
+            # one quantization step for the input and one for the output
+            self.assertEqual(y, y_ref, atol=0.021, rtol=0)
+
     def test_add_int8(self):
         class M(nn.Module):
             def __init__(self):
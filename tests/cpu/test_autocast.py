@@ -96,6 +96,96 @@ class TestFunction(TestCase):
                 out_autocast = _conv(_in_cpu)
             self.assertEqual(out_autocast.dtype, torch.float)
 
+class TestSharedCastCache(TestCase):
+    def tearDown(self):
+        ipex.cpu.autocast.set_shared_cache_enabled(False)
+        super(TestSharedCastCache, self).tearDown()
+
+    def _stats_delta(self, before):
+        after = ipex.cpu.autocast.get_shared_cache_stats()
+        return {k: after[k] - before[k] for k in ("hits", "misses", "evictions")}
+
+    def test_shared_across_threads(self):
+        import threading
+        ipex.cpu.autocast.set_shared_cache_enabled(True)
+        linear = nn.Linear(64, 64)
+        x = torch.randn(4, 64)
+        ref = linear(x.bfloat16().float())
+        outputs = [None] * 4
+
+        def run(idx):
+            with torch.cpu.amp.autocast(dtype=torch.bfloat16), torch.no_grad():
+                for _ in range(3):
+                    outputs[idx] = linear(x)
+
+        before = ipex.cpu.autocast.get_shared_cache_stats()
+        threads = [threading.Thread(target=run, args=(i,)) for i in range(4)]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+        delta = self._stats_delta(before)
+        # the weight and bias are cast once per concurrent first access at most
+        self.assertTrue(delta["hits"] >= 2 * 3 * 4 - 2 * 4)
+        self.assertEqual(ipex.cpu.autocast.get_shared_cache_stats()["entries"], 2)
+        for out in outputs:
+            self.assertEqual(out.dtype, torch.bfloat16)
+            self.assertEqual(out.float(), ref, prec=0.1)
+
+    def test_invalidate_on_update(self):
+        ipex.cpu.autocast.set_shared_cache_enabled(True)
+        linear = nn.Linear(16, 16)
+        x = torch.randn(2, 16)
+        with torch.cpu.amp.autocast(dtype=torch.bfloat16), torch.no_grad():
+            y1 = linear(x)
+            before = ipex.cpu.autocast.get_shared_cache_stats()
+            linear.weight.add_(1.0)
+            y2 = linear(x)
+            delta = self._stats_delta(before)
+        # the weight is recast, the bias still hits
+        self.assertEqual(delta["misses"], 1)
+        self.assertEqual(delta["hits"], 1)
+        self.assertEqual(y2.float(), (y1.float() + x.sum(-1, keepdim=True)), prec=0.2)
+
+    def test_capacity(self):
+        linears = [nn.Linear(256, 256, bias=False) for _ in range(64)]
+        weight_bytes = 256 * 256 * 2
+        ipex.cpu.autocast.set_shared_cache_enabled(True, capacity=16 * weight_bytes)
+        x = torch.randn(2, 256)
+        before = ipex.cpu.autocast.get_shared_cache_stats()
+        with torch.cpu.amp.autocast(dtype=torch.bfloat16), torch.no_grad():
+            for linear in linears:
+                linear(x)
+        stats = ipex.cpu.autocast.get_shared_cache_stats()
+        self.assertTrue(stats["bytes"] <= 16 * weight_bytes)
+        self.assertTrue(self._stats_delta(before)["evictions"] > 0)
+        ipex.cpu.autocast.set_shared_cache_enabled(False, capacity=4 << 30)
+        self.assertEqual(ipex.cpu.autocast.get_shared_cache_stats()["entries"], 0)
+
+    def test_capacity_is_global(self):
+        weight_bytes = 256 * 256 * 2
+        ipex.cpu.autocast.set_shared_cache_enabled(True, capacity=2 * weight_bytes)
+        self.assertEqual(ipex.cpu.autocast.get_shared_cache_capacity(), 2 * weight_bytes)
+        x = torch.randn(2, 256)
+        # far larger than a per-stripe share of the capacity, still cached
+        linear = nn.Linear(256, 256, bias=False)
+        with torch.cpu.amp.autocast(dtype=torch.bfloat16), torch.no_grad():
+            linear(x)
+            before = ipex.cpu.autocast.get_shared_cache_stats()
+            linear(x)
+            self.assertEqual(self._stats_delta(before)["hits"], 1)
+        self.assertEqual(ipex.cpu.autocast.get_shared_cache_stats()["bytes"], weight_bytes)
+        # larger than the whole capacity, kept in the thread-local cache
+        big = nn.Linear(256, 1024, bias=False)
+        with torch.cpu.amp.autocast(dtype=torch.bfloat16), torch.no_grad():
+            y1 = big(x)
+            y2 = big(x)
+        self.assertEqual(y1, y2)
+        stats = ipex.cpu.autocast.get_shared_cache_stats()
+        self.assertEqual(stats["entries"], 1)
+        self.assertEqual(stats["bytes"], weight_bytes)
+        ipex.cpu.autocast.set_shared_cache_enabled(False, capacity=4 << 30)
+
 class TestAutocastWithJit(TestCase):
     def setUp(self):
         super(TestAutocastWithJit, self).setUp()
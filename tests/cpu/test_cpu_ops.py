@@ -960,6 +960,42 @@ class CPUOPsTester(TestCase):
                 y1_5 = torch.index_select(x1_5, dim, indices, out=torch.empty(0))
                 self.assertTrue(y1_5.dtype == torch.float32)
 
+    def test_index_select_gather(self):
+        # random indices with duplicates, rows from 4 to 4096 bytes
+        for datatype in [torch.float32, torch.bfloat16, torch.double]:
+            for inner_size in [3, 16, 257, 1024]:
+                x = torch.randn(5000, inner_size).to(datatype)
+                indices = torch.randint(5000, (20000,))
+                self.assertEqual(x.index_select(0, indices), x[indices])
+                y = torch.randn(3, 5000, inner_size).to(datatype)
+                self.assertEqual(y.index_select(1, indices), y[:, indices])
+
+    def test_index_add(self):
+        for datatype in [torch.float32, torch.bfloat16, torch.double]:
+            for index_datatype in [torch.int32, torch.int64]:
+                for dim, alpha in [(0, 1), (0, 0.5), (1, 2)]:
+                    x = torch.randn(300, 40, 17).to(datatype)
+                    # many duplicates
+                    indices = torch.randint(
+                        x.size(dim), (5000,), dtype=index_datatype
+                    )
+                    source_size = list(x.size())
+                    source_size[dim] = indices.numel()
+                    source = torch.randn(source_size).to(datatype)
+                    ref = x.clone().index_add_(dim, indices, source, alpha=alpha)
+                    y = torch.ops.torch_ipex.index_add_(
+                        x.clone(), dim, indices, source, alpha=alpha
+                    )
+                    prec = 0.5 if datatype == torch.bfloat16 else 1e-4
+                    self.assertEqual(y, ref, atol=prec, rtol=prec)
+        # falls back to torch for the unsupported inputs
+        x = torch.randn(10, 4).t()
+        indices = torch.tensor([0, 1, 1])
+        source = torch.randn(4, 3)
+        ref = x.clone().index_add_(1, indices, source)
+        y = torch.ops.torch_ipex.index_add_(x.clone(), 1, indices, source)
+        self.assertEqual(y, ref)
+
     def test_cat(self):
         for datatype in [torch.float32, torch.double, torch.bfloat16]:
             for dim, size in itertools.product([0, 1], [[2, 1], [2, 2], [5, 10]]):
@@ -56,5 +56,74 @@ class TestCumSum(TestCase):
         # Check that output maintained correct shape
         self.assertEqual(raw_tensor.shape, raw_tensor.grad.shape)
 
+    def test_cumsum_dims(self):
+        # the long scans are split in chunks, the short ones run one per task
+        shapes = [[1000003], [3, 70001], [70001, 3], [4, 50000, 5], [2, 3, 300, 7]]
+        for shape in shapes:
+            for dim in range(len(shape)):
+                for dtype in [torch.int32, torch.long, torch.float, torch.double]:
+                    x = torch.randint(-8, 8, shape).to(dtype)
+                    expected = torch.cumsum(x, dim)
+                    self.assertEqual(torch.ops.torch_ipex.cumsum(x, dim), expected)
+                    exclusive = torch.ops.torch_ipex.cumsum(x, dim, exclusive=True)
+                    self.assertEqual(exclusive, expected - x.to(expected.dtype))
+
+    def test_cumsum_bf16(self):
+        for shape, dim in [([7, 4097], 1), ([4097, 7], 0), ([200003], 0)]:
+            x = torch.randint(0, 4, shape).bfloat16()
+            res = torch.ops.torch_ipex.cumsum(x, dim)
+            self.assertEqual(res.dtype, torch.bfloat16)
+            # accumulated in float, rounded once
+            self.assertEqual(res, x.float().cumsum(dim).bfloat16())
+
+    def test_cumsum_exclusive_grad(self):
+        x = torch.randn(5, 6, requires_grad=True)
+        y = x.detach().clone().requires_grad_()
+        grad = torch.randn(5, 6)
+        torch.ops.torch_ipex.cumsum(x, 0, exclusive=True).backward(grad)
+        (y.cumsum(0) - y).backward(grad)
+        self.assertEqual(x.grad, y.grad)
+
+    def test_segment_cumsum(self):
+        for num_segments, inner in [(1, 1), (5, 1), (4000, 1), (300, 3), (7, 64)]:
+            lengths = torch.randint(0, 500, (num_segments,))
+            lengths[0] = 0
+            offsets = torch.nn.functional.pad(lengths.cumsum(0), (1, 0))
+            x = torch.randint(-8, 8, (int(offsets[-1]), inner)).squeeze(-1)
+            for dtype in [torch.int32, torch.long, torch.float]:
+                x = x.to(dtype)
+                expected = torch.cat(
+                    [s.cumsum(0) for s in x.split(lengths.tolist())])
+                res = torch.ops.torch_ipex.segment_cumsum(x, offsets)
+                self.assertEqual(res, expected)
+                res = torch.ops.torch_ipex.segment_cumsum(
+                    x, offsets.int(), exclusive=True)
+                self.assertEqual(res, expected - x.to(expected.dtype))
+
+        # the offsets of the features of a batch are the exclusive scan of
+        # their lengths, per feature
+        lengths = torch.tensor([2, 0, 1, 3, 1, 1], dtype=torch.int32)
+        feature_offsets = torch.tensor([0, 3, 6])
+        res = torch.ops.torch_ipex.segment_cumsum(
+            lengths, feature_offsets, exclusive=True)
+        self.assertEqual(res, torch.tensor([0, 2, 2, 0, 3, 4]))
+
+        with self.assertRaises(RuntimeError):
+            torch.ops.torch_ipex.segment_cumsum(lengths, torch.tensor([0, 4, 3, 6]))
+
+    def test_segment_cumsum_grad(self):
+        offsets = torch.tensor([0, 3, 3, 7, 8])
+        for exclusive in [False, True]:
+            x = torch.randn(8, 2, requires_grad=True)
+            grad = torch.randn(8, 2)
+            torch.ops.torch_ipex.segment_cumsum(
+                x, offsets, exclusive=exclusive).backward(grad)
+            y = x.detach().clone().requires_grad_()
+            expected = torch.cat([s.cumsum(0) for s in y.split([3, 0, 4, 1])])
+            if exclusive:
+                expected = expected - y
+            expected.backward(grad)
+            self.assertEqual(x.grad, y.grad)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -0,0 +1,56 @@
+import unittest
+
+import torch
+import intel_extension_for_pytorch as ipex
+from torch.ao.quantization import HistogramObserver as TorchHistogramObserver
+from intel_extension_for_pytorch.quantization import HistogramObserver
+from common_utils import TestCase
+
+class HistogramObserverTester(TestCase):
+    def _run_observers(self, inputs, **kwargs):
+        ref = TorchHistogramObserver(**kwargs)
+        obs = HistogramObserver(**kwargs)
+        for x in inputs:
+            ref(x)
+            obs(x)
+        return ref, obs
+
+    def test_histogram_update(self):
+        torch.manual_seed(0)
+        # growing ranges exercise the combine path, the repeated range the
+        # plain accumulation and the constant tensor the min == max case.
+        inputs = [
+            torch.full((16,), 0.5),
+            torch.randn(4, 1000),
+            torch.randn(4, 1000) * 3,
+            torch.randn(4, 1000) * 3,
+            torch.rand(1, 3, 37, 37) * 20 - 4,
+        ]
+        ref, obs = self._run_observers(inputs, reduce_range=False)
+        self.assertEqual(obs.min_val, ref.min_val)
+        self.assertEqual(obs.max_val, ref.max_val, prec=1e-4)
+        self.assertEqual(obs.histogram.sum(), ref.histogram.sum(), prec=1e-1)
+        # only values sitting exactly on a bin edge may land in a neighbour bin
+        self.assertEqual(obs.histogram, ref.histogram, prec=2)
+
+    def test_calculate_qparams(self):
+        torch.manual_seed(0)
+        for dtype, qscheme in [(torch.quint8, torch.per_tensor_affine),
+                               (torch.qint8, torch.per_tensor_symmetric)]:
+            # heavy tails so that the clipping range search does real work
+            inputs = [torch.randn(64, 128) ** 3 for _ in range(8)]
+            ref, obs = self._run_observers(inputs, dtype=dtype, qscheme=qscheme, reduce_range=False)
+            scale_ref, zp_ref = ref.calculate_qparams()
+            scale, zp = obs.calculate_qparams()
+            self.assertEqual(scale, scale_ref, prec=1e-3 * scale_ref.item())
+            self.assertTrue((zp - zp_ref).abs().max().item() <= 1)
+
+    def test_default_static_qconfig(self):
+        obs = ipex.quantization.default_static_qconfig.activation()
+        self.assertTrue(isinstance(obs, HistogramObserver))
+        x = torch.randn(8, 16)
+        self.assertEqual(obs(x), x)
+        self.assertTrue(obs.histogram.sum().item() == x.numel())
+
+if __name__ == '__main__':
+    test = unittest.main()
@@ -0,0 +1,153 @@
+import torch
+import intel_extension_for_pytorch as ipex
+import unittest
+from common_utils import TestCase
+
+def make_jagged(lengths, *inner, dtype=torch.float):
+    offsets = torch.nn.functional.pad(torch.tensor(lengths).cumsum(0), (1, 0))
+    values = torch.randn(int(offsets[-1]), *inner).to(dtype)
+    return values, offsets
+
+def to_dense(values, offsets, max_length, padding_value=0.):
+    dense = torch.full((offsets.numel() - 1, max_length) + values.shape[1:],
+                       padding_value, dtype=values.dtype)
+    for b in range(offsets.numel() - 1):
+        seq = values[offsets[b]:offsets[b + 1]][:max_length]
+        dense[b, :seq.size(0)] = seq
+    return dense
+
+class TestJagged(TestCase):
+    def test_jagged_dense_conversion(self):
+        lengths = [3, 0, 5, 1, 7]
+        for dtype in [torch.float, torch.bfloat16, torch.long]:
+            values, offsets = make_jagged(lengths, 2, 3, dtype=dtype)
+            for max_length in [7, 4]:
+                dense = torch.ops.torch_ipex.jagged_to_padded_dense(
+                    values, offsets, max_length, padding_value=-1.)
+                self.assertEqual(dense, to_dense(values, offsets, max_length, -1.))
+                # the rows past max_length are zeros
+                res = torch.ops.torch_ipex.dense_to_jagged(dense, offsets.int())
+                expected = torch.cat([
+                    torch.cat([values[o:o + min(l, max_length)],
+                               values.new_zeros(max(l - max_length, 0), 2, 3)])
+                    for o, l in zip(offsets.tolist(), lengths)])
+                self.assertEqual(res, expected)
+        values, offsets = make_jagged(lengths, 4)
+        dense = torch.ops.torch_ipex.jagged_to_padded_dense(values, offsets)
+        self.assertEqual(dense.shape, (5, 7, 4))
+
+    def test_jagged_dense_conversion_grad(self):
+        values, offsets = make_jagged([3, 0, 5, 2], 4)
+        values.requires_grad_()
+        dense = torch.ops.torch_ipex.jagged_to_padded_dense(values, offsets, 4)
+        grad = torch.randn(dense.shape)
+        dense.backward(grad)
+        expected = torch.cat([grad[0, :3], grad[2, :4], torch.zeros(1, 4), grad[3, :2]])
+        self.assertEqual(values.grad, expected)
+
+        dense = torch.randn(4, 6, 4, requires_grad=True)
+        torch.ops.torch_ipex.dense_to_jagged(dense, offsets).sum().backward()
+        self.assertEqual(dense.grad, to_dense(torch.ones(10, 4), offsets, 6))
+
+    def test_jagged_dense_elementwise(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            values, offsets = make_jagged([3, 0, 6, 1], 5, dtype=dtype)
+            dense = torch.randn(4, 4, 5).to(dtype)
+            padded = to_dense(values, offsets, 6)
+            dense6 = torch.nn.functional.pad(dense, (0, 0, 0, 2))
+            for op, fn in [("add", torch.add), ("mul", torch.mul)]:
+                res = getattr(torch.ops.torch_ipex, "jagged_dense_elementwise_" + op)(
+                    values, offsets, dense)
+                expected = torch.ops.torch_ipex.dense_to_jagged(
+                    fn(padded, dense6), offsets)
+                self.assertEqual(res, expected)
+
+    def test_jagged_dense_elementwise_grad(self):
+        values, offsets = make_jagged([3, 0, 6, 1], 5)
+        dense = torch.randn(4, 4, 5)
+        for op, fn in [("add", torch.add), ("mul", torch.mul)]:
+            x = values.clone().requires_grad_()
+            y = dense.clone().requires_grad_()
+            res = getattr(torch.ops.torch_ipex, "jagged_dense_elementwise_" + op)(
+                x, offsets, y)
+            grad = torch.randn(res.shape)
+            res.backward(grad)
+            x2 = values.clone().requires_grad_()
+            y2 = dense.clone().requires_grad_()
+            padded = torch.ops.torch_ipex.jagged_to_padded_dense(x2, offsets, 6)
+            expected = torch.ops.torch_ipex.dense_to_jagged(
+                fn(padded, torch.nn.functional.pad(y2, (0, 0, 0, 2))), offsets)
+            expected.backward(grad)
+            self.assertEqual(x.grad, x2.grad)
+            self.assertEqual(y.grad, y2.grad)
+
+    def test_jagged_softmax(self):
+        for inner in [(), (3,)]:
+            for dtype in [torch.float, torch.bfloat16]:
+                values, offsets = make_jagged([4, 0, 1, 33], *inner, dtype=dtype)
+                values.requires_grad_()
+                res = torch.ops.torch_ipex.jagged_softmax(values, offsets)
+                ref_values = values.detach().float().requires_grad_()
+                expected = torch.cat(
+                    [s.softmax(0) for s in ref_values.split([4, 0, 1, 33])])
+                self.assertEqual(res, expected.to(dtype), prec=1e-2)
+                grad = torch.randn(res.shape).to(dtype)
+                res.backward(grad)
+                expected.backward(grad.float())
+                self.assertEqual(values.grad, ref_values.grad.to(dtype), prec=2e-2)
+
+    def test_jagged_bmm(self):
+        lengths = [3, 0, 7, 2]
+        x, offsets = make_jagged(lengths, 8)
+        y = torch.randn(4, 8, 5)
+        x.requires_grad_()
+        y.requires_grad_()
+        res = torch.ops.torch_ipex.jagged_dense_bmm(x, offsets, y)
+        xs = x.split(lengths)
+        expected = torch.cat([xs[b] @ y[b] for b in range(4)])
+        self.assertEqual(res, expected)
+        grad = torch.randn(res.shape)
+        res.backward(grad)
+        x_grad, y_grad = torch.autograd.grad(expected, (x, y), grad)
+        self.assertEqual(x.grad, x_grad)
+        self.assertEqual(y.grad, y_grad)
+
+        z = torch.randn(12, 6, requires_grad=True)
+        res = torch.ops.torch_ipex.jagged_jagged_bmm(x, z, offsets)
+        zs = z.split(lengths)
+        expected = torch.stack([xs[b].t() @ zs[b] for b in range(4)])
+        self.assertEqual(res, expected)
+        self.assertEqual(res[1], torch.zeros(8, 6))
+        grad = torch.randn(res.shape)
+        x_grad, z_grad = torch.autograd.grad(res, (x, z), grad)
+        x_ref, z_ref = torch.autograd.grad(expected, (x, z), grad)
+        self.assertEqual(x_grad, x_ref)
+        self.assertEqual(z_grad, z_ref)
+
+    def test_jagged_index_select(self):
+        lengths = [3, 0, 5, 1]
+        for dtype in [torch.float, torch.bfloat16, torch.int32]:
+            values, offsets = make_jagged(lengths, 2, dtype=dtype)
+            indices = torch.tensor([2, 0, 2, 1, 3])
+            res, res_offsets = torch.ops.torch_ipex.jagged_index_select(
+                values, offsets.int(), indices)
+            seqs = values.split(lengths)
+            self.assertEqual(res, torch.cat([seqs[i] for i in indices]))
+            self.assertEqual(res_offsets, torch.tensor([0, 5, 8, 13, 13, 14]))
+            self.assertEqual(res_offsets.dtype, torch.int32)
+
+        values, offsets = make_jagged(lengths, 2)
+        values.requires_grad_()
+        res, _ = torch.ops.torch_ipex.jagged_index_select(values, offsets, indices)
+        grad = torch.randn(res.shape)
+        res.backward(grad)
+        ref_values = values.detach().clone().requires_grad_()
+        seqs = ref_values.split(lengths)
+        torch.cat([seqs[i] for i in indices]).backward(grad)
+        self.assertEqual(values.grad, ref_values.grad)
+
+        with self.assertRaises(IndexError):
+            torch.ops.torch_ipex.jagged_index_select(values, offsets, torch.tensor([4]))
+
+if __name__ == '__main__':
+    test = unittest.main()
@@ -1145,6 +1145,35 @@ class ModMultLinearWithOrWithoutBias(nn.Module):
          res4 = self.linear4(x)
          return res1, res2, res3, res4
 
+class ModMultTowerLinear(nn.Module):
+    def __init__(self, towers, in_features, out_features, act=None):
+         super(ModMultTowerLinear, self).__init__()
+         self.towers = nn.ModuleList([nn.Linear(in_features, out_features) for _ in range(towers)])
+         self.act = act
+
+    def forward(self, xs):
+         outs = []
+         for i, tower in enumerate(self.towers):
+             out = tower(xs[i])
+             if self.act is not None:
+                 out = self.act(out)
+             outs.append(out)
+         return outs
+
+class ConvLinearChain(nn.Module):
+    def __init__(self):
+        super(ConvLinearChain, self).__init__()
+        self.conv1 = nn.Conv2d(3, 8, 3, padding=1)
+        self.conv2 = nn.Conv2d(8, 8, 3, padding=1)
+        self.linear1 = nn.Linear(8 * 16 * 16, 32)
+        self.linear2 = nn.Linear(32, 10)
+
+    def forward(self, x):
+        x = F.relu(self.conv1(x))
+        x = self.conv2(x)
+        x = F.relu(self.linear1(x.flatten(1)))
+        return self.linear2(x)
+
 class LinearSwishNaive(nn.Module):
     def __init__(self, in_feature, out_feature):
         super(LinearSwishNaive, self).__init__()
@@ -1405,6 +1434,176 @@ class Tester(TestCase):
         self.assertTrue(any(n.kind() == imperative_node for n in trace_graph.nodes()))
         
 
+    def test_grouped_linear_op(self):
+        xs = [torch.randn(3, 7, 16) for _ in range(4)]
+        weight = torch.randn(4, 16, 24)
+        bias = torch.randn(4, 24)
+        for post_op, act in [("none", lambda x: x), ("relu", torch.relu),
+                             ("gelu", F.gelu), ("silu", F.silu), ("sigmoid", torch.sigmoid)]:
+            outs = torch.ops.torch_ipex.grouped_linear(xs, weight, bias, post_op)
+            for i in range(4):
+                self.assertEqual(outs[i], act(torch.matmul(xs[i], weight[i]) + bias[i]))
+        outs = torch.ops.torch_ipex.grouped_linear(xs, weight, None, "none")
+        for i in range(4):
+            self.assertEqual(outs[i], torch.matmul(xs[i], weight[i]))
+        outs = torch.ops.torch_ipex.grouped_linear(
+            [x.bfloat16() for x in xs], weight.bfloat16(), bias.bfloat16(), "relu")
+        for i in range(4):
+            ref = torch.relu(torch.matmul(xs[i].bfloat16(), weight[i].bfloat16()) + bias[i].bfloat16())
+            self.assertEqual(outs[i], ref, rtol=1e-2, atol=1e-2)
+        # inputs of different leading sizes, e.g. a shape change after the
+        # graph was grouped on the profiled ones
+        ys = [torch.randn(2, 16), torch.randn(5, 3, 16), torch.randn(16), torch.randn(0, 16)]
+        outs = torch.ops.torch_ipex.grouped_linear(ys, weight, bias, "gelu")
+        for i in range(4):
+            self.assertEqual(outs[i], F.gelu(torch.matmul(ys[i], weight[i]) + bias[i]))
+        with self.assertRaises(RuntimeError):
+            torch.ops.torch_ipex.grouped_linear(
+                [torch.randn(2, 8) for _ in range(4)], weight, bias, "none")
+        # The epilogue is computed in fp32, so double is not supported.
+        with self.assertRaises(RuntimeError):
+            torch.ops.torch_ipex.grouped_linear(
+                [x.double() for x in xs], weight.double(), bias.double(), "relu")
+
+    def test_grouped_linear(self):
+        def check_op_count(graph_str, op_names=[]):
+            count = 0
+            for node in graph_str.strip().split("\n"):
+                for op_name in op_names:
+                    if op_name in node:
+                        count += 1
+            return count
+        xs = [torch.rand(8, 16) for _ in range(3)]
+        for act in [None, nn.ReLU()]:
+            model = ipex.optimize(ModMultTowerLinear(3, 16, 32, act).eval(), dtype=torch.float32)
+            ori_enabled = ipex._C._jit_grouped_linear_enabled()
+            ipex._C._jit_set_grouped_linear_enabled(True)
+            try:
+                with torch.no_grad():
+                    ori_res = model(xs)
+                    model_jit = torch.jit.freeze(torch.jit.trace(model, (xs,)))
+                    model_jit(xs)
+                    jit_res = model_jit(xs)
+                    graph = str(model_jit.graph_for(xs))
+            finally:
+                ipex._C._jit_set_grouped_linear_enabled(ori_enabled)
+            self.assertEqual(check_op_count(graph, ["torch_ipex::grouped_linear"]), 1)
+            if act is not None:
+                self.assertEqual(check_op_count(graph, ["aten::relu"]), 0)
+            for ori, res in zip(ori_res, jit_res):
+                self.assertEqual(ori, res)
+            # the grouping is not guarded on the profiled sizes
+            ys = [torch.rand(3, 16), torch.rand(5, 16), torch.rand(8, 16)]
+            with torch.no_grad():
+                for ori, res in zip(model(ys), model_jit(ys)):
+                    self.assertEqual(ori, res)
+
+    def test_memory_planning(self):
+        x = torch.rand(2, 3, 16, 16)
+        model = ipex.optimize(ConvLinearChain().eval(), dtype=torch.float32)
+        ori_enabled = ipex._C._jit_memory_planning_enabled()
+        ipex._C._jit_set_memory_planning_enabled(True)
+        num_plans = len(ipex._C._jit_get_memory_plans())
+        try:
+            with torch.no_grad():
+                ori_res = model(x)
+                model_jit = torch.jit.freeze(torch.jit.trace(model, x))
+                for _ in range(3):
+                    jit_res = model_jit(x)
+                graph = str(model_jit.graph_for(x))
+                # the slots are planned for the profiled batch size, other
+                # sizes fall back to allocating the outputs
+                for batch_size in [4, 1, 2]:
+                    y = torch.rand(batch_size, 3, 16, 16)
+                    self.assertEqual(model(y), model_jit(y))
+        finally:
+            ipex._C._jit_set_memory_planning_enabled(ori_enabled)
+        self.assertEqual(ori_res, jit_res)
+        self.assertTrue("ipex::memory_plan_slot" in graph)
+        self.assertTrue("ipex_prepack::convolution_relu_run_out" in graph)
+        plans = ipex._C._jit_get_memory_plans()[num_plans:]
+        self.assertTrue(len(plans) > 0)
+        for plan in plans:
+            # conv1 and linear1 outputs are never alive at the same time
+            self.assertEqual(plan["num_values"], 3)
+            self.assertTrue(plan["arena_bytes"] < plan["total_bytes"])
+            self.assertTrue(plan["peak_bytes"] <= plan["arena_bytes"])
+
+    def _woq_dequant_ref(self, weight, bits, group_size):
+        N, K = weight.shape
+        G = group_size if group_size > 0 else K
+        num_groups = (K + G - 1) // G
+        qmax = 127.0 if bits == 8 else 7.0
+        w = F.pad(weight.float(), (0, num_groups * G - K)).view(N, num_groups, G)
+        scales = w.abs().amax(-1, keepdim=True) / qmax
+        scales[scales == 0] = 1.0
+        q = (w / scales).round().clamp(-qmax, qmax)
+        return (q * scales).view(N, -1)[:, :K]
+
+    def test_woq_linear_op(self):
+        for bits, group_size, N, K in [(8, 0, 40, 64), (8, 32, 48, 96),
+                                       (4, 0, 33, 64), (4, 32, 64, 80)]:
+            weight = torch.randn(N, K)
+            bias = torch.randn(N)
+            qweight, scales = torch.ops.torch_ipex.woq_linear_pack_weight(weight, bits, group_size)
+            ref_weight = self._woq_dequant_ref(weight, bits, group_size)
+            # the last case goes through the dequantized GEMM
+            for M in [1, 5, 70]:
+                x = torch.randn(M, K)
+                out = torch.ops.torch_ipex.woq_linear(x, qweight, scales, bias, N, bits, group_size)
+                self.assertEqual(out, F.linear(x, ref_weight, bias), rtol=1e-4, atol=1e-4)
+            for x in [torch.randn(2, 3, K).bfloat16(), torch.randn(70, K).bfloat16()]:
+                out = torch.ops.torch_ipex.woq_linear(x, qweight, scales, None, N, bits, group_size)
+                self.assertEqual(out.dtype, torch.bfloat16)
+                self.assertEqual(out, F.linear(x.float(), ref_weight), rtol=1e-2, atol=1e-1)
+
+    def test_woq_linear_op_checks(self):
+        N, K, group_size = 40, 64, 32
+        weight = torch.randn(N, K)
+        x = torch.randn(2, K)
+        q8, s8 = torch.ops.torch_ipex.woq_linear_pack_weight(weight, 8, group_size)
+        q4, s4 = torch.ops.torch_ipex.woq_linear_pack_weight(weight, 4, group_size)
+        bad_args = [
+            # packed for the other number of bits
+            (q4, s4, None, 8),
+            (q8, s8, None, 4),
+            (q8.to(torch.uint8), s8, None, 8),
+            (q8.transpose(1, 2).contiguous().transpose(1, 2), s8, None, 8),
+            (q8, s8.double(), None, 8),
+            (q8, s8.transpose(1, 2).contiguous().transpose(1, 2), None, 8),
+            # scales of another group size
+            (q8, s8[:, :1], None, 8),
+            (q8, s8, torch.randn(N).double(), 8),
+        ]
+        for qweight, scales, bias, bits in bad_args:
+            with self.assertRaises(RuntimeError):
+                torch.ops.torch_ipex.woq_linear(x, qweight, scales, bias, N, bits, group_size)
+        out = torch.ops.torch_ipex.woq_linear(x, q8, s8, torch.randn(N).bfloat16(), N, 8, group_size)
+        self.assertEqual(out.dtype, torch.float)
+
+    def test_woq_linear(self):
+        model = nn.Sequential(nn.Linear(64, 96), nn.ReLU(), nn.Linear(96, 40)).eval()
+        x = torch.randn(4, 64)
+        ori_config = ipex._C._jit_get_woq_linear()
+        for bits, group_size in [(8, 0), (4, 32)]:
+            ref_model = copy.deepcopy(model)
+            with torch.no_grad():
+                for m in ref_model:
+                    if isinstance(m, nn.Linear):
+                        m.weight.copy_(self._woq_dequant_ref(m.weight, bits, group_size))
+                ref_res = ref_model(x)
+            ipex._C._jit_set_woq_linear(bits, group_size)
+            try:
+                with torch.no_grad():
+                    model_jit = torch.jit.freeze(torch.jit.trace(model, x))
+                    model_jit(x)
+                    jit_res = model_jit(x)
+                    graph = str(model_jit.graph_for(x))
+            finally:
+                ipex._C._jit_set_woq_linear(*ori_config)
+            self.assertEqual(graph.count("ipex_prepack::woq_linear_run"), 2)
+            self.assertEqual(jit_res, ref_res, rtol=1e-4, atol=1e-4)
+
     def test_concat_linear(self):
         def check_op_count(graph_str, op_names=[]):
             count = 0
@@ -449,6 +449,155 @@ class TestOp(JitLlgaTestCase):
         graph, scripted = self.checkScript(m, [x, y, z])
         self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 0)
 
+    @llga_fp32_bf16_test_env
+    def test_concurrent_partitions(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv1 = nn.Conv2d(8, 16, 3, padding=1)
+                self.conv2 = nn.Conv2d(8, 16, 1)
+
+            def forward(self, x):
+                a = F.relu(self.conv1(x))
+                b = F.relu(self.conv2(x))
+                # not supported by LLGA, joins the two branches
+                return torch.atan2(a, b)
+
+        x = torch.randn(2, 8, 14, 14)
+        m = M()
+        num_pools = ipex._C._jit_llga_concurrent_partitions()
+        ipex._C._jit_set_llga_concurrent_partitions(2)
+        try:
+            graph, _ = self.checkTrace(m, [x])
+        finally:
+            ipex._C._jit_set_llga_concurrent_partitions(num_pools)
+        # the two branches are independent and joined before atan2
+        self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 2)
+        self.assertGraphContainsExactly(graph, 'ipex::LlgaFusionJoin', 2)
+
+    @unittest.skipIf(not ipex.cpu.runtime.is_runtime_ext_enabled(), "Skip when IPEX Runtime extension is not enabled")
+    @unittest.skipIf(len(os.sched_getaffinity(0)) < 2, "Needs 2 cores for 2 sub-pools")
+    @llga_fp32_bf16_test_env
+    def test_concurrent_partitions_run(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv1 = nn.Conv2d(8, 16, 3, padding=1)
+                self.conv2 = nn.Conv2d(8, 16, 1)
+
+            def forward(self, x):
+                a = F.relu(self.conv1(x))
+                b = F.relu(self.conv2(x))
+                return torch.atan2(a, b)
+
+        m = M().eval()
+        num_pools = ipex._C._jit_llga_concurrent_partitions()
+        ipex._C._jit_set_llga_concurrent_partitions(2)
+        try:
+            graph, traced = self.checkTrace(m, [torch.randn(2, 8, 14, 14)])
+            launches = ipex._C._jit_llga_concurrent_launches()
+            with torch.no_grad():
+                for _ in range(3):
+                    x = torch.randn(2, 8, 14, 14)
+                    self.assertEqual(traced(x), m(x))
+            # the partitions ran on the sub-pools, not on the calling thread
+            self.assertTrue(ipex._C._jit_llga_concurrent_launches() - launches >= 3 * 2)
+        finally:
+            ipex._C._jit_set_llga_concurrent_partitions(num_pools)
+        self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 2)
+
+    @llga_fp32_bf16_test_env
+    def test_output_reuse(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv = nn.Conv2d(8, 8, 3, padding=1)
+
+            def forward(self, x):
+                return F.relu(self.conv(x))
+
+        m = M()
+        x1 = torch.randn(1, 8, 10, 10)
+        x2 = torch.randn(1, 8, 10, 10)
+        graph, traced = self.checkTrace(m, [x1])
+        self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 1)
+        self.assertFalse(ipex._C._jit_llga_output_reuse_enabled())
+        ipex._C._jit_set_llga_output_reuse_enabled(True)
+        try:
+            with torch.no_grad():
+                # an output still held is not overwritten by the next run
+                y1 = traced(x1)
+                y2 = traced(x2)
+                self.assertNotEqual(y1.data_ptr(), y2.data_ptr())
+                self.assertEqual(y1, m(x1))
+                self.assertEqual(y2, m(x2))
+                # a released output is reused by the next run
+                del y1, y2
+                y3 = traced(x1)
+                ptr = y3.data_ptr()
+                del y3
+                y4 = traced(x2)
+                self.assertEqual(y4.data_ptr(), ptr)
+                self.assertEqual(y4, m(x2))
+                # the output held by the caller is dropped from the cache
+                y5 = traced(x1)
+                self.assertNotEqual(y5.data_ptr(), y4.data_ptr())
+                self.assertEqual(y4, m(x2))
+                self.assertEqual(y5, m(x1))
+                # an output whose layout was changed in place is not reused
+                del y4, y5
+                y6 = traced(x1)
+                y6.transpose_(2, 3)
+                del y6
+                y7 = traced(x2)
+                y8 = traced(x1)
+                self.assertEqual(y7, m(x2))
+                self.assertEqual(y8, m(x1))
+            # the outputs of a run recording autograd history are not cached
+            x3 = x1.clone().requires_grad_()
+            y9 = traced(x3)
+            self.assertEqual(y9, m(x1))
+        finally:
+            ipex._C._jit_set_llga_output_reuse_enabled(False)
+
+    @llga_fp32_bf16_test_env
+    def test_training(self):
+        class M(nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.conv = nn.Conv2d(4, 8, 3, padding=1)
+                self.linear = nn.Linear(8 * 6 * 6, 10)
+
+            def forward(self, x):
+                x = F.relu(self.conv(x))
+                return torch.sigmoid(self.linear(x.flatten(1)))
+
+        m = M().train()
+        x = torch.randn(2, 4, 6, 6)
+        traced = torch.jit.trace(m, x)
+        for _ in range(3):
+            xi = x.clone().requires_grad_()
+            traced.zero_grad()
+            y_jit = traced(xi)
+            y_jit.sum().backward()
+        # the partitions stay fused and are differentiated by
+        # LlgaPartitionBackward
+        names, grad_fns = set(), [y_jit.grad_fn]
+        while grad_fns:
+            fn = grad_fns.pop()
+            if fn is not None:
+                names.add(fn.name())
+                grad_fns.extend(next_fn for next_fn, _ in fn.next_functions)
+        self.assertTrue("LlgaPartitionBackward" in names, names)
+        xr = x.clone().requires_grad_()
+        m.zero_grad()
+        y = m(xr)
+        y.sum().backward()
+        self.assertEqual(traced(x), y)
+        self.assertEqual(xi.grad, xr.grad)
+        for p, p_ref in zip(traced.parameters(), m.parameters()):
+            self.assertEqual(p.grad, p_ref.grad)
+
 class TestFusionPattern(JitLlgaTestCase):
     @llga_fp32_bf16_test_env
     def test_conv2d_eltwise(self):
@@ -758,7 +907,7 @@ class TestFusionPattern(JitLlgaTestCase):
             x = torch.rand(1, 32, 16, 16, requires_grad=False)
             y = torch.rand(1, 32, 16, 16, requires_grad=False)
             graph, _ = self.checkTrace(m, [x, y])
-            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 3)
+            self.assertGraphContainsExactly(graph, LLGA_FUSION_GROUP, 2)
 
     @llga_fp32_bf16_test_env
     def test_wildcard(self):
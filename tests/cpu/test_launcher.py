@@ -6,6 +6,7 @@ from intel_extension_for_pytorch.cpu.launch import *
 import os
 import glob
 import subprocess
+import tempfile
 
 class TestLauncher(TestCase):
     launch_scripts = [["python", "-m", "intel_extension_for_pytorch.cpu.launch"],
@@ -229,5 +230,52 @@ class TestLauncher(TestCase):
             assert r.returncode == 0
             assert expected_cores_proc1 in str(r.stdout, "utf-8")
             assert expected_cores_proc2 in str(r.stdout, "utf-8")
+
+    def test_weight_sharing_dir(self):
+        script = "\n".join([
+            "import torch",
+            "import intel_extension_for_pytorch as ipex",
+            "torch.manual_seed(0)",
+            "model = ipex.optimize(torch.nn.Conv2d(3, 8, 3).eval())",
+            "with torch.no_grad():",
+            "    print('conv sum: {:.4f}'.format(model(torch.ones(1, 3, 8, 8)).sum().item()))",
+            "with open('/proc/self/maps') as f:",
+            "    print('mapped: {}'.format(sum('ipex_packed_weight_' in l for l in f)))"])
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            share_dir = os.path.join(tmp_dir, "weights")
+            script_path = os.path.join(tmp_dir, "prepack.py")
+            with open(script_path, "w") as f:
+                f.write(script)
+
+            def run():
+                cmd = self.launch_scripts[0] + ["--ninstances", "1", "--weight_sharing_dir", share_dir, script_path]
+                r = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT)
+                assert r.returncode == 0
+                lines = str(r.stdout, "utf-8").split("\n")
+                return [l for l in lines if "conv sum" in l], [l for l in lines if "mapped" in l]
+
+            # the first run packs and stores the weight, the second one maps it
+            out0, mapped0 = run()
+            files = glob.glob(os.path.join(share_dir, "ipex_packed_weights_{}".format(os.geteuid()),
+                                           "ipex_packed_weight_*"))
+            assert len(files) == 1
+            user_dir = os.path.dirname(files[0])
+            assert os.stat(user_dir).st_mode & 0o777 == 0o700
+            inode = os.stat(files[0]).st_ino
+            out1, mapped1 = run()
+            assert len(out0) == 1
+            assert out0 == out1
+            assert mapped0 == ["mapped: 1"] and mapped1 == ["mapped: 1"]
+            # mapped from the existing file, not packed and stored again
+            assert os.stat(files[0]).st_ino == inode
+
+            # a file others can write is not mapped, but packed and stored again
+            os.chmod(files[0], 0o666)
+            out2, mapped2 = run()
+            assert out2 == out0
+            assert mapped2 == ["mapped: 1"]
+            assert os.stat(files[0]).st_ino != inode
+            assert os.stat(files[0]).st_mode & 0o777 == 0o600
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -1,4 +1,5 @@
 import unittest
+import copy
 
 import torch
 import intel_extension_for_pytorch as ipex
@@ -43,5 +44,65 @@ class LayerNormTester(TestCase):
                         self.assertEqual(y2_fp32.dtype, torch.float32)
                         self.assertEqual(y1_fp32, y2_fp32)
 
+    def test_layer_norm_mixed_dtype(self):
+        # bf16/fp16 input with float or reduced precision gamma/beta, hidden
+        # sizes covering both full vectors and a scalar tail.
+        for hidden in [768, 4099]:
+            for dtype in [torch.bfloat16, torch.half]:
+                for param_dtype in [torch.float, dtype]:
+                    x = (torch.randn(33, hidden) * 4 + 3).to(dtype)
+                    weight = torch.randn(hidden).to(param_dtype)
+                    bias = torch.randn(hidden).to(param_dtype)
+                    y_ref = torch.nn.functional.layer_norm(x.float(), [hidden], weight.float(), bias.float())
+                    with torch.no_grad():
+                        y = torch.nn.functional.layer_norm(
+                            x, [hidden], weight, bias)
+                    self.assertEqual(y.dtype, dtype)
+                    self.assertEqual(y.float(), y_ref, prec=5e-2)
+
+    def test_layer_norm_backward(self):
+        for shape, normalized_shape in [((8, 768), [768]), ((2, 7, 13), [7, 13]), ((4, 5, 33), [33])]:
+            for elementwise_affine in [True, False]:
+                x = torch.randn(shape, dtype=torch.double)
+                grad = torch.randn(shape, dtype=torch.double)
+                m = torch.nn.LayerNorm(normalized_shape, elementwise_affine=elementwise_affine)
+                if elementwise_affine:
+                    torch.nn.init.normal_(m.weight)
+                    torch.nn.init.normal_(m.bias)
+                m_ref = copy.deepcopy(m).double()
+
+                x1 = x.float().requires_grad_()
+                y = m(x1)
+                y.backward(grad.float())
+                x2 = x.clone().requires_grad_()
+                y_ref = m_ref(x2)
+                y_ref.backward(grad)
+
+                self.assertEqual(y, y_ref.float(), prec=1e-4)
+                self.assertEqual(x1.grad, x2.grad.float(), prec=1e-4)
+                if elementwise_affine:
+                    self.assertEqual(m.weight.grad, m_ref.weight.grad.float(), prec=1e-3)
+                    self.assertEqual(m.bias.grad, m_ref.bias.grad.float(), prec=1e-3)
+
+    def test_layer_norm_backward_bf16(self):
+        hidden = 1024
+        x = torch.randn(16, hidden)
+        grad = torch.randn(16, hidden)
+        m = torch.nn.LayerNorm(hidden)
+        m_bf16 = copy.deepcopy(m).bfloat16()
+
+        x1 = x.clone().requires_grad_()
+        m(x1).backward(grad)
+        x2 = x.bfloat16().requires_grad_()
+        y = m_bf16(x2)
+        y.backward(grad.bfloat16())
+
+        self.assertEqual(y.dtype, torch.bfloat16)
+        self.assertEqual(x2.grad.dtype, torch.bfloat16)
+        self.assertEqual(m_bf16.weight.grad.dtype, torch.bfloat16)
+        self.assertEqual(x2.grad.float(), x1.grad, prec=5e-2)
+        self.assertEqual(m_bf16.weight.grad.float(), m.weight.grad, prec=1e-1)
+        self.assertEqual(m_bf16.bias.grad.float(), m.bias.grad, prec=1e-1)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -186,6 +186,41 @@ class TestNMS(TestCase):
         self.assertEqual(output2_raw_double, output2_raw)
         self.assertTrue(output2_raw_double[0].dtype == torch.float64)
 
+    def test_batch_nms_multi_batch(self):
+        criteria = 0.50
+        max_output = 200
+        predicted_loc = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_ploc.pt")) # sizes: [1, 15130, 4]
+        predicted_score = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_plabel.pt")) # sizes: [1, 15130, 81]
+        dboxes_xywh = torch.load(os.path.join(os.path.dirname(__file__), "data/nms_dboxes_xywh.pt"))
+        bboxes, probs = parallel_scale_back_batch(predicted_loc, predicted_score, dboxes_xywh, 0.1, 0.2)
+        output_single = batch_score_nms(bboxes.clone(), probs.clone(), criteria, max_output)
+        # The second image keeps less boxes than max_output
+        probs_low = probs.clone()
+        probs_low[:, :, 2:] = 0
+        output_low = batch_score_nms(bboxes.clone(), probs_low.clone(), criteria, max_output)
+        output_batch = batch_score_nms(
+            torch.cat((bboxes, bboxes, bboxes)), torch.cat((probs, probs_low, probs)), criteria, max_output)
+
+        self.assertEqual(output_batch[3], torch.cat((output_single[3], output_low[3], output_single[3])))
+        for i in range(3):
+            self.assertEqual(output_batch[i], torch.cat((output_single[i], output_low[i], output_single[i])))
+
+    def test_batch_nms_non_positive_threshold(self):
+        # IoU >= 0 holds for any pair of boxes, only the best box of each
+        # class is kept
+        bboxes = torch.tensor([[[0.0, 0.0, 0.1, 0.1],
+                                [0.5, 0.5, 0.6, 0.6],
+                                [0.2, 0.2, 0.3, 0.3]]])
+        probs = torch.tensor([[[0.0, 0.9],
+                               [0.0, 0.8],
+                               [0.0, 0.7]]])
+        output = batch_score_nms(bboxes, probs, 0.5, 200)
+        self.assertEqual(output[3].tolist(), [3])
+        output = batch_score_nms(bboxes, probs, 0.0, 200)
+        self.assertEqual(output[3].tolist(), [1])
+        self.assertEqual(output[0], bboxes[0, :1])
+        self.assertEqual(output[2], torch.tensor([0.9]))
+
     def test_jit_trace_batch_nms(self):
         class Batch_NMS(nn.Module):
             def __init__(self, criteria, max_output):
@@ -283,6 +318,46 @@ class TestNMS(TestCase):
                 result_double = nms(loc.clone().double(), score.clone().double(), criteria, False)
                 self.assertEqual(result_double, result_ref)
 
+    def greedy_nms(self, dets, scores, threshold, bias=1.0):
+        """
+            Serial greedy NMS used as the reference of the blocked NMS kernel.
+        """
+        order = scores.sort(0, descending=True)[1]
+        x1, y1, x2, y2 = dets.unbind(1)
+        areas = (x2 - x1 + bias) * (y2 - y1 + bias)
+        suppressed = torch.zeros(dets.size(0), dtype=torch.bool)
+        for _i in range(order.size(0)):
+            i = order[_i]
+            if suppressed[i]:
+                continue
+            rest = order[_i + 1:]
+            w = (torch.min(x2[i], x2[rest]) - torch.max(x1[i], x1[rest]) + bias).clamp(min=0)
+            h = (torch.min(y2[i], y2[rest]) - torch.max(y1[i], y1[rest]) + bias).clamp(min=0)
+            inter = w * h
+            ovr = inter / (areas[i] + areas[rest] - inter)
+            suppressed[rest[ovr >= threshold]] = True
+        return torch.nonzero(~suppressed).squeeze(1)
+
+    def test_nms_large_number_of_boxes(self):
+        # Cover several blocks of the blocked NMS kernel and a tail block.
+        torch.manual_seed(0)
+        ndets = 5000
+        xy = torch.rand(ndets, 2) * 800
+        wh = torch.rand(ndets, 2) * 100 + 1
+        dets = torch.cat((xy, xy + wh), dim=1)
+        scores = torch.rand(ndets)
+        for criteria in (0.3, 0.7):
+            result_ref = self.greedy_nms(dets, scores, criteria)
+            self.assertEqual(nms(dets, scores, criteria, False), result_ref)
+
+            scores_sorted, indices = torch.sort(scores, descending=True)
+            dets_sorted = dets.index_select(0, indices)
+            result_sorted = nms(dets_sorted, scores_sorted, criteria, True)
+            self.assertEqual(indices[result_sorted].sort()[0], result_ref)
+
+            result_double = nms(dets.double(), scores.double(), criteria, False)
+            self.assertEqual(result_double, result_ref)
+
     def test_rpn_nms_result(self):
         image_shapes = [(800, 824), (800, 1199)]
         min_size = 0
@@ -0,0 +1,78 @@
+import re
+import unittest
+
+import torch
+import intel_extension_for_pytorch as ipex
+from intel_extension_for_pytorch.utils import op_counters
+from common_utils import TestCase
+
+
+def parse_prometheus(text):
+    samples = {}
+    for line in text.splitlines():
+        if line.startswith("#"):
+            continue
+        m = re.match(r'(\w+)\{(.*)\} (\S+)$', line)
+        assert m, "malformed sample: " + line
+        labels = tuple(re.findall(r'(\w+)="([^"]*)"', m.group(2)))
+        samples[(m.group(1), labels)] = float(m.group(3))
+    return samples
+
+
+class TestOpCounters(TestCase):
+    def setUp(self):
+        self.enabled = op_counters.op_counters_enabled()
+        op_counters.enable_op_counters(True)
+        op_counters.reset_op_counters()
+
+    def tearDown(self):
+        op_counters.enable_op_counters(self.enabled)
+
+    def test_dispatch_stub_counters(self):
+        x = torch.randn(17, 33)
+        for _ in range(3):
+            torch.ops.torch_ipex.cumsum(x, 1)
+        samples = parse_prometheus(op_counters.op_counters_prometheus())
+        op = ("op", "torch_ipex::cumsum_kernel_stub")
+        self.assertEqual(samples[("ipex_op_latency_seconds_count", (op,))], 3)
+        self.assertEqual(
+            samples[("ipex_op_latency_seconds_bucket", (op, ("le", "+Inf")))], 3
+        )
+        self.assertGreater(samples[("ipex_op_latency_seconds_sum", (op,))], 0)
+        # the buckets are cumulative
+        buckets = [
+            v
+            for (name, labels), v in samples.items()
+            if name == "ipex_op_latency_seconds_bucket" and labels[0] == op
+        ]
+        self.assertEqual(buckets, sorted(buckets))
+
+        op_counters.reset_op_counters()
+        samples = parse_prometheus(op_counters.op_counters_prometheus())
+        self.assertFalse(("ipex_op_latency_seconds_count", (op,)) in samples)
+
+        op_counters.enable_op_counters(False)
+        torch.ops.torch_ipex.cumsum(x, 1)
+        samples = parse_prometheus(op_counters.op_counters_prometheus())
+        self.assertFalse(("ipex_op_latency_seconds_count", (op,)) in samples)
+
+    def test_prepacked_conv_counters(self):
+        model = torch.nn.Conv2d(8, 16, kernel_size=3, padding=1).eval()
+        ipex_model = ipex.optimize(model, dtype=torch.float, level="O1")
+        x = torch.randn(2, 8, 10, 10)
+        with torch.no_grad():
+            y = ipex_model(x)
+            ipex_model(x)
+        samples = parse_prometheus(op_counters.op_counters_prometheus())
+        op = ("op", "ipex_prepack::convolution_run")
+        self.assertEqual(samples[("ipex_op_latency_seconds_count", (op,))], 2)
+        flops = 2 * y.numel() * 8 * 3 * 3
+        self.assertEqual(samples[("ipex_op_flops_total", (op,))], 2 * flops)
+        self.assertGreater(
+            samples[("ipex_op_bytes_total", (op,))],
+            2 * (x.numel() + y.numel()) * 4,
+        )
+
+
+if __name__ == "__main__":
+    test = unittest.main()
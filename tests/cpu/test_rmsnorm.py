@@ -15,6 +15,20 @@ class RMSNorm(nn.Module):
         hidden_states = hidden_states * torch.rsqrt(variance + self.variance_epsilon)
         return self.weight * hidden_states
 
+class AddRMSNorm(nn.Module):
+    def __init__(self, hidden_size, eps=1e-6):
+        super().__init__()
+        self.norm = RMSNorm(hidden_size, eps)
+
+    def forward(self, hidden_states, residual):
+        residual = residual + hidden_states
+        return self.norm(residual), residual
+
+def add_rmsnorm_ref(x, residual, weight, eps):
+    s = (x.float() + residual.float())
+    variance = s.pow(2).mean(-1, keepdim=True)
+    return s * torch.rsqrt(variance + eps) * weight.float(), s
+
 class RMSNormTester(TestCase):
     def test_RMSNorm(self):
         for dim in [2,3,4,5]:
@@ -34,5 +48,47 @@ class RMSNormTester(TestCase):
                 self.assertEqual(y1_fp32, y2_fp32)
                 self.assertTrue(any(n.kind() == "ipex::RMSNorm" for n in rmsnorm_graph.nodes()))
 
+    def test_add_RMSNorm_fusion(self):
+        with torch.no_grad():
+            x = torch.randn(2, 7, 64)
+            residual = torch.randn(2, 7, 64)
+            model = AddRMSNorm(64).eval()
+            model.norm.weight.data = torch.randn(64)
+            trace_model = torch.jit.freeze(torch.jit.trace(model, (x, residual)))
+            for _ in range(2):
+                y, r = trace_model(x, residual)
+            y_ref, r_ref = model(x, residual)
+            graph = trace_model.graph_for(x, residual)
+            self.assertTrue(any(n.kind() == "ipex::add_RMSNorm" for n in graph.nodes()))
+            self.assertEqual(y, y_ref)
+            self.assertEqual(r, r_ref)
+
+    def test_add_rmsnorm(self):
+        for dtype, prec in [(torch.float, 1e-5), (torch.bfloat16, 2e-2), (torch.half, 2e-3)]:
+            for size in [[1, 15], [3, 64], [2, 5, 4099]]:
+                x = torch.randn(size).to(dtype)
+                residual = torch.randn(size).to(dtype)
+                weight = torch.randn(size[-1])
+                y_ref, s_ref = add_rmsnorm_ref(x, residual, weight, 1e-6)
+                y, s = torch.ops.torch_ipex.add_rmsnorm(x, residual, weight, 1e-6)
+                self.assertEqual(y.dtype, dtype)
+                self.assertEqual(s.dtype, dtype)
+                self.assertEqual(s, s_ref.to(dtype), rtol=prec, atol=prec)
+                self.assertEqual(y.float(), y_ref, rtol=prec * 2, atol=prec * 2)
+
+    def test_add_rmsnorm_quant(self):
+        for dtype in [torch.float, torch.bfloat16]:
+            x = torch.randn(4, 3, 256).to(dtype)
+            residual = torch.randn(4, 3, 256).to(dtype)
+            weight = torch.randn(256)
+            y_ref, s_ref = add_rmsnorm_ref(x, residual, weight, 1e-6)
+            q, scales, s = torch.ops.torch_ipex.add_rmsnorm_quant(x, residual, weight, 1e-6)
+            self.assertEqual(q.dtype, torch.int8)
+            self.assertEqual(scales.shape, torch.Size([4, 3]))
+            self.assertEqual(s, s_ref.to(dtype))
+            # per-token symmetric quantization
+            self.assertEqual(scales, y_ref.abs().amax(-1) / 127, rtol=2e-2, atol=1e-5)
+            self.assertEqual(q.float() * scales.unsqueeze(-1), y_ref, rtol=0, atol=(scales.max() * 1.01).item())
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -171,5 +171,54 @@ class TestRNNTEmbedding(TestCase):
 
             self.assertEqual(y_embed_org, y_embed)
 
+class TestRNNTGreedyDecode(TestCase):
+    def _test_org(self, x, out_lens, embedding, lstm, fc1, fc2, max_symbols, blank_id):
+        # unbatched greedy decoding, one sequence at a time
+        labels = []
+        for b in range(x.size(1)):
+            label = []
+            hidden = None
+            last = self._SOS
+            for t in range(out_lens[b]):
+                for _ in range(max_symbols):
+                    y = torch.tensor([[max(last, 0)]])
+                    g = embedding(y) * (0 if last == self._SOS else 1)
+                    g, hidden_prime = lstm(g, hidden)
+                    joint = fc2(torch.relu(fc1(torch.cat((x[t, b:b + 1], g[:, 0]), dim=1))))
+                    k = joint.argmax(1).item()
+                    if k == blank_id:
+                        break
+                    label.append(k)
+                    last = k
+                    hidden = hidden_prime
+            labels.append(label)
+        return labels
+
+    def test_rnnt_greedy_decode(self):
+        self._SOS = -1
+        vocab_size, pred_n_hidden, enc_n_hidden, joint_n_hidden = 29, 32, 24, 48
+        blank_id = vocab_size - 1
+        max_symbols = 3
+        torch.manual_seed(0)
+        embedding = torch.nn.Embedding(vocab_size - 1, pred_n_hidden)
+        lstm = torch.nn.LSTM(pred_n_hidden, pred_n_hidden, num_layers=2, batch_first=True)
+        fc1 = torch.nn.Linear(enc_n_hidden + pred_n_hidden, joint_n_hidden)
+        fc2 = torch.nn.Linear(joint_n_hidden, vocab_size)
+        with torch.no_grad():
+            # make blank frequent enough to exercise both branches
+            fc2.bias[blank_id] += 1.0
+            for batch_size in [1, 5, 16]:
+                x = torch.randn(12, batch_size, enc_n_hidden)
+                out_lens = torch.randint(1, 13, (batch_size,), dtype=torch.int)
+                labels_org = self._test_org(x, out_lens, embedding, lstm, fc1, fc2, max_symbols, blank_id)
+                label_tensor, label_len, step_latency = torch.ops.torch_ipex.rnnt_greedy_decode(
+                    x, out_lens, embedding.weight, list(lstm._flat_weights),
+                    fc1.weight, fc1.bias, fc2.weight, fc2.bias,
+                    max_symbols, blank_id, self._SOS)
+                self.assertTrue(step_latency.numel() > 0)
+                for b in range(batch_size):
+                    self.assertEqual(label_len[b].item(), len(labels_org[b]))
+                    self.assertEqual(label_tensor[b, 1:1 + label_len[b]].tolist(), labels_org[b])
+
 if __name__ == '__main__':
     test = unittest.main()
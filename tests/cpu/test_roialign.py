@@ -156,6 +156,45 @@ class RoIAlignTester(TestCase):
             self.assertTrue(x4.grad.dtype == torch.bfloat16)
             self.assertTrue(torch.allclose(gt_x.grad.to(x4.dtype), x4.grad, rtol=1e-5, atol=1e-5))
 
+    def test_roialign_unbalanced_rois(self):
+        # ROIs of very different sizes go through the ROI-batch scheduler
+        torch.manual_seed(0)
+        x = torch.rand(2, 16, 64, 64)
+        xy = torch.rand(64, 2) * 32
+        wh = torch.cat((torch.rand(60, 2) * 2, torch.rand(4, 2) * 32 + 16))
+        rois = torch.cat((torch.randint(0, 2, (64, 1)).float(), xy, xy + wh), dim=1)
+        for num_threads in [1, 3, torch.get_num_threads()]:
+            with torch.no_grad():
+                torch.set_num_threads(num_threads)
+                y0 = fn(x, rois, 7, 7, spatial_scale=0.5, sampling_ratio=-1)
+                y1 = fn(x.to(memory_format=torch.channels_last), rois, 7, 7, spatial_scale=0.5, sampling_ratio=-1)
+                y2 = fn(x.double(), rois.double(), 7, 7, spatial_scale=0.5, sampling_ratio=-1)
+            self.assertTrue(torch.allclose(y0, y1, rtol=1e-5, atol=1e-5))
+            self.assertTrue(torch.allclose(y0, y2.float(), rtol=1e-5, atol=1e-5))
+
+    def test_qroialign(self):
+        x = torch.rand(2, 50, 10, 10)
+        rois = torch.tensor([[0, 0, 0, 9, 9],
+                             [0, 0, 5, 4, 9],
+                             [0, 5, 5, 9, 9],
+                             [1, 0, 0, 9, 9]],
+                            dtype=torch.float)
+        o_scale = 0.01
+        for in_dtype, o_dtype, o_zp in itertools.product(
+                [torch.qint8, torch.quint8], [torch.qint8, torch.quint8], [0, 10]):
+            in_zp = 0 if in_dtype == torch.qint8 else 128
+            qx = torch.quantize_per_tensor(x, 0.01, in_zp, in_dtype)
+            for memory_format in [torch.contiguous_format, torch.channels_last]:
+                qx_ = qx.contiguous(memory_format=memory_format)
+                with torch.no_grad():
+                    y_ref = torch.quantize_per_tensor(
+                        fn(qx_.dequantize(), rois, 5, 5, spatial_scale=1, sampling_ratio=-1), o_scale, o_zp, o_dtype)
+                y = torch.ops.ipex.qroi_align(qx_, rois, 1.0, 5, 5, -1, False, o_scale, o_zp, o_dtype)
+                self.assertTrue(y.dtype == o_dtype)
+                self.assertTrue(y.is_contiguous(memory_format=torch.channels_last))
+                # allow one quantization step difference due to the fused requantization
+                self.assertTrue(torch.allclose(y.dequantize(), y_ref.dequantize(), rtol=0, atol=o_scale * 1.01))
+
     @skipIfNoTorchVision
     def test_torchvision_roialign(self):
         pool_size = 5
@@ -167,6 +167,37 @@ class IPEXMatmulDiv(nn.Module):
     def forward(self, x1, x2, x3):
         return torch.matmul(x1, x2) / x3 + x3
 
+class IPEXBmmAdd(nn.Module):
+    def __init__(self):
+        super(IPEXBmmAdd, self).__init__()
+
+    def forward(self, input, batch1, batch2):
+        return torch.tanh(torch.bmm(batch1, batch2) + input)
+
+class IPEXMhaScoresCalc(nn.Module):
+    def __init__(self, dim_per_head):
+        super(IPEXMhaScoresCalc, self).__init__()
+        self.dim_per_head = dim_per_head
+
+    def forward(self, q, k, rel_qk):
+        scores = torch.matmul(q, k.transpose(-1, -2)) / self.dim_per_head
+        return torch.tanh(nn.functional.softmax(scores + rel_qk, dim=-1))
+
+class IPEXSoftmax(nn.Module):
+    def __init__(self):
+        super(IPEXSoftmax, self).__init__()
+
+    def forward(self, a, b):
+        return torch.tanh(nn.functional.softmax(a + b, dim=-1))
+
+class IPEXAddLayerNorm(nn.Module):
+    def __init__(self, hidden_size):
+        super(IPEXAddLayerNorm, self).__init__()
+        self.layernorm = nn.LayerNorm(hidden_size)
+
+    def forward(self, a, b):
+        return torch.tanh(self.layernorm(a + b))
+
 class TestTE(JitTestCase):
     def test_ipex_unary_conv_fusion(self, op_list=unary_PyTorch_op_to_IPEX_op_map):
         old = torch._C._debug_get_fusion_group_inlining()
@@ -360,6 +391,61 @@ class TestTE(JitTestCase):
         res_imperative = te_matmul_div(x1, x2, x3)
         self.assertEqual(res_jit, res_imperative)
 
+    def _test_ipex_custom_op_nnc(self, model, inputs, ipex_op):
+        # The models end with a pointwise op so that the IPEX op has something
+        # to fuse with and forms a TensorExprGroup.
+        old_can_fuse_on_cpu = torch._C._jit_can_fuse_on_cpu()
+        torch._C._jit_override_can_fuse_on_cpu(True)
+        ipex._C.enable_custom_op_2_nnc_fuser()
+        try:
+            with torch.no_grad():
+                model_traced = torch.jit.trace(model.eval(), inputs)
+                model_traced = torch.jit.freeze(model_traced)
+                for _ in range(3):
+                    model_traced(*inputs)
+                res_jit = model_traced(*inputs)
+                res_imperative = model(*inputs)
+                graph = model_traced.graph_for(*inputs)
+        finally:
+            ipex._C.disable_custom_op_2_nnc_fuser()
+            torch._C._jit_override_can_fuse_on_cpu(old_can_fuse_on_cpu)
+        self.assertEqual(res_jit, res_imperative, rtol=1e-4, atol=1e-4)
+        te_groups = graph.findAllNodes("prim::TensorExprGroup")
+        self.assertTrue(len(te_groups) > 0, str(graph))
+        self.assertTrue(
+            any(g.g("Subgraph").findNode(ipex_op) is not None for g in te_groups),
+            "{} is not in a TensorExprGroup: {}".format(ipex_op, graph))
+
+    def test_ipex_bmm_add(self):
+        rand_seed = int(get_rand_seed())
+        torch.manual_seed(rand_seed)
+        input = torch.randn(4, 8, 16)
+        batch1 = torch.randn(4, 8, 32)
+        batch2 = torch.randn(4, 32, 16)
+        self._test_ipex_custom_op_nnc(IPEXBmmAdd(), (input, batch1, batch2), "ipex::bmm_add")
+
+    def test_ipex_mha_scores_calc(self):
+        rand_seed = int(get_rand_seed())
+        torch.manual_seed(rand_seed)
+        q = torch.randn(2, 4, 16, 8)
+        k = torch.randn(2, 4, 16, 8)
+        rel_qk = torch.randn(2, 4, 16, 16)
+        self._test_ipex_custom_op_nnc(IPEXMhaScoresCalc(8.0), (q, k, rel_qk), "ipex::mha_scores_calc")
+
+    def test_ipex_add_layernorm(self):
+        rand_seed = int(get_rand_seed())
+        torch.manual_seed(rand_seed)
+        a = torch.randn(2, 16, 64)
+        b = torch.randn(2, 16, 64)
+        self._test_ipex_custom_op_nnc(IPEXAddLayerNorm(64), (a, b), "ipex::add_layernorm")
+
+    def test_ipex_softmax(self):
+        rand_seed = int(get_rand_seed())
+        torch.manual_seed(rand_seed)
+        a = torch.randn(2, 4, 16, 16)
+        b = torch.randn(2, 4, 16, 16)
+        self._test_ipex_custom_op_nnc(IPEXSoftmax(), (a, b), "ipex::softmax")
+
     def test_ipex_unary_linear_fusion(self, op_list=unary_PyTorch_op_to_IPEX_op_map):
         old = torch._C._debug_get_fusion_group_inlining()
         torch._C._debug_set_fusion_group_inlining(False)
@@ -39,6 +39,83 @@ class Config():
         torch.manual_seed(seed)
         torch_ipex_cpp.xsmm_manual_seed(seed)
 
+class DecoderConfig():
+    def __init__(self):
+        self.hidden_size = 256
+        self.intermediate_size = 688
+        self.num_attention_heads = 4
+        self.max_position_embeddings = 64
+        self.rms_norm_eps = 1e-6
+        self.hidden_act = 'silu'
+
+class RefRMSNorm(nn.Module):
+    def __init__(self, hidden_size, eps):
+        super().__init__()
+        self.weight = nn.Parameter(torch.randn(hidden_size))
+        self.variance_epsilon = eps
+
+    def forward(self, x):
+        variance = x.pow(2).mean(-1, keepdim=True)
+        return self.weight * x * torch.rsqrt(variance + self.variance_epsilon)
+
+class RefDecoderLayer(nn.Module):
+    # LLaMA style decoder layer with the parameter names of transformers
+    def __init__(self, config):
+        super().__init__()
+        H = config.hidden_size
+        self.num_heads = config.num_attention_heads
+        self.head_dim = H // self.num_heads
+        self.self_attn = nn.Module()
+        for name in ['q_proj', 'k_proj', 'v_proj', 'o_proj']:
+            setattr(self.self_attn, name, nn.Linear(H, H, bias=False))
+        self.mlp = nn.Module()
+        self.mlp.gate_proj = nn.Linear(H, config.intermediate_size, bias=False)
+        self.mlp.up_proj = nn.Linear(H, config.intermediate_size, bias=False)
+        self.mlp.down_proj = nn.Linear(config.intermediate_size, H, bias=False)
+        self.input_layernorm = RefRMSNorm(H, config.rms_norm_eps)
+        self.post_attention_layernorm = RefRMSNorm(H, config.rms_norm_eps)
+
+    def rope(self, x, pos):
+        inv_freq = 1.0 / (10000 ** (torch.arange(0, self.head_dim, 2).float() / self.head_dim))
+        freqs = torch.outer(pos.float(), inv_freq)
+        emb = torch.cat((freqs, freqs), dim=-1)
+        x1, x2 = x[..., :self.head_dim // 2], x[..., self.head_dim // 2:]
+        return x * emb.cos() + torch.cat((-x2, x1), dim=-1) * emb.sin()
+
+    def forward(self, x, past=None, key_mask=None):
+        # key_mask: optional additive [B, P + S] mask of the padded keys
+        B, S, H = x.shape
+        P = past[0].size(2) if past is not None else 0
+        pos = torch.arange(P, P + S)
+        h = self.input_layernorm(x)
+        q, k, v = [getattr(self.self_attn, name)(h).view(B, S, self.num_heads, -1).transpose(1, 2)
+                   for name in ['q_proj', 'k_proj', 'v_proj']]
+        q, k = self.rope(q, pos), self.rope(k, pos)
+        if past is not None:
+            k = torch.cat([past[0], k], dim=2)
+            v = torch.cat([past[1], v], dim=2)
+        scores = torch.matmul(q, k.transpose(-1, -2)) / (self.head_dim ** 0.5)
+        causal = torch.ones(S, P + S).tril(P).bool()
+        scores = scores.masked_fill(~causal, float('-inf'))
+        if key_mask is not None:
+            scores = scores + key_mask[:, None, None, :]
+        attn = torch.matmul(scores.softmax(-1), v).transpose(1, 2).reshape(B, S, H)
+        x = x + self.self_attn.o_proj(attn)
+        h = self.post_attention_layernorm(x)
+        x = x + self.mlp.down_proj(F.silu(self.mlp.gate_proj(h)) * self.mlp.up_proj(h))
+        return x, (k, v)
+
+class RefDecoderModel(nn.Module):
+    def __init__(self, config, num_layers=2):
+        super().__init__()
+        self.config = config
+        self.layers = nn.ModuleList([RefDecoderLayer(config) for _ in range(num_layers)])
+
+    def forward(self, x):
+        for layer in self.layers:
+            x = layer(x)[0]
+        return x
+
 class TPPOPsTester(TestCase):
     def setUp(self):
         self.config = Config()
@@ -107,6 +184,23 @@ class TPPOPsTester(TestCase):
         self.assertEqual(hf_res, tpp_res, prec=0.0002)  
         self._test_backward(hf_res, tpp_res, hf_self_att, tpp_self_att, prec=0.005)
 
+    def test_tpp_bert_self_attention_inference(self):
+        # eval without attention output takes the online softmax path which
+        # does not materialize the attention probabilities
+        ipex.tpp.fused_bert.unpad = False
+        hf_self_att = transformers.models.bert.modeling_bert.BertSelfAttention(self.config).eval()
+        tpp_self_att = ipex.tpp.fused_bert.BertSelfAttention(self.config).eval()
+        tpp_self_att.load_state_dict(hf_self_att.state_dict())
+        hidden_states = torch.randn(self.batch, self.max_seq_len, self.config.hidden_size)
+        _, tpp_att_mask, seq_offsets, seq_spr_offsets = \
+            ipex.tpp.fused_bert.generate_mask(self.attention_mask)
+        with torch.no_grad():
+            hf_res = hf_self_att(hidden_states, self.attention_mask)[0]
+            tpp_res = tpp_self_att(hidden_states.view(self.batch * self.max_seq_len, self.config.hidden_size), \
+                tpp_att_mask, seq_offsets=seq_offsets, \
+                seq_sqr_offsets=seq_spr_offsets)[0].unblocked_tensor().view(self.batch, self.max_seq_len, -1)
+        self.assertEqual(hf_res, tpp_res, prec=0.0002)
+
     def test_tpp_bert_output(self):
         hf_self_out = transformers.models.bert.modeling_bert.BertSelfOutput(self.config)
         tpp_self_out = ipex.tpp.fused_bert.BertSelfOutput(self.config)
@@ -131,5 +225,160 @@ class TPPOPsTester(TestCase):
         self.assertEqual(hf_res, tpp_res, prec=0.001)    
         self._test_backward(hf_res, tpp_res, hf_intermediate, tpp_intermediate, prec=0.01)
 
+    def test_tpp_decoder_layer(self):
+        config = DecoderConfig()
+        ref_layer = RefDecoderLayer(config)
+        ipex.tpp.fused_decoder.layer_use_bf16 = False
+        tpp_layer = ipex.tpp.fused_decoder.DecoderLayer(config).eval()
+        self.assertTrue(ipex.tpp.fused_decoder.is_supported_decoder_layer(ref_layer, config))
+        tpp_layer.load_state_dict(ref_layer.state_dict())
+        with torch.no_grad():
+            # prefill with more keys than one attention block, then one step
+            x = torch.randn(2, 80, config.hidden_size)
+            ref_res, ref_past = ref_layer(x)
+            tpp_res, tpp_past = tpp_layer(x, use_cache=True)
+            self.assertEqual(ref_res, tpp_res, prec=0.001)
+            self.assertEqual(ref_past[0], tpp_past[0], prec=0.001)
+            self.assertEqual(ref_past[1], tpp_past[1], prec=0.001)
+            x = torch.randn(2, 1, config.hidden_size)
+            ref_res, _ = ref_layer(x, ref_past)
+            tpp_res, _ = tpp_layer(x, past_key_value=tpp_past, use_cache=True)
+            self.assertEqual(ref_res, tpp_res, prec=0.001)
+
+    def test_tpp_decoder_layer_kv_cache(self):
+        config = DecoderConfig()
+        ref_layer = RefDecoderLayer(config)
+        ipex.tpp.fused_decoder.layer_use_bf16 = False
+        tpp_layer = ipex.tpp.fused_decoder.DecoderLayer(config).eval()
+        tpp_layer.load_state_dict(ref_layer.state_dict())
+        with torch.no_grad():
+            x = torch.randn(2, 40, config.hidden_size)
+            _, ref_past = ref_layer(x)
+            _, tpp_past = tpp_layer(x, use_cache=True)
+            prefix_ref, prefix_tpp = ref_past, tpp_past
+            # the decode steps cross key blocks and outgrow the buffers once
+            data_ptrs = set()
+            for _ in range(100):
+                x = torch.randn(2, 1, config.hidden_size)
+                ref_res, ref_past = ref_layer(x, ref_past)
+                tpp_res, tpp_past = tpp_layer(x, past_key_value=tpp_past, use_cache=True)
+                self.assertEqual(ref_res, tpp_res, prec=0.001)
+                data_ptrs.add(tpp_past[0].data_ptr())
+            self.assertEqual(ref_past[0], tpp_past[0], prec=0.001)
+            self.assertEqual(ref_past[1], tpp_past[1], prec=0.001)
+            self.assertEqual(len(data_ptrs), 2)
+            # the buffers of the prefix were appended to, so the continuations
+            # from it copy them and keep the longer cache intact
+            for _ in range(2):
+                x = torch.randn(2, 3, config.hidden_size)
+                ref_res, _ = ref_layer(x, prefix_ref)
+                tpp_res, _ = tpp_layer(x, past_key_value=prefix_tpp, use_cache=True)
+                self.assertEqual(ref_res, tpp_res, prec=0.001)
+            self.assertEqual(ref_past[0], tpp_past[0], prec=0.001)
+            # a plain (key, value) tuple, e.g. after reordering the beams
+            x = torch.randn(2, 1, config.hidden_size)
+            ref_res, _ = ref_layer(x, ref_past)
+            tpp_res, _ = tpp_layer(
+                x, past_key_value=(tpp_past[0].clone(), tpp_past[1].clone()), use_cache=True)
+            self.assertEqual(ref_res, tpp_res, prec=0.001)
+
+    def _get_padding_masks(self, B, S, P, pad):
+        # 2D [B, P + S] padding mask and the 4D [B, 1, S, P + S] causal mask
+        # built from it, with the first `pad` keys of the last sequence padded
+        T = P + S
+        mask_2d = torch.ones(B, T)
+        mask_2d[-1, :pad] = 0
+        key_mask = (1.0 - mask_2d) * torch.finfo(torch.float).min
+        causal = torch.ones(S, T).tril(P).bool()
+        mask_4d = torch.zeros(B, 1, S, T)
+        mask_4d.masked_fill_(~causal, torch.finfo(torch.float).min)
+        mask_4d.masked_fill_(mask_2d[:, None, None, :] == 0, torch.finfo(torch.float).min)
+        return mask_2d, mask_4d, key_mask
+
+    def test_tpp_decoder_layer_attention_mask(self):
+        config = DecoderConfig()
+        ref_layer = RefDecoderLayer(config)
+        ipex.tpp.fused_decoder.layer_use_bf16 = False
+        tpp_layer = ipex.tpp.fused_decoder.DecoderLayer(config).eval()
+        tpp_layer.load_state_dict(ref_layer.state_dict())
+        B, S, pad = 2, 80, 3
+        with torch.no_grad():
+            for use_4d in [False, True]:
+                x = torch.randn(B, S, config.hidden_size)
+                mask_2d, mask_4d, key_mask = self._get_padding_masks(B, S, 0, pad)
+                ref_res, ref_past = ref_layer(x, key_mask=key_mask)
+                tpp_res, tpp_past = tpp_layer(
+                    x, attention_mask=mask_4d if use_4d else mask_2d, use_cache=True)
+                # the queries of the padded tokens are not compared
+                self.assertEqual(ref_res[0], tpp_res[0], prec=0.001)
+                self.assertEqual(ref_res[1, pad:], tpp_res[1, pad:], prec=0.001)
+                self.assertEqual(ref_past[0], tpp_past[0], prec=0.001)
+                self.assertEqual(ref_past[1], tpp_past[1], prec=0.001)
+                x = torch.randn(B, 1, config.hidden_size)
+                mask_2d, mask_4d, key_mask = self._get_padding_masks(B, 1, S, pad)
+                ref_res, _ = ref_layer(x, ref_past, key_mask=key_mask)
+                tpp_res, _ = tpp_layer(
+                    x, attention_mask=mask_4d if use_4d else mask_2d,
+                    past_key_value=tpp_past, use_cache=True)
+                self.assertEqual(ref_res, tpp_res, prec=0.001)
+
+    def test_tpp_decoder_layer_bf16(self):
+        # bf16 runs with the weights blocked in VNNI pairs
+        config = DecoderConfig()
+        ref_layer = RefDecoderLayer(config)
+        ipex.tpp.fused_decoder.layer_use_bf16 = True
+        try:
+            tpp_layer = ipex.tpp.fused_decoder.DecoderLayer(config).eval()
+        finally:
+            ipex.tpp.fused_decoder.layer_use_bf16 = False
+        tpp_layer.load_state_dict(ref_layer.state_dict())
+        with torch.no_grad():
+            x = torch.randn(2, 80, config.hidden_size)
+            ref_res, ref_past = ref_layer(x)
+            tpp_res, tpp_past = tpp_layer(x, use_cache=True)
+            self.assertEqual(tpp_res.dtype, torch.float)
+            self.assertEqual(tpp_past[0].dtype, torch.bfloat16)
+            self.assertEqual(ref_res, tpp_res, prec=0.1)
+            self.assertEqual(ref_past[0], tpp_past[0].float(), prec=0.05)
+            self.assertEqual(ref_past[1], tpp_past[1].float(), prec=0.05)
+            x = torch.randn(2, 1, config.hidden_size)
+            ref_res, _ = ref_layer(x, ref_past)
+            tpp_res, _ = tpp_layer(x, past_key_value=tpp_past, use_cache=True)
+            self.assertEqual(ref_res, tpp_res, prec=0.1)
+
+    def test_fast_decoder(self):
+        config = DecoderConfig()
+        model = RefDecoderModel(config).eval()
+        x = torch.randn(2, 16, config.hidden_size)
+        for dtype, prec in [(torch.float, 0.001), (torch.bfloat16, 0.2)]:
+            opt_model = ipex.fast_decoder(model, dtype=dtype)
+            self.assertIsNot(opt_model, model)
+            self.assertTrue(all(isinstance(layer, ipex.tpp.fused_decoder.DecoderLayer)
+                                for layer in opt_model.layers))
+            self.assertTrue(all(isinstance(layer, RefDecoderLayer) for layer in model.layers))
+            with torch.no_grad():
+                self.assertEqual(model(x), opt_model(x), prec=prec)
+        ipex.tpp.fused_decoder.layer_use_bf16 = False
+
+    def test_fast_decoder_unsupported(self):
+        # no layer is replaced, the origin model is returned
+        config = DecoderConfig()
+        config.hidden_act = 'gelu'
+        model = RefDecoderModel(config).eval()
+        with self.assertWarnsRegex(UserWarning, "only supports LLaMA style decoder layers"):
+            opt_model = ipex.fast_decoder(model)
+        self.assertIs(opt_model, model)
+
+    def test_tpp_dense_sparse_add(self):
+        # duplicated and unsorted indices, more sparse rows than dense rows
+        for M, NS in [(3, 50), (1000, 4096)]:
+            dense = torch.randn(M, 64)
+            indices = torch.randint(0, M, (1, NS))
+            values = torch.randn(NS, 64)
+            sparse = torch.sparse_coo_tensor(indices, values, (M, 64))
+            ref = dense.clone().add_(sparse, alpha=-0.1)
+            torch_ipex_cpp.tpp_dense_sparse_add_(dense, sparse, -0.1)
+            self.assertEqual(ref, dense, prec=1e-5)
+
 if __name__ == '__main__':
     test = unittest.main()
@@ -1,6 +1,7 @@
 import unittest
 import itertools
 import copy
+import gc
 import os
 import time
 import sys
@@ -1195,6 +1196,82 @@ class TestPrepackCases(TestCase):
     def test_lstm_training(self):
         self._test_lstm(inference=False)
 
+    def test_lstm_inference_decode_steps(self):
+        # Small-batch single-step calls (e.g. RNN-T decoding) reuse the cached
+        # LSTM context; switching batch size or updating weights must not
+        # reuse stale state.
+        torch.manual_seed(0)
+        model = torch.nn.LSTM(input_size=40, hidden_size=37, num_layers=2).eval()
+        ipex_model = ipex.optimize(copy.deepcopy(model), dtype=torch.float, level='O1')
+        with torch.no_grad():
+            for batch_size, seq_len in [(1, 1), (8, 1), (32, 1), (3, 4), (64, 1), (2, 16)]:
+                x = torch.randn(seq_len, batch_size, 40)
+                h = torch.randn(2, batch_size, 37)
+                c = torch.randn(2, batch_size, 37)
+                for _ in range(3):
+                    y_ref, (hy_ref, cy_ref) = model(x, (h, c))
+                    y, (hy, cy) = ipex_model(x, (h, c))
+                    self.assertEqual(y_ref, y, rtol=1e-5, atol=1e-5)
+                    self.assertEqual(hy_ref, hy, rtol=1e-5, atol=1e-5)
+                    self.assertEqual(cy_ref, cy, rtol=1e-5, atol=1e-5)
+                    h, c = hy_ref, cy_ref
+            model.bias_ih_l0.add_(0.5)
+            ipex_model.bias_ih_l0.add_(0.5)
+            x = torch.randn(1, 4, 40)
+            y_ref, _ = model(x)
+            y, _ = ipex_model(x)
+            self.assertEqual(y_ref, y, rtol=1e-5, atol=1e-5)
+
+    def test_lstm_packed_weight_cache(self):
+        # packed LSTM weights are cached once per storage and dropped when the
+        # weights are freed, so reloading a model does not grow the cache
+        base_stats = core._get_packed_weight_cache_stats()
+        # seq_len > 8 takes the oneDNN path, which packs the weights
+        x = torch.randn(10, 2, 40)
+        for _ in range(3):
+            model = torch.nn.LSTM(input_size=40, hidden_size=37, num_layers=2).eval()
+            ipex_model = ipex.optimize(model, dtype=torch.float, level='O1')
+            with torch.no_grad():
+                ipex_model(x)
+                stats = core._get_packed_weight_cache_stats()
+                ipex_model(x)
+                self.assertEqual(core._get_packed_weight_cache_stats(), stats)
+            self.assertTrue(stats["num_weights"] > base_stats["num_weights"])
+            self.assertTrue(stats["num_weights"] <= base_stats["num_weights"] + 4)
+            del model, ipex_model
+            gc.collect()
+            self.assertEqual(core._get_packed_weight_cache_stats(), base_stats)
+
+    def test_lstm_inference_mode(self):
+        # Inference tensors have no version counter; the LSTM context must
+        # still be usable for them and follow their in-place updates.
+        torch.manual_seed(0)
+        model = torch.nn.LSTM(input_size=40, hidden_size=37, num_layers=2).eval()
+        ipex_model = ipex.optimize(copy.deepcopy(model), dtype=torch.float, level='O1')
+        with torch.inference_mode():
+            for batch_size, seq_len in [(1, 1), (4, 2), (64, 1), (2, 16)]:
+                x = torch.randn(seq_len, batch_size, 40)
+                for _ in range(2):
+                    y_ref, (hy_ref, cy_ref) = model(x)
+                    y, (hy, cy) = ipex_model(x)
+                    self.assertEqual(y_ref, y, rtol=1e-5, atol=1e-5)
+                    self.assertEqual(hy_ref, hy, rtol=1e-5, atol=1e-5)
+                    self.assertEqual(cy_ref, cy, rtol=1e-5, atol=1e-5)
+            # Parameters created under inference mode are inference tensors.
+            inference_model = torch.nn.LSTM(input_size=40, hidden_size=37).eval()
+            ipex_inference_model = ipex.optimize(copy.deepcopy(inference_model), dtype=torch.float, level='O1')
+            x = torch.randn(1, 4, 40)
+            for _ in range(2):
+                y_ref, _ = inference_model(x)
+                y, _ = ipex_inference_model(x)
+                self.assertEqual(y_ref, y, rtol=1e-5, atol=1e-5)
+                new_weight = torch.randn_like(inference_model.weight_ih_l0)
+                new_bias = torch.randn_like(inference_model.bias_hh_l0)
+                inference_model.weight_ih_l0.copy_(new_weight)
+                ipex_inference_model.weight_ih_l0.copy_(new_weight)
+                inference_model.bias_hh_l0.copy_(new_bias)
+                ipex_inference_model.bias_hh_l0.copy_(new_bias)
+
     def test_lstm_serialization(self):
         class Lstm(torch.nn.Module):
             def __init__(self, input_size, hidden_size, num_layers, bidirectional, bias, dropout, batch_first):